@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "gb.h"
+#include "mbc.h"
+
+/**
+ * @file dispatch_bench.c
+ * @brief Measures raw instruction throughput of the opcode dispatch engine.
+ *
+ * The same source is built once per engine (gbcee_dispatch_bench_table,
+ * gbcee_dispatch_bench_goto), so running both binaries gives a direct
+ * instructions per second comparison.
+ */
+
+#ifndef GBCEE_BENCH_ENGINE
+#define GBCEE_BENCH_ENGINE "table"
+#endif
+
+/// default number of instructions to execute
+#define DEFAULT_INSTRUCTIONS 50000000ULL
+
+/**
+ * Synthetic workload: a tight loop over WRAM mixing loads, ALU ops,
+ * a CB op and a conditional jump, with a CALL/RET and PUSH/POP per outer pass.
+ */
+static const uint8_t program[] = {
+    0x21, 0x00, 0xC0,   // 0100: LD HL, 0xC000
+    0x0E, 0x00,         // 0103: LD C, 0
+    0x2A,               // 0105: LD A, (HL+)
+    0x80,               // 0106: ADD A, B
+    0x47,               // 0107: LD B, A
+    0xCB, 0x37,         // 0108: SWAP A
+    0xA9,               // 010A: XOR C
+    0x22,               // 010B: LD (HL+), A
+    0x0C,               // 010C: INC C
+    0x20, 0xF6,         // 010D: JR NZ, 0x0105
+    0xC5,               // 010F: PUSH BC
+    0xCD, 0x00, 0x02,   // 0110: CALL 0x0200
+    0xC1,               // 0113: POP BC
+    0xC3, 0x00, 0x01,   // 0114: JP 0x0100
+};
+
+static const uint8_t subroutine[] = {
+    0x3C,               // 0200: INC A
+    0xCB, 0x7F,         // 0201: BIT 7, A
+    0xC9,               // 0203: RET
+};
+
+static double now_seconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long long instructions = DEFAULT_INSTRUCTIONS;
+    if (argc > 1) {
+        instructions = strtoull(argv[1], NULL, 10);
+    }
+
+    gb_t* gb = gb_create();
+    if (!gb) {
+        fprintf(stderr, "Failed to allocate the emulator.\n");
+        return 1;
+    }
+    gb->mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
+    gb->mmu.rom_size = 32 * 1024;
+    if (!gb->mmu.rom_data) {
+        fprintf(stderr, "Failed to allocate benchmark ROM.\n");
+        gb_destroy(gb);
+        return 1;
+    }
+    mbc_init(&gb->mmu); // map the ROM pages like mmu_load_rom would
+
+    for (size_t i = 0; i < sizeof(program); i++) {
+        gb->mmu.rom_data[0x0100 + i] = program[i];
+    }
+    for (size_t i = 0; i < sizeof(subroutine); i++) {
+        gb->mmu.rom_data[0x0200 + i] = subroutine[i];
+    }
+
+    double start = now_seconds();
+    for (unsigned long long i = 0; i < instructions; i++) {
+        if (cpu_step(gb) == 0) {
+            fprintf(stderr, "CPU stopped unexpectedly at 0x%04X\n", gb->cpu.PC);
+            gb_destroy(gb);
+            return 1;
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    printf("engine=%s instructions=%llu seconds=%.3f ips=%.0f (%.2f MIPS)\n",
+        GBCEE_BENCH_ENGINE, instructions, elapsed,
+        instructions / elapsed, instructions / elapsed / 1e6);
+
+    gb_destroy(gb);
+    return 0;
+}
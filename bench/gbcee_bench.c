@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "gb.h"
+#include "emu.h"
+#include "joypad.h"
+#include "movie.h"
+
+/**
+ * @file gbcee_bench.c
+ * @brief Runs a ROM headless for a fixed amount of emulated time and reports throughput as JSON.
+ *
+ * Usage: gbcee_bench <rom> [--frames N | --cycles N] [--input movie]
+ *                    [--no-render] [--no-idle-skip] [--opstats file]
+ *
+ * The ROM runs for N frames (default DEFAULT_FRAMES) or N T-cycles, with
+ * the joypad driven by an optional movie file (see movie.h) so runs are
+ * repeatable. Frames are rendered into an off-screen framebuffer unless
+ * --no-render is given. Nothing but the emulation itself is timed: the ROM
+ * and movie are loaded before the clock starts.
+ *
+ * One JSON object is written to stdout with the emulated work (frames,
+ * T-cycles, instructions executed, cycles covered by idle skipping) and
+ * the host rates (instructions/s as MIPS, cycles/s, frames/s, speed
+ * relative to a real DMG). Instructions skipped by HALT or idle loop
+ * fast-forwarding are not counted, so MIPS drops and frames/s rises when
+ * skipping kicks in.
+ *
+ * --opstats writes the per-opcode profile of the run (see opstats.h) to a
+ * file; it needs a build with GBCEE_OPSTATS and slows the run down.
+ */
+
+/// frames run when neither --frames nor --cycles is given (one emulated minute)
+#define DEFAULT_FRAMES 3600
+
+/// T-cycles per second of a real DMG
+#define DMG_CLOCK_HZ 4194304.0
+
+static uint32_t framebuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+static double now_seconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Writes a JSON string literal (quotes included)
+ *
+ * @param text: string to escape
+ *
+ * @returns void
+ */
+static void print_json_string(const char* text) {
+    putchar('"');
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            printf("\\%c", *p);
+        } else if (*p < 0x20) {
+            printf("\\u%04x", *p);
+        } else {
+            putchar(*p);
+        }
+    }
+    putchar('"');
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s <rom> [--frames N | --cycles N] [--input movie] [--no-render] [--no-idle-skip] [--opstats file]\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    const char* rom_path = NULL;
+    const char* movie_path = NULL;
+    const char* opstats_path = NULL;
+    uint64_t target_frames = DEFAULT_FRAMES;
+    uint64_t target_cycles = 0;     // 0 = run target_frames instead
+    bool render = true;
+    bool idle_skip = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            target_frames = strtoull(argv[++i], NULL, 10);
+            target_cycles = 0;
+        } else if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            target_cycles = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            movie_path = argv[++i];
+        } else if (strcmp(argv[i], "--opstats") == 0 && i + 1 < argc) {
+            opstats_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-render") == 0) {
+            render = false;
+        } else if (strcmp(argv[i], "--no-idle-skip") == 0) {
+            idle_skip = false;
+        } else if (argv[i][0] != '-' && !rom_path) {
+            rom_path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!rom_path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    movie_event_t* movie = NULL;
+    int movie_length = 0;
+    if (movie_path) {
+        movie = movie_load(movie_path, &movie_length);
+        if (movie_length < 0) {
+            fprintf(stderr, "Error: Failed to load movie '%s'.\n", movie_path);
+            return 1;
+        }
+    }
+
+    gb_t* gb = gb_create();
+    if (!gb || mmu_load_rom(gb, rom_path) != 0) {
+        fprintf(stderr, "Error: Failed to load ROM '%s'.\n", rom_path);
+        gb_destroy(gb);
+        free(movie);
+        return 1;
+    }
+    gb->serial_echo = false;    // keep stdout valid JSON
+    gb->idle.enabled = idle_skip;
+    if (render) {
+        ppu_set_framebuffer(gb, framebuffer);
+    }
+    if (opstats_path && !opstats_enable(gb)) {
+        fprintf(stderr, "Error: Opcode profiling is not available in this build (configure with -DGBCEE_OPSTATS=ON).\n");
+        gb_destroy(gb);
+        free(movie);
+        return 1;
+    }
+
+    uint64_t limit = target_cycles ? target_cycles : target_frames * CYCLES_PER_FRAME;
+    uint64_t cycles = 0;
+    int frame = 0;
+    int next_event = 0;
+
+    double start = now_seconds();
+    while (cycles < limit && !gb->cpu.stopped) {
+        // apply every input change that lands on this frame
+        while (next_event < movie_length && movie[next_event].frame <= frame) {
+            joypad_set_buttons(gb, movie[next_event].buttons);
+            next_event++;
+        }
+
+        // whole frames, then the tail of a --cycles run
+        if (limit - cycles >= CYCLES_PER_FRAME) {
+            cycles += emu_run_frame(gb);
+        } else {
+            cycles += cpu_run_cycles(gb, (int)(limit - cycles));
+        }
+        frame++;
+    }
+    double seconds = now_seconds() - start;
+
+    uint64_t instructions = gb->cpu.instructions;
+    double frames = (double)cycles / CYCLES_PER_FRAME;
+    double per_second = seconds > 0 ? 1.0 / seconds : 0.0;
+
+#ifdef GBCEE_DISPATCH_GOTO
+    const char* dispatch = "goto";
+#else
+    const char* dispatch = "table";
+#endif
+
+    printf("{\n");
+    printf("  \"rom\": ");
+    print_json_string(rom_path);
+    printf(",\n  \"input\": ");
+    if (movie_path) {
+        print_json_string(movie_path);
+    } else {
+        printf("null");
+    }
+    printf(",\n");
+    printf("  \"dispatch\": \"%s\",\n", dispatch);
+    printf("  \"lazy_flags\": %s,\n", GBCEE_LAZY_FLAGS ? "true" : "false");
+    printf("  \"render\": %s,\n", render ? "true" : "false");
+    printf("  \"idle_skip\": %s,\n", idle_skip ? "true" : "false");
+    printf("  \"status\": \"%s\",\n", gb->cpu.stopped ? "stopped" : "ok");
+    printf("  \"frames\": %.3f,\n", frames);
+    printf("  \"cycles\": %llu,\n", (unsigned long long)cycles);
+    printf("  \"instructions\": %llu,\n", (unsigned long long)instructions);
+    printf("  \"idle_skipped_cycles\": %llu,\n", (unsigned long long)gb->idle.skipped_cycles);
+    printf("  \"wall_seconds\": %.6f,\n", seconds);
+    printf("  \"mips\": %.3f,\n", instructions * per_second / 1e6);
+    printf("  \"cycles_per_second\": %.0f,\n", cycles * per_second);
+    printf("  \"frames_per_second\": %.1f,\n", frames * per_second);
+    printf("  \"speed\": %.2f,\n", cycles * per_second / DMG_CLOCK_HZ);
+    printf("  \"hash\": \"%016llx\"\n", (unsigned long long)gb_state_hash(gb));
+    printf("}\n");
+
+    if (opstats_path) {
+        FILE* out = fopen(opstats_path, "w");
+        if (!out) {
+            fprintf(stderr, "Error: Failed to write the opcode profile to '%s'.\n", opstats_path);
+        } else {
+            opstats_report(gb, out, 0);
+            fclose(out);
+        }
+    }
+
+    int status = gb->cpu.stopped ? 2 : 0;
+    gb_destroy(gb);
+    free(movie);
+    return status;
+}
@@ -0,0 +1,488 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#include "gb.h"
+#include "alu.h"
+#include "mbc.h"
+
+/**
+ * @file micro_bench.c
+ * @brief Micro-benchmarks for the hot paths: memory access, ALU helpers and opcode dispatch.
+ *
+ * Usage: gbcee_micro_bench [filter] [--samples N] [--sample-ms M]
+ *
+ * Every benchmark is a loop calling one operation many times. The loop
+ * length is first calibrated so one run takes about M milliseconds
+ * (default DEFAULT_SAMPLE_MS), then one warm-up run is thrown away and N
+ * runs (default DEFAULT_SAMPLES) are timed. The report gives, per
+ * benchmark, the mean ns/op with the 95% confidence interval of that mean
+ * (Student's t), the fastest run and the relative spread. Two results whose
+ * intervals do not overlap are a real difference; overlapping ones are
+ * noise. baseline.call times a call to a function that only returns a
+ * field, the loop and call overhead every other number includes.
+ *
+ * Only benchmarks whose name contains the filter are run, e.g.
+ * `gbcee_micro_bench mmu_read.` or `gbcee_micro_bench alu.DAA`.
+ *
+ * The machine is an in-memory MBC1 cartridge (8 ROM banks, 32KB RAM, RAM
+ * enabled, bank 3 mapped at 0x4000), so every memory region is reachable.
+ */
+
+#ifdef GBCEE_DISPATCH_GOTO
+#define GBCEE_BENCH_ENGINE "goto"
+#else
+#define GBCEE_BENCH_ENGINE "table"
+#endif
+
+#define DEFAULT_SAMPLES 20
+#define DEFAULT_SAMPLE_MS 20
+#define MAX_SAMPLES 1000
+
+/// results are folded into this so the compiler cannot drop the calls
+static volatile uint32_t sink;
+
+/// one benchmark: runs its operation `ops` times
+typedef struct micro_bench_t {
+    const char* name;
+    void (*run)(gb_t* gb, uint64_t ops);
+} micro_bench_t;
+
+static double now_seconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+// ==========================================================================
+// Memory access
+// ==========================================================================
+
+/**
+ * Every read/write benchmark walks 256 consecutive addresses from a region
+ * base, so it stays within one region but does not hit a single byte.
+ */
+#define MMU_READ_BENCH(name, base) \
+    static void bench_##name(gb_t* gb, uint64_t ops) { \
+        uint32_t sum = 0; \
+        for (uint64_t i = 0; i < ops; i++) { \
+            sum += mmu_read(gb, (uint16_t)((base) + (i & 0xFF))); \
+        } \
+        sink += sum; \
+    }
+
+#define MMU_WRITE_BENCH(name, base) \
+    static void bench_##name(gb_t* gb, uint64_t ops) { \
+        for (uint64_t i = 0; i < ops; i++) { \
+            mmu_write(gb, (uint16_t)((base) + (i & 0xFF)), (uint8_t)i); \
+        } \
+    }
+
+MMU_READ_BENCH(read_rom0, 0x0100)
+MMU_READ_BENCH(read_romx, 0x4000)
+MMU_READ_BENCH(read_vram, 0x8000)
+MMU_READ_BENCH(read_eram, 0xA000)
+MMU_READ_BENCH(read_wram, 0xC000)
+MMU_READ_BENCH(read_echo, 0xE000)
+MMU_READ_BENCH(read_oam, 0xFE00)
+MMU_READ_BENCH(read_io_hram, 0xFF00)        // IO, HRAM and IE mixed
+
+MMU_WRITE_BENCH(write_vram, 0x8000)
+MMU_WRITE_BENCH(write_eram, 0xA000)
+MMU_WRITE_BENCH(write_wram, 0xC000)
+MMU_WRITE_BENCH(write_echo, 0xE000)
+
+static void bench_read_ly(gb_t* gb, uint64_t ops) {
+    uint32_t sum = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        sum += mmu_read(gb, 0xFF44);
+    }
+    sink += sum;
+}
+
+static void bench_write_hram(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        mmu_write(gb, (uint16_t)(0xFF80 + (i & 0x7F)), (uint8_t)i);
+    }
+}
+
+static void bench_write_bgp(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        mmu_write(gb, 0xFF47, (uint8_t)i);
+    }
+}
+
+// ROM bank switch: every write remaps 0x4000-0x7FFF
+static void bench_write_rom_bank(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        mmu_write(gb, 0x2000, (uint8_t)(1 + (i & 3)));
+    }
+    mmu_write(gb, 0x2000, 3);
+}
+
+
+// ==========================================================================
+// ALU helpers
+// ==========================================================================
+
+/**
+ * Operands come from the loop counter so the flag results vary; A is fed
+ * back through every operation, the way a real instruction stream does.
+ */
+#define ALU_A_BENCH(op) \
+    static void bench_##op(gb_t* gb, uint64_t ops) { \
+        for (uint64_t i = 0; i < ops; i++) { \
+            op(gb, (uint8_t)(i * 37)); \
+        } \
+        sink += gb->cpu.A + cpu_flags(&gb->cpu); \
+    }
+
+ALU_A_BENCH(ADD_A)
+ALU_A_BENCH(ADC_A)
+ALU_A_BENCH(SUB_A)
+ALU_A_BENCH(SBC_A)
+ALU_A_BENCH(CP_A)
+ALU_A_BENCH(AND_A)
+ALU_A_BENCH(XOR_A)
+
+static void bench_INC(gb_t* gb, uint64_t ops) {
+    uint8_t value = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        value = INC(gb, value);
+    }
+    sink += value + cpu_flags(&gb->cpu);
+}
+
+static void bench_DAA(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        gb->cpu.A = (uint8_t)i;
+        flags_store(&gb->cpu, (uint8_t)(i >> 4) & 0x70);   // N, H, C combinations
+        DAA(gb);
+    }
+    sink += gb->cpu.A + cpu_flags(&gb->cpu);
+}
+
+static void bench_ADD_HL(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        ADD_HL(gb, (uint16_t)(i * 4099));
+    }
+    sink += gb->cpu.H + cpu_flags(&gb->cpu);
+}
+
+static void bench_RLC(gb_t* gb, uint64_t ops) {
+    (void)gb;
+    uint8_t value = 0x5A;
+    bool carry = false;
+    for (uint64_t i = 0; i < ops; i++) {
+        value = RLC(value ^ (uint8_t)i, &carry);
+    }
+    sink += value + carry;
+}
+
+static void bench_RR(gb_t* gb, uint64_t ops) {
+    uint8_t value = 0x5A;
+    for (uint64_t i = 0; i < ops; i++) {
+        value = RR(gb, value ^ (uint8_t)i);
+    }
+    sink += value + cpu_flags(&gb->cpu);
+}
+
+static void bench_SWAP(gb_t* gb, uint64_t ops) {
+    uint8_t value = 0x5A;
+    for (uint64_t i = 0; i < ops; i++) {
+        value = SWAP(gb, value ^ (uint8_t)i);
+    }
+    sink += value + cpu_flags(&gb->cpu);
+}
+
+static void bench_BIT(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        BIT(gb, (uint8_t)i, (uint8_t)(i >> 8) & 7);
+    }
+    sink += cpu_flags(&gb->cpu);
+}
+
+
+// ==========================================================================
+// Dispatch
+// ==========================================================================
+
+/// length of the synthetic opcode streams (a power of two)
+#define MIX_LENGTH 4096
+
+static uint8_t base_mix[MIX_LENGTH];
+static uint8_t cb_mix[MIX_LENGTH];
+
+/**
+ * @brief Fills the opcode streams with a fixed pseudo-random mix
+ *
+ * @details Only register to register opcodes are used (LD r,r', ALU A,r,
+ * INC/DEC r, rotates of A, CPL/SCF/CCF, NOP and the CB ops on registers):
+ * they read no operands and touch no memory, so the numbers are dispatch
+ * plus handler and nothing else.
+ *
+ * @returns void
+ */
+static void build_opcode_mixes() {
+    static const uint8_t singles[] = {
+        0x00, 0x04, 0x05, 0x0C, 0x0D, 0x14, 0x15, 0x1C, 0x1D, 0x24, 0x25, 0x2C, 0x2D, 0x3C, 0x3D,
+        0x07, 0x0F, 0x17, 0x1F, 0x2F, 0x37, 0x3F,
+    };
+
+    uint8_t base_ops[256], cb_ops[256];
+    int base_count = 0, cb_count = 0;
+    for (int op = 0x40; op < 0xC0; op++) {
+        if ((op & 0x07) != 0x06 && (op < 0x70 || op >= 0x78)) {    // no (HL) operand, no HALT
+            base_ops[base_count++] = (uint8_t)op;
+        }
+    }
+    for (size_t i = 0; i < sizeof(singles); i++) {
+        base_ops[base_count++] = singles[i];
+    }
+    for (int op = 0; op < 0x100; op++) {
+        if ((op & 0x07) != 0x06) {
+            cb_ops[cb_count++] = (uint8_t)op;
+        }
+    }
+
+    uint32_t seed = 0x9E3779B9u;
+    for (int i = 0; i < MIX_LENGTH; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        base_mix[i] = base_ops[(seed >> 16) % base_count];
+        cb_mix[i] = cb_ops[(seed >> 8) % cb_count];
+    }
+}
+
+static void bench_execute_opcode(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        execute_opcode(gb, base_mix[i & (MIX_LENGTH - 1)]);
+    }
+    sink += gb->cpu.A + cpu_flags(&gb->cpu);
+}
+
+static void bench_execute_cb_opcode(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        execute_cb_opcode(gb, cb_mix[i & (MIX_LENGTH - 1)]);
+    }
+    sink += gb->cpu.A + cpu_flags(&gb->cpu);
+}
+
+// fetch + dispatch + cycle accounting: the same mix laid out as a program at 0xD000,
+// out of reach of the WRAM write benchmarks
+static void bench_cpu_step(gb_t* gb, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        if ((i & (MIX_LENGTH - 1)) == 0) {
+            gb->cpu.PC = 0xD000;
+        }
+        cpu_step(gb);
+    }
+    sink += gb->cpu.A + cpu_flags(&gb->cpu);
+}
+
+// the cheapest out-of-line call into the core: loop plus call overhead
+static void bench_call(gb_t* gb, uint64_t ops) {
+    uint32_t sum = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        sum += mmu_get_ie_register(gb);
+    }
+    sink += sum;
+}
+
+static const micro_bench_t benches[] = {
+    { "baseline.call",          bench_call },
+
+    { "mmu_read.rom0",          bench_read_rom0 },
+    { "mmu_read.romx",          bench_read_romx },
+    { "mmu_read.vram",          bench_read_vram },
+    { "mmu_read.eram",          bench_read_eram },
+    { "mmu_read.wram",          bench_read_wram },
+    { "mmu_read.echo",          bench_read_echo },
+    { "mmu_read.oam",           bench_read_oam },
+    { "mmu_read.io_hram",       bench_read_io_hram },
+    { "mmu_read.ly",            bench_read_ly },
+
+    { "mmu_write.vram",         bench_write_vram },
+    { "mmu_write.eram",         bench_write_eram },
+    { "mmu_write.wram",         bench_write_wram },
+    { "mmu_write.echo",         bench_write_echo },
+    { "mmu_write.hram",         bench_write_hram },
+    { "mmu_write.bgp",          bench_write_bgp },
+    { "mmu_write.rom_bank",     bench_write_rom_bank },
+
+    { "alu.ADD_A",              bench_ADD_A },
+    { "alu.ADC_A",              bench_ADC_A },
+    { "alu.SUB_A",              bench_SUB_A },
+    { "alu.SBC_A",              bench_SBC_A },
+    { "alu.CP_A",               bench_CP_A },
+    { "alu.AND_A",              bench_AND_A },
+    { "alu.XOR_A",              bench_XOR_A },
+    { "alu.INC",                bench_INC },
+    { "alu.DAA",                bench_DAA },
+    { "alu.ADD_HL",             bench_ADD_HL },
+    { "alu.RLC",                bench_RLC },
+    { "alu.RR",                 bench_RR },
+    { "alu.SWAP",               bench_SWAP },
+    { "alu.BIT",                bench_BIT },
+
+    { "dispatch.execute_opcode",    bench_execute_opcode },
+    { "dispatch.execute_cb_opcode", bench_execute_cb_opcode },
+    { "dispatch.cpu_step",          bench_cpu_step },
+};
+
+
+// ==========================================================================
+// Measurement
+// ==========================================================================
+
+/**
+ * @brief Two-sided 95% quantile of Student's t distribution
+ *
+ * @param df: degrees of freedom (samples - 1)
+ *
+ * @returns t such that mean +- t * stderr covers 95%
+ */
+static double student_t95(int df) {
+    static const double table[] = {
+        0.0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df < 1) {
+        return 0.0;
+    }
+    if (df < (int)(sizeof(table) / sizeof(table[0]))) {
+        return table[df];
+    }
+    return df < 60 ? 2.000 : df < 120 ? 1.980 : 1.960;
+}
+
+/**
+ * @brief Creates the benchmark machine (see the file comment)
+ *
+ * @returns the machine, NULL on allocation failure or if RAM or bank 3 did not get mapped
+ */
+static gb_t* create_machine() {
+    gb_t* gb = gb_create();
+    if (!gb) {
+        return NULL;
+    }
+    gb->mmu.rom_size = 8 * 0x4000;
+    gb->mmu.rom_data = (uint8_t*)calloc(gb->mmu.rom_size, 1);
+    if (!gb->mmu.rom_data) {
+        gb_destroy(gb);
+        return NULL;
+    }
+    gb->mmu.rom_data[0x0147] = 0x03;    // MBC1 + RAM + battery (the only MBC that banks here)
+    gb->mmu.rom_data[0x0148] = 0x02;    // 128KB
+    gb->mmu.rom_data[0x0149] = 0x03;    // 32KB RAM
+    gb->mmu.mbc_type = MBC_TYPE_MBC1;
+    mbc_init(&gb->mmu);
+
+    mmu_write(gb, 0x0000, 0x0A);        // enable cartridge RAM
+    mmu_write(gb, 0x2000, 3);
+    gb->serial_echo = false;
+
+    // the ERAM and banked ROM benchmarks are meaningless unless both took effect
+    if (!gb->mmu.eram_ptr || gb->mmu.rom_bankN_ptr != gb->mmu.rom_data + 3 * 0x4000) {
+        gb_destroy(gb);
+        return NULL;
+    }
+
+    memcpy(&gb->mmu.wram[0x1000], base_mix, MIX_LENGTH);     // 0xD000, program for dispatch.cpu_step
+    return gb;
+}
+
+/**
+ * @brief Calibrates, warms up and times one benchmark, then prints its line
+ *
+ * @param bench: benchmark to run
+ * @param samples: timed runs
+ * @param sample_seconds: target duration of one run
+ *
+ * @returns void
+ */
+static void run_bench(gb_t* gb, const micro_bench_t* bench, int samples, double sample_seconds) {
+    // double the loop length until one run takes long enough to time
+    uint64_t ops = 1024;
+    for (;;) {
+        double start = now_seconds();
+        bench->run(gb, ops);
+        double elapsed = now_seconds() - start;
+        if (elapsed >= sample_seconds || ops >= (1ull << 40)) {
+            break;
+        }
+        ops *= elapsed > sample_seconds / 64 ? 2 : 8;
+    }
+    bench->run(gb, ops);    // warm-up
+
+    double ns[MAX_SAMPLES];
+    double sum = 0.0, best = INFINITY;
+    for (int i = 0; i < samples; i++) {
+        double start = now_seconds();
+        bench->run(gb, ops);
+        ns[i] = (now_seconds() - start) * 1e9 / (double)ops;
+        sum += ns[i];
+        if (ns[i] < best) {
+            best = ns[i];
+        }
+    }
+
+    double mean = sum / samples;
+    double variance = 0.0;
+    for (int i = 0; i < samples; i++) {
+        variance += (ns[i] - mean) * (ns[i] - mean);
+    }
+    double stddev = samples > 1 ? sqrt(variance / (samples - 1)) : 0.0;
+    double ci = student_t95(samples - 1) * stddev / sqrt((double)samples);
+
+    printf("%-28s %9.3f  +- %7.3f  %9.3f  %6.1f%%  %12llu\n",
+        bench->name, mean, ci, best, mean > 0 ? 100.0 * stddev / mean : 0.0, (unsigned long long)ops);
+}
+
+int main(int argc, char* argv[]) {
+    const char* filter = NULL;
+    int samples = DEFAULT_SAMPLES;
+    double sample_ms = DEFAULT_SAMPLE_MS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sample-ms") == 0 && i + 1 < argc) {
+            sample_ms = atof(argv[++i]);
+        } else if (argv[i][0] != '-' && !filter) {
+            filter = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [filter] [--samples N] [--sample-ms M]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (samples < 2 || samples > MAX_SAMPLES || sample_ms <= 0) {
+        fprintf(stderr, "--samples must be 2 to %d and --sample-ms positive\n", MAX_SAMPLES);
+        return 1;
+    }
+
+    build_opcode_mixes();
+    gb_t* gb = create_machine();
+    if (!gb) {
+        fprintf(stderr, "Failed to set up the benchmark machine (MBC1, RAM enabled, bank 3).\n");
+        return 1;
+    }
+
+    printf("# engine=%s samples=%d sample_ms=%.0f, ns/op: mean +- 95%% CI, fastest run, stddev/mean, ops per run\n",
+        GBCEE_BENCH_ENGINE, samples, sample_ms);
+    printf("%-28s %9s  %11s  %9s  %7s  %12s\n", "benchmark", "ns/op", "ci95", "min", "spread", "ops");
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (!filter || strstr(benches[i].name, filter)) {
+            run_bench(gb, &benches[i], samples, sample_ms / 1000.0);
+        }
+    }
+
+    gb_destroy(gb);
+    return 0;
+}
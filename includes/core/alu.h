@@ -4,56 +4,59 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
 // Arithmeticv operations 
 
-void ADD_A(uint8_t val);
-void ADC_A(uint8_t val);
-void SUB_A(uint8_t val);
-void SBC_A(uint8_t val);
-void CP_A(uint8_t val);
-uint8_t INC(uint8_t val);
-uint8_t DEC(uint8_t val);
+void ADD_A(gb_t* gb, uint8_t val);
+void ADC_A(gb_t* gb, uint8_t val);
+void SUB_A(gb_t* gb, uint8_t val);
+void SBC_A(gb_t* gb, uint8_t val);
+void CP_A(gb_t* gb, uint8_t val);
+uint8_t INC(gb_t* gb, uint8_t val);
+uint8_t DEC(gb_t* gb, uint8_t val);
 
 // 16- bit arithmetic ops
 
-void ADD_HL(uint16_t val);
-void ADD_SP(uint16_t val);
+void ADD_HL(gb_t* gb, uint16_t val);
+void ADD_SP(gb_t* gb, uint16_t val);
 void INC_16(uint16_t *regist);
 void DEC_16(uint16_t *regist);
 
 // Logical Operations
 
-void AND_A(uint8_t val);
-void OR_A(uint8_t val);
-void XOR_A(uint8_t val);
+void AND_A(gb_t* gb, uint8_t val);
+void OR_A(gb_t* gb, uint8_t val);
+void XOR_A(gb_t* gb, uint8_t val);
 
 // misc ALU ops
 
-uint8_t SWAP(uint8_t val);
-void DAA();
-void CPL();
-void CCF();
-void SCF();
+uint8_t SWAP(gb_t* gb, uint8_t val);
+void DAA(gb_t* gb);
+void CPL(gb_t* gb);
+void CCF(gb_t* gb);
+void SCF(gb_t* gb);
 
 // rotates and shifts
 
 uint8_t RLC(uint8_t value, bool *carry_out); // rotate n left
 uint8_t RL(uint8_t value, bool carry_in, bool *carry_out); // rotate n left through carry
-uint8_t RRC(uint8_t value); // rotate n right 
-uint8_t RR(uint8_t value); // rotate n right through carry
+uint8_t RRC(gb_t* gb, uint8_t value); // rotate n right 
+uint8_t RR(gb_t* gb, uint8_t value); // rotate n right through carry
 
-void SLA(uint8_t *val); // shift n left by 1
-void SRA(uint8_t *val); // shift n arithmetic right
-void SRL(uint8_t *val); // logical shift right
+void SLA(gb_t* gb, uint8_t *val); // shift n left by 1
+void SRA(gb_t* gb, uint8_t *val); // shift n arithmetic right
+void SRL(gb_t* gb, uint8_t *val); // logical shift right
 
 // BIT Opcodes
 
-void BIT(uint8_t val, uint8_t bit);
+void BIT(gb_t* gb, uint8_t val, uint8_t bit);
 void SET(uint8_t *val, uint8_t bit);
 void RES(uint8_t *val, uint8_t bit);
 
 // STACK - based operations
 
-void push16(uint16_t val);
+void push16(gb_t* gb, uint16_t val);
 
 #endif
\ No newline at end of file
@@ -20,27 +20,39 @@ typedef struct CPU {
     uint16_t SP; // Stack pointer
     
     bool halted; // halted flag
-    bool stopped; // used for graceful stoppage
+    bool stopped; // used for graceful stoppage (set when the CPU faults)
     bool ime;           // Master Interrupt enable flag
     bool ime_enable;    // EI (enable interrupts) sets this -> ime becomes true after next instruction 
     bool ime_disable;   // DI (disable interrupts) sets this -> ime becomes false after next instruction
-} CPU;
 
-extern CPU cpu;
+    bool branch_taken;  // set by conditional JR/JP/CALL/RET when the condition holds (selects the taken cycle cost)
+
+    uint64_t instructions;  // executed since gb_create (statistics only, not part of the machine state)
+
+    // last flag-setting ALU operation, F is only derived from it when read (GBCEE_LAZY_FLAGS)
+    struct {
+        uint8_t op;         // FLAGS_* kind, FLAGS_NONE when F is up to date
+        uint8_t a, b;       // operands
+        uint8_t carry;      // carry in (ADC, SBC)
+        uint8_t result;
+    } lazy;
+} CPU;
 
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
 
 
 /* HELPER MACRO DEFINITIONS */
 
-/* Helper macros for combined 16-bit registers */
-#define REG_BC ((cpu.B << 8) | cpu.C)
-#define REG_DE ((cpu.D << 8) | cpu.E)
-#define REG_HL ((cpu.H << 8) | cpu.L)
+/* Helper macros for combined 16-bit registers (expect a `gb_t* gb` in scope) */
+#define REG_BC ((gb->cpu.B << 8) | gb->cpu.C)
+#define REG_DE ((gb->cpu.D << 8) | gb->cpu.E)
+#define REG_HL ((gb->cpu.H << 8) | gb->cpu.L)
 
 /* Setter macros for 16-bit operations */ 
-#define SET_REG_BC(val) do { cpu.B = ((val) >> 8) & 0xFF; cpu.C = (val) & 0xFF; } while (0)
-#define SET_REG_DE(val) do { cpu.D = ((val) >> 8) & 0xFF; cpu.E = (val) & 0xFF; } while (0)
-#define SET_REG_HL(val) do { cpu.H = ((val) >> 8) & 0xFF; cpu.L = (val) & 0xFF; } while (0)
+#define SET_REG_BC(val) do { gb->cpu.B = ((val) >> 8) & 0xFF; gb->cpu.C = (val) & 0xFF; } while (0)
+#define SET_REG_DE(val) do { gb->cpu.D = ((val) >> 8) & 0xFF; gb->cpu.E = (val) & 0xFF; } while (0)
+#define SET_REG_HL(val) do { gb->cpu.H = ((val) >> 8) & 0xFF; gb->cpu.L = (val) & 0xFF; } while (0)
 
 /* Flag definitions for Zero(Z), Negative(N), Half-Carry(H), and Carry(C) */
 #define FLAG_Z 0x80
@@ -49,14 +61,158 @@ extern CPU cpu;
 #define FLAG_C 0x10
 
 
+/**
+ * Lazy flags
+ *
+ * With GBCEE_LAZY_FLAGS=1 the ALU helpers only record the kind of operation
+ * and its operands in cpu.lazy, and F is derived from them when something
+ * reads it: a conditional jump, PUSH AF, ADC/SBC and the rotates through
+ * carry, DAA, CPL/CCF/SCF... Most results are overwritten by the next ALU
+ * operation before anyone looks at them. cpu_step and cpu_run_cycles bring
+ * F up to date before they return, so outside the CPU it is always current.
+ *
+ * Inside the CPU, F is read through flag_z, flag_c and cpu_flags, partly
+ * modified only after flags_sync and overwritten through flags_store.
+ * Without GBCEE_LAZY_FLAGS every flags_set is applied to F right away.
+ */
+#ifndef GBCEE_LAZY_FLAGS
+#define GBCEE_LAZY_FLAGS 0
+#endif
+
+/// how F follows from cpu.lazy, the first three keep the C flag F had before them
+enum {
+    FLAGS_NONE,     // F is up to date
+    FLAGS_INC,      // INC: Z, H from the result, N reset, C kept
+    FLAGS_DEC,      // DEC: Z, H from the result, N set, C kept
+    FLAGS_BIT,      // BIT: Z if the tested bit (result) is 0, H set, N reset, C kept
+    FLAGS_ADD,      // ADD/ADC: a + b + carry
+    FLAGS_SUB,      // SUB/SBC/CP: a - b - carry
+    FLAGS_LOGIC,    // Z from the result, the other flags given in b (AND, OR, XOR, SWAP, shifts)
+};
+
+/**
+ * @brief Flags left by an operation
+ *
+ * @param op FLAGS_* kind of the operation
+ * @param a first operand
+ * @param b second operand (FLAGS_LOGIC: the flags besides Z)
+ * @param carry carry in, 0 or 1
+ * @param result 8-bit result
+ * @param f flags before the operation
+ *
+ * @returns the new value of F
+ */
+static inline uint8_t flags_compute(uint8_t op, uint8_t a, uint8_t b, uint8_t carry, uint8_t result, uint8_t f) {
+    uint8_t z = result == 0 ? FLAG_Z : 0;
+    switch (op) {
+    case FLAGS_INC:
+        return (f & FLAG_C) | z | ((result & 0x0F) == 0x00 ? FLAG_H : 0);
+    case FLAGS_DEC:
+        return (f & FLAG_C) | FLAG_N | z | ((result & 0x0F) == 0x0F ? FLAG_H : 0);
+    case FLAGS_BIT:
+        return (f & FLAG_C) | FLAG_H | z;
+    case FLAGS_ADD:
+        return z | (((a & 0x0F) + (b & 0x0F) + carry) > 0x0F ? FLAG_H : 0) | (a + b + carry > 0xFF ? FLAG_C : 0);
+    case FLAGS_SUB:
+        return FLAG_N | z | ((a & 0x0F) < (b & 0x0F) + carry ? FLAG_H : 0) | (a < b + carry ? FLAG_C : 0);
+    case FLAGS_LOGIC:
+        return z | b;
+    default:
+        return f;
+    }
+}
+
+/**
+ * @brief Current value of F, pending flags included
+ *
+ * @param cpu CPU registers
+ *
+ * @returns F
+ */
+static inline uint8_t cpu_flags(const CPU* cpu) {
+#if GBCEE_LAZY_FLAGS
+    return flags_compute(cpu->lazy.op, cpu->lazy.a, cpu->lazy.b, cpu->lazy.carry, cpu->lazy.result, cpu->F);
+#else
+    return cpu->F;
+#endif
+}
+
+/**
+ * @brief Brings F up to date, before code that changes only some of its bits
+ *
+ * @param cpu CPU registers
+ *
+ * @returns void
+ */
+static inline void flags_sync(CPU* cpu) {
+#if GBCEE_LAZY_FLAGS
+    if (cpu->lazy.op != FLAGS_NONE) {
+        cpu->F = cpu_flags(cpu);
+        cpu->lazy.op = FLAGS_NONE;
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+/**
+ * @brief Overwrites F, dropping any pending flags
+ *
+ * @param cpu CPU registers
+ * @param f new value of F
+ *
+ * @returns void
+ */
+static inline void flags_store(CPU* cpu, uint8_t f) {
+    cpu->F = f;
+    cpu->lazy.op = FLAGS_NONE;
+}
+
+/**
+ * @brief Sets the flags of an ALU operation (see flags_compute for the arguments)
+ *
+ * @returns void
+ */
+static inline void flags_set(CPU* cpu, uint8_t op, uint8_t a, uint8_t b, uint8_t carry, uint8_t result) {
+#if GBCEE_LAZY_FLAGS
+    // the kinds that keep C take it from F, which a pending ADD/SUB/LOGIC has not reached yet
+    if (op <= FLAGS_BIT && cpu->lazy.op > FLAGS_BIT) {
+        flags_sync(cpu);
+    }
+    cpu->lazy.op = op;
+    cpu->lazy.a = a;
+    cpu->lazy.b = b;
+    cpu->lazy.carry = carry;
+    cpu->lazy.result = result;
+#else
+    cpu->F = flags_compute(op, a, b, carry, result, cpu->F);
+#endif
+}
+
+/// Z flag, every pending kind sets it from the result
+static inline bool flag_z(const CPU* cpu) {
+#if GBCEE_LAZY_FLAGS
+    if (cpu->lazy.op != FLAGS_NONE) {
+        return cpu->lazy.result == 0;
+    }
+#endif
+    return (cpu->F & FLAG_Z) != 0;
+}
+
+/// C flag
+static inline bool flag_c(const CPU* cpu) {
+    return (cpu_flags(cpu) & FLAG_C) != 0;
+}
+
+
 
 /**
  * @brief cpu_reset - Resets the CPU to its post-BIOS state.
  *
  * @details Initializes registers and sets PC to 0x0100.
- * No parameters, no return value.
+ * @param gb: emulator instance
  */
-void cpu_reset();
+void cpu_reset(gb_t* gb);
 
 /**
  * @brief cpu_step - Executes a single CPU instruction.
@@ -64,21 +220,36 @@ void cpu_reset();
  * @details Fetches, decodes, and executes one instruction at PC.
  * May modify CPU registers and memory.
  * 
- * @param None 
+ * @param gb: emulator instance
  * 
- * @returns cycle count 
+ * @returns T-cycles consumed by the instruction, 0 if the CPU faulted
  */
-int cpu_step();
+int cpu_step(gb_t* gb);
+
+/**
+ * @brief cpu_run_cycles - Runs instructions, timer and interrupts for a cycle budget.
+ *
+ * @details Batched replacement for calling cpu_step, timer_step and
+ * handle_interrupts once per instruction. Stops early if the CPU faults
+ * (gb->cpu.stopped is set).
+ * 
+ * @param budget T-cycles to run for
+ * 
+ * @returns exact T-cycles consumed, including interrupt dispatch
+ */
+int cpu_run_cycles(gb_t* gb, int budget);
 
 /**
  * @brief execute_opcode: Execution suite for an opcode
  * 
+ * @details Dispatches through a 256-entry handler table, or through
+ * computed goto when built with GBCEE_DISPATCH=GOTO (GCC/Clang only)
+ * 
  * @param opcode: 8-bit opcode
  *
- * @returns
- * int
+ * @returns true on success, false on an illegal opcode
  */
-bool execute_opcode(uint8_t opcode);
+bool execute_opcode(gb_t* gb, uint8_t opcode);
 
 /**
  * @brief execute_cb_opcode: Executes CB Opcodes inside the cpu step
@@ -90,6 +261,16 @@ bool execute_opcode(uint8_t opcode);
  * @note returns true if CB opcode is succesfully executed
  * returns false otherwise
  */
-bool execute_cb_opcode(uint8_t opcode); 
+bool execute_cb_opcode(gb_t* gb, uint8_t opcode); 
+
+/**
+ * @brief cpu_opcode_name: Name of the handler an opcode dispatches to
+ *
+ * @param cb: true for the CB-prefixed table
+ * @param opcode: 8-bit opcode
+ *
+ * @returns the handler's name in cpu.c, e.g. "op_jr_nz_e8" or "cb_bit_7_h"
+ */
+const char* cpu_opcode_name(bool cb, uint8_t opcode);
 
 #endif
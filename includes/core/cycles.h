@@ -3,10 +3,15 @@
 
 #include <stdint.h>
 
-// Base opcode cycles
+// All counts are T-cycles (4 T-cycles = 1 machine cycle)
+
+// Base opcode cycles (not-taken cost for conditional branches)
 extern const uint8_t opcode_cycles[256];
 
-// CB-prefixed opcode cycles
+// Taken cost for conditional JR/JP/CALL/RET, 0 for every other opcode
+extern const uint8_t opcode_cycles_taken[256];
+
+// CB-prefixed opcode cycles (including the 0xCB prefix)
 extern const uint8_t cb_opcode_cycles[256];
 
-#endif
\ No newline at end of file
+#endif
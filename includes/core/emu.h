@@ -0,0 +1,26 @@
+#ifndef EMU_H
+#define EMU_H
+
+/**
+ * @file emu.h
+ * @brief Frame level entry points for running the emulated machine.
+ */
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
+/// T-cycles in one DMG frame (154 scanlines * 456 cycles)
+#define CYCLES_PER_FRAME 70224
+
+/**
+ * @brief Runs the machine for one frame worth of T-cycles.
+ *
+ * @details Instructions are never split, so a frame may overshoot by a few
+ * cycles. The overshoot is carried into the next frame, which keeps the
+ * long run average at exactly CYCLES_PER_FRAME.
+ *
+ * @returns exact T-cycles consumed by this frame (less than a frame if the CPU faulted)
+ */
+int emu_run_frame(gb_t* gb);
+
+#endif
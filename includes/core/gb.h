@@ -0,0 +1,117 @@
+#ifndef GB_H
+#define GB_H
+
+#include "cpu.h"
+#include "mmu.h"
+#include "ppu.h"
+#include "scheduler.h"
+#include "idle.h"
+#include "trace.h"
+#include "opstats.h"
+#include "profiler.h"
+
+/**
+ * @file gb.h
+ * @brief The emulator instance: all state of one emulated Game Boy.
+ *
+ * Every core function takes a `gb_t*` as its first parameter instead of
+ * reaching for globals, so one process can run any number of independent
+ * machines side by side.
+ */
+
+/// the complete state of one emulated machine
+typedef struct gb_t {
+    CPU cpu;                // CPU registers and flags
+    mmu_t mmu;              // memory map, cartridge, timer and interrupt registers
+    ppu_t ppu;              // LCD state machine, renders into a caller-owned framebuffer
+    scheduler_t sched;      // machine clock and the timed peripheral events
+    idle_t idle;            // idle loop detector, idle.enabled turns skipping off
+    trace_t trace;          // instruction trace ring, off until trace_enable
+    opstats_t* opstats;     // per-opcode counters, NULL until opstats_enable
+    profiler_t* profiler;   // PC sampling profiler, NULL until profiler_enable
+    int frame_overshoot;    // cycles the previous frame ran past its boundary (emu_run_frame)
+    bool serial_echo;       // print serial port writes (test ROM output) to stdout
+} gb_t;
+
+/**
+ * @brief Allocates a new machine with the MMU initialized and the scheduler, CPU and PPU reset.
+ *
+ * @returns the new instance, NULL if the allocation failed
+ */
+gb_t* gb_create();
+
+/**
+ * @brief Frees a machine created by gb_create, including its loaded ROM.
+ *
+ * @param gb instance to free (NULL is ignored)
+ *
+ * @returns void
+ */
+void gb_destroy(gb_t* gb);
+
+/**
+ * @brief Hashes the emulated machine state (64-bit FNV-1a).
+ *
+ * @details Covers the CPU registers, all RAM regions, the IO registers,
+ * the interrupt, timer, banking and PPU state. The framebuffer is
+ * caller-owned output rather than state and is left out. Two runs of the same ROM with
+ * the same inputs end on the same hash, so it works as a cheap regression
+ * fingerprint. Host-side data (the ROM pointer, settings) is left out.
+ *
+ * @param gb instance to hash
+ *
+ * @returns the state hash
+ */
+uint64_t gb_state_hash(const gb_t* gb);
+
+
+// ==========================================================================
+// Inline fetch accessors
+// ==========================================================================
+
+/**
+ * @brief Reads an instruction byte, inlined into the CPU's fetch path.
+ *
+ * @details Code runs from ROM, WRAM or HRAM, all of which resolve here
+ * without a call: mapped pages through the page table, HRAM (0xFF80-0xFFFE,
+ * where DMA routines live) through a range check. Anything else takes the
+ * full mmu_read path.
+ *
+ * @param gb emulator instance
+ * @param addr address to read from
+ *
+ * @returns byte at addr
+ */
+static inline uint8_t mmu_fetch8(gb_t* gb, uint16_t addr) {
+    const uint8_t* page = gb->mmu.read_map[addr >> MMU_PAGE_SHIFT];
+    if (page) {
+        return page[addr & 0xFF];
+    }
+    if (addr >= 0xFF80 && addr != 0xFFFF) {
+        return gb->mmu.hram[addr - 0xFF80];
+    }
+    return mmu_read(gb, addr);
+}
+
+/**
+ * @brief Reads a little-endian 16-bit instruction operand.
+ *
+ * @details Both bytes come from the same page unless the operand straddles
+ * a page boundary, in which case it is read byte by byte.
+ *
+ * @param gb emulator instance
+ * @param addr address of the low byte
+ *
+ * @returns the 16-bit value at addr
+ */
+static inline uint16_t mmu_fetch16(gb_t* gb, uint16_t addr) {
+    const uint8_t* page = gb->mmu.read_map[addr >> MMU_PAGE_SHIFT];
+    if (page && (addr & 0xFF) != 0xFF) {
+        return page[addr & 0xFF] | (page[(addr & 0xFF) + 1] << 8);
+    }
+    uint8_t low = mmu_fetch8(gb, addr);
+    uint8_t high = mmu_fetch8(gb, (uint16_t)(addr + 1));
+    return (high << 8) | low;
+}
+
+#endif
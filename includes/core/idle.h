@@ -0,0 +1,130 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
+/**
+ * @file idle.h
+ * @brief Detection and skipping of idle (polling) loops.
+ *
+ * Many ROMs busy-wait on an IO register instead of halting, e.g.
+ * `LDH A,(LY); CP n; JR NZ,-`. When the CPU jumps back to the head of a
+ * short loop in ROM, the run loop records the next iteration: it may only
+ * execute instructions that write nothing (no stores, no stack, no
+ * EI/DI/HALT) and read nothing that changes between scheduled events (DIV
+ * and TIMA do). If that iteration ends in exactly the CPU state it started
+ * in and no event fired meanwhile, every further iteration until the next
+ * event is identical, so the run loop skips those whole iterations at once
+ * and lands on the exact instruction boundary it would have reached anyway.
+ *
+ * Loops found to write or read unstable registers are remembered and not
+ * recorded again. gb->idle.enabled switches the whole thing off.
+ */
+
+/// longest loop body considered, in bytes from the head to the closing branch
+#define IDLE_MAX_BODY 32
+
+/// most instructions one recorded iteration may execute
+#define IDLE_MAX_INSTRUCTIONS 16
+
+/// loops remembered as never idle (direct mapped by the address of the closing branch)
+#define IDLE_REJECT_SLOTS 64
+
+/// idle loop detector of one emulated machine (host side, not machine state)
+typedef struct idle_t {
+    bool enabled;               // skip idle loops (on by default)
+
+    // iteration being recorded
+    uint16_t head;              // loop head, the target of the closing branch
+    uint16_t branch_pc;         // backward branch that closes the loop
+    int instructions;           // instructions executed so far
+    uint64_t next_at_start;     // gb->sched.next when recording started, firing an event changes it
+    uint8_t regs[13];           // CPU state at the loop head when recording started
+
+    uint32_t rejected[IDLE_REJECT_SLOTS];   // (bank << 16 | branch_pc) + 1 of loops that are never idle
+    uint64_t skipped_cycles;    // T-cycles skipped so far
+} idle_t;
+
+/**
+ * @brief Key of a loop in the reject table (banked ROM addresses include the bank).
+ *
+ * @details Loops are told apart by their closing branch, not their head:
+ * a polling loop and the outer loop around it often share the head.
+ *
+ * @param branch_pc address of the branch that closes the loop
+ * @param bank ROM bank mapped at 0x4000 - 0x7FFF
+ *
+ * @returns the key, never 0
+ */
+static inline uint32_t idle_key(uint16_t branch_pc, int bank) {
+    uint32_t bank_bits = branch_pc >= 0x4000 ? (uint32_t)bank : 0;
+    return ((bank_bits << 16) | branch_pc) + 1;
+}
+
+/**
+ * @brief Whether a jump back from branch_pc to head may close an idle loop.
+ *
+ * @details Inlined into the run loop so tight loops that already failed
+ * (or are too long, or run outside ROM) cost a few compares per iteration.
+ *
+ * @param idle detector state
+ * @param head target of the jump
+ * @param branch_pc address of the instruction that jumped back
+ * @param bank ROM bank mapped at 0x4000 - 0x7FFF
+ *
+ * @returns true if the next iteration is worth recording
+ */
+static inline bool idle_candidate(const idle_t* idle, uint16_t head, uint16_t branch_pc, int bank) {
+    return idle->enabled && branch_pc < 0x8000 && branch_pc - head <= IDLE_MAX_BODY &&
+           idle->rejected[branch_pc % IDLE_REJECT_SLOTS] != idle_key(branch_pc, bank);
+}
+
+/**
+ * @brief Forgets every loop and turns skipping on.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void idle_reset(gb_t* gb);
+
+/**
+ * @brief Starts recording the iteration that begins at gb->cpu.PC.
+ *
+ * @param gb emulator instance
+ * @param branch_pc address of the branch that just jumped back to the head
+ *
+ * @returns false if an interrupt is about to be dispatched (the loop is left anyway)
+ */
+bool idle_begin(gb_t* gb, uint16_t branch_pc);
+
+/**
+ * @brief Vets the next instruction of the iteration being recorded.
+ *
+ * @details Called before the instruction executes. A store, stack access,
+ * EI/DI/HALT, a DIV/TIMA read or an overlong iteration marks the loop as
+ * never idle. Leaving the loop just ends the recording.
+ *
+ * @param gb emulator instance
+ * @param pc address of the instruction about to run
+ *
+ * @returns true if the instruction may run as part of the recording
+ */
+bool idle_check_instruction(gb_t* gb, uint16_t pc);
+
+/**
+ * @brief Finishes an iteration that jumped back to the head through the closing branch.
+ *
+ * @param gb emulator instance
+ * @param cycles T-cycles the iteration took
+ * @param remaining T-cycles left in the current run budget
+ *
+ * @returns T-cycles of whole identical iterations the caller can skip (0 if none)
+ */
+int idle_end(gb_t* gb, int cycles, int remaining);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef OPSTATS_H
+#define OPSTATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
+/**
+ * @file opstats.h
+ * @brief Per-opcode execution histogram and cycle profile.
+ *
+ * Counts how many times every base and CB opcode ran and how many T-cycles
+ * it took (taken branches at their taken cost). HALT and idle loop
+ * fast-forwarding run no instructions and are not counted. The report
+ * lists the opcodes by the cycles they used, with their handler names from
+ * cpu.c, so it shows which handlers are worth specialising for a workload.
+ *
+ * Counting is compiled in only with GBCEE_OPSTATS=1 (CMake option
+ * GBCEE_OPSTATS); otherwise the hooks in the CPU expand to nothing.
+ */
+
+#ifndef GBCEE_OPSTATS
+#define GBCEE_OPSTATS 0
+#endif
+
+/// counters of one machine, indexed [0] base / [1] CB-prefixed, then opcode
+typedef struct opstats_t {
+    uint64_t count[2][256];
+    uint64_t cycles[2][256];
+} opstats_t;
+
+/**
+ * @brief Starts counting from zero (allocates the counters on first use).
+ *
+ * @param gb emulator instance
+ *
+ * @returns true on success, false if counting is not compiled in or the allocation failed
+ */
+bool opstats_enable(gb_t* gb);
+
+/**
+ * @brief Stops counting and frees the counters.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void opstats_disable(gb_t* gb);
+
+/**
+ * @brief Writes the report: every executed opcode, most T-cycles first.
+ *
+ * @param gb emulator instance
+ * @param out output stream
+ * @param limit maximum number of opcodes listed (0 for all)
+ *
+ * @returns 0 on success, -1 if counting is off
+ */
+int opstats_report(const gb_t* gb, FILE* out, int limit);
+
+#if GBCEE_OPSTATS
+#define OPSTATS_RECORD(gb, prefix, opcode, cycles) \
+    do { \
+        opstats_t* opstats_ = (gb)->opstats; \
+        if (opstats_) { \
+            opstats_->count[prefix][opcode]++; \
+            opstats_->cycles[prefix][opcode] += (cycles); \
+        } \
+    } while (0)
+#else
+#define OPSTATS_RECORD(gb, prefix, opcode, cycles) do {} while (0)
+#endif
+
+#endif
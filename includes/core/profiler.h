@@ -0,0 +1,184 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
+/**
+ * @file profiler.h
+ * @brief Sampling profiler for the game code: where the emulated CPU spends its time.
+ *
+ * Every `period` emulated T-cycles (a scheduler event, so nothing runs
+ * in between) the profiler records where the CPU is, together with the
+ * call stack that led there. A location is the PC plus the ROM bank it
+ * was mapped from, so code at 0x4000-0x7FFF in different banks never
+ * gets mixed up. A sample that lands late (after a long HALT span)
+ * counts once per period it covers, which keeps the profile proportional
+ * to emulated time.
+ *
+ * Call stacks come from a shadow stack: push16 (CALL, RST, interrupt
+ * dispatch) pushes the return address with the SP it was written at, and
+ * pop16 (RET, RETI) drops every frame whose return address is now above
+ * SP. Frames are also dropped when a sample finds SP above them, which
+ * covers code that discards its return address by hand.
+ *
+ * Locations are symbolized through an optional RGBDS .sym file: each
+ * address resolves to the closest global label at or below it in the
+ * same bank. Results are written as folded stacks (one
+ * `caller;callee;leaf count` line per stack, the input format of
+ * flamegraph.pl and speedscope) or as a flat profile with self and total
+ * samples per function.
+ *
+ * Sampling is compiled in only with GBCEE_PROFILER=1 (CMake option
+ * GBCEE_PROFILER); otherwise the push16/pop16 hooks expand to nothing.
+ */
+
+#ifndef GBCEE_PROFILER
+#define GBCEE_PROFILER 0
+#endif
+
+/// T-cycles between samples when none is given (about 68 samples per frame)
+#define PROFILER_DEFAULT_PERIOD 1024
+
+/// deepest call stack kept, deeper calls are not recorded
+#define PROFILER_MAX_DEPTH 32
+
+/// location: ROM bank in bits 16-31 (0 outside 0x4000-0x7FFF), address in bits 0-15
+typedef uint32_t profiler_loc_t;
+
+/// one frame of the shadow call stack
+typedef struct profiler_frame_t {
+    profiler_loc_t return_loc;  // return address and the bank mapped when it was pushed
+    uint16_t sp;                // where it was pushed
+} profiler_frame_t;
+
+/// one distinct call stack and how often it was sampled
+typedef struct profiler_stack_t {
+    uint64_t samples;
+    uint8_t depth;                              // frames before the leaf
+    profiler_loc_t locs[PROFILER_MAX_DEPTH + 1];  // return addresses outermost first, then the sampled PC
+} profiler_stack_t;
+
+/// profiler state of one machine (host side, not machine state)
+typedef struct profiler_t {
+    uint32_t period;            // T-cycles between samples
+    uint64_t next_sample;       // scheduler time the next sample is due
+    uint64_t total_samples;
+
+    profiler_frame_t frames[PROFILER_MAX_DEPTH];
+    int depth;                  // frames in use
+    int dropped;                // calls past PROFILER_MAX_DEPTH that were not recorded
+
+    profiler_stack_t* stacks;   // distinct stacks sampled so far
+    uint32_t stack_count;
+    uint32_t stack_capacity;
+    uint32_t* index;            // open addressing hash of stack positions + 1 (0 = empty)
+    uint32_t index_size;        // power of two, at least twice stack_count
+} profiler_t;
+
+/// symbols of one .sym file, sorted by location
+typedef struct profiler_symbols_t profiler_symbols_t;
+
+/**
+ * @brief Starts sampling from an empty profile (replacing any previous one).
+ *
+ * @param gb emulator instance
+ * @param period T-cycles between samples (0 for PROFILER_DEFAULT_PERIOD)
+ *
+ * @returns true on success, false if the profiler is not compiled in or the allocation failed
+ */
+bool profiler_enable(gb_t* gb, uint32_t period);
+
+/**
+ * @brief Stops sampling and frees the profile.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void profiler_disable(gb_t* gb);
+
+/**
+ * @brief Scheduler handler: records the current location and call stack.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void profiler_sample(gb_t* gb);
+
+/**
+ * @brief Called by push16 when a return address is pushed (CALL, RST, interrupt).
+ *
+ * @param gb emulator instance (SP already lowered)
+ * @param return_addr the pushed address
+ *
+ * @returns void
+ */
+void profiler_call(gb_t* gb, uint16_t return_addr);
+
+/**
+ * @brief Called by pop16 after a return address was popped (RET, RETI).
+ *
+ * @param gb emulator instance (SP already raised)
+ *
+ * @returns void
+ */
+void profiler_return(gb_t* gb);
+
+/**
+ * @brief Loads an RGBDS .sym file (`BB:AAAA Label` lines, ';' comments).
+ *
+ * @param path .sym file
+ *
+ * @returns the symbols (free with profiler_free_symbols), NULL if the file could not be read
+ */
+profiler_symbols_t* profiler_load_symbols(const char* path);
+
+/**
+ * @brief Frees symbols loaded by profiler_load_symbols.
+ *
+ * @param symbols symbols to free (NULL is ignored)
+ *
+ * @returns void
+ */
+void profiler_free_symbols(profiler_symbols_t* symbols);
+
+/**
+ * @brief Writes the profile as folded stacks, one `frame;frame;leaf count` line per stack.
+ *
+ * @param gb emulator instance
+ * @param out output stream
+ * @param symbols symbols to resolve locations with (NULL prints them as BB:AAAA)
+ *
+ * @returns 0 on success, -1 if the profiler is off
+ */
+int profiler_write_folded(const gb_t* gb, FILE* out, const profiler_symbols_t* symbols);
+
+/**
+ * @brief Writes the flat profile: samples per function, most self samples first.
+ *
+ * @param gb emulator instance
+ * @param out output stream
+ * @param symbols symbols to resolve locations with (NULL lists every sampled address)
+ * @param limit maximum number of functions listed (0 for all)
+ *
+ * @returns 0 on success, -1 if the profiler is off
+ */
+int profiler_write_flat(const gb_t* gb, FILE* out, const profiler_symbols_t* symbols, int limit);
+
+#if GBCEE_PROFILER
+#define PROFILER_CALL(gb, return_addr) \
+    do { if ((gb)->profiler) profiler_call(gb, return_addr); } while (0)
+#define PROFILER_RETURN(gb) \
+    do { if ((gb)->profiler) profiler_return(gb); } while (0)
+#else
+#define PROFILER_CALL(gb, return_addr) do {} while (0)
+#define PROFILER_RETURN(gb) do {} while (0)
+#endif
+
+#endif
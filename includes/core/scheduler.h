@@ -0,0 +1,70 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
+/**
+ * @file scheduler.h
+ * @brief Central event scheduler for the peripherals.
+ *
+ * The CPU loop only advances one clock (gb->sched.now) and compares it
+ * against the earliest due event; peripherals are synced when one of their
+ * events fires or when their registers are accessed, never per instruction.
+ * Each peripheral keeps at most one pending event, so the schedule is a
+ * small array indexed by event kind with the earliest due time cached.
+ */
+
+/// due time of an event that is not scheduled
+#define SCHED_NEVER UINT64_MAX
+
+/// the kinds of timed events, one slot each
+typedef enum sched_event_t {
+    SCHED_TIMER,        // next TIMA overflow (timer_sync)
+    SCHED_PPU,          // next PPU mode change (ppu_sync)
+    SCHED_PROFILER,     // next profiler sample, never scheduled unless profiling (profiler_sample)
+    SCHED_EVENT_COUNT,
+} sched_event_t;
+
+/// event schedule of one emulated machine
+typedef struct scheduler_t {
+    uint64_t now;                       // T-cycles run since power on
+    uint64_t next;                      // earliest time in due[], the only value the CPU loop checks
+    uint64_t due[SCHED_EVENT_COUNT];    // absolute time each event fires, SCHED_NEVER while idle
+} scheduler_t;
+
+/**
+ * @brief Clears the schedule and restarts the clock at 0.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void scheduler_reset(gb_t* gb);
+
+/**
+ * @brief Sets (or moves) the time an event fires.
+ *
+ * @param gb emulator instance
+ * @param event event kind, replaces any earlier time for it
+ * @param when absolute time in T-cycles, SCHED_NEVER to cancel it
+ *
+ * @returns void
+ */
+void scheduler_schedule(gb_t* gb, sched_event_t event, uint64_t when);
+
+/**
+ * @brief Fires every event that is due at gb->sched.now.
+ *
+ * @details Each event is unscheduled before its handler runs; the handler
+ * syncs its peripheral, which schedules the following event again.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void scheduler_run(gb_t* gb);
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
+/**
+ * @file trace.h
+ * @brief Binary instruction trace kept in an in-memory ring buffer.
+ *
+ * Every executed instruction is stored as a fixed-size record (PC, bank,
+ * opcode bytes, registers) overwriting the oldest one once the ring is
+ * full. Nothing is formatted while the machine runs: the ring is written
+ * to a file when the CPU faults (if trace.dump_path is set) or when
+ * trace_dump is called, and tools/gbcee_trace.c turns the file into text.
+ *
+ * Recording is compiled in only with GBCEE_TRACE=1 (CMake option
+ * GBCEE_TRACE); otherwise the hook in the CPU expands to nothing.
+ *
+ * File layout, all integers little endian:
+ *   header  "GBCTRACE", u32 version (1), u32 record count, u64 instructions seen
+ *   records oldest first, TRACE_RECORD_SIZE bytes each:
+ *           u16 PC, u16 SP, u8 ROM bank, u8 opcode, u8 operand[2],
+ *           u8 A, F, B, C, D, E, H, L
+ */
+
+#ifndef GBCEE_TRACE
+#define GBCEE_TRACE 0
+#endif
+
+#define TRACE_MAGIC "GBCTRACE"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 24
+#define TRACE_RECORD_SIZE 16
+
+/// ring size used when none is given (records, a power of two)
+#define TRACE_DEFAULT_CAPACITY (1u << 16)
+
+/// one executed instruction, registers as they were before it ran
+typedef struct trace_record_t {
+    uint16_t pc;
+    uint16_t sp;
+    uint8_t bank;           // ROM bank mapped at 0x4000 - 0x7FFF
+    uint8_t opcode;
+    uint8_t operand[2];     // the two bytes after the opcode (CB opcode, immediates)
+    uint8_t a, f, b, c, d, e, h, l;
+} trace_record_t;
+
+/// trace ring of one machine (host side, not machine state)
+typedef struct trace_t {
+    trace_record_t* records;    // NULL while tracing is off
+    uint32_t capacity;          // power of two
+    uint64_t count;             // instructions recorded since trace_enable
+    const char* dump_path;      // written when the CPU faults (caller-owned, NULL for none)
+} trace_t;
+
+/**
+ * @brief Starts tracing into a fresh ring (replacing any previous one).
+ *
+ * @param gb emulator instance
+ * @param capacity records kept, rounded up to a power of two (0 for TRACE_DEFAULT_CAPACITY)
+ *
+ * @returns true on success, false if tracing is not compiled in or the allocation failed
+ */
+bool trace_enable(gb_t* gb, uint32_t capacity);
+
+/**
+ * @brief Stops tracing and frees the ring.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void trace_disable(gb_t* gb);
+
+/**
+ * @brief Appends one instruction to the ring.
+ *
+ * @param gb emulator instance (tracing enabled)
+ * @param pc address of the instruction
+ * @param opcode first opcode byte
+ *
+ * @returns void
+ */
+void trace_record(gb_t* gb, uint16_t pc, uint8_t opcode);
+
+/**
+ * @brief Writes the ring to a file, oldest record first.
+ *
+ * @param gb emulator instance
+ * @param path output file
+ *
+ * @returns 0 on success, -1 if tracing is off or the file could not be written
+ */
+int trace_dump(const gb_t* gb, const char* path);
+
+/**
+ * @brief Called by the CPU when it faults: dumps the ring to trace.dump_path if both are set.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void trace_fault(const gb_t* gb);
+
+#if GBCEE_TRACE
+#define TRACE_INSTRUCTION(gb, pc, opcode) \
+    do { if ((gb)->trace.records) trace_record(gb, pc, opcode); } while (0)
+#define TRACE_FAULT(gb) trace_fault(gb)
+#else
+#define TRACE_INSTRUCTION(gb, pc, opcode) do {} while (0)
+#define TRACE_FAULT(gb) do {} while (0)
+#endif
+
+#endif
@@ -7,10 +7,14 @@
         DEBUG CONFIGURATION
 ========================================
 Flip these to 1 or 0 as needed
+
+Logging is compiled out unless DEBUG_MASTER is 1 (CMake option
+GBCEE_LOGGING), so release builds pay nothing for it. LOG_CPU_STATE
+prints every instruction; for long runs use the binary trace (trace.h).
 */
 
 #ifndef DEBUG_MASTER
-#define DEBUG_MASTER 1   // master switch (0 = kill ALL logs)
+#define DEBUG_MASTER 0   // master switch (0 = kill ALL logs)
 #endif
 
 #ifndef DEBUG_CPU
@@ -71,12 +75,12 @@ Flip these to 1 or 0 as needed
 // Full CPU state dump (reuse anywhere)
 #define LOG_CPU_STATE(pc, opcode, cpu) \
     LOG_CPU("[PC=0x%04X] Opcode 0x%02X | A=%02X F=%02X B=%02X C=%02X D=%02X E=%02X H=%02X L=%02X SP=%04X\n", \
-        pc, opcode, cpu.A, cpu.F, cpu.B, cpu.C, cpu.D, cpu.E, cpu.H, cpu.L, cpu.SP)
+        pc, opcode, cpu.A, cpu_flags(&(cpu)), cpu.B, cpu.C, cpu.D, cpu.E, cpu.H, cpu.L, cpu.SP)
 
 // CB-prefixed version
 #define LOG_CB_STATE(pc, opcode, cpu) \
     LOG_CB("[PC=0x%04X] Opcode 0xCB %02X | A=%02X F=%02X B=%02X C=%02X D=%02X E=%02X H=%02X L=%02X SP=%04X\n", \
-        pc, opcode, cpu.A, cpu.F, cpu.B, cpu.C, cpu.D, cpu.E, cpu.H, cpu.L, cpu.SP)
+        pc, opcode, cpu.A, cpu_flags(&(cpu)), cpu.B, cpu.C, cpu.D, cpu.E, cpu.H, cpu.L, cpu.SP)
 
 /*
 ========================================
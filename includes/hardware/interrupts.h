@@ -3,6 +3,9 @@
 
 #include "alu.h" // for push16
 
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
 /**
  * @brief Handles the CPU interrupt cycle
  * 
@@ -12,11 +15,11 @@
  * 
  * checks for pending and enabled interrupts
  * 
- * @param none
+ * @param gb: emulator instance
  * 
- * @returns void
+ * @returns T-cycles spent dispatching (20 when an interrupt is serviced, 0 otherwise)
  */ 
-void handle_interrupts();
+int handle_interrupts(gb_t* gb);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef JOYPAD_H
+#define JOYPAD_H
+
+#include <stdint.h>
+
+/**
+ * @file joypad.h
+ * @brief The JOYP register (0xFF00) and the button state behind it.
+ *
+ * Buttons are passed around as one byte, a set bit meaning "pressed".
+ * The low nibble is the D-pad and the high nibble the action buttons,
+ * which matches the two nibbles the game selects through JOYP.
+ */
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
+#define JOYPAD_RIGHT  0x01
+#define JOYPAD_LEFT   0x02
+#define JOYPAD_UP     0x04
+#define JOYPAD_DOWN   0x08
+#define JOYPAD_A      0x10
+#define JOYPAD_B      0x20
+#define JOYPAD_SELECT 0x40
+#define JOYPAD_START  0x80
+
+/**
+ * @brief Sets which buttons are currently held down.
+ *
+ * @details Requests the joypad interrupt (IF bit 4) for every button that
+ * goes from released to pressed.
+ *
+ * @param gb emulator instance
+ * @param buttons mask of JOYPAD_* bits, set = pressed
+ *
+ * @returns void
+ */
+void joypad_set_buttons(gb_t* gb, uint8_t buttons);
+
+/**
+ * @brief Reads JOYP (0xFF00) for the nibble(s) the game has selected.
+ *
+ * @param gb emulator instance
+ *
+ * @returns register value, inputs are active low like on hardware
+ */
+uint8_t joypad_read(gb_t* gb);
+
+#endif
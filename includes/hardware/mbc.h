@@ -16,6 +16,22 @@ typedef struct mmu_t mmu_t;
 void mbc_init(mmu_t* mmu);
 
 
+/**
+ * @brief Recomputes the cached bank pointers and the ROM/external RAM pages of the memory map
+ * 
+ * @details Called by mbc_init and after every bank switch or RAM enable
+ * change, so reads never redo the bank math. Pages that cannot be mapped
+ * directly (no ROM loaded, RAM disabled, out of range banks) are left NULL
+ * and fall back to the mbc_read / mbc_write handlers. Code that plants
+ * rom_data by hand has to call mbc_init afterwards.
+ * 
+ * @param mmu: pointer to the main mmu struct
+ * 
+ * @return void
+ */
+void mbc_update_map(mmu_t* mmu);
+
+
 /**
  * @brief Handles reads from 0x0000 to 0x7FFF ROM area
  * 
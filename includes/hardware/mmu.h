@@ -7,6 +7,9 @@
 
 #include "rom.h"
 
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
 // =================================================
 // Global Size definitions
 // =================================================
@@ -26,8 +29,9 @@
 /// IO register size (128 bytes)
 #define IO_SIZE 0x80
 
-/// Max External RAM size (32KB)
-#define MAX_ERAM_SIZE (32 * 1024)
+/// The memory map is split into 256 pages of 256 bytes each
+#define MMU_PAGE_COUNT 256
+#define MMU_PAGE_SHIFT 8
 
 
 // ===================================================
@@ -36,13 +40,24 @@
 
 /// the core mmu struct which stores all memory and state
 typedef struct mmu_t {
-    // dynamically allocated rom data
+    // page table: one entry per 256-byte page pointing straight at the backing
+    // memory, NULL sends the access through the handler chain (IO, MBC registers...)
+    uint8_t* read_map[MMU_PAGE_COUNT];
+    uint8_t* write_map[MMU_PAGE_COUNT];
+
+    // rom data: a read-only shared image from the ROM cache when rom_image is set,
+    // otherwise a heap buffer planted by hand (tests, benchmarks) that mmu_free frees.
+    // rom_size is always a power of two multiple of 16KB (and at least 32KB)
     uint8_t* rom_data;
     size_t rom_size;
+    rom_image_t* rom_image;
+
+    // external (cartridge) RAM, allocated by mbc_init at the size the header declares
+    uint8_t* eram;
+    size_t eram_size;           // 0 if the cartridge has no RAM
 
     // internal memory regions
     uint8_t vram[VRAM_SIZE];
-    uint8_t eram[MAX_ERAM_SIZE];
     uint8_t wram[WRAM_SIZE];
     uint8_t oam[OAM_SIZE];
     uint8_t io[IO_SIZE];
@@ -59,22 +74,33 @@ typedef struct mmu_t {
     int current_ram_bank;
     int mbc1_mode;
 
+    uint32_t rom_bank_mask;     // ROM bank count - 1, bank numbers wrap like the real address lines
+
+    // Cached bank pointers, recomputed by mbc_update_map whenever the MBC registers change
+    uint8_t* rom_bank0_ptr;     // bank mapped at 0x0000-0x3FFF, NULL without a ROM
+    uint8_t* rom_bankN_ptr;     // bank mapped at 0x4000-0x7FFF, NULL without a ROM
+    uint8_t* eram_ptr;          // RAM bank at 0xA000-0xBFFF, NULL while RAM is disabled or absent
+
     // Timer registers and internal state
     uint16_t internal_timer;    // 16-bit counter for DIV
     uint8_t tima;               // 0xFF05 - TIMA register counter
     uint8_t tma;                // 0xFF06 - Timer modulo
     uint8_t tac;                // 0xFF07 - Timer control
+    uint64_t timer_synced_at;   // scheduler time (gb->sched.now) the timer was last brought up to date
+
+    // Joypad
+    uint8_t joypad_buttons;     // JOYPAD_* mask of held buttons, set = pressed
 } mmu_t;
 
 /**
  * @brief mmu_init - 
  * Initializes Main Memory Unit memory regions.
  *
- * Clears RAM and prepares memory map. No parameters.
+ * Clears RAM and prepares memory map.
  * 
  * @returns void
  */
-void mmu_init();
+void mmu_init(gb_t* gb);
 
 /**
  * @brief mmu_free -
@@ -82,7 +108,7 @@ void mmu_init();
  * 
  * @returns void
  */
-void mmu_free();
+void mmu_free(gb_t* gb);
 
 /**
  * @brief mmu_read - Reads a byte from the specified address.
@@ -91,7 +117,7 @@ void mmu_free();
  *
  * @returns uint8_t Value at address.
  */
-uint8_t mmu_read(uint16_t addr);
+uint8_t mmu_read(gb_t* gb, uint16_t addr);
 
 /**
  * mmu_write - 
@@ -103,7 +129,7 @@ uint8_t mmu_read(uint16_t addr);
  * 
  * Return: void
  */
-void mmu_write(uint16_t addr, uint8_t value);
+void mmu_write(gb_t* gb, uint16_t addr, uint8_t value);
 
 
 /**
@@ -112,7 +138,7 @@ void mmu_write(uint16_t addr, uint8_t value);
  * @param filepath The path to the Game Boy ROM file.
  * @return 0 on success, or -1 on failure (e.g., file not found).
  */
-int mmu_load_rom(const char* filepath);
+int mmu_load_rom(gb_t* gb, const char* filepath);
 
 // removed external loading for bound checks
 
@@ -121,13 +147,13 @@ int mmu_load_rom(const char* filepath);
 * 
 * @return The 8-bit value of the IE register.
 */
-uint8_t mmu_get_ie_register();
+uint8_t mmu_get_ie_register(gb_t* gb);
 
 /**
 * @brief Gets the current value of the Interrupt Flag (IF) register 
 * 
 * @return The 8-bit value of the IF register.
 */
-uint8_t mmu_get_if_register();
+uint8_t mmu_get_if_register(gb_t* gb);
 
 #endif
\ No newline at end of file
@@ -2,28 +2,164 @@
 #define PPU_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#include "ppu_kernels.h"
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
+/**
+ * @file ppu.h
+ * @brief Scanline based Pixel Processing Unit.
+ *
+ * The PPU walks every scanline through OAM scan -> drawing -> HBlank, then
+ * spends 10 lines in VBlank, keeping LY/STAT and the VBlank/STAT interrupts
+ * in step. A whole scanline (background, window, sprites) is rendered into
+ * the framebuffer when its drawing mode ends, instead of emulating each dot.
+ *
+ * The framebuffer belongs to the caller (see ppu_set_framebuffer). Without
+ * one the PPU still runs its full timing but composes no pixels, which is
+ * all a render-less frontend needs. Frame skipping (ppu_set_render_skip)
+ * does the same for all but every Nth frame.
+ */
+
+// change according to screen sizes
+#define SCREEN_WIDTH 160
+#define SCREEN_HEIGHT 144
+
+/// tiles in VRAM tile data (0x8000 - 0x97FF, 16 bytes each)
+#define PPU_TILE_COUNT 384
+
+/// PPU modes, as reported in the low 2 bits of STAT
+typedef enum ppu_mode_t {
+    PPU_MODE_HBLANK = 0,
+    PPU_MODE_VBLANK = 1,
+    PPU_MODE_OAM_SCAN = 2,
+    PPU_MODE_DRAWING = 3,
+} ppu_mode_t;
+
+/// PPU state of one emulated machine
+typedef struct ppu_t {
+    // caller-owned ARGB8888 output, one row of SCREEN_WIDTH pixels per scanline (NULL: not drawn)
+    uint32_t* framebuffer;
+
+    ppu_mode_t mode;
+    int dot;                // T-cycles into the current scanline (0 - 455)
+    uint8_t ly;             // current scanline (0 - 153)
+    uint8_t window_line;    // window row to draw next, only advances on lines showing the window
+    bool stat_line;         // level of the STAT interrupt line, the interrupt fires on its rising edge
+    bool frame_ready;       // set when VBlank ends a rendered frame, cleared by whoever presents it
+
+    // frame skipping, a host setting like the framebuffer (not machine state)
+    int render_skip;        // frames skipped after every rendered one (0: render every frame)
+    int skip_countdown;     // frames still to skip before the next rendered one
+    bool render_frame;      // whether the frame in progress composes pixels
+
+    uint64_t synced_at;     // scheduler time (gb->sched.now) the PPU was last brought up to date
+
+    // Decoded tile cache: every tile row as 8 color indices (0 - 3), leftmost pixel first.
+    // VRAM tile data writes only mark the tile dirty, it is decoded again on its next use.
+    uint8_t tile_cache[PPU_TILE_COUNT][8][8];
+    bool tile_dirty[PPU_TILE_COUNT];
+
+    const ppu_kernels_t* kernels;   // pixel kernels, the best the CPU supports (ppu_kernels_best)
+} ppu_t;
+
+/**
+ * @brief Puts the PPU and the LCD registers in their post boot ROM state.
+ *
+ * @param gb emulator instance
+ *
+ * @returns void
+ */
+void ppu_reset(gb_t* gb);
+
+/**
+ * @brief Points the PPU at the buffer scanlines are rendered into.
+ *
+ * @details The buffer is owned by the caller and must hold
+ * SCREEN_WIDTH * SCREEN_HEIGHT pixels for as long as it is attached. It is
+ * cleared to white. Passing NULL detaches it: timing, LY/STAT and interrupts
+ * are unaffected, only the pixel composition is skipped.
+ *
+ * @param gb emulator instance
+ * @param framebuffer ARGB8888 buffer, or NULL to render nothing
+ *
+ * @returns void
+ */
+void ppu_set_framebuffer(gb_t* gb, uint32_t* framebuffer);
+
+/**
+ * @brief Renders only every (frames + 1)th frame.
+ *
+ * @details Skipped frames still advance modes, LY, STAT and the interrupts
+ * exactly, so the game runs identically; they just fetch no tiles and
+ * write no pixels, and do not set frame_ready. The frame in progress counts
+ * as the last rendered one, so the next `frames` frames are skipped.
+ *
+ * @param gb emulator instance
+ * @param frames frames to skip after each rendered one (0 renders every frame)
+ *
+ * @returns void
+ */
+void ppu_set_render_skip(gb_t* gb, int frames);
+
+/**
+ * @brief Marks the decoded copy of a VRAM tile stale, called on tile data writes.
+ *
+ * @param gb emulator instance
+ * @param addr address written (0x8000 - 0x97FF)
+ *
+ * @returns void
+ */
+void ppu_tile_written(gb_t* gb, uint16_t addr);
+
+/**
+ * @brief Advances the PPU by a number of T-cycles.
+ *
+ * @details Walks through every mode change in the span: renders a scanline
+ * when its drawing mode ends, raises VBlank when LY reaches 144 and STAT on
+ * the rising edge of any enabled STAT source. Does nothing while the LCD is off.
+ *
+ * @param gb emulator instance
+ * @param cycles T-cycles to advance by
+ *
+ * @returns void
+ */
+void ppu_step(gb_t* gb, int cycles);
 
 /**
- * init_ppu - Initializes the PPU (Pixel Processing Unit).
+ * @brief Brings the PPU up to gb->sched.now and schedules its next mode change.
+ *
+ * @details Like the timer, the PPU is only synced when its SCHED_PPU event
+ * fires or before an LCD register is accessed, never per instruction.
  *
- * Resets internal registers and prepares the PPU for rendering.
+ * @param gb emulator instance
+ *
+ * @returns void
  */
-void init_ppu();
+void ppu_sync(gb_t* gb);
 
 /**
- * ppu_step - Advances the PPU by one step (typically per CPU cycle).
+ * @brief Reads an LCD register (0xFF40 - 0xFF4B, except DMA at 0xFF46).
+ *
+ * @param gb emulator instance
+ * @param addr register address
  *
- * Simulates rendering phases (OAM Search, Drawing, HBlank, VBlank).
- * Should be called once per CPU cycle or as part of frame scheduling.
+ * @returns the up to date register value
  */
-void ppu_step();
+uint8_t ppu_read(gb_t* gb, uint16_t addr);
 
 /**
- * ppu_render_frame - Renders the full frame to the SDL window.
+ * @brief Writes an LCD register (0xFF40 - 0xFF4B, except DMA at 0xFF46).
+ *
+ * @param gb emulator instance
+ * @param addr register address
+ * @param value value to be written
  *
- * Draws the current screen contents using SDL.
- * Should be called after each complete frame (VBlank).
+ * @returns void
  */
-void ppu_render_frame();
+void ppu_write(gb_t* gb, uint16_t addr, uint8_t value);
 
 #endif
@@ -0,0 +1,63 @@
+#ifndef PPU_KERNELS_H
+#define PPU_KERNELS_H
+
+#include <stdint.h>
+
+/**
+ * @file ppu_kernels.h
+ * @brief Pixel kernels of the scanline renderer, with SIMD variants.
+ *
+ * Every kernel exists as a portable scalar version and, on x86 with
+ * GCC/Clang, as SSE2 and AVX2 versions compiled through target attributes
+ * (no global -mavx2 needed). All variants produce bit-identical output.
+ * Each PPU picks the best table its CPU supports when it is reset.
+ */
+
+/// instruction sets a kernel table can be built for
+typedef enum ppu_kernel_isa_t {
+    PPU_KERNELS_SCALAR,
+    PPU_KERNELS_SSE2,
+    PPU_KERNELS_AVX2,
+    PPU_KERNELS_ISA_COUNT,
+} ppu_kernel_isa_t;
+
+/// one set of kernels
+typedef struct ppu_kernels_t {
+    const char* name;
+
+    /**
+     * @brief Decodes a 16-byte 2bpp tile into 8 rows of 8 color indices (0 - 3).
+     *
+     * @param data tile data, 2 bytes (low, high bitplane) per row
+     * @param out receives 64 color indices, row by row, leftmost pixel first
+     */
+    void (*decode_tile)(const uint8_t* data, uint8_t* out);
+
+    /**
+     * @brief Maps color indices to ARGB8888 pixels through a 4-entry lookup table.
+     *
+     * @param index color indices (0 - 3)
+     * @param lut ARGB8888 color of each index (a palette register applied to the shades)
+     * @param out receives count pixels
+     * @param count number of pixels
+     */
+    void (*expand_line)(const uint8_t* index, const uint32_t lut[4], uint32_t* out, int count);
+} ppu_kernels_t;
+
+/**
+ * @brief Kernel table for one instruction set.
+ *
+ * @param isa instruction set
+ *
+ * @returns the table, NULL if it is not compiled in or the CPU lacks the instruction set
+ */
+const ppu_kernels_t* ppu_kernels_for(ppu_kernel_isa_t isa);
+
+/**
+ * @brief Fastest kernel table the running CPU supports.
+ *
+ * @returns the table (never NULL, falls back to scalar)
+ */
+const ppu_kernels_t* ppu_kernels_best();
+
+#endif
@@ -1,6 +1,11 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include <stdint.h>
+
+/// emulator instance, defined in gb.h
+typedef struct gb_t gb_t;
+
 /**
  * @file timer.h
  * @brief Public interface for the Game Boy's timer and divider system.
@@ -29,8 +34,10 @@
  * If enabled, it determines the correct frequency for the TIMA
  * counter based on the lower two bits of the TAC register.
  * 
- *  It checks for a "falling edge" on a specific bit of the internal
- * DIV counter, which is the trigger for incrementing TIMA.
+ *  It counts the "falling edges" of a specific bit of the internal
+ * DIV counter in the span, each of which increments TIMA. The count and
+ * the resulting TIMA are computed in closed form, so any step size costs
+ * the same and none is ever missed.
  * 
  * If TIMA overflows (goes from 0xFF to 0x00), it reloads TIMA with
  * the value from the TMA register and requests a timer interrupt
@@ -38,6 +45,38 @@
  * 
  * @returns void
  */
-void timer_step(int cycles);
+void timer_step(gb_t* gb, int cycles);
+
+/**
+ * @brief Brings the timer up to gb->sched.now and schedules its next TIMA overflow.
+ *
+ * @details The batched run loop (cpu_run_cycles) only advances the scheduler
+ * clock; this runs when the SCHED_TIMER event fires, i.e. at the next TIMA
+ * overflow, the only point where the timer affects anything but its own
+ * registers. Register accesses sync first as well, so DIV/TIMA/TAC always
+ * read back exact values.
+ *
+ * @returns void
+ */
+void timer_sync(gb_t* gb);
+
+/**
+ * @brief Reads DIV, TIMA, TMA or TAC (0xFF04 - 0xFF07) after syncing the timer.
+ *
+ * @param addr register address
+ *
+ * @returns register value
+ */
+uint8_t timer_read(gb_t* gb, uint16_t addr);
+
+/**
+ * @brief Writes DIV, TIMA, TMA or TAC (0xFF04 - 0xFF07) after syncing the timer.
+ *
+ * @param addr register address
+ * @param value value to be written (any DIV write resets the counter)
+ *
+ * @returns void
+ */
+void timer_write(gb_t* gb, uint16_t addr, uint8_t value);
 
-#endif
\ No newline at end of file
+#endif
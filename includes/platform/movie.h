@@ -0,0 +1,45 @@
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file movie.h
+ * @brief Scripted joypad input for headless runs (gbcee_batch, gbcee_bench).
+ *
+ * Movie file: one input change per line, `<frame> <buttons>`, held until
+ * the next line. Buttons are names joined with '+' (A, B, SELECT, START,
+ * RIGHT, LEFT, UP, DOWN) or '-' for none, e.g. `120 START` then `126 -`.
+ * Frames must be increasing; blank lines and lines starting with '#' are
+ * skipped.
+ */
+
+/// one input change from a movie file
+typedef struct movie_event_t {
+    int frame;
+    uint8_t buttons;    // JOYPAD_* mask held from this frame on
+} movie_event_t;
+
+/**
+ * @brief Parses a button list such as "A+START" or "-".
+ *
+ * @param text button list (names are case insensitive)
+ * @param out_buttons receives the JOYPAD_* mask
+ *
+ * @returns true on success, false on an unknown button name
+ */
+bool movie_parse_buttons(const char* text, uint8_t* out_buttons);
+
+/**
+ * @brief Loads a movie file.
+ *
+ * @param path movie file
+ * @param out_count receives the number of events
+ *
+ * @returns malloc'd events sorted by frame (NULL with *out_count == 0 for an
+ * empty movie), NULL with *out_count == -1 on failure
+ */
+movie_event_t* movie_load(const char* path, int* out_count);
+
+#endif
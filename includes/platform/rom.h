@@ -25,17 +25,54 @@ typedef enum mbc_type_t {
 
 extern mbc_type_t mbc_type;
 
+/// a loaded ROM file, shared by every instance running the same game
+typedef struct rom_image_t rom_image_t;
+
 /**
- * @brief load_rom - loads a ROM file, allocates memory for it, and parses its header
+ * @brief load_rom - loads a ROM file through the process-wide ROM cache and parses its header
  * 
+ * The file is mapped read-only (mmap, MAP_PRIVATE) instead of copied, and images are
+ * cached by path + size + header checksums, so N instances of the same game share one
+ * physical copy. The returned rom data must never be written to. Its size is always a
+ * power of two of at least 32KB covering the size declared at 0x0148, files that are
+ * shorter get a heap copy padded with 0xFF.
+ *
  * Parameters: 
  * @param path Path to the ROM file.
- * @param out_rom_data pointer to an uint8_t* that will be set to the allocated rom data
+ * @param out_image pointer to a rom_image_t* that will be set to the cache entry (hand back with rom_release)
+ * @param out_rom_data pointer to an uint8_t* that will be set to the read-only rom data
  * @param out_rom_size pointer to a size_t that will be set to the size of the rom
  * @param out_mbc_type pointer to an mbc_type_t
  *
  * @returns 1 on success, 0 on failure.
  */
-int load_rom(const char* path, uint8_t** out_rom_data, size_t* out_rom_size, mbc_type_t* out_mbc_type);
+int load_rom(const char* path, rom_image_t** out_image, uint8_t** out_rom_data, size_t* out_rom_size, mbc_type_t* out_mbc_type);
+
+/**
+ * @brief rom_header_rom_size - decodes the cartridge header ROM size byte (0x0148)
+ *
+ * @param size_code ROM size byte
+ *
+ * @returns the ROM size in bytes, 0 for an unknown code
+ */
+size_t rom_header_rom_size(uint8_t size_code);
+
+/**
+ * @brief rom_header_ram_size - decodes the cartridge header RAM size byte (0x0149)
+ *
+ * @param size_code RAM size byte
+ *
+ * @returns the external RAM size in bytes, 0 if the cartridge has none
+ */
+size_t rom_header_ram_size(uint8_t size_code);
+
+/**
+ * @brief rom_release - drops a reference taken by load_rom, unmapping the image once nobody uses it
+ *
+ * @param image cache entry returned by load_rom (NULL is ignored)
+ *
+ * @returns void
+ */
+void rom_release(rom_image_t* image);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef VIDEO_H
+#define VIDEO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file video.h
+ * @brief Frontend-agnostic video output.
+ *
+ * The PPU only renders into a caller-owned framebuffer (ppu_set_framebuffer);
+ * a video backend is the frontend side that does something with finished
+ * frames. The headless backend is always available and has no display
+ * dependency. The SDL2 window is only compiled in when the build found SDL2
+ * (GBCEE_HAVE_SDL).
+ */
+
+/// one video frontend
+typedef struct video_backend_t {
+    const char* name;
+
+    /**
+     * @brief Opens the output (window, device, ...).
+     *
+     * @returns true on success
+     */
+    bool (*init)();
+
+    /**
+     * @brief Shows a finished 160x144 ARGB8888 frame.
+     *
+     * @param framebuffer the frame, as attached to the PPU
+     */
+    void (*present)(const uint32_t* framebuffer);
+
+    /**
+     * @brief Drains pending frontend events.
+     *
+     * @returns false once the user asked to quit
+     */
+    bool (*poll)();
+
+    /**
+     * @brief Closes the output again.
+     */
+    void (*shutdown)();
+} video_backend_t;
+
+/// no output at all, for servers and batch jobs
+extern const video_backend_t video_headless;
+
+#ifdef GBCEE_HAVE_SDL
+/// SDL2 window at 2x scale
+extern const video_backend_t video_sdl;
+#endif
+
+/**
+ * @brief Looks a compiled-in backend up by name.
+ *
+ * @param name backend name ("headless", "sdl")
+ *
+ * @returns the backend, NULL if it is unknown or not compiled in
+ */
+const video_backend_t* video_find(const char* name);
+
+/**
+ * @brief Backend used when none is asked for: the SDL window if compiled in, headless otherwise.
+ *
+ * @returns the backend (never NULL)
+ */
+const video_backend_t* video_default();
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "cpu.h"
 #include "mmu.h"
+#include "gb.h"
 
 /* Flag bit Masks 
  * GameBoy CPU:
@@ -19,9 +20,9 @@
 #define FLAG_C 0x10
 
 /* Helper macros for combined 16-bit registers */
-#define REG_BC ((cpu.B << 8) | cpu.C)
-#define REG_DE ((cpu.D << 8) | cpu.E)
-#define REG_HL ((cpu.H << 8) | cpu.L)
+#define REG_BC ((gb->cpu.B << 8) | gb->cpu.C)
+#define REG_DE ((gb->cpu.D << 8) | gb->cpu.E)
+#define REG_HL ((gb->cpu.H << 8) | gb->cpu.L)
 
 
 /* ARITHMETIC OPERATIONS */
@@ -41,19 +42,10 @@
  * 
  * @return  void
  */
-void ADD_A(uint8_t val) {
-    uint16_t result = cpu.A + val;
-    cpu.F = 0;
-    if ((result & 0xFF) == 0) {
-        cpu.F |= FLAG_Z;
-    }
-    if ((cpu.A & 0x0F) + (val & 0x0F) > 0x0F) {
-        cpu.F |= FLAG_H;
-    }
-    if (result > 0xFF) {
-        cpu.F |= FLAG_C;
-    }
-    cpu.A = result & 0xFF;
+void ADD_A(gb_t* gb, uint8_t val) {
+    uint8_t result = gb->cpu.A + val;
+    flags_set(&gb->cpu, FLAGS_ADD, gb->cpu.A, val, 0, result);
+    gb->cpu.A = result;
 }
 
 
@@ -64,23 +56,11 @@ void ADD_A(uint8_t val) {
  * 
  * @return void
  */
-void ADC_A(uint8_t val) {
-    uint8_t carry = (cpu.F & FLAG_C) ? 1 : 0;
-    uint16_t result = cpu.A + val + carry;
-
-    cpu.F = 0; // reset flag
-
-    if ((result & 0xFF) == 0) {
-        cpu.F |= FLAG_Z;
-    }
-    if (((cpu.A & 0x0F) + (val & 0x0F) + carry) & 0x10) {
-        cpu.F |= FLAG_H;
-    }
-    if (result > 0xFF) {
-        cpu.F |= FLAG_C;
-    }
-
-    cpu.A = result & 0xFF;
+void ADC_A(gb_t* gb, uint8_t val) {
+    uint8_t carry = flag_c(&gb->cpu) ? 1 : 0;
+    uint8_t result = gb->cpu.A + val + carry;
+    flags_set(&gb->cpu, FLAGS_ADD, gb->cpu.A, val, carry, result);
+    gb->cpu.A = result;
 }
 
 
@@ -92,19 +72,10 @@ void ADC_A(uint8_t val) {
  * 
  * @return  void    
  */
-void SUB_A(uint8_t val) { 
-    cpu.F = FLAG_N;
-    if ((cpu.A & 0x0F) < (val & 0x0F)) {
-        cpu.F |= FLAG_H;
-    }
-    if (cpu.A < val) {
-        cpu.F |= FLAG_C; 
-    }
-    cpu.A -= val;
-
-    if (cpu.A == 0) {
-        cpu.F |= FLAG_Z;
-    }
+void SUB_A(gb_t* gb, uint8_t val) { 
+    uint8_t result = gb->cpu.A - val;
+    flags_set(&gb->cpu, FLAGS_SUB, gb->cpu.A, val, 0, result);
+    gb->cpu.A = result;
 }
 
 
@@ -115,22 +86,11 @@ void SUB_A(uint8_t val) {
  * 
  * @return void
  */
-void SBC_A(uint8_t val) {
-    uint8_t carry = (cpu.F & FLAG_C) ? 1 : 0;
-    uint16_t result = cpu.A - val - carry;
-
-    cpu.F = FLAG_N;
-
-    if ((result & 0xFF) == 0) {
-        cpu.F |= FLAG_Z;
-    }
-    if ((cpu.A & 0x0F) < ((val & 0x0F) + carry)) {
-        cpu.F |= FLAG_H;
-    }
-    if (cpu.A < (val + carry)) {
-        cpu.F |= FLAG_C;
-    }
-    cpu.A = result & 0xFF;
+void SBC_A(gb_t* gb, uint8_t val) {
+    uint8_t carry = flag_c(&gb->cpu) ? 1 : 0;
+    uint8_t result = gb->cpu.A - val - carry;
+    flags_set(&gb->cpu, FLAGS_SUB, gb->cpu.A, val, carry, result);
+    gb->cpu.A = result;
 }
 
 /**
@@ -142,18 +102,9 @@ void SBC_A(uint8_t val) {
  * 
  * @return void
  */
-void CP_A(uint8_t val) {
-    cpu.F = FLAG_N;
-    if ((cpu.A & 0x0F) < (val & 0x0F)) {
-        cpu.F |= FLAG_H;
-    }
-    if (cpu.A < val) {
-        cpu.F |= FLAG_C;
-    }
-    uint8_t result = cpu.A - val;
-    if (result == 0) {
-        cpu.F |= FLAG_Z;
-    }
+void CP_A(gb_t* gb, uint8_t val) {
+    uint8_t result = gb->cpu.A - val;
+    flags_set(&gb->cpu, FLAGS_SUB, gb->cpu.A, val, 0, result);
 }
 
 
@@ -172,24 +123,26 @@ void CP_A(uint8_t val) {
  * 
  * @returns void
  */
-void ADD_HL(uint16_t val) {
+void ADD_HL(gb_t* gb, uint16_t val) {
     uint32_t result = REG_HL + val;
     uint16_t old_hl = REG_HL;
 
+    flags_sync(&gb->cpu);
+
     //preserve Z, reset N, clear H and C
-    cpu.F &= FLAG_Z; // Z flag is NOT affected by this instruction
+    gb->cpu.F &= FLAG_Z; // Z flag is NOT affected by this instruction
 
     // Check half carry from bit 11
     if (((old_hl & 0x0FFF) + (val & 0x0FFF)) > 0x0FFF)
-        cpu.F |= FLAG_H;
+        gb->cpu.F |= FLAG_H;
     else
-        cpu.F &= ~FLAG_H;
+        gb->cpu.F &= ~FLAG_H;
 
     // Check full carry from bit 15
     if (result > 0xFFFF)
-        cpu.F |= FLAG_C;
+        gb->cpu.F |= FLAG_C;
     else
-        cpu.F &= ~FLAG_C;
+        gb->cpu.F &= ~FLAG_C;
 
     // set H and L values as expected
     SET_REG_HL(result & 0xFFFF);
@@ -208,21 +161,22 @@ void ADD_HL(uint16_t val) {
  * 
  * @returns void
  */
-void ADD_SP(uint16_t val) {
-    uint16_t sp = cpu.SP;
+void ADD_SP(gb_t* gb, uint16_t val) {
+    uint16_t sp = gb->cpu.SP;
     uint16_t result = sp + val;
 
-    cpu.F = 0; // Reset Z and N
+    uint8_t flags = 0; // Reset Z and N
 
     // Half-carry check (bit 3)
     if (((sp & 0x0F) + (val & 0x0F)) > 0x0F) {
-        cpu.F |= FLAG_H;
+        flags |= FLAG_H;
     }
     // Full-carry check (bit 7)
     if (((sp & 0xFF) + (val & 0xFF)) > 0xFF) {
-        cpu.F |= FLAG_C;
+        flags |= FLAG_C;
     }
-    cpu.SP = result;
+    flags_store(&gb->cpu, flags);
+    gb->cpu.SP = result;
 }
 
 
@@ -279,15 +233,11 @@ void DEC_16(uint16_t *regist) {
  * H: Set.
  * C: Reset.
  */
-void AND_A(uint8_t val) {
-    cpu.A &= val; //apply logical AND
+void AND_A(gb_t* gb, uint8_t val) {
+    gb->cpu.A &= val; //apply logical AND
 
-    cpu.F = FLAG_H; // half-carry is ALWAYS set
-
-    if (cpu.A == 0) {
-        cpu.F |= FLAG_Z;
-    }
-    // N and C are implicitly reset by setting F = FLAG_H | FLAG_Z
+    // half-carry is ALWAYS set, Z from the result, N and C reset
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, FLAG_H, 0, gb->cpu.A);
 }
 
 /** 
@@ -297,12 +247,9 @@ void AND_A(uint8_t val) {
  * 
  * @return void
  */
-void OR_A(uint8_t val) {
-    cpu.A |= val; //apply logical OR
-    cpu.F = 0; // set half carry to 0
-    if (cpu.A == 0) {
-        cpu.F |= FLAG_Z;
-    }
+void OR_A(gb_t* gb, uint8_t val) {
+    gb->cpu.A |= val; //apply logical OR
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, 0, 0, gb->cpu.A); // only Z can be set
 }
 
 
@@ -313,12 +260,9 @@ void OR_A(uint8_t val) {
  *
  * @return  void
  */
-void XOR_A(uint8_t val) {
-    cpu.A ^= val; // XOR setting step
-    cpu.F = 0; //set half carry to 0
-    if (cpu.A == 0) {
-        cpu.F |= FLAG_Z;
-    }
+void XOR_A(gb_t* gb, uint8_t val) {
+    gb->cpu.A ^= val; // XOR setting step
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, 0, 0, gb->cpu.A); // only Z can be set
 }
 
 
@@ -344,14 +288,10 @@ void XOR_A(uint8_t val) {
  * 
  * 
  */
-uint8_t SWAP(uint8_t val) {
+uint8_t SWAP(gb_t* gb, uint8_t val) {
     uint8_t result = (val >> 4) | (val << 4);
 
-    cpu.F = 0; // clear all flags
-
-    if (result == 0) {
-        cpu.F = FLAG_Z; // set Z flag if result is 0
-    }
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, 0, 0, result); // only Z can be set
     return result;
 }
 
@@ -366,21 +306,11 @@ uint8_t SWAP(uint8_t val) {
  * 
  * @return uint8_t: incremented value
  */
-uint8_t INC(uint8_t val) {
+uint8_t INC(gb_t* gb, uint8_t val) {
     uint8_t result = val + 1;
 
-    // clear Z, H, N flags
-    // preserve carry flag
-    cpu.F &= FLAG_C;
-
-    if (result == 0) {
-        cpu.F |= FLAG_Z;
-    }
-    // half carry if lower nible overflows
-    if ((val & 0x0F) == 0x0F) {
-        cpu.F |= FLAG_H;
-    }
-    // N cleared already by &= FLAG_C
+    // Z if 0, half carry if the lower nibble overflowed (to 0), N reset, carry preserved
+    flags_set(&gb->cpu, FLAGS_INC, val, 1, 0, result);
     return result;
 }
 
@@ -395,23 +325,11 @@ uint8_t INC(uint8_t val) {
  * 
  * @return uint8_t decremented value
  */
-uint8_t DEC(uint8_t val) {
+uint8_t DEC(gb_t* gb, uint8_t val) {
     uint8_t result = val - 1;
 
-    // clear z, h
-    // set n
-    // preserve C
-    cpu.F &= FLAG_C;
-    cpu.F |= FLAG_N;
-
-    if (result == 0) {
-        cpu.F |= FLAG_Z;
-    }
-    // half borrow:
-    // if lower nibble borrows (0x10 -> 0x0F)
-    if ((val & 0x0F) == 0x00) {
-        cpu.F |= FLAG_H;
-    }
+    // Z if 0, half borrow if the lower nibble borrowed (to 0x0F), N set, C preserved
+    flags_set(&gb->cpu, FLAGS_DEC, val, 1, 0, result);
     return result;
 }
 
@@ -424,26 +342,28 @@ uint8_t DEC(uint8_t val) {
  * 
  * uses opcode 0x27
  * 
- * @param none
+ * @param gb: emulator instance
  * 
  * @return none
  */
-void DAA() {
-    uint16_t a = cpu.A;
+void DAA(gb_t* gb) {
+    uint16_t a = gb->cpu.A;
+
+    flags_sync(&gb->cpu);
 
-    if (!(cpu.F & FLAG_N)) { // After an addition
-        if ((cpu.F & FLAG_C) || a > 0x99) {
+    if (!(gb->cpu.F & FLAG_N)) { // After an addition
+        if ((gb->cpu.F & FLAG_C) || a > 0x99) {
             a += 0x60;
-            cpu.F |= FLAG_C;
+            gb->cpu.F |= FLAG_C;
         }
-        if ((cpu.F & FLAG_H) || (a & 0x0F) > 0x09) {
+        if ((gb->cpu.F & FLAG_H) || (a & 0x0F) > 0x09) {
             a += 0x06;
         }
     } else { // After a subtraction
-        if (cpu.F & FLAG_C) {
+        if (gb->cpu.F & FLAG_C) {
             a -= 0x60;
         }
-        if (cpu.F & FLAG_H) {
+        if (gb->cpu.F & FLAG_H) {
             a -= 0x06;
         }
     }
@@ -451,22 +371,22 @@ void DAA() {
     // Flag Logic:
 
     // The H flag is always cleared
-    cpu.F &= ~FLAG_H; 
+    gb->cpu.F &= ~FLAG_H; 
 
     // the Z flag is set based on results   
     if ((a & 0xFF) == 0) {
-        cpu.F |= FLAG_Z;
+        gb->cpu.F |= FLAG_Z;
     } else {
-        cpu.F &= ~FLAG_Z;
+        gb->cpu.F &= ~FLAG_Z;
     }   
     
     // The C flag is set if the addition path caused a carry out 
     if ((a & 0x100) != 0) {
-        cpu.F |= FLAG_C; // preserve the carry
+        gb->cpu.F |= FLAG_C; // preserve the carry
     }
 
     //update the A register with the adjusted value
-    cpu.A = a & 0xFF;
+    gb->cpu.A = a & 0xFF;
 }
 
 
@@ -481,14 +401,15 @@ void DAA() {
  * 
  * uses opcode 0x2F
  * 
- * @param none
+ * @param gb: emulator instance
  * 
  * @return void
  * 
  */
-void CPL() {
-    cpu.A = ~cpu.A;
-    cpu.F |= FLAG_N | FLAG_H;
+void CPL(gb_t* gb) {
+    gb->cpu.A = ~gb->cpu.A;
+    flags_sync(&gb->cpu);
+    gb->cpu.F |= FLAG_N | FLAG_H;
 }
 
 
@@ -506,13 +427,14 @@ void CPL() {
 
  * opcode 0x3F
  *
- * @param none
+ * @param gb: emulator instance
  * 
  * @returns void
  */
-void CCF() {
-    cpu.F &= ~(FLAG_N | FLAG_H); // reset N and H flags
-    cpu.F ^= FLAG_C; // toggle carry flag (main logic)
+void CCF(gb_t* gb) {
+    flags_sync(&gb->cpu);
+    gb->cpu.F &= ~(FLAG_N | FLAG_H); // reset N and H flags
+    gb->cpu.F ^= FLAG_C; // toggle carry flag (main logic)
 }
 
 
@@ -525,13 +447,14 @@ void CCF() {
     H - Reset.
     C - Set.
  *
- * @param none
+ * @param gb: emulator instance
  * 
  * @returns void
  */
-void SCF() {
-    cpu.F &= ~(FLAG_N | FLAG_H); // reset N and H flags
-    cpu.F |= FLAG_C; // set carry flag
+void SCF(gb_t* gb) {
+    flags_sync(&gb->cpu);
+    gb->cpu.F &= ~(FLAG_N | FLAG_H); // reset N and H flags
+    gb->cpu.F |= FLAG_C; // set carry flag
 }
 
 
@@ -580,14 +503,12 @@ uint8_t RL(uint8_t value, bool carry_in, bool *carry_out) {
  * 
  * @returns uint8_t The result of rotation
  */
-uint8_t RRC(uint8_t value) {
+uint8_t RRC(gb_t* gb, uint8_t value) {
     uint8_t bit0 = value & 0x01;
     uint8_t result = (value >> 1) | (bit0 << 7); // Rotate right
 
-    // Set flags
-    cpu.F = 0;
-    if (result == 0) cpu.F |= 0x80;  // Z
-    if (bit0)        cpu.F |= 0x10;  // C
+    // Set flags: Z from the result, C = old bit 0
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, bit0 ? FLAG_C : 0, 0, result);
 
     return result;
 }
@@ -600,15 +521,13 @@ uint8_t RRC(uint8_t value) {
  * 
  * @returns uint8_t The result of rotation
  */
-uint8_t RR(uint8_t value) {
-    uint8_t carry = (cpu.F & 0x10) ? 1 : 0;   // old carry
+uint8_t RR(gb_t* gb, uint8_t value) {
+    uint8_t carry = flag_c(&gb->cpu) ? 1 : 0;   // old carry
     uint8_t bit0 = value & 0x01;
     uint8_t result = (value >> 1) | (carry << 7);
 
-    // Set flags
-    cpu.F = 0;
-    if (result == 0) cpu.F |= 0x80;  // Z
-    if (bit0)        cpu.F |= 0x10;  // C
+    // Set flags: Z from the result, C = old bit 0
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, bit0 ? FLAG_C : 0, 0, result);
 
     return result;
 }
@@ -627,14 +546,12 @@ uint8_t RR(uint8_t value) {
  * 
  * @returns void
  */
-void SLA(uint8_t *val) {
+void SLA(gb_t* gb, uint8_t *val) {
     uint8_t old = *val;
     uint8_t result = old << 1;
 
-    // Set flags
-    cpu.F = 0;
-    if (result == 0) cpu.F |= FLAG_Z;
-    if (old & 0x80) cpu.F |= FLAG_C;  // old MSB
+    // Set flags: Z from the result, C = old MSB
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, (old & 0x80) ? FLAG_C : 0, 0, result);
 
     *val = result;
 }
@@ -653,15 +570,13 @@ void SLA(uint8_t *val) {
  * 
  * @returns void
  */
-void SRA(uint8_t *val) {
+void SRA(gb_t* gb, uint8_t *val) {
     uint8_t old = *val;
     uint8_t msb = old & 0x80;
     uint8_t result = (old >> 1) | msb;
 
-    // Set flags
-    cpu.F = 0;
-    if (result == 0) cpu.F |= FLAG_Z;
-    if (old & 0x01) cpu.F |= FLAG_C;  // old LSB
+    // Set flags: Z from the result, C = old LSB
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, (old & 0x01) ? FLAG_C : 0, 0, result);
 
     *val = result;
 }
@@ -679,14 +594,12 @@ void SRA(uint8_t *val) {
  * 
  * @returns void
  */
-void SRL(uint8_t *val) {
+void SRL(gb_t* gb, uint8_t *val) {
     uint8_t old = *val;
     uint8_t result = old >> 1;
 
-    // Set flags
-    cpu.F = 0;
-    if (result == 0) cpu.F |= FLAG_Z;
-    if (old & 0x01) cpu.F |= FLAG_C;  // old LSB
+    // Set flags: Z from the result, C = old LSB
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, (old & 0x01) ? FLAG_C : 0, 0, result);
 
     *val = result;
 }
@@ -711,17 +624,10 @@ void SRL(uint8_t *val) {
  * 
  * @returns void
  */
-void BIT(uint8_t value, uint8_t bit) {
+void BIT(gb_t* gb, uint8_t value, uint8_t bit) {
     // Preserve Carry flag, reset N, set H
-    cpu.F &= FLAG_C;
-    cpu.F |= FLAG_H;
-    cpu.F &= ~FLAG_N;
-
     // Set or reset Z depending on whether bit is 0
-    if ((value & (1 << bit)) == 0)
-        cpu.F |= FLAG_Z;
-    else
-        cpu.F &= ~FLAG_Z;
+    flags_set(&gb->cpu, FLAGS_BIT, value, bit, 0, value & (1 << bit));
 }
 
 
@@ -761,7 +667,8 @@ void RES(uint8_t* value, uint8_t bit) {
  * 
  * @param val :value to be pushed
  */
-void push16(uint16_t val) {
-    mmu_write(--cpu.SP, (val >> 8) & 0xFF); // higher byte
-    mmu_write(--cpu.SP, val & 0xFF);    // lower byte
+void push16(gb_t* gb, uint16_t val) {
+    mmu_write(gb, --gb->cpu.SP, (val >> 8) & 0xFF); // higher byte
+    mmu_write(gb, --gb->cpu.SP, val & 0xFF);    // lower byte
+    PROFILER_CALL(gb, val); // only ever pushes return addresses
 }
\ No newline at end of file
@@ -1,44 +1,66 @@
 #include "cpu.h"
+#include "gb.h"
 #include "mmu.h"
 #include "rom.h"
 #include "alu.h"
+#include "cycles.h"
+#include "timer.h"
+#include "ppu.h"
+#include "scheduler.h"
+#include "idle.h"
+#include "trace.h"
+#include "opstats.h"
+#include "profiler.h"
+#include "interrupts.h"
 
 #include "debug.h"
 
 #include <stdbool.h>
 #include <stdio.h>
 
-CPU cpu;
 
 // relocated macroes to headerfile
 
+/**
+ * Dispatch engine selection
+ *
+ * GBCEE_DISPATCH_GOTO selects the computed-goto dispatcher (labels as values),
+ * which is a GNU extension and only available on GCC/Clang.
+ * Every other configuration falls back to the portable handler table.
+ */
+#if defined(GBCEE_DISPATCH_GOTO) && !(defined(__GNUC__) || defined(__clang__))
+#undef GBCEE_DISPATCH_GOTO
+#endif
+
 /**
  * @brief cpu_reset - Resets the CPU to its post-BIOS state.
  *
  * Initializes registers and sets PC to 0x0100.
- * 
+ *
  * @returns void
  */
-void cpu_reset() {
-    cpu.A = 0x01; // int 1
-    cpu.F = 0xB0; // int 176
-    cpu.B = 0x00; // int 0
-    cpu.C = 0x13; // int 19
-    cpu.D = 0x00; // int 0
-    cpu.E = 0xD8; // int 216
-    cpu.H = 0x01; // int 1
-    cpu.L = 0x4D; // int 77
+void cpu_reset(gb_t* gb) {
+    gb->cpu.A = 0x01; // int 1
+    flags_store(&gb->cpu, 0xB0); // int 176
+    gb->cpu.B = 0x00; // int 0
+    gb->cpu.C = 0x13; // int 19
+    gb->cpu.D = 0x00; // int 0
+    gb->cpu.E = 0xD8; // int 216
+    gb->cpu.H = 0x01; // int 1
+    gb->cpu.L = 0x4D; // int 77
     // Stack Pointer
-    cpu.SP = 0xFFFE; //int 65534
+    gb->cpu.SP = 0xFFFE; //int 65534
     // Program counter
-    cpu.PC = 0x0100; // int 256
+    gb->cpu.PC = 0x0100; // int 256
+
+    gb->cpu.halted = false;
+    gb->cpu.stopped = false;
 
-    cpu.halted = false;
-    cpu.stopped = false;
+    gb->cpu.ime = false;
+    gb->cpu.ime_enable = false;
+    gb->cpu.ime_disable = false;
 
-    cpu.ime = false;
-    cpu.ime_enable = false;
-    cpu.ime_disable = false;
+    gb->cpu.branch_taken = false;
 }
 
 
@@ -46,2238 +68,1745 @@ void cpu_reset() {
 
 /**
  * @brief Function to fetch the next 8-bit value
- * 
+ *
  * @details Fetches the next 8-bit immediate value and increments the PC
- * 
+ *
  * @note the definition scope for this function needs to be static
- * 
- * @param none
- * 
- * @returns the immediate 8-bit value uint8_t 
+ *
+ * @param gb: emulator instance
+ *
+ * @returns the immediate 8-bit value uint8_t
  */
-static uint8_t fetch_d8() {
-    return(mmu_read(cpu.PC++));
+static inline uint8_t fetch_d8(gb_t* gb) {
+    return(mmu_fetch8(gb, gb->cpu.PC++));
 }
 
 
 /**
  * @brief Function to fetch the next 16-bit value
- * 
+ *
  * @details Fetches the next 16-bit immediate value (little-endian) and advances the PC
- * 
+ *
  * @note the definition scope is required to be static
- * 
- * @param none
- * 
- * @returns next 16-bit immediate value 
- */
-static uint16_t fetch_d16() {
-    uint8_t low = mmu_read(cpu.PC++);
-    uint8_t high = mmu_read(cpu.PC++);
+ *
+ * @param gb: emulator instance
+ *
+ * @returns next 16-bit immediate value
+ */
+static inline uint16_t fetch_d16(gb_t* gb) {
+    uint16_t value = mmu_fetch16(gb, gb->cpu.PC);
+    gb->cpu.PC += 2;
+    return value;
+}
+
+
+/**
+ * @brief Pops a 16-bit value off the stack (low byte first)
+ *
+ * @returns the popped 16-bit value
+ */
+static uint16_t pop16(gb_t* gb) {
+    uint8_t low = mmu_read(gb, gb->cpu.SP);
+    uint8_t high = mmu_read(gb, gb->cpu.SP + 1);
+    gb->cpu.SP += 2;
+    PROFILER_RETURN(gb); // only RET and RETI pop through here
     return (high << 8) | low;
 }
 
 
 /**
- * @brief cpu_step - Executes a single CPU instruction.
+ * @brief Fetches, decodes, and executes one instruction at PC.
  *
- * @details Fetches, decodes, and executes one instruction at PC.
- * 
- * May modify CPU registers and memory. 
- * 
- * @returns 
- * Returns cycle count
+ * @details Shared body of cpu_step and cpu_run_cycles, inlined into both.
+ * Sets gb->cpu.stopped when the CPU faults.
+ *
+ * @returns T-cycles consumed, 0 on a fault
  */
-int cpu_step() {
+static inline int cpu_execute(gb_t* gb) {
     // Halt if PC goes beyond 64KB or ROM loaded range
-    if (cpu.PC == 0xFFFF) { // ((uint32_t)cpu.PC >= 0x10000)
-        printf("[HALT] PC out of bounds: 0x%04X\n", cpu.PC);
-        // cpu.halted = true;
+    if (gb->cpu.PC == 0xFFFF) { // ((uint32_t)gb->cpu.PC >= 0x10000)
+        LOG_ERROR("[HALT] PC out of bounds: 0x%04X\n", gb->cpu.PC);
+        gb->cpu.stopped = true;
+        TRACE_FAULT(gb);
         return 0;
     }
 
-    if (cpu.halted) {
+    if (gb->cpu.halted) {
         return 4;
     }
 
     // simulating the interrupt bug on the DMG
-    uint8_t ie_reg = mmu_get_ie_register();
-    uint8_t if_reg = mmu_get_if_register();
-    bool halt_bug = (mmu_read(cpu.PC) == 0x76 && // is the next instruction HALT?
-                                cpu.ime &&            // IME disabled?
-                                (ie_reg & if_reg & 0x1F) != 0); // is there a pending & enabled interrupt?
+    // the cheap register checks go first so the opcode is only peeked at
+    // when an interrupt is actually pending
+    uint8_t ie_reg = gb->mmu.interrupt_enable;
+    uint8_t if_reg = gb->mmu.interrupt_flag;
+    bool halt_bug = (gb->cpu.ime &&                             // IME disabled?
+                     (ie_reg & if_reg & 0x1F) != 0 &&          // is there a pending & enabled interrupt?
+                     mmu_fetch8(gb, gb->cpu.PC) == 0x76);      // is the next instruction HALT?
 
 
     // standard fetch-decode-execute cycle
-    uint16_t pc = cpu.PC;
-    uint8_t opcode = fetch_d8();
+    uint16_t pc = gb->cpu.PC;
+    uint8_t opcode = fetch_d8(gb);
 
     // if the halt bug would be triggered, then decrement the PC
     if (halt_bug) {
-        cpu.PC--;
+        gb->cpu.PC--;
     }
-    
-    // print for debugging
-    // printf("[PC=0x%04X] Opcode 0x%02X | A=0x%02X F=0x%02X B=0x%02X C=0x%02X D=0x%02X E=0x%02X H=0x%02X L=0x%02X SP=0x%04X\n", 
-    //        pc, opcode, cpu.A, cpu.F, cpu.B, cpu.C, cpu.D, cpu.E, cpu.H, cpu.L, cpu.SP
-    // );
-    // use new debug macro
-    LOG_CPU_STATE(pc, opcode, cpu);
+
+    // use new debug macros (both compile to nothing unless enabled)
+    LOG_CPU_STATE(pc, opcode, gb->cpu);
+    TRACE_INSTRUCTION(gb, pc, opcode);
 
     // Instruction Execution Suite
     bool success;
+    int cycles;
 
-    // CB - Prefixed Bit operations 
+    // CB - Prefixed Bit operations
     if (opcode == 0xCB) {
-        uint8_t cb_opcode = fetch_d8();
+        uint8_t cb_opcode = fetch_d8(gb);
 
         // special logging for CB_opcodes
-        // printf("[PC=0x%04X] Opcode 0xCB 0x%02X | A=0x%02X F=0x%02X B=0x%02X C=0x%02X D=0x%02X E=0x%02X H=0x%02X L=0x%02X SP=0x%04X\n", 
-        //    pc, cb_opcode, cpu.A, cpu.F, cpu.B, cpu.C, cpu.D, cpu.E, cpu.H, cpu.L, cpu.SP
-        // );
+        LOG_CB_STATE(pc, cb_opcode, gb->cpu);
 
-        LOG_CB_STATE(pc, cb_opcode, cpu);
-        
-        success =  execute_cb_opcode(cb_opcode);
+        success =  execute_cb_opcode(gb, cb_opcode);
+        cycles = cb_opcode_cycles[cb_opcode];
+        OPSTATS_RECORD(gb, 1, cb_opcode, cycles);
     } else {
-        success = execute_opcode(opcode);
+        gb->cpu.branch_taken = false;
+        success = execute_opcode(gb, opcode);
+        cycles = gb->cpu.branch_taken ? opcode_cycles_taken[opcode] : opcode_cycles[opcode];
+        OPSTATS_RECORD(gb, 0, opcode, cycles);
     }
 
-    // on succesfully executing an instruction, it returns a true value and continues on with the cpu step
-    // bool success = execute_opcode(opcode); 
-
     // Apply delayed IME effects AFTER the instruction
-    if (cpu.ime_enable) {
-        cpu.ime = true;
-        cpu.ime_enable = false;
-    } else if (cpu.ime_disable) {
-        cpu.ime = false;
-        cpu.ime_disable = false;
+    if (gb->cpu.ime_enable) {
+        gb->cpu.ime = true;
+        gb->cpu.ime_enable = false;
+    } else if (gb->cpu.ime_disable) {
+        gb->cpu.ime = false;
+        gb->cpu.ime_disable = false;
     }
 
     if (!success) {
         // unimplemented instruction was hit.
-        printf("[FATAL] Unimplemented opcode 0x%02X at 0x%04X\n", opcode, pc);
+        LOG_ERROR("[FATAL] Unimplemented opcode 0x%02X at 0x%04X\n", opcode, pc);
+        gb->cpu.stopped = true;
+        TRACE_FAULT(gb);
         return 0;
     }
-    // placeholder value
-    return 4;
+    gb->cpu.instructions++;
+    return cycles;
 }
 
 
 /**
- * @brief execute_opcode()-
- * Decodes and executes given 8-bit opcode 
- * 
- * @param opcode 8-bit operation code to be executed
+ * @brief cpu_step - Executes a single CPU instruction.
  *
- * @return  returns true on success and false on halt/unknown instruction
+ * @details Fetches, decodes, and executes one instruction at PC.
+ *
+ * May modify CPU registers and memory.
+ *
+ * @returns
+ * Returns cycle count
  */
-bool execute_opcode(uint8_t opcode) {
-    /*
-        Flags:
-        Z set if result is zero
-        N reset
-        H set if overflow from bit 3
-    */
-    switch (opcode) {
-        // No operation
-        case 0x00: 
-            // cpu.PC++;
-            break;
-
-        /* 8-bit Load operations */
-
-        /** 
-         * 1. LD nn, n
-         * 
-         * Description: Puts value nn into n
-         * 
-         * Use With: B,C,D,E,H,L,BC,DE,HL,SP
-         *
-         * LD B,n  06  
-         * LD C,n  0E  
-         * LD D,n  16  
-         * LD E,n  1E  
-         * LD H,n  26   
-         * LD L,n  2E 
-         */
-        // case 0x3E: cpu.A = fetch_d8(); break; // LD A,#
-        // case 0x3E implemented further
-        case 0x06: cpu.B = fetch_d8(); break; // LD B, n
-        case 0x0E: cpu.C = fetch_d8(); break; // LD C, n
-        case 0x16: cpu.D = fetch_d8(); break; // LD D, n
-        case 0x1E: cpu.E = fetch_d8(); break; // LD E, n
-        case 0x26: cpu.H = fetch_d8(); break; // LD H, n
-        case 0x2E: cpu.L = fetch_d8(); break; // LD L, n
-
-
-        /** 
-         * 2. LD r1, r2
-         * 
-         * Description: Puts value r2 into r1
-         * 
-         * Use With: 
-         * r1,r2 = A,B,C,D,E,H,L,(HL)
-         */
-        
-        // LD r1, r2 : Copy between two 8-bit resistors
-        // for register A
-        case 0x7F: break;               //(NOP Equivalent) LD A, A
-        case 0x78: cpu.A = cpu.B; break; // LD A, B
-        case 0x79: cpu.A = cpu.C; break; // LD A, C
-        case 0x7A: cpu.A = cpu.D; break; // LD A, D
-        case 0x7B: cpu.A = cpu.E; break; // LD A, E
-        case 0x7C: cpu.A = cpu.H; break; // LD A, H
-        case 0x7D: cpu.A = cpu.L; break; // LD A, L
-        
-        // for register B
-        case 0x40: break;               // LC B, B(NOP Equivalent)
-        case 0x41: cpu.B = cpu.C; break; // LD B, C
-        case 0x42: cpu.B = cpu.D; break;// LD B, D
-        case 0x43: cpu.B = cpu.E; break;// LD B, E
-        case 0x44: cpu.B = cpu.H; break;// LD B, H
-        case 0x45: cpu.B = cpu.L; break;// LD B, L
-        // case 0x47: cpu.B = cpu.A; break; // LD B, A ---- implemented later in the module
-        // case 0x7F is already implemented 
-
-        //for register C
-        case 0x48: cpu.C = cpu.B; break; // LD C, B
-        case 0x49: break;               // LC C, C (NOP Equivalent)
-        case 0x4A: cpu.C = cpu.D; break;// LD C, D
-        case 0x4B: cpu.C = cpu.E; break;// LD C, E
-        case 0x4C: cpu.C = cpu.H; break;// LD C, H
-        case 0x4D: cpu.C = cpu.L; break;// LD C, L
-        // case 0x4E: cpu.C = cpu.A; break; // LD C, (HL)
-        // case 0x4F: cpu.C = cpu.A; break;
-
-        //for register D
-        case 0x50: cpu.D = cpu.B; break; // LD D, B
-        case 0x51: cpu.D = cpu.C; break;// LD D, C
-        case 0x52: break;               // LC D, D (NOP Equivalent)
-        case 0x53: cpu.D = cpu.E; break;// LD D, E
-        case 0x54: cpu.D = cpu.H; break;// LD D, H
-        case 0x55: cpu.D = cpu.L; break;// LD D, L
-        // case 0x56: cpu.D = cpu.A; break; // LD D, (HL)
-
-        //for register E
-        case 0x58: cpu.E = cpu.B; break; // LC E, B
-        case 0x59: cpu.E = cpu.C; break; // LD E, C
-        case 0x5A: cpu.E = cpu.D; break;// LD E, D
-        case 0x5B: break;               // LD E, E (NOP Equivalent)
-        case 0x5C: cpu.E = cpu.H; break;// LD E, H
-        case 0x5D: cpu.E = cpu.L; break;// LD E, L
-        // case 0x5E: LD E, (HL)
-
-        //for register H
-        case 0x60: cpu.H = cpu.B; break; // LC H, B
-        case 0x61: cpu.H = cpu.C; break; // LD H, C
-        case 0x62: cpu.H = cpu.D; break;// LD H, D
-        case 0x63: cpu.H = cpu.E; break;// LD H, E
-        case 0x64: break;               // LD H, H (NOP Equivalent)
-        case 0x65: cpu.H = cpu.L; break;// LD H, L
-        // case 0x66: LD H, (HL)
-
-        //for register L
-        case 0x68: cpu.L = cpu.B; break;// LC L, B
-        case 0x69: cpu.L = cpu.C; break; // LD L, C
-        case 0x6A: cpu.L = cpu.D; break;// LD L, D
-        case 0x6B: cpu.L = cpu.E; break;// LD L, E
-        case 0x6C: cpu.L = cpu.H; break;// LD L, H
-        case 0x6D: break;               // LD L, L (NOP Equivalent)
-        // case 0x6E:  LD L, (HL)
-        
-        // LD (HL), n
-        case 0x77: mmu_write(REG_HL, cpu.A); break; // LD (HL), A --- implemented later as well
-        case 0x70: mmu_write(REG_HL, cpu.B); break; // LD (HL), B
-        case 0x71: mmu_write(REG_HL, cpu.C); break; // LD (HL), C
-        case 0x72: mmu_write(REG_HL, cpu.D); break; // LD (HL), D
-        case 0x73: mmu_write(REG_HL, cpu.E); break; // LD (HL), E
-        case 0x74: mmu_write(REG_HL, cpu.H); break; // LD (HL), H
-        case 0x75: mmu_write(REG_HL, cpu.L); break; // LD (HL), L
-
-
-        // LD (HL), n-- 12 cycle count
-        case 0x36: {
-            uint8_t val = fetch_d8();
-            // write value at HL register (already defined w macro)
-            mmu_write(REG_HL, val);
-            break;
-        }
+int cpu_step(gb_t* gb) {
+    int cycles = cpu_execute(gb);
+    flags_sync(&gb->cpu);
+    return cycles;
+}
 
-        /**
-         * 3. LD A, n
-         * 
-         * Put value of n into A
-         * 
-         * use with: 
-         * n = A,B,C,D,E,H,L,(BC),(DE),(HL),(nn),#
-         * nn = two byte immediate value. (LS byte first.)
-         * 
-         */
 
-        // 0x7F - 0x7D already implemented
+/**
+ * @brief Advances the machine clock and fires the peripheral events that came due
+ *
+ * @param cycles: T-cycles just spent by the CPU
+ *
+ * @returns void
+ */
+static inline void cpu_tick(gb_t* gb, int cycles) {
+    gb->sched.now += cycles;
+    if (gb->sched.now >= gb->sched.next) {
+        scheduler_run(gb);
+    }
+}
 
-        case 0x0A: cpu.A = mmu_read(REG_BC); break;
+/**
+ * @brief T-cycles a halted CPU can skip in one go
+ *
+ * @details Halted, the CPU only burns 4-cycle steps until IF changes, and with
+ * IF clear only a scheduled event can change it. Jumping to the first 4-cycle
+ * boundary at or after the next event (or the end of the budget) lands on the
+ * exact step the CPU would have woken on.
+ *
+ * @param remaining: T-cycles left in the budget (> 0)
+ *
+ * @returns span to skip, a positive multiple of 4
+ */
+static inline int cpu_halt_span(const gb_t* gb, int remaining) {
+    uint64_t span = (uint64_t)remaining;
+    uint64_t until_event = gb->sched.next - gb->sched.now;   // huge when nothing is scheduled
+    if (until_event < span) {
+        span = until_event;
+    }
+    return span < 4 ? 4 : (int)((span + 3) & ~(uint64_t)3);
+}
 
-        case 0x1A: cpu.A = mmu_read(REG_DE); break;
+/**
+ * @brief Runs one iteration of a possible idle loop, vetting every instruction
+ *
+ * @details Entered right after a jump back to the loop head. The iteration
+ * runs exactly as it would in cpu_run_cycles; if it comes back to the head
+ * through the same branch without touching anything (see idle.h), the
+ * identical iterations up to the next event are skipped as well.
+ *
+ * @param branch_pc: address of the branch that jumped back to the head
+ * @param remaining: T-cycles left in the budget
+ *
+ * @returns T-cycles consumed, skipped iterations included
+ */
+static int cpu_run_idle_iteration(gb_t* gb, uint16_t branch_pc, int remaining) {
+    if (!idle_begin(gb, branch_pc)) {
+        return 0;
+    }
 
-        // case 0x7E: cpu.A = mmu_read(REG_HL); break;
+    uint16_t head = gb->cpu.PC;
+    int elapsed = 0;
 
-        // A, (nn)
-        case 0xFA:{
-            // load from absolute 16-bit address into A
-            // PC is at the address of the first operand byte
-            uint16_t addr = fetch_d16();
-            cpu.A = mmu_read(addr);
-            break;
+    while (elapsed < remaining && idle_check_instruction(gb, gb->cpu.PC)) {
+        uint16_t pc = gb->cpu.PC;
+        int cycles = cpu_execute(gb);
+        if (cycles == 0) {
+            break; // CPU faulted, gb->cpu.stopped is set
         }
+        elapsed += cycles;
+        cpu_tick(gb, cycles);
 
-        // A, # case 0x3E
-        // Load immediate 8-bit value int A
-        case 0x3E:{
-            cpu.A = fetch_d8();
-            break;
+        if (gb->cpu.PC < pc) {
+            if (pc == branch_pc && gb->cpu.PC == head) {
+                int skip = idle_end(gb, elapsed, remaining - elapsed);
+                elapsed += skip;
+                cpu_tick(gb, skip);
+            }
+            break; // one iteration at most, the run loop takes the next jump back
         }
 
-
-        /**
-         * 4. LD n, A
-         * Put value A into n
-         * 
-         * Use with:
-         * 
-         * n = A,B,C,D,E,H,L,(BC),(DE),(HL),(nn)
-         * nn = two byte immediate value. (LS byte first.)
-         */
-
-        
-        // case 0x7F: // Already implemented cpu.A = cpu.A   // LD A, A
-        case 0x47: cpu.B = cpu.A; break;                     // LD B, A
-        case 0x4F: cpu.C = cpu.A; break;                     // LD C, A
-        case 0x57: cpu.D = cpu.A; break;                     // LD D, A
-        case 0x5F: cpu.E = cpu.A; break;                     // LD E, A
-        case 0x67: cpu.H = cpu.A; break;                     // LD H, A
-        case 0x6F: cpu.L = cpu.A; break;                     // LD L, A
-
-        case 0x02: mmu_write(REG_BC, cpu.A); break; // LD (BC), A
-        case 0x12: mmu_write(REG_DE, cpu.A) ;break; // LD (DE), A
-        // case 0x77: ;break; // LD (HL), A -- already implemented as mmu_write(REG_HL, cpu.A)
-
-        // LD (nn = 16 bit immediate address), A 
-        case 0xEA: {
-            uint16_t addr = fetch_d16();
-            mmu_write(addr, cpu.A);
-            break;
+        if (gb->mmu.interrupt_flag & 0x1F) {
+            int dispatch = handle_interrupts(gb);
+            elapsed += dispatch;
+            cpu_tick(gb, dispatch);
+            if (dispatch) {
+                break; // the handler is not part of the loop
+            }
         }
+    }
 
-                
-        /* Load - Store Instructions */
-        // LD n, (HL)
-        case 0x7E: cpu.A = mmu_read(REG_HL); break; // LD A (HL)    
-        case 0x46: cpu.B = mmu_read(REG_HL); break; // LD B (HL)
-        case 0x4E: cpu.C = mmu_read(REG_HL); break; // LD C (HL)
-        case 0x56: cpu.D = mmu_read(REG_HL); break; // LD D (HL)
-        case 0x5E: cpu.E = mmu_read(REG_HL); break; // LD E (HL)
-        case 0x66: cpu.H = mmu_read(REG_HL); break; // LD H (HL)
-        case 0x6E: cpu.L = mmu_read(REG_HL); break; // LD L (HL)
-
-        
-        /**
-         * 5. LD A, (C)
-         * 
-         * put value at address $FF00 + register C into A
-         * same as LD A, ($FF00 + C) 
-         * 
-         * one byte instruction only, do NOT take an operand
-         * from the rom and instead just execute the one byte instruction
-         */
-
-        case 0xF2:{
-            uint16_t addr = 0xFF00 + cpu.C;
-            cpu.A = mmu_read(addr);
-            break;
-        }
+    return elapsed;
+}
 
-        /**
-         * 6. LD (C), A
-         * 
-         * put value of A into address $FF00 + register C
-         * opposite to that of LD A, C
-         * 
-         * one byte instruction only, do NOT take an operand
-         * from the rom and instead just execute the one byte instruction
-         *   
-         */
-        
-        case 0xE2:{
-            uint16_t addr = 0xFF00 + cpu.C;
-            mmu_write(addr, cpu.A);
-            break;
+/**
+ * @brief cpu_run_cycles - Runs whole instructions until a cycle budget is used up.
+ *
+ * @details The loop only advances the scheduler clock; the timer and the PPU
+ * are synced when their next event is due (a TIMA increment, a PPU mode change)
+ * or when their registers are accessed, and interrupts are only dispatched
+ * when IF has a request pending. A halted CPU skips straight to the next
+ * event instead of spinning 4 cycles at a time, and so do idle polling loops
+ * (see idle.h) unless gb->idle.enabled is off.
+ *
+ * @param budget T-cycles to run for
+ *
+ * @returns T-cycles actually consumed (may overshoot the budget by the last instruction)
+ */
+int cpu_run_cycles(gb_t* gb, int budget) {
+    int elapsed = 0;
+
+    while (elapsed < budget) {
+        uint16_t pc = gb->cpu.PC;
+        int cycles = cpu_execute(gb);
+        if (cycles == 0) {
+            break; // CPU faulted, gb->cpu.stopped is set
         }
 
-        /**
-         * 7. LD A, (HLD)
-         * 
-         * same as LDD A, (HL)
-         * 
-         * 
-         * 8. LD A, (HL-)
-         * 
-         * same as LDD A, (HL)
-         * 
-         * 
-         * 9. LDD A, (HL)
-         * 
-         * --- all 3 aliases: 
-         * put value of HL into A
-         * Decrement HL
-         * 
-         * same as: LD A, (HL)  -  DEC HL
-         */
-
-        case 0x3A: {
-            //LD A, (HL-)
-            //LDD A, (HL)
-            uint16_t hl = REG_HL;
-            cpu.A = mmu_read(hl);
-            hl--; //decrement
-
-            cpu.H = (hl >> 8) &0xFF;
-            cpu.L = hl &0xFF;
-            break;
+        // HALT with nothing in IF: fast-forward to the next event that could wake it
+        if (gb->cpu.halted && !(gb->mmu.interrupt_flag & 0x1F)) {
+            cycles = cpu_halt_span(gb, budget - elapsed);
         }
 
+        elapsed += cycles;
+        cpu_tick(gb, cycles);
 
-        /**
-         * 10. LD (HLD), A
-         * same as LDD (HL), A
-         * 
-         * 11. LD (HL-), A
-         * same as LDD (HL), A
-         * 
-         * 12. LDD (HL), A
-         * puts A into memory address (HL)
-         * reverse of 
-         * decrement HL
-         * 
-         * same as LD (HL), A  -  DEC HL 
-         */
-         
-        case 0x32:{
-            uint16_t hl = REG_HL;
-            mmu_write(hl, cpu.A);
-            hl--; //decrement step
-
-            cpu.H = (hl >> 8) & 0xFF; 
-            cpu.L = hl & 0xFF;
-            break;
+        // a jump back to a short loop in ROM: record an iteration, skip the identical ones after it
+        if (gb->cpu.PC < pc && idle_candidate(&gb->idle, gb->cpu.PC, pc, gb->mmu.current_rom_bank)) {
+            elapsed += cpu_run_idle_iteration(gb, pc, budget - elapsed);
         }
 
-        /**
-         * 13. LD A, (HLI) --- HL increment
-         * same as LDI A, (HL)
-         * 
-         * 14. LD A, (HL+)
-         * same as LDI A, (HL)
-         * 
-         * 15. LDI A, (HL)
-         * put value at address HL into A
-         * increment HL
-         * 
-         * same as LD A, (HL)  -  INC HL
-         * 
-         */
-
-        case 0x2A:{
-            uint16_t hl = REG_HL;
-            cpu.A = mmu_read(hl);
-
-            hl++; //increment step
-
-            cpu.H = (hl >> 8) & 0xFF;
-            cpu.L = hl & 0xFF;
-
-            break;
+        // pending IF bits either wake the CPU from HALT or get serviced
+        if (gb->mmu.interrupt_flag & 0x1F) {
+            int dispatch = handle_interrupts(gb);
+            elapsed += dispatch;
+            cpu_tick(gb, dispatch);
         }
+    }
 
-        /**
-         * 16. LD (HLI), A
-         * same as LDI (HL), A
-         * 
-         * 17. LD (HL+), A
-         * same as LDI (HL), A 
-         * 
-         * 18. LDI (HL), A
-         * puts A into memory address HL
-         * increment HL
-         * 
-         * same as LD (HL), A --- INC HL
-         * 
-         */
-
-        case 0x22:{
-            uint16_t hl = REG_HL;
-            mmu_write(hl, cpu.A);
-
-            hl++; //increment step
-
-            cpu.H = (hl >> 8) & 0xFF;
-            cpu.L = hl & 0xFF;
-
-            break;
-        }
+    // leave F, the timer and the PPU exact for whoever looks at them between batches
+    flags_sync(&gb->cpu);
+    timer_sync(gb);
+    ppu_sync(gb);
+    return elapsed;
+}
 
 
-        /**
-         * 19. LDH (n), A
-         * puts A into memory address $FF00 + n
-         * 
-         * use with: 
-         * n = one byte immediate
-         */
+// ==========================================================================
+// BASE OPCODE HANDLERS
+// ==========================================================================
 
-        case 0xE0:{
-            uint16_t offset = fetch_d8(); // taking an offset
-            uint16_t addr = 0xFF00 + offset; 
+/**
+ * Every opcode is implemented as a small static handler. The handlers are
+ * wired to their opcodes in BASE_OPCODE_MAP / CB_OPCODE_MAP further below,
+ * which feed both the handler tables and the computed-goto dispatcher.
+ *
+ * Flags:
+ *  Z set if result is zero
+ *  N reset
+ *  H set if overflow from bit 3
+ */
 
-            mmu_write(addr, cpu.A);
-            break;
-        }
+// No operation
+static void op_nop(gb_t* gb) { (void)gb; }
 
-        /**
-         * 20. LDH A, (n)
-         * put memory address $FF00 + n into A
-         * reverse of instruction 19
-         * 
-         * use with:
-         * n = one byte immediate value
-         */
-
-        case 0xF0:{
-            uint8_t offset = fetch_d8();
-            cpu.A = mmu_read(0xFF00 + offset);
-            break;
-        }
+/**
+ * Illegal / unused opcode (0xD3, 0xDB, 0xDD, 0xE3, 0xE4, 0xEB, 0xEC, 0xED, 0xF4, 0xFC, 0xFD)
+ *
+ * The real hardware locks up, we rewind the PC for debugging and halt.
+ * The CB prefix also maps here: it is decoded by cpu_step before dispatch.
+ */
+static void op_illegal(gb_t* gb) {
+    LOG_ERROR("[HALT] Unimplemented opcode: 0x%02X at 0x%04X\n", mmu_read(gb, gb->cpu.PC - 1), gb->cpu.PC);
+    gb->cpu.PC--; // Rewind PC for debugging
 
+    gb->cpu.halted = true; // Safely halt on unknown opcode
+}
 
-        
-        /* 16-bit load ooperations */
-        
-        /**
-         * 1. LD n, nn
-         * put value nn into n
-         * 
-         * use with:
-         * n = BC,DE,HL,SP
-         * nn = 16 bit immediate value
-         * 
-         */
-
-        // LD BC, nn
-        case 0x01:{ 
-            uint16_t nn = fetch_d16();
-            SET_REG_BC(nn);
-            break;
-        }
 
-        // LD DE, nn
-        case 0x11:{
-            uint16_t nn = fetch_d16();
-            SET_REG_DE(nn);
-            break;
-        }    
-        
-        // LD HL, nn
-        case 0x21: {    
-            uint16_t nn = fetch_d16();
-            SET_REG_HL(nn);
-            break;
-        } 
-        
-        // LD SP (Stack pointer), nn
-        case 0x31:{
-            cpu.SP = fetch_d16();
-            break;
-        }
+/* 8-bit Load operations */
 
+/**
+ * 1. LD nn, n
+ *
+ * Description: Puts value nn into n
+ *
+ * Use With: B,C,D,E,H,L,BC,DE,HL,SP
+ */
+static void op_ld_b_d8(gb_t* gb) { gb->cpu.B = fetch_d8(gb); }    // LD B, n
+static void op_ld_c_d8(gb_t* gb) { gb->cpu.C = fetch_d8(gb); }    // LD C, n
+static void op_ld_d_d8(gb_t* gb) { gb->cpu.D = fetch_d8(gb); }    // LD D, n
+static void op_ld_e_d8(gb_t* gb) { gb->cpu.E = fetch_d8(gb); }    // LD E, n
+static void op_ld_h_d8(gb_t* gb) { gb->cpu.H = fetch_d8(gb); }    // LD H, n
+static void op_ld_l_d8(gb_t* gb) { gb->cpu.L = fetch_d8(gb); }    // LD L, n
 
-        /**
-         * 2. LD SP, HL
-         * puts value at HL into SP (stack Pointer)
-         * 
-         * 8 cycles
-         */
-        
-        // LD SP, HL 
-        case 0xF9:{
-            // cpu.SP = (cpu.H << 8) | cpu.L; 
-            cpu.SP = REG_HL; // macro predefined for consistency
-            break;
-        }
 
+/**
+ * 2. LD r1, r2
+ *
+ * Description: Puts value r2 into r1
+ *
+ * Use With:
+ * r1,r2 = A,B,C,D,E,H,L,(HL)
+ *
+ * LD r, r (same register) are NOP equivalents and map to op_nop
+ */
 
-        /**
-         * 3. LD HL, SP + n
-         * same as LDHL SP, n
-         * 
-         * 4. LDHL SP, n
-         * Puts SP + n effective address into HL
-         *
-         * use with:
-         * n = one byte signed immediate value
-         * 
-         * flags affected:
-         * Z = Reset
-         * N = Reset
-         * H = Set or reset according to operation
-         * C = Set or reset acc to op
-         */
-
-        // signed offset arithmetic !!!
-        case 0xF8: {
-            int16_t n = (int8_t)fetch_d8(); // cast to signed int8 first!
-            uint16_t sp = cpu.SP;
-            uint16_t result = sp + n;
-
-            // set HL to result
-            // cpu.H = (result >> 8) & 0xFF;
-            // cpu.L = result & 0xFF;
-            SET_REG_HL(result);
-
-            //clear Z and N flags
-            cpu.F &= ~(FLAG_Z | FLAG_N);
-
-            //set Half carry (H) and carry (c) flags based on lower byte addition
-            // use same logic to add signed int to unsigned int
-            uint16_t temp = (sp ^ n ^ result) & 0xFFFF;
-
-            if ((temp & 0x10) != 0) {
-                cpu.F |= FLAG_H;
-            } else {
-                cpu.F &= ~FLAG_H;
-            }
-            if ((temp & 0x100) != 0) {
-                cpu.F |= FLAG_C;
-            } else {
-                cpu.F &= ~FLAG_C;
-            }
+// for register A
+static void op_ld_a_b(gb_t* gb) { gb->cpu.A = gb->cpu.B; }          // LD A, B
+static void op_ld_a_c(gb_t* gb) { gb->cpu.A = gb->cpu.C; }          // LD A, C
+static void op_ld_a_d(gb_t* gb) { gb->cpu.A = gb->cpu.D; }          // LD A, D
+static void op_ld_a_e(gb_t* gb) { gb->cpu.A = gb->cpu.E; }          // LD A, E
+static void op_ld_a_h(gb_t* gb) { gb->cpu.A = gb->cpu.H; }          // LD A, H
+static void op_ld_a_l(gb_t* gb) { gb->cpu.A = gb->cpu.L; }          // LD A, L
+
+// for register B
+static void op_ld_b_c(gb_t* gb) { gb->cpu.B = gb->cpu.C; }          // LD B, C
+static void op_ld_b_d(gb_t* gb) { gb->cpu.B = gb->cpu.D; }          // LD B, D
+static void op_ld_b_e(gb_t* gb) { gb->cpu.B = gb->cpu.E; }          // LD B, E
+static void op_ld_b_h(gb_t* gb) { gb->cpu.B = gb->cpu.H; }          // LD B, H
+static void op_ld_b_l(gb_t* gb) { gb->cpu.B = gb->cpu.L; }          // LD B, L
+
+// for register C
+static void op_ld_c_b(gb_t* gb) { gb->cpu.C = gb->cpu.B; }          // LD C, B
+static void op_ld_c_d(gb_t* gb) { gb->cpu.C = gb->cpu.D; }          // LD C, D
+static void op_ld_c_e(gb_t* gb) { gb->cpu.C = gb->cpu.E; }          // LD C, E
+static void op_ld_c_h(gb_t* gb) { gb->cpu.C = gb->cpu.H; }          // LD C, H
+static void op_ld_c_l(gb_t* gb) { gb->cpu.C = gb->cpu.L; }          // LD C, L
+
+// for register D
+static void op_ld_d_b(gb_t* gb) { gb->cpu.D = gb->cpu.B; }          // LD D, B
+static void op_ld_d_c(gb_t* gb) { gb->cpu.D = gb->cpu.C; }          // LD D, C
+static void op_ld_d_e(gb_t* gb) { gb->cpu.D = gb->cpu.E; }          // LD D, E
+static void op_ld_d_h(gb_t* gb) { gb->cpu.D = gb->cpu.H; }          // LD D, H
+static void op_ld_d_l(gb_t* gb) { gb->cpu.D = gb->cpu.L; }          // LD D, L
+
+// for register E
+static void op_ld_e_b(gb_t* gb) { gb->cpu.E = gb->cpu.B; }          // LD E, B
+static void op_ld_e_c(gb_t* gb) { gb->cpu.E = gb->cpu.C; }          // LD E, C
+static void op_ld_e_d(gb_t* gb) { gb->cpu.E = gb->cpu.D; }          // LD E, D
+static void op_ld_e_h(gb_t* gb) { gb->cpu.E = gb->cpu.H; }          // LD E, H
+static void op_ld_e_l(gb_t* gb) { gb->cpu.E = gb->cpu.L; }          // LD E, L
+
+// for register H
+static void op_ld_h_b(gb_t* gb) { gb->cpu.H = gb->cpu.B; }          // LD H, B
+static void op_ld_h_c(gb_t* gb) { gb->cpu.H = gb->cpu.C; }          // LD H, C
+static void op_ld_h_d(gb_t* gb) { gb->cpu.H = gb->cpu.D; }          // LD H, D
+static void op_ld_h_e(gb_t* gb) { gb->cpu.H = gb->cpu.E; }          // LD H, E
+static void op_ld_h_l(gb_t* gb) { gb->cpu.H = gb->cpu.L; }          // LD H, L
+
+// for register L
+static void op_ld_l_b(gb_t* gb) { gb->cpu.L = gb->cpu.B; }          // LD L, B
+static void op_ld_l_c(gb_t* gb) { gb->cpu.L = gb->cpu.C; }          // LD L, C
+static void op_ld_l_d(gb_t* gb) { gb->cpu.L = gb->cpu.D; }          // LD L, D
+static void op_ld_l_e(gb_t* gb) { gb->cpu.L = gb->cpu.E; }          // LD L, E
+static void op_ld_l_h(gb_t* gb) { gb->cpu.L = gb->cpu.H; }          // LD L, H
+
+// LD (HL), r
+static void op_ld_hl_a(gb_t* gb) { mmu_write(gb, REG_HL, gb->cpu.A); }  // LD (HL), A
+static void op_ld_hl_b(gb_t* gb) { mmu_write(gb, REG_HL, gb->cpu.B); }  // LD (HL), B
+static void op_ld_hl_c(gb_t* gb) { mmu_write(gb, REG_HL, gb->cpu.C); }  // LD (HL), C
+static void op_ld_hl_d(gb_t* gb) { mmu_write(gb, REG_HL, gb->cpu.D); }  // LD (HL), D
+static void op_ld_hl_e(gb_t* gb) { mmu_write(gb, REG_HL, gb->cpu.E); }  // LD (HL), E
+static void op_ld_hl_h(gb_t* gb) { mmu_write(gb, REG_HL, gb->cpu.H); }  // LD (HL), H
+static void op_ld_hl_l(gb_t* gb) { mmu_write(gb, REG_HL, gb->cpu.L); }  // LD (HL), L
+
+// LD (HL), n-- 12 cycle count
+static void op_ld_hl_d8(gb_t* gb) {
+    uint8_t val = fetch_d8(gb);
+    // write value at HL register (already defined w macro)
+    mmu_write(gb, REG_HL, val);
+}
 
-            break;
-        }
 
-        /**
-         * 5. LD (nn), SP
-         * put stack pointer (SP) at addr n
-         * 
-         * use with:
-         * nn = two byte immediate address
-         * 
-         * 20 cycles
-         */
+/**
+ * 3. LD A, n
+ *
+ * Put value of n into A
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(BC),(DE),(HL),(nn),#
+ * nn = two byte immediate value. (LS byte first.)
+ */
+static void op_ld_a_bc(gb_t* gb) { gb->cpu.A = mmu_read(gb, REG_BC); }  // LD A, (BC)
+static void op_ld_a_de(gb_t* gb) { gb->cpu.A = mmu_read(gb, REG_DE); }  // LD A, (DE)
+
+// A, (nn)
+static void op_ld_a_a16(gb_t* gb) {
+    // load from absolute 16-bit address into A
+    // PC is at the address of the first operand byte
+    uint16_t addr = fetch_d16(gb);
+    gb->cpu.A = mmu_read(gb, addr);
+}
 
+// A, #
+// Load immediate 8-bit value int A
+static void op_ld_a_d8(gb_t* gb) { gb->cpu.A = fetch_d8(gb); }
 
-        case 0x08: {
-            // read immediate 16-bit address nn
-            // it is a littl;e endian
-            uint16_t addr = fetch_d16();
 
-            // store stack pointer val at addr nn
-            // little endian -- low byte first
-            mmu_write(addr, cpu.SP & 0xFF);     // SP Low byte
-            mmu_write(addr + 1, (cpu.SP >> 8) & 0xFF); // SP high byte
+/**
+ * 4. LD n, A
+ * Put value A into n
+ *
+ * Use with:
+ * n = A,B,C,D,E,H,L,(BC),(DE),(HL),(nn)
+ * nn = two byte immediate value. (LS byte first.)
+ */
+static void op_ld_b_a(gb_t* gb) { gb->cpu.B = gb->cpu.A; }          // LD B, A
+static void op_ld_c_a(gb_t* gb) { gb->cpu.C = gb->cpu.A; }          // LD C, A
+static void op_ld_d_a(gb_t* gb) { gb->cpu.D = gb->cpu.A; }          // LD D, A
+static void op_ld_e_a(gb_t* gb) { gb->cpu.E = gb->cpu.A; }          // LD E, A
+static void op_ld_h_a(gb_t* gb) { gb->cpu.H = gb->cpu.A; }          // LD H, A
+static void op_ld_l_a(gb_t* gb) { gb->cpu.L = gb->cpu.A; }          // LD L, A
+
+static void op_ld_bc_a(gb_t* gb) { mmu_write(gb, REG_BC, gb->cpu.A); }  // LD (BC), A
+static void op_ld_de_a(gb_t* gb) { mmu_write(gb, REG_DE, gb->cpu.A); }  // LD (DE), A
+
+// LD (nn = 16 bit immediate address), A
+static void op_ld_a16_a(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    mmu_write(gb, addr, gb->cpu.A);
+}
 
-            break;
-        }
 
-        // STACK OPERATIONS PUSH AND POP
-
-        /**
-         * 6. PUSH nn
-         * 
-         *  push register pair nn onto stack
-         * decrement SP (Stack Pointer) twice
-         * 
-         * use with:
-         * nn = AF, BC, DE, HL
-         * 
-         * HIGH BYTE FIRST
-         * LOW BYTE NEXT
-         */
-
-        // PUSH AF
-        case 0xF5: {
-            mmu_write(--cpu.SP, cpu.A);
-            mmu_write(--cpu.SP, cpu.F & 0xF0);  // mask off lower 4 bits (always 0 on hardware)
-            break;
-        }
+/* Load - Store Instructions */
+// LD n, (HL)
+static void op_ld_a_hl(gb_t* gb) { gb->cpu.A = mmu_read(gb, REG_HL); }  // LD A (HL)
+static void op_ld_b_hl(gb_t* gb) { gb->cpu.B = mmu_read(gb, REG_HL); }  // LD B (HL)
+static void op_ld_c_hl(gb_t* gb) { gb->cpu.C = mmu_read(gb, REG_HL); }  // LD C (HL)
+static void op_ld_d_hl(gb_t* gb) { gb->cpu.D = mmu_read(gb, REG_HL); }  // LD D (HL)
+static void op_ld_e_hl(gb_t* gb) { gb->cpu.E = mmu_read(gb, REG_HL); }  // LD E (HL)
+static void op_ld_h_hl(gb_t* gb) { gb->cpu.H = mmu_read(gb, REG_HL); }  // LD H (HL)
+static void op_ld_l_hl(gb_t* gb) { gb->cpu.L = mmu_read(gb, REG_HL); }  // LD L (HL)
 
-        // PUSH BC
-        case 0xC5:{
-            mmu_write(--cpu.SP, cpu.B);
-            mmu_write(--cpu.SP, cpu.C);
-            break;
-        }
 
-        // PUSH DE
-        case 0xD5:{
-            mmu_write(--cpu.SP, cpu.D);
-            mmu_write(--cpu.SP, cpu.E);
-            break;
-        }
+/**
+ * 5. LD A, (C)
+ *
+ * put value at address $FF00 + register C into A
+ * same as LD A, ($FF00 + C)
+ *
+ * one byte instruction only, do NOT take an operand
+ */
+static void op_ld_a_ioc(gb_t* gb) {
+    uint16_t addr = 0xFF00 + gb->cpu.C;
+    gb->cpu.A = mmu_read(gb, addr);
+}
 
-        // PUSH HL
-        case 0xE5:{
-            mmu_write(--cpu.SP, cpu.H);
-            mmu_write(--cpu.SP, cpu.L);
-            break;
-        }
+/**
+ * 6. LD (C), A
+ *
+ * put value of A into address $FF00 + register C
+ * opposite to that of LD A, C
+ */
+static void op_ld_ioc_a(gb_t* gb) {
+    uint16_t addr = 0xFF00 + gb->cpu.C;
+    mmu_write(gb, addr, gb->cpu.A);
+}
 
+/**
+ * 7. - 9. LD A, (HLD) / LD A, (HL-) / LDD A, (HL)
+ *
+ * --- all 3 aliases:
+ * put value of HL into A
+ * Decrement HL
+ */
+static void op_ldd_a_hl(gb_t* gb) {
+    uint16_t hl = REG_HL;
+    gb->cpu.A = mmu_read(gb, hl);
+    hl--; //decrement
 
-        /**
-         * 7. POP nn
-         * 
-         * pop off two bytes off stack into register pair nn
-         * increment stack pointer SP twice every iteration
-         * 
-         * use with:
-         * nn = AF, BC, DE, HL
-         * 
-         *  LOW BYTE FIRST
-         *  HIGH BYTE NEXT
-         * 
-         */
-
-        // POP AF
-        case 0xF1: {
-            cpu.F = mmu_read(cpu.SP++) & 0xF0;
-            cpu.A = mmu_read(cpu.SP++);
-            break;
-        }
+    gb->cpu.H = (hl >> 8) &0xFF;
+    gb->cpu.L = hl &0xFF;
+}
 
+/**
+ * 10. - 12. LD (HLD), A / LD (HL-), A / LDD (HL), A
+ *
+ * puts A into memory address (HL)
+ * decrement HL
+ */
+static void op_ldd_hl_a(gb_t* gb) {
+    uint16_t hl = REG_HL;
+    mmu_write(gb, hl, gb->cpu.A);
+    hl--; //decrement step
 
-        // POP BC
-        case 0xC1:{
-            cpu.C = mmu_read(cpu.SP++);
-            cpu.B = mmu_read(cpu.SP++);
-            break;
-        }
+    gb->cpu.H = (hl >> 8) & 0xFF;
+    gb->cpu.L = hl & 0xFF;
+}
 
-        // POP DE
-        case 0xD1:{
-            cpu.E = mmu_read(cpu.SP++);
-            cpu.D = mmu_read(cpu.SP++);
-            break;
-        }
+/**
+ * 13. - 15. LD A, (HLI) / LD A, (HL+) / LDI A, (HL)
+ *
+ * put value at address HL into A
+ * increment HL
+ */
+static void op_ldi_a_hl(gb_t* gb) {
+    uint16_t hl = REG_HL;
+    gb->cpu.A = mmu_read(gb, hl);
 
-        // POP HL   
-        case 0xE1:{
-            cpu.L = mmu_read(cpu.SP++);
-            cpu.H = mmu_read(cpu.SP++);
-            break;
-        }
+    hl++; //increment step
 
-        // -------------------------------- //
-        /* ARITHMETIC LOGIC UNIT OPERATIONS */
-        // -------------------------------- //
-
-        /* 8-BIT ARITHMETIC LOGIC OPERATIONS*/
-        /**
-         * 1. ADD A, n
-         * add n to A
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL),#
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Set if carry from bit 3.
-            C - Set if car
-         */
-
-        case 0x87: ADD_A(cpu.A); break;     // ADD A, A
-        case 0x80: ADD_A(cpu.B); break;     // ADD A, B
-        case 0x81: ADD_A(cpu.C); break;     // ADD A, C
-        case 0x82: ADD_A(cpu.D); break;     // ADD A, D
-        case 0x83: ADD_A(cpu.E); break;     // ADD A, E
-        case 0x84: ADD_A(cpu.H); break;     // ADD A, H
-        case 0x85: ADD_A(cpu.L); break;     // ADD A, L
-
-        case 0x86: ADD_A(mmu_read(REG_HL)); break;     // ADD A, (HL)
-        
-        // ADD A, #
-        case 0xC6: ADD_A(fetch_d8()); break;
-
-
-        /**
-         * 2. ADC A, n
-         * add n + carry flag to A
-         * 
-         * use with:
-         * n = A,B, C,D,E,H,L,(HL),#
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Set if carry from bit 3.
-            C - Set if carry from bit 7.
-         */
-
-        case 0x8F:ADC_A(cpu.A); break;      // ADC A, A
-        case 0x88:ADC_A(cpu.B); break;      // ADC A, B
-        case 0x89:ADC_A(cpu.C); break;      // ADC A, C
-        case 0x8A:ADC_A(cpu.D); break;      // ADC A, D
-        case 0x8B:ADC_A(cpu.E); break;      // ADC A, E
-        case 0x8C:ADC_A(cpu.H); break;      // ADC A, H
-        case 0x8D:ADC_A(cpu.L); break;      // ADC A, L
-
-        case 0x8E:ADC_A(mmu_read(REG_HL)); break;      // ADC A, (HL)
-        
-        // ADC A, #
-        case 0xCE: ADC_A(fetch_d8()); break;
-
-
-        /**
-         * 3. SUB n
-         * subtract n from A
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL),#
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Set.
-            H - Set if no borrow from bit 4.
-            C - Set if no borrow
-
-         * SUB B, A  ==  Subtract B from A
-         */
-        
-        case 0x97: SUB_A(cpu.A); break;     // SUB A, A
-        case 0x90: SUB_A(cpu.B); break;     // SUB B, A
-        case 0x91: SUB_A(cpu.C); break;     // SUB C, A
-        case 0x92: SUB_A(cpu.D); break;     // SUB D, A
-        case 0x93: SUB_A(cpu.E); break;     // SUB E, A
-        case 0x94: SUB_A(cpu.H); break;     // SUB H, A
-        case 0x95: SUB_A(cpu.L); break;     // SUB L, A
-
-        case 0x96: SUB_A(mmu_read(REG_HL)); break;     // SUB (HL), A
-
-        // SUB #, A
-        case 0xD6: SUB_A(fetch_d8()); break;
-
-
-        /**
-         * 4. SBC_A
-         * subtract n + carry flag from A
-         * 
-         * use with: 
-         * n = A,B,C,D,E,H,L,(HL),#
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Set.
-            H - Set if no borrow from bit 4.
-            C - Set if no borro
-         */
-
-        case 0x9F: SBC_A(cpu.A); break;     //SBC A, A
-        case 0x98: SBC_A(cpu.B); break;     //SBC A, B
-        case 0x99: SBC_A(cpu.C); break;     //SBC A, C
-        case 0x9A: SBC_A(cpu.D); break;     //SBC A, D
-        case 0x9B: SBC_A(cpu.E); break;     //SBC A, E
-        case 0x9C: SBC_A(cpu.H); break;     //SBC A, H
-        case 0x9D: SBC_A(cpu.L); break;     //SBC A, L
-
-        case 0x9E: SBC_A(mmu_read(REG_HL)); break;     //SBC A, (HL)
-
-        // SBC A, #
-        // not in the gameboy manual ?!?!?!
-        case 0xDE: SBC_A(fetch_d8()); break;
-
-
-        /**
-         * 5. AND n
-         * logically AND n with A 
-         * 
-         * result in A register
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL),# 
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Set.
-            C - Reset.
-         * 
-         */
-
-        case 0xA7: AND_A(cpu.A); break;    // AND A 
-        case 0xA0: AND_A(cpu.B); break;    // AND B 
-        case 0xA1: AND_A(cpu.C); break;    // AND C 
-        case 0xA2: AND_A(cpu.D); break;    // AND D 
-        case 0xA3: AND_A(cpu.E); break;    // AND E 
-        case 0xA4: AND_A(cpu.H); break;    // AND H 
-        case 0xA5: AND_A(cpu.L); break;    // AND L 
-
-        case 0xA6: AND_A(mmu_read(REG_HL)); break;    // AND (HL) 
-
-        // AND A, #
-        case 0xE6: AND_A(fetch_d8()); break;
-
-
-        /**
-         * 6. OR n
-         * logical OR with register A
-         * 
-         * result is stored in A
-         * 
-         * use with:
-         * n =  A,B,C,D,E,H,L,(HL),#
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Rese
-         */
-        
-        case 0xB7: OR_A(cpu.A); break;          //OR A, A
-        case 0xB0: OR_A(cpu.B); break;          //OR A, B
-        case 0xB1: OR_A(cpu.C); break;          //OR A, C
-        case 0xB2: OR_A(cpu.D); break;          //OR A, D
-        case 0xB3: OR_A(cpu.E); break;          //OR A, E
-        case 0xB4: OR_A(cpu.H); break;          //OR A, H
-        case 0xB5: OR_A(cpu.L); break;          //OR A, L
-        
-        case 0xB6: OR_A(mmu_read(REG_HL)); break;          //OR A, (HL)
-        
-        case 0xF6: OR_A(fetch_d8()); break;          //OR A, n
-
-
-
-        /**
-         * 7. XOR n
-         * logical exclusive OR n with register A
-         * 
-         * store result in A
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL),#
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Reset.
-         */
-
-        case 0xAF: XOR_A(cpu.A); break;     // XOR A, A
-        case 0xA8: XOR_A(cpu.B); break;     // XOR A, B
-        case 0xA9: XOR_A(cpu.C); break;     // XOR A, C
-        case 0xAA: XOR_A(cpu.D); break;     // XOR A, D
-        case 0xAB: XOR_A(cpu.E); break;     // XOR A, E
-        case 0xAC: XOR_A(cpu.H); break;     // XOR A, H
-        case 0xAD: XOR_A(cpu.L); break;     // XOR A, L
-        
-        case 0xAE: XOR_A(mmu_read(REG_HL)); break;     // XOR A, (HL)
-
-        //XOR A, *
-        case 0xEE: XOR_A(fetch_d8()); break;
-
-
-        /**
-         * 8. CP n
-         *  compare A with n. 
-         * 
-         * this is basically an A - n subtraction instruction but the results
-         * are not stored and discarded instead
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL),#
-         * 
-         * Flags affected:
-            Z - Set if result is zero. (Set if A = n.)
-            N - Set.
-            H - Set if no borrow from bit 4.
-            C - Set for no borrow. (Set if A < n.)
-         */
-        case 0xBF: CP_A(cpu.A); break;      // CP A, A
-        case 0xB8: CP_A(cpu.B); break;      // CP A, B
-        case 0xB9: CP_A(cpu.C); break;      // CP A, C
-        case 0xBA: CP_A(cpu.D); break;      // CP A, D
-        case 0xBB: CP_A(cpu.E); break;      // CP A, E
-        case 0xBC: CP_A(cpu.H); break;      // CP A, H
-        case 0xBD: CP_A(cpu.L); break;      // CP A, L
-        
-        case 0xBE: CP_A(mmu_read(REG_HL)); break;      // CP A, (HL)
-        
-        case 0xFE: CP_A(fetch_d8()); break;      // CP A, #
-
-
-        /* INCREMENT AND DECREMENT OPERATORS*/
-        
-        /* 8-BIT INCREMENT OPERATIONS*/
-
-        /**
-         * 9. INC n
-         * increment register n
-         * 
-         * use with:
-         *  n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Set if carry from bit 3.
-            C - Not affected
-         */
-
-        case 0x3C: cpu.A = INC(cpu.A); break;  // INC A
-        case 0x04: cpu.B = INC(cpu.B); break;   // INC B
-        case 0x0C: cpu.C = INC(cpu.C); break;   // INC C
-        case 0x14: cpu.D = INC(cpu.D); break;   // INC D
-        case 0x1C: cpu.E = INC(cpu.E); break;   // INC E
-        case 0x24: cpu.H = INC(cpu.H); break;   // INC H
-        case 0x2C: cpu.L = INC(cpu.L); break;  //INC L
-
-        // INC (HL)
-        case 0x34: {
-            uint8_t val = mmu_read(REG_HL);
-            val = INC(val);
-            mmu_write(REG_HL, val);
-            break;
-        }
+    gb->cpu.H = (hl >> 8) & 0xFF;
+    gb->cpu.L = hl & 0xFF;
+}
 
-        
-        /* DECREMENT OPERATIONS */
-        /**
-         * 10. DEC n
-         * decrement register n
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if reselt is zero.
-            N - Set.
-            H - Set if no borrow from bit 4.
-            C - Not affect
-         */
-
-        case 0x3D: cpu.A = DEC(cpu.A); break;       // DEC A
-        case 0x05: cpu.B = DEC(cpu.B); break;       // DEC B
-        case 0x0D: cpu.C = DEC(cpu.C); break;       // DEC C
-        case 0x15: cpu.D = DEC(cpu.D); break;       // DEC D
-        case 0x1D: cpu.E = DEC(cpu.E); break;       // DEC E
-        case 0x25: cpu.H = DEC(cpu.H); break;       // DEC H
-        case 0x2D: cpu.L = DEC(cpu.L); break;       // DEC L
-        
-        // DEC A, (HL)
-        case 0x35: {
-            uint8_t val = mmu_read(REG_HL);
-            val = DEC(val);
-            mmu_write(REG_HL, val);
-            break;
-        }
+/**
+ * 16. - 18. LD (HLI), A / LD (HL+), A / LDI (HL), A
+ *
+ * puts A into memory address HL
+ * increment HL
+ */
+static void op_ldi_hl_a(gb_t* gb) {
+    uint16_t hl = REG_HL;
+    mmu_write(gb, hl, gb->cpu.A);
 
-        // older logic: 
-        // case 0x05: {
-        //     uint8_t prev = cpu.B;
-        //     cpu.B--;
-
-        //     cpu.F &= FLAG_C;        //preserve C (carry) always, clear other flags
-        //     cpu.F |= FLAG_N;
-            
-        //     if (cpu.B == 0) {
-        //         cpu.F |= FLAG_Z;
-        //     }
-            
-        //     if ((prev & 0x0F) == 0x00) {
-        //         cpu.F |= FLAG_H;
-        //     }
-        //     break;
-        // }
-
-
-        /* 16-BIT ARITHMETIC OPERATIONS*/
-
-        /**
-         * 1. ADD HL, n
-         * adds n to HL
-         * 
-         * use with:
-         *  n = BC,DE,HL,SP
-         * 
-         * flags affected:
-            Z - Not affected.
-            N - Reset.
-            H - Set if carry from bit 11.
-            C - Set if carry from bit 15. 
-        */
-
-        case 0x09: ADD_HL(REG_BC); break;   // ADD HL, BC
-        case 0x19: ADD_HL(REG_DE); break;   // ADD HL, DE
-        case 0x29: ADD_HL(REG_HL); break;   // ADD HL, HL
-        case 0x39: ADD_HL(cpu.SP); break;   // ADD HL, SP (stakc pointer)
-        
-
-        /**
-         * 2. ADD SP, n
-         * adds n to stack pointer (SP)
-         * 
-         * use with:
-         *  n = one byte signed immediate value (#)
-         * 
-         * Flags affected:
-            Z - Reset.
-            N - Reset.
-            H - Set or reset according to operation.
-            C - Set or reset acc
-         */
-
-        case 0xE8: ADD_SP(cpu.SP); break;   //ADD SP, #
-
-
-        /**
-         * 3. INC nn
-         * increment register nn 
-         * 
-         * use with:
-         * nn = BC,DE,HL,SP 
-         * 
-         * Flags affected: none
-         */
-
-        // INC BC
-        case 0x03: {
-            uint16_t bc = REG_BC;
-            INC_16(&bc);
-            SET_REG_BC(bc); 
-            break;
-        }
+    hl++; //increment step
 
-        // INC DE
-        case 0x13: {
-            uint16_t de = REG_DE;
-            INC_16(&de);
-            SET_REG_DE(de); 
-            break;
-        }
+    gb->cpu.H = (hl >> 8) & 0xFF;
+    gb->cpu.L = hl & 0xFF;
+}
 
-        // INC HL
-        case 0x23: {
-            uint16_t hl = REG_HL;
-            INC_16(&hl);
-            SET_REG_HL(hl); 
-            break;
-        }
+/**
+ * 19. LDH (n), A
+ * puts A into memory address $FF00 + n
+ *
+ * use with:
+ * n = one byte immediate
+ */
+static void op_ldh_a8_a(gb_t* gb) {
+    uint16_t offset = fetch_d8(gb); // taking an offset
+    uint16_t addr = 0xFF00 + offset;
 
-        case 0x33: INC_16(&cpu.SP); break; // INC SP (stack pointer)
-        
-        
-        /**
-         * 4. DEC nn
-         * decrement register nn 
-         * 
-         * use with:
-         * nn = BC,DE,HL,SP
-         * 
-         * Flags affected: none
-         */
-
-        // DEC BC
-        case 0x0B:{
-            uint16_t bc = REG_BC;
-            DEC_16(&bc);
-            SET_REG_BC(bc);
-            break;
-        }
+    mmu_write(gb, addr, gb->cpu.A);
+}
 
-        // DEC DE
-        case 0x1B:{
-            uint16_t de = REG_DE;
-            DEC_16(&de);
-            SET_REG_DE(de);
-            break;
-        }
+/**
+ * 20. LDH A, (n)
+ * put memory address $FF00 + n into A
+ * reverse of instruction 19
+ */
+static void op_ldh_a_a8(gb_t* gb) {
+    uint8_t offset = fetch_d8(gb);
+    gb->cpu.A = mmu_read(gb, 0xFF00 + offset);
+}
 
-        // DEC HL
-        case 0x2B:{
-            uint16_t hl = REG_HL;
-            DEC_16(&hl);
-            SET_REG_HL(hl);
-            break;
-        }
-    
-        case 0x3B: DEC_16(&cpu.SP); break;     //DEC SP (stack pointer)
-
-
-        /* MISCELLANEOUS OPERATIONS */
-
-        /**
-         * 1. SWAP - implemented in execute CB opcodes
-         * 
-         * 
-         * 2. DAA decimal adjust register A
-         * 
-         * this instruction adjusts reg A so that the correct representation of BCD (Binary Coded Decimal) is obtained
-         * 
-         * Flags affected:
-            Z - Set if register A is zero.
-            N - Not affected.
-            H - Reset.
-            C - Set or reset according to operation
-         */
-        // DAA
-        case 0x27: {
-            DAA();
-            break;
-        }
 
-        /**
-         * 3. CPL - complement register A (flip all bits)
-         * 
-         * Flags affected:
-            Z - Not affected.
-            N - Set.
-            H - Set.
-            C - Not affected.
-         */
-        case 0x2F: CPL(); break;
-
-
-        /**
-         * 4. CCF - complement Carry flag
-         * if c flag is set, then reset it.
-         * If C flag is reset, then set it.
-         *
-         * Flags affected:
-            Z - Not affected.
-            N - Reset.
-            H - Reset.
-            C - Complemented.
-         */
-        case 0x3F: CCF(); break;
-
-
-        /** 
-         * 5. SCF - set carry flag
-         * 
-         *  Flags affected:
-            Z - Not affected.
-            N - Reset.
-            H - Reset.
-            C - Set.
-         */
-        case 0x37: SCF(); break;
-
-        /**
-         * MISC 9. DI (disable interrupts)
-         * this instruction DISABLES interrupts but NOT IMMEDIATELY.
-         * Interrupts are disabled after instruction AFTER DI is executed
-         * 
-         * Flags affected: none
-         */
-        case 0xF3: cpu.ime_disable = true; break;
-
-
-        /**
-         * MISC 10. EI (enable interrupts)
-         * this instruction ENABLES interrupts but not IMMEDIATELY.
-         * Interrupts are enabled after instruction AFTER EI is executed
-         */
-        case 0xFB: cpu.ime_enable = true; break;
-
-
-        /* 3.3.6 ROTATES AND SHIFTS */
-
-        /**
-         * 1. RLC A (what)
-         * Rotate A left, Old bit 7 to carry flag 
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 7 data. 
-         */
-
-        case 0x07:{
-            uint8_t bit7 = (cpu.A >> 7) &0x01;
-            cpu.A = (cpu.A << 1) | bit7;
-
-            //flags
-            cpu.F = 0; // Z=0, N=0, H=0
-            if (bit7) {
-                cpu.F |= FLAG_C;
-            }
-            break;
-        }
 
+/* 16-bit load ooperations */
 
-        /**
-         * 2. RLA rotate A left through carry flag
-         * 
-         * flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 7 data.
-         */
-
-        case 0x17: { // RLA
-            uint8_t carry = (cpu.F & FLAG_C) ? 1 : 0;
-            uint8_t bit7 = (cpu.A >> 7) & 0x01;
-            cpu.A = (cpu.A << 1) | carry;
-
-            // Flags
-            cpu.F = 0;
-            if (bit7) {
-                cpu.F |= FLAG_C;
-            }
+/**
+ * 1. LD n, nn
+ * put value nn into n
+ *
+ * use with:
+ * n = BC,DE,HL,SP
+ * nn = 16 bit immediate value
+ */
+static void op_ld_bc_d16(gb_t* gb) { uint16_t nn = fetch_d16(gb); SET_REG_BC(nn); }       // LD BC, nn
+static void op_ld_de_d16(gb_t* gb) { uint16_t nn = fetch_d16(gb); SET_REG_DE(nn); }       // LD DE, nn
+static void op_ld_hl_d16(gb_t* gb) { uint16_t nn = fetch_d16(gb); SET_REG_HL(nn); }       // LD HL, nn
+static void op_ld_sp_d16(gb_t* gb) { gb->cpu.SP = fetch_d16(gb); }                        // LD SP, nn
 
-            break;
-        }
+/**
+ * 2. LD SP, HL
+ * puts value at HL into SP (stack Pointer)
+ *
+ * 8 cycles
+ */
+static void op_ld_sp_hl(gb_t* gb) { gb->cpu.SP = REG_HL; }
 
+/**
+ * 3. LD HL, SP + n
+ * same as LDHL SP, n
+ *
+ * 4. LDHL SP, n
+ * Puts SP + n effective address into HL
+ *
+ * use with:
+ * n = one byte signed immediate value
+ *
+ * flags affected:
+ * Z = Reset
+ * N = Reset
+ * H = Set or reset according to operation
+ * C = Set or reset acc to op
+ */
+static void op_ld_hl_sp_e8(gb_t* gb) {
+    int16_t n = (int8_t)fetch_d8(gb); // cast to signed int8 first!
+    uint16_t sp = gb->cpu.SP;
+    uint16_t result = sp + n;
 
-        /** 
-         * 3. RRCA 
-         * Rotate A right. old bit 0 to carry flag
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 0 data.
-         */ 
-
-        case 0x0F: { // RRCA
-            uint8_t bit0 = cpu.A & 0x01;
-            cpu.A = (cpu.A >> 1) | (bit0 << 7);
-
-            // Flags
-            cpu.F = 0;
-            if (bit0) {
-                cpu.F |= FLAG_C;
-            }
+    // set HL to result
+    SET_REG_HL(result);
 
-            break;
-        }
+    //clear Z and N flags
+    flags_sync(&gb->cpu);
+    gb->cpu.F &= ~(FLAG_Z | FLAG_N);
 
+    //set Half carry (H) and carry (c) flags based on lower byte addition
+    // use same logic to add signed int to unsigned int
+    uint16_t temp = (sp ^ n ^ result) & 0xFFFF;
 
-        /**
-         * 4. RRA
-         * Rotate A right through carry flag
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 0 data
-         */
-
-        case 0x1F: { // RRA
-            uint8_t carry = (cpu.F & FLAG_C) ? 1 : 0;
-            uint8_t bit0 = cpu.A & 0x01;
-            cpu.A = (cpu.A >> 1) | (carry << 7);
-
-            // Flags
-            cpu.F = 0;
-            if (bit0) {
-                cpu.F |= FLAG_C;
-            }
+    if ((temp & 0x10) != 0) {
+        gb->cpu.F |= FLAG_H;
+    } else {
+        gb->cpu.F &= ~FLAG_H;
+    }
+    if ((temp & 0x100) != 0) {
+        gb->cpu.F |= FLAG_C;
+    } else {
+        gb->cpu.F &= ~FLAG_C;
+    }
+}
 
-            break;
-        }
+/**
+ * 5. LD (nn), SP
+ * put stack pointer (SP) at addr n
+ *
+ * use with:
+ * nn = two byte immediate address
+ *
+ * 20 cycles
+ */
+static void op_ld_a16_sp(gb_t* gb) {
+    // read immediate 16-bit address nn
+    // it is a littl;e endian
+    uint16_t addr = fetch_d16(gb);
+
+    // store stack pointer val at addr nn
+    // little endian -- low byte first
+    mmu_write(gb, addr, gb->cpu.SP & 0xFF);     // SP Low byte
+    mmu_write(gb, addr + 1, (gb->cpu.SP >> 8) & 0xFF); // SP high byte
+}
 
 
+// STACK OPERATIONS PUSH AND POP
 
-        /* JUMPS (van halen moment)*/
-        /**
-         * 1. JP, nn
-         * jump to address nn 
-         * 
-         * use with: 
-         *  nn = two byte immediate value. (least significant byte first.)
-         */
-   
-        // JP nn
-        case 0xC3: {
-            cpu.PC = fetch_d16(); // get the address and advance the PC correctly
-            break;
-        }
+/**
+ * 6. PUSH nn
+ *
+ * push register pair nn onto stack
+ * decrement SP (Stack Pointer) twice
+ *
+ * use with:
+ * nn = AF, BC, DE, HL
+ *
+ * HIGH BYTE FIRST
+ * LOW BYTE NEXT
+ */
+static void op_push_af(gb_t* gb) {
+    mmu_write(gb, --gb->cpu.SP, gb->cpu.A);
+    mmu_write(gb, --gb->cpu.SP, cpu_flags(&gb->cpu) & 0xF0);  // mask off lower 4 bits (always 0 on hardware)
+}
 
-        /**
-         * 2. JP cc, nn
-         * 
-         * jump to address n if following conditions are true:
-         * cc = NZ, jump if Z flag is reset
-         * cc = Z, jump if Z flag is set
-         * cc = NC, jump if C flag is reset
-         * cc = C, jump if C flag is set
-         * 
-         * use with:
-         * nn = two byte immediate value. (least significant  byte first.)
-         * 
-         */
-
-        // JP NZ nn
-        case 0xC2:{
-            uint16_t addr = fetch_d16();
-            if ((cpu.F & FLAG_Z) == 0) {
-                cpu.PC = addr;
-            }
+static void op_push_bc(gb_t* gb) { mmu_write(gb, --gb->cpu.SP, gb->cpu.B); mmu_write(gb, --gb->cpu.SP, gb->cpu.C); }
+static void op_push_de(gb_t* gb) { mmu_write(gb, --gb->cpu.SP, gb->cpu.D); mmu_write(gb, --gb->cpu.SP, gb->cpu.E); }
+static void op_push_hl(gb_t* gb) { mmu_write(gb, --gb->cpu.SP, gb->cpu.H); mmu_write(gb, --gb->cpu.SP, gb->cpu.L); }
 
-            break;
-        }
+/**
+ * 7. POP nn
+ *
+ * pop off two bytes off stack into register pair nn
+ * increment stack pointer SP twice every iteration
+ *
+ * use with:
+ * nn = AF, BC, DE, HL
+ *
+ *  LOW BYTE FIRST
+ *  HIGH BYTE NEXT
+ */
+static void op_pop_af(gb_t* gb) {
+    flags_store(&gb->cpu, mmu_read(gb, gb->cpu.SP++) & 0xF0);
+    gb->cpu.A = mmu_read(gb, gb->cpu.SP++);
+}
 
-        // JP Z nn
-        case 0xCA:{
-            uint16_t addr = fetch_d16();
-            if ((cpu.F & FLAG_Z) != 0) {
-                cpu.PC = addr;
-            } 
+static void op_pop_bc(gb_t* gb) { gb->cpu.C = mmu_read(gb, gb->cpu.SP++); gb->cpu.B = mmu_read(gb, gb->cpu.SP++); }
+static void op_pop_de(gb_t* gb) { gb->cpu.E = mmu_read(gb, gb->cpu.SP++); gb->cpu.D = mmu_read(gb, gb->cpu.SP++); }
+static void op_pop_hl(gb_t* gb) { gb->cpu.L = mmu_read(gb, gb->cpu.SP++); gb->cpu.H = mmu_read(gb, gb->cpu.SP++); }
 
-            break;
-        }
 
-        // JP NC nn
-        case 0xD2:{
-            uint16_t addr = fetch_d16();
-            if ((cpu.F & FLAG_C) == 0) {
-                cpu.PC = addr;
-            } 
+// -------------------------------- //
+/* ARITHMETIC LOGIC UNIT OPERATIONS */
+// -------------------------------- //
 
-            break;
-        }
-        
-        // JP C nn
-        case 0xDA:{
-            uint16_t addr = fetch_d16();
-            if ((cpu.F & FLAG_C) != 0) {
-                cpu.PC = addr;
-            }
+/**
+ * 1. ADD A, n
+ * add n to A
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL),#
+ */
+static void op_add_a_a(gb_t* gb) { ADD_A(gb, gb->cpu.A); }                  // ADD A, A
+static void op_add_a_b(gb_t* gb) { ADD_A(gb, gb->cpu.B); }                  // ADD A, B
+static void op_add_a_c(gb_t* gb) { ADD_A(gb, gb->cpu.C); }                  // ADD A, C
+static void op_add_a_d(gb_t* gb) { ADD_A(gb, gb->cpu.D); }                  // ADD A, D
+static void op_add_a_e(gb_t* gb) { ADD_A(gb, gb->cpu.E); }                  // ADD A, E
+static void op_add_a_h(gb_t* gb) { ADD_A(gb, gb->cpu.H); }                  // ADD A, H
+static void op_add_a_l(gb_t* gb) { ADD_A(gb, gb->cpu.L); }                  // ADD A, L
+static void op_add_a_hl(gb_t* gb) { ADD_A(gb, mmu_read(gb, REG_HL)); }      // ADD A, (HL)
+static void op_add_a_d8(gb_t* gb) { ADD_A(gb, fetch_d8(gb)); }              // ADD A, #
 
-            break;
-        }
+/**
+ * 2. ADC A, n
+ * add n + carry flag to A
+ *
+ * use with:
+ * n = A,B, C,D,E,H,L,(HL),#
+ */
+static void op_adc_a_a(gb_t* gb) { ADC_A(gb, gb->cpu.A); }                  // ADC A, A
+static void op_adc_a_b(gb_t* gb) { ADC_A(gb, gb->cpu.B); }                  // ADC A, B
+static void op_adc_a_c(gb_t* gb) { ADC_A(gb, gb->cpu.C); }                  // ADC A, C
+static void op_adc_a_d(gb_t* gb) { ADC_A(gb, gb->cpu.D); }                  // ADC A, D
+static void op_adc_a_e(gb_t* gb) { ADC_A(gb, gb->cpu.E); }                  // ADC A, E
+static void op_adc_a_h(gb_t* gb) { ADC_A(gb, gb->cpu.H); }                  // ADC A, H
+static void op_adc_a_l(gb_t* gb) { ADC_A(gb, gb->cpu.L); }                  // ADC A, L
+static void op_adc_a_hl(gb_t* gb) { ADC_A(gb, mmu_read(gb, REG_HL)); }      // ADC A, (HL)
+static void op_adc_a_d8(gb_t* gb) { ADC_A(gb, fetch_d8(gb)); }              // ADC A, #
 
+/**
+ * 3. SUB n
+ * subtract n from A
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL),#
+ */
+static void op_sub_a(gb_t* gb) { SUB_A(gb, gb->cpu.A); }                    // SUB A
+static void op_sub_b(gb_t* gb) { SUB_A(gb, gb->cpu.B); }                    // SUB B
+static void op_sub_c(gb_t* gb) { SUB_A(gb, gb->cpu.C); }                    // SUB C
+static void op_sub_d(gb_t* gb) { SUB_A(gb, gb->cpu.D); }                    // SUB D
+static void op_sub_e(gb_t* gb) { SUB_A(gb, gb->cpu.E); }                    // SUB E
+static void op_sub_h(gb_t* gb) { SUB_A(gb, gb->cpu.H); }                    // SUB H
+static void op_sub_l(gb_t* gb) { SUB_A(gb, gb->cpu.L); }                    // SUB L
+static void op_sub_hl(gb_t* gb) { SUB_A(gb, mmu_read(gb, REG_HL)); }        // SUB (HL)
+static void op_sub_d8(gb_t* gb) { SUB_A(gb, fetch_d8(gb)); }                // SUB #
 
-        /**
-         * 3. JP HL
-         * jump to address contained in HL 16-bit register
-         * 
-         */
+/**
+ * 4. SBC_A
+ * subtract n + carry flag from A
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL),#
+ */
+static void op_sbc_a_a(gb_t* gb) { SBC_A(gb, gb->cpu.A); }                  // SBC A, A
+static void op_sbc_a_b(gb_t* gb) { SBC_A(gb, gb->cpu.B); }                  // SBC A, B
+static void op_sbc_a_c(gb_t* gb) { SBC_A(gb, gb->cpu.C); }                  // SBC A, C
+static void op_sbc_a_d(gb_t* gb) { SBC_A(gb, gb->cpu.D); }                  // SBC A, D
+static void op_sbc_a_e(gb_t* gb) { SBC_A(gb, gb->cpu.E); }                  // SBC A, E
+static void op_sbc_a_h(gb_t* gb) { SBC_A(gb, gb->cpu.H); }                  // SBC A, H
+static void op_sbc_a_l(gb_t* gb) { SBC_A(gb, gb->cpu.L); }                  // SBC A, L
+static void op_sbc_a_hl(gb_t* gb) { SBC_A(gb, mmu_read(gb, REG_HL)); }      // SBC A, (HL)
+static void op_sbc_a_d8(gb_t* gb) { SBC_A(gb, fetch_d8(gb)); }              // SBC A, #
 
-        // JP HL 
-        case 0xE9: cpu.PC = REG_HL; break;
+/**
+ * 5. AND n
+ * logically AND n with A, result in A register
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL),#
+ */
+static void op_and_a(gb_t* gb) { AND_A(gb, gb->cpu.A); }                    // AND A
+static void op_and_b(gb_t* gb) { AND_A(gb, gb->cpu.B); }                    // AND B
+static void op_and_c(gb_t* gb) { AND_A(gb, gb->cpu.C); }                    // AND C
+static void op_and_d(gb_t* gb) { AND_A(gb, gb->cpu.D); }                    // AND D
+static void op_and_e(gb_t* gb) { AND_A(gb, gb->cpu.E); }                    // AND E
+static void op_and_h(gb_t* gb) { AND_A(gb, gb->cpu.H); }                    // AND H
+static void op_and_l(gb_t* gb) { AND_A(gb, gb->cpu.L); }                    // AND L
+static void op_and_hl(gb_t* gb) { AND_A(gb, mmu_read(gb, REG_HL)); }        // AND (HL)
+static void op_and_d8(gb_t* gb) { AND_A(gb, fetch_d8(gb)); }                // AND #
 
+/**
+ * 6. OR n
+ * logical OR with register A, result is stored in A
+ *
+ * use with:
+ * n =  A,B,C,D,E,H,L,(HL),#
+ */
+static void op_or_a(gb_t* gb) { OR_A(gb, gb->cpu.A); }                      // OR A
+static void op_or_b(gb_t* gb) { OR_A(gb, gb->cpu.B); }                      // OR B
+static void op_or_c(gb_t* gb) { OR_A(gb, gb->cpu.C); }                      // OR C
+static void op_or_d(gb_t* gb) { OR_A(gb, gb->cpu.D); }                      // OR D
+static void op_or_e(gb_t* gb) { OR_A(gb, gb->cpu.E); }                      // OR E
+static void op_or_h(gb_t* gb) { OR_A(gb, gb->cpu.H); }                      // OR H
+static void op_or_l(gb_t* gb) { OR_A(gb, gb->cpu.L); }                      // OR L
+static void op_or_hl(gb_t* gb) { OR_A(gb, mmu_read(gb, REG_HL)); }          // OR (HL)
+static void op_or_d8(gb_t* gb) { OR_A(gb, fetch_d8(gb)); }                  // OR #
 
-        /**
-         * 4. JR n
-         * add n to current address and jump to it
-         * 
-         * use with:
-         * n = one byte signed immediate value 
-         */
+/**
+ * 7. XOR n
+ * logical exclusive OR n with register A, store result in A
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL),#
+ */
+static void op_xor_a(gb_t* gb) { XOR_A(gb, gb->cpu.A); }                    // XOR A
+static void op_xor_b(gb_t* gb) { XOR_A(gb, gb->cpu.B); }                    // XOR B
+static void op_xor_c(gb_t* gb) { XOR_A(gb, gb->cpu.C); }                    // XOR C
+static void op_xor_d(gb_t* gb) { XOR_A(gb, gb->cpu.D); }                    // XOR D
+static void op_xor_e(gb_t* gb) { XOR_A(gb, gb->cpu.E); }                    // XOR E
+static void op_xor_h(gb_t* gb) { XOR_A(gb, gb->cpu.H); }                    // XOR H
+static void op_xor_l(gb_t* gb) { XOR_A(gb, gb->cpu.L); }                    // XOR L
+static void op_xor_hl(gb_t* gb) { XOR_A(gb, mmu_read(gb, REG_HL)); }        // XOR (HL)
+static void op_xor_d8(gb_t* gb) { XOR_A(gb, fetch_d8(gb)); }                // XOR #
 
-        // JR n (signed offset)
-        case 0x18: {
-            int8_t offset = (int8_t)fetch_d8();
-            cpu.PC += offset;
-            break;
-        }
+/**
+ * 8. CP n
+ * compare A with n.
+ *
+ * this is basically an A - n subtraction instruction but the results
+ * are not stored and discarded instead
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL),#
+ */
+static void op_cp_a(gb_t* gb) { CP_A(gb, gb->cpu.A); }                      // CP A
+static void op_cp_b(gb_t* gb) { CP_A(gb, gb->cpu.B); }                      // CP B
+static void op_cp_c(gb_t* gb) { CP_A(gb, gb->cpu.C); }                      // CP C
+static void op_cp_d(gb_t* gb) { CP_A(gb, gb->cpu.D); }                      // CP D
+static void op_cp_e(gb_t* gb) { CP_A(gb, gb->cpu.E); }                      // CP E
+static void op_cp_h(gb_t* gb) { CP_A(gb, gb->cpu.H); }                      // CP H
+static void op_cp_l(gb_t* gb) { CP_A(gb, gb->cpu.L); }                      // CP L
+static void op_cp_hl(gb_t* gb) { CP_A(gb, mmu_read(gb, REG_HL)); }          // CP (HL)
+static void op_cp_d8(gb_t* gb) { CP_A(gb, fetch_d8(gb)); }                  // CP #
 
-        /**
-         * 5. JR cc, n
-         * if following condition is true, then add n to current address and jump to it
-         * 
-         * use with:
-         *  n = one byte signed immediate value
-            cc = NZ, Jump if Z flag is reset.
-            cc = Z, Jump if Z flag is set.
-            cc = NC, Jump if C flag is reset.
-            cc = C, Jump if C flag is set
-         */
-
-        // JR NZ, * opcode 0x20
-        case 0x20: {
-            int8_t offset = (int8_t)fetch_d8();
-            if ((cpu.F & FLAG_Z) == 0) {
-                cpu.PC += offset;
-            }
-            break;
-        }
 
-        // JR Z, * opcode 0x28
-        case 0x28: {
-            int8_t offset = (int8_t)fetch_d8();
-            if ((cpu.F & FLAG_Z) != 0) {
-                cpu.PC += offset;
-            }
-            break;
-        }
+/* INCREMENT AND DECREMENT OPERATORS*/
 
-        // JR NC, * opcode 0x30
-        case 0x30: {
-            int8_t offset = (int8_t)fetch_d8();
-            if ((cpu.F & FLAG_C) == 0) {
-                cpu.PC += offset;
-            }
-            break;
-        }
+/**
+ * 9. INC n
+ * increment register n
+ *
+ * use with:
+ *  n = A,B,C,D,E,H,L,(HL)
+ */
+static void op_inc_a(gb_t* gb) { gb->cpu.A = INC(gb, gb->cpu.A); }              // INC A
+static void op_inc_b(gb_t* gb) { gb->cpu.B = INC(gb, gb->cpu.B); }              // INC B
+static void op_inc_c(gb_t* gb) { gb->cpu.C = INC(gb, gb->cpu.C); }              // INC C
+static void op_inc_d(gb_t* gb) { gb->cpu.D = INC(gb, gb->cpu.D); }              // INC D
+static void op_inc_e(gb_t* gb) { gb->cpu.E = INC(gb, gb->cpu.E); }              // INC E
+static void op_inc_h(gb_t* gb) { gb->cpu.H = INC(gb, gb->cpu.H); }              // INC H
+static void op_inc_l(gb_t* gb) { gb->cpu.L = INC(gb, gb->cpu.L); }              // INC L
+
+// INC (HL)
+static void op_inc_hlp(gb_t* gb) {
+    uint8_t val = mmu_read(gb, REG_HL);
+    val = INC(gb, val);
+    mmu_write(gb, REG_HL, val);
+}
 
-        // JR C, * opcode 0x38
-        case 0x38: {
-            int8_t offset = (int8_t)fetch_d8();
-            if ((cpu.F & FLAG_C) != 0) {
-                cpu.PC += offset;
-            }
-            break;
-        }
+/**
+ * 10. DEC n
+ * decrement register n
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL)
+ */
+static void op_dec_a(gb_t* gb) { gb->cpu.A = DEC(gb, gb->cpu.A); }              // DEC A
+static void op_dec_b(gb_t* gb) { gb->cpu.B = DEC(gb, gb->cpu.B); }              // DEC B
+static void op_dec_c(gb_t* gb) { gb->cpu.C = DEC(gb, gb->cpu.C); }              // DEC C
+static void op_dec_d(gb_t* gb) { gb->cpu.D = DEC(gb, gb->cpu.D); }              // DEC D
+static void op_dec_e(gb_t* gb) { gb->cpu.E = DEC(gb, gb->cpu.E); }              // DEC E
+static void op_dec_h(gb_t* gb) { gb->cpu.H = DEC(gb, gb->cpu.H); }              // DEC H
+static void op_dec_l(gb_t* gb) { gb->cpu.L = DEC(gb, gb->cpu.L); }              // DEC L
+
+// DEC (HL)
+static void op_dec_hlp(gb_t* gb) {
+    uint8_t val = mmu_read(gb, REG_HL);
+    val = DEC(gb, val);
+    mmu_write(gb, REG_HL, val);
+}
 
 
-        /* CALLS */
-
-        /**
-         * 1. CALL nn 
-         * puts address of next instruction onto stack and then jumps to address nn
-         * 
-         * use with:
-         * nn = two byte immediate value (Least Significant byte first)
-         */
-        // CALL nn
-        case 0xCD:{
-            uint16_t addr = fetch_d16();
-            push16(cpu.PC);
-            // replaced the old code for the push16 implementation
-            // mmu_write(--cpu.SP, (cpu.PC >> 8));
-            // mmu_write(--cpu.SP, (cpu.PC & 0xFF));
-            cpu.PC = addr;
-            break;
-        }
+/* 16-BIT ARITHMETIC OPERATIONS*/
 
-        /**
-         * 2. CALL cc, nn 
-         * call addr n if following conditions are true:
-            cc = NZ, Call if Z flag is reset.
-            cc = Z, Call if Z flag is set.
-            cc = NC, Call if C flag is reset.
-            cc = C, Call if C flag is set.
-         * 
-         * use with:
-         * nn = two byte immediate value (Least significant byte first)
-         */
-
-        // CALL NZ, nn
-        case 0xC4: {
-            uint16_t addr = fetch_d16();
-            if ((cpu.F & FLAG_Z) == 0) {
-                push16(cpu.PC);
-                cpu.PC = addr;
-            }
-            break;
-        }
+/**
+ * 1. ADD HL, n
+ * adds n to HL
+ *
+ * use with:
+ *  n = BC,DE,HL,SP
+ */
+static void op_add_hl_bc(gb_t* gb) { ADD_HL(gb, REG_BC); }                  // ADD HL, BC
+static void op_add_hl_de(gb_t* gb) { ADD_HL(gb, REG_DE); }                  // ADD HL, DE
+static void op_add_hl_hl(gb_t* gb) { ADD_HL(gb, REG_HL); }                  // ADD HL, HL
+static void op_add_hl_sp(gb_t* gb) { ADD_HL(gb, gb->cpu.SP); }              // ADD HL, SP
 
-        // CALL Z, nn
-        case 0xCC: {
-            uint16_t addr = fetch_d16();
-            if ((cpu.F & FLAG_Z) != 0) {
-                push16(cpu.PC);
-                cpu.PC = addr;
-            }
-            break;
-        }
+/**
+ * 2. ADD SP, n
+ * adds n to stack pointer (SP)
+ *
+ * use with:
+ *  n = one byte signed immediate value (#)
+ */
+static void op_add_sp_e8(gb_t* gb) { ADD_SP(gb, (int8_t)fetch_d8(gb)); }
 
-        // CALL NC, nn
-        case 0xD4: {
-            uint16_t addr = fetch_d16();
-            if ((cpu.F & FLAG_C) == 0) {
-                push16(cpu.PC);
-                cpu.PC = addr;
-            }
-            break;
-        }
+/**
+ * 3. INC nn
+ * increment register nn
+ *
+ * use with:
+ * nn = BC,DE,HL,SP
+ *
+ * Flags affected: none
+ */
+static void op_inc_bc(gb_t* gb) { uint16_t bc = REG_BC; INC_16(&bc); SET_REG_BC(bc); }      // INC BC
+static void op_inc_de(gb_t* gb) { uint16_t de = REG_DE; INC_16(&de); SET_REG_DE(de); }      // INC DE
+static void op_inc_hl(gb_t* gb) { uint16_t hl = REG_HL; INC_16(&hl); SET_REG_HL(hl); }      // INC HL
+static void op_inc_sp(gb_t* gb) { INC_16(&gb->cpu.SP); }                                    // INC SP
 
-        // CALL C, nn
-        case 0xDC: {
-            uint16_t addr = fetch_d16();
-            if ((cpu.F & FLAG_C) != 0) {
-                push16(cpu.PC);
-                cpu.PC = addr;
-            }
-            break;
-        }
+/**
+ * 4. DEC nn
+ * decrement register nn
+ *
+ * use with:
+ * nn = BC,DE,HL,SP
+ *
+ * Flags affected: none
+ */
+static void op_dec_bc(gb_t* gb) { uint16_t bc = REG_BC; DEC_16(&bc); SET_REG_BC(bc); }      // DEC BC
+static void op_dec_de(gb_t* gb) { uint16_t de = REG_DE; DEC_16(&de); SET_REG_DE(de); }      // DEC DE
+static void op_dec_hl(gb_t* gb) { uint16_t hl = REG_HL; DEC_16(&hl); SET_REG_HL(hl); }      // DEC HL
+static void op_dec_sp(gb_t* gb) { DEC_16(&gb->cpu.SP); }                                    // DEC SP
 
-        /**
-         * 3.3.10 RESTARTS
-         * 
-         * 1. RST n
-         * push present address onto stack
-         * jump to address $0000 + n
-         * 
-         * use with:
-         *  n = $00,$08,$10,$18,$20,$28,$30,$38
-         */
-        
-        // RST 00H 
-        case 0xC7: push16(cpu.PC); cpu.PC = 0x00; break;
-        
-        // RST 08H 
-        case 0xCF: push16(cpu.PC); cpu.PC = 0x08; break;
-        
-        // RST 10H 
-        case 0xD7: push16(cpu.PC); cpu.PC = 0x10; break;
-        
-        // RST 18H 
-        case 0xDF: push16(cpu.PC); cpu.PC = 0x18; break;
-        
-        // RST 20H 
-        case 0xE7: push16(cpu.PC); cpu.PC = 0x20; break;
-        
-        // RST 28H 
-        case 0xEF: push16(cpu.PC); cpu.PC = 0x28; break;
-        
-        // RST 30H 
-        case 0xF7: push16(cpu.PC); cpu.PC = 0x30; break;
-        
-        // RST 38H 
-        case 0xFF: push16(cpu.PC); cpu.PC = 0x38; break;
-
-
-
-        /* RETURNS */
-
-        /**
-         * 1 RET
-         * pop two bytes from stack and jump to that address
-         * 
-         * opcode: 0xC9
-         */
-        // RET 
-        case 0xC9:{
-            uint8_t lo = mmu_read(cpu.SP);
-            uint8_t hi = mmu_read(cpu.SP + 1);
-            cpu.SP += 2;
-            cpu.PC = (hi << 8) | lo;
-            break;
-        }
 
-        /**
-         * 2. RET cc
-         * return if the conditions are true:
-            cc = NZ, Return if Z flag is reset.
-            cc = Z, Return if Z flag is set.
-            cc = NC, Return if C flag is reset.
-            cc = C, R
-         */
-        // RET NZ
-        case 0xC0: {
-            if ((cpu.F & FLAG_Z) == 0) {
-                uint8_t low = mmu_read(cpu.SP);
-                uint8_t high = mmu_read(cpu.SP + 1);
-                cpu.SP += 2;
-                cpu.PC = (high << 8) | low;
-            }
-            break;
-        }
+/* MISCELLANEOUS OPERATIONS */
 
-        // RET Z
-        case 0xC8: {
-            if ((cpu.F & FLAG_Z) != 0) {
-                uint8_t low = mmu_read(cpu.SP);
-                uint8_t high = mmu_read(cpu.SP + 1);
-                cpu.SP += 2;
-                cpu.PC = (high << 8) | low;
-            }
-            break;
-        }
+// DAA - decimal adjust register A
+static void op_daa(gb_t* gb) { DAA(gb); }
 
-        // RET NC
-        case 0xD0: {           
-            if ((cpu.F & FLAG_C) == 0) {
-                uint8_t low = mmu_read(cpu.SP);
-                uint8_t high = mmu_read(cpu.SP + 1);
-                cpu.SP += 2;
-                cpu.PC = (high << 8) | low;
-            }
-            break;
-        }
+// CPL - complement register A (flip all bits)
+static void op_cpl(gb_t* gb) { CPL(gb); }
 
-        // RET C
-        case 0xD8: {
-            if ((cpu.F & FLAG_C) != 0) {
-                uint8_t low = mmu_read(cpu.SP);
-                uint8_t high = mmu_read(cpu.SP + 1);
-                cpu.SP += 2;
-                cpu.PC = (high << 8) | low;
-            }
-            break;
-        }
+// CCF - complement Carry flag
+static void op_ccf(gb_t* gb) { CCF(gb); }
 
+// SCF - set carry flag
+static void op_scf(gb_t* gb) { SCF(gb); }
 
-        /**
-         * 3. RETI
-         * pop two bytes from stack and jump to that address then enable interrupts
-         */
+/**
+ * DI (disable interrupts)
+ * Interrupts are disabled after instruction AFTER DI is executed
+ */
+static void op_di(gb_t* gb) { gb->cpu.ime_disable = true; }
 
-         // RETI 
-        case 0xD9: {
-            uint8_t low = mmu_read(cpu.SP);
-            uint8_t high = mmu_read(cpu.SP + 1);
-            cpu.SP += 2;
-            cpu.PC = (high << 8) | low;
-            cpu.ime = true; // enable ime immediately without delay
-            break;
-        }
+/**
+ * EI (enable interrupts)
+ * Interrupts are enabled after instruction AFTER EI is executed
+ */
+static void op_ei(gb_t* gb) { gb->cpu.ime_enable = true; }
 
+// HALT instruction
+static void op_halt(gb_t* gb) {
+    LOG_CPU("[HALT] HALT instruction encountered at 0x%04X\n", gb->cpu.PC);
+    gb->cpu.halted = true;
+}
 
-        // HALT instruction
-        case 0x76: {
-            printf("[HALT] HALT instruction encountered at 0x%04X\n", cpu.PC);
-            cpu.halted = true;
-            break; // indicate that cpu is halted
-        }
+// STOP Instruction
+// two-byte instruction which halts the CPU screen and puts it into a low power state
+static void op_stop(gb_t* gb) {
+    LOG_CPU("[STOP] instruction encountered at 0x%04X\n", gb->cpu.PC);
 
-        // STOP Instruction
-        // two-byte instruction which halts the CPU screen and puts it into a low power state
-        case 0x10: {
-            printf("[STOP] instruction encountered at 0x%04X\n", cpu.PC);
-            
-            fetch_d8(); // increment the PC past the 0x00
-
-            // request the interrupt
-            uint8_t current_if = mmu_get_if_register();
-            // set bit 4 (joypad) in the IF
-            mmu_write(0xFF0F, current_if | 0x10); // set bit 4
-
-            // set bit 4 (joypad) in the IE
-            uint8_t current_ie = mmu_get_ie_register();
-            mmu_write(0xFFFF, current_ie | 0x10); // set bit 4
-
-            cpu.halted = true;
-            // cpu.stopped = true;
-            return true;
-            // break;
-        }
+    fetch_d8(gb); // increment the PC past the 0x00
+
+    // request the interrupt
+    uint8_t current_if = mmu_get_if_register(gb);
+    // set bit 4 (joypad) in the IF
+    mmu_write(gb, 0xFF0F, current_if | 0x10); // set bit 4
 
-        default:
-            printf("[HALT] Unimplemented opcode: 0x%02X at 0x%04X\n", opcode, cpu.PC);
-            cpu.PC--; // Rewind PC for debugging
+    // set bit 4 (joypad) in the IE
+    uint8_t current_ie = mmu_get_ie_register(gb);
+    mmu_write(gb, 0xFFFF, current_ie | 0x10); // set bit 4
 
-            cpu.halted = true;
-            return false; // Safely halt on unknown opcode   
-    }   
-    return true;
+    gb->cpu.halted = true;
 }
 
+
+/* 3.3.6 ROTATES AND SHIFTS */
+
 /**
- * @brief Executes CB Opcodes
- * 
- * Separated from execute_opcode for logic
+ * 1. RLCA
+ * Rotate A left, Old bit 7 to carry flag
+ */
+static void op_rlca(gb_t* gb) {
+    uint8_t bit7 = (gb->cpu.A >> 7) &0x01;
+    gb->cpu.A = (gb->cpu.A << 1) | bit7;
+
+    //flags
+    flags_store(&gb->cpu, bit7 ? FLAG_C : 0); // Z=0, N=0, H=0
+}
+
+/**
+ * 2. RLA rotate A left through carry flag
+ */
+static void op_rla(gb_t* gb) {
+    uint8_t carry = flag_c(&gb->cpu) ? 1 : 0;
+    uint8_t bit7 = (gb->cpu.A >> 7) & 0x01;
+    gb->cpu.A = (gb->cpu.A << 1) | carry;
+
+    // Flags
+    flags_store(&gb->cpu, bit7 ? FLAG_C : 0);
+}
+
+/**
+ * 3. RRCA
+ * Rotate A right. old bit 0 to carry flag
+ */
+static void op_rrca(gb_t* gb) {
+    uint8_t bit0 = gb->cpu.A & 0x01;
+    gb->cpu.A = (gb->cpu.A >> 1) | (bit0 << 7);
+
+    // Flags
+    flags_store(&gb->cpu, bit0 ? FLAG_C : 0);
+}
+
+/**
+ * 4. RRA
+ * Rotate A right through carry flag
+ */
+static void op_rra(gb_t* gb) {
+    uint8_t carry = flag_c(&gb->cpu) ? 1 : 0;
+    uint8_t bit0 = gb->cpu.A & 0x01;
+    gb->cpu.A = (gb->cpu.A >> 1) | (carry << 7);
+
+    // Flags
+    flags_store(&gb->cpu, bit0 ? FLAG_C : 0);
+}
+
+
+/* JUMPS (van halen moment)*/
+
+/**
+ * 1. JP, nn
+ * jump to address nn
+ */
+static void op_jp_a16(gb_t* gb) { gb->cpu.PC = fetch_d16(gb); }
+
+/**
+ * 2. JP cc, nn
  *
- * @return  bool    
- * returns true if CB opcode is succesfully executed
- * returns false otherwise
+ * jump to address n if following conditions are true:
+ * cc = NZ, jump if Z flag is reset
+ * cc = Z, jump if Z flag is set
+ * cc = NC, jump if C flag is reset
+ * cc = C, jump if C flag is set
  */
-bool execute_cb_opcode(uint8_t opcode) {
-    /*  Set Z if bit is clear
-        Clear N
-        Set H
-        Preserve C
-        According to gameboy spec BIT instructions
-    */
-
-    
-    // array to auto generate the 64 BIT b,r instructions
-    // Indexes 0-7 correspond to: B, C, D, E, H, L, (HL), A
-    uint8_t* const regs[] = {
-        &cpu.B, &cpu.C, &cpu.D, &cpu.E, &cpu.H, &cpu.L, NULL, &cpu.A 
-    };
-
-    // switch case for each CB-prefixed opcodes
-    switch(opcode) {
-        /**
-         * 1. SWAP n
-         * swap upper and lower nibles of n
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Reset
-         */
-
-        case 0x37: cpu.A = SWAP(cpu.A); break;      // SWAP A
-        case 0x30: cpu.B = SWAP(cpu.B); break;      // SWAP B
-        case 0x31: cpu.C = SWAP(cpu.C); break;      // SWAP C
-        case 0x32: cpu.D = SWAP(cpu.D); break;      // SWAP D
-        case 0x33: cpu.E = SWAP(cpu.E); break;      // SWAP E
-        case 0x34: cpu.H = SWAP(cpu.H); break;      // SWAP H
-        case 0x35: cpu.L = SWAP(cpu.L); break;      // SWAP L
-
-        // SWAP (HL)
-        case 0x36: {
-            uint8_t val = mmu_read(REG_HL);
-            uint8_t swap = SWAP(val);
-
-            mmu_write(REG_HL, swap);
-            break;
-        }
+static void op_jp_nz_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    if (!flag_z(&gb->cpu)) {
+        gb->cpu.PC = addr;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        /**
-         * RLC n
-         * rotate n left. old bit 7 to carry flag
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 7 data.
-         */
-
-
-        // RLC A 
-        case 0x07: { 
-            bool carry;
-            cpu.A = RLC(cpu.A, &carry);
-            cpu.F = 0;
-
-            // dont set the Z flag for A case
-            if (carry)    cpu.F |= FLAG_C;
-            break;
-        }
+static void op_jp_z_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    if (flag_z(&gb->cpu)) {
+        gb->cpu.PC = addr;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        // RLC B
-        case 0x00: { 
-            bool carry;
-            cpu.B = RLC(cpu.B, &carry);
-            cpu.F = 0;
+static void op_jp_nc_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    if (!flag_c(&gb->cpu)) {
+        gb->cpu.PC = addr;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-            if (cpu.B == 0) cpu.F |= FLAG_Z;
-            if (carry)    cpu.F |= FLAG_C;
-            break;
-        }
+static void op_jp_c_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    if (flag_c(&gb->cpu)) {
+        gb->cpu.PC = addr;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        // RLC C
-        case 0x01: { 
-            bool carry;
-            cpu.C = RLC(cpu.C, &carry);
-            cpu.F = 0;
+/**
+ * 3. JP HL
+ * jump to address contained in HL 16-bit register
+ */
+static void op_jp_hl(gb_t* gb) { gb->cpu.PC = REG_HL; }
 
-            if (cpu.C == 0) cpu.F |= FLAG_Z;
-            if (carry)    cpu.F |= FLAG_C;
-            break;
-        }
+/**
+ * 4. JR n
+ * add n to current address and jump to it
+ *
+ * use with:
+ * n = one byte signed immediate value
+ */
+static void op_jr_e8(gb_t* gb) { int8_t offset = (int8_t)fetch_d8(gb); gb->cpu.PC += offset; }
 
-        // RLC D
-        case 0x02: { 
-            bool carry;
-            cpu.D = RLC(cpu.D, &carry);
-            cpu.F = 0;
+/**
+ * 5. JR cc, n
+ * if following condition is true, then add n to current address and jump to it
+ */
+static void op_jr_nz_e8(gb_t* gb) {
+    int8_t offset = (int8_t)fetch_d8(gb);
+    if (!flag_z(&gb->cpu)) {
+        gb->cpu.PC += offset;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-            if (cpu.D == 0) cpu.F |= FLAG_Z;
-            if (carry)    cpu.F |= FLAG_C;
-            break;
-        }
+static void op_jr_z_e8(gb_t* gb) {
+    int8_t offset = (int8_t)fetch_d8(gb);
+    if (flag_z(&gb->cpu)) {
+        gb->cpu.PC += offset;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        // RLC E
-        case 0x03: { 
-            bool carry;
-            cpu.E = RLC(cpu.E, &carry);
-            cpu.F = 0;
+static void op_jr_nc_e8(gb_t* gb) {
+    int8_t offset = (int8_t)fetch_d8(gb);
+    if (!flag_c(&gb->cpu)) {
+        gb->cpu.PC += offset;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-            if (cpu.E == 0) cpu.F |= FLAG_Z;
-            if (carry)    cpu.F |= FLAG_C;
-            break;
-        }
+static void op_jr_c_e8(gb_t* gb) {
+    int8_t offset = (int8_t)fetch_d8(gb);
+    if (flag_c(&gb->cpu)) {
+        gb->cpu.PC += offset;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        // RLC H
-        case 0x04: {
-            bool carry;
-            cpu.H = RLC(cpu.H, &carry);
-            cpu.F = 0;
 
-            if (cpu.H == 0) cpu.F |= FLAG_Z;
-            if (carry)    cpu.F |= FLAG_C;
-            break;
-        }
+/* CALLS */
 
-        // RLC L
-        case 0x05: { 
-            bool carry;
-            cpu.L = RLC(cpu.L, &carry);
-            cpu.F = 0;
+/**
+ * 1. CALL nn
+ * puts address of next instruction onto stack and then jumps to address nn
+ */
+static void op_call_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    push16(gb, gb->cpu.PC);
+    gb->cpu.PC = addr;
+}
 
-            if (cpu.L == 0) cpu.F |= FLAG_Z;
-            if (carry)    cpu.F |= FLAG_C;
-            break;
-        }
+/**
+ * 2. CALL cc, nn
+ * call addr n if following conditions are true:
+    cc = NZ, Call if Z flag is reset.
+    cc = Z, Call if Z flag is set.
+    cc = NC, Call if C flag is reset.
+    cc = C, Call if C flag is set.
+ */
+static void op_call_nz_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    if (!flag_z(&gb->cpu)) {
+        push16(gb, gb->cpu.PC);
+        gb->cpu.PC = addr;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        // RLC (HL)
-        case 0x06: { 
-            bool carry;
-            uint8_t val = mmu_read(REG_HL);
-            uint8_t result = RLC(val, &carry);
-            mmu_write(REG_HL, result);
-            cpu.F = 0;
-
-            if (result == 0) cpu.F |= FLAG_Z;
-            if (carry)      cpu.F |= FLAG_C;
-            break;
-        }
+static void op_call_z_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    if (flag_z(&gb->cpu)) {
+        push16(gb, gb->cpu.PC);
+        gb->cpu.PC = addr;
+        gb->cpu.branch_taken = true;
+    }
+}
 
+static void op_call_nc_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    if (!flag_c(&gb->cpu)) {
+        push16(gb, gb->cpu.PC);
+        gb->cpu.PC = addr;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        /**
-         * 6. RL n 
-         * rotate n left through carry flag 
-         * 
-         * use with:
-         *  n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 7 data.
-         */
-
-        // RL B
-        case 0x10: {
-            bool carry_out;
-            cpu.B = RL(cpu.B, (cpu.F & FLAG_C), &carry_out);
-            cpu.F = 0;
-            if (cpu.B == 0) cpu.F |= FLAG_Z;
-            if (carry_out)  cpu.F |= FLAG_C;
-            break;
-        }
+static void op_call_c_a16(gb_t* gb) {
+    uint16_t addr = fetch_d16(gb);
+    if (flag_c(&gb->cpu)) {
+        push16(gb, gb->cpu.PC);
+        gb->cpu.PC = addr;
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        // RL C
-        case 0x11: {
-            bool carry_out;
-            cpu.C = RL(cpu.C, (cpu.F & FLAG_C), &carry_out);
-            cpu.F = 0;
-            if (cpu.C == 0) cpu.F |= FLAG_Z;
-            if (carry_out)  cpu.F |= FLAG_C;
-            break;
-        }
+/**
+ * 3.3.10 RESTARTS
+ *
+ * 1. RST n
+ * push present address onto stack
+ * jump to address $0000 + n
+ */
+static void op_rst_00(gb_t* gb) { push16(gb, gb->cpu.PC); gb->cpu.PC = 0x00; }     // RST 00H
+static void op_rst_08(gb_t* gb) { push16(gb, gb->cpu.PC); gb->cpu.PC = 0x08; }     // RST 08H
+static void op_rst_10(gb_t* gb) { push16(gb, gb->cpu.PC); gb->cpu.PC = 0x10; }     // RST 10H
+static void op_rst_18(gb_t* gb) { push16(gb, gb->cpu.PC); gb->cpu.PC = 0x18; }     // RST 18H
+static void op_rst_20(gb_t* gb) { push16(gb, gb->cpu.PC); gb->cpu.PC = 0x20; }     // RST 20H
+static void op_rst_28(gb_t* gb) { push16(gb, gb->cpu.PC); gb->cpu.PC = 0x28; }     // RST 28H
+static void op_rst_30(gb_t* gb) { push16(gb, gb->cpu.PC); gb->cpu.PC = 0x30; }     // RST 30H
+static void op_rst_38(gb_t* gb) { push16(gb, gb->cpu.PC); gb->cpu.PC = 0x38; }     // RST 38H
 
-        // RL D
-        case 0x12: {
-            bool carry_out;
-            cpu.D = RL(cpu.D, (cpu.F & FLAG_C), &carry_out);
-            cpu.F = 0;
-            if (cpu.D == 0) cpu.F |= FLAG_Z;
-            if (carry_out)  cpu.F |= FLAG_C;
-            break;
-        }
 
-        // RL E
-        case 0x13: {
-            bool carry_out;
-            cpu.E = RL(cpu.E, (cpu.F & FLAG_C), &carry_out);
-            cpu.F = 0;
-            if (cpu.E == 0) cpu.F |= FLAG_Z;
-            if (carry_out)  cpu.F |= FLAG_C;
-            break;
-        }
+/* RETURNS */
 
-        // RL H
-        case 0x14: {
-            bool carry_out;
-            cpu.H = RL(cpu.H, (cpu.F & FLAG_C), &carry_out);
-            cpu.F = 0;
-            if (cpu.H == 0) cpu.F |= FLAG_Z;
-            if (carry_out)  cpu.F |= FLAG_C;
-            break;
-        }
+/**
+ * 1 RET
+ * pop two bytes from stack and jump to that address
+ */
+static void op_ret(gb_t* gb) { gb->cpu.PC = pop16(gb); }
 
-        // RL L
-        case 0x15: {
-            bool carry_out;
-            cpu.L = RL(cpu.L, (cpu.F & FLAG_C), &carry_out);
-            cpu.F = 0;
-            if (cpu.L == 0) cpu.F |= FLAG_Z;
-            if (carry_out)  cpu.F |= FLAG_C;
-            break;
-        }
+/**
+ * 2. RET cc
+ * return if the conditions are true:
+    cc = NZ, Return if Z flag is reset.
+    cc = Z, Return if Z flag is set.
+    cc = NC, Return if C flag is reset.
+    cc = C, Return if C flag is set.
+ */
+static void op_ret_nz(gb_t* gb) {
+    if (!flag_z(&gb->cpu)) {
+        gb->cpu.PC = pop16(gb);
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        // RL (HL)
-        case 0x16: {
-            uint8_t val = mmu_read(REG_HL);
-            bool carry_out;
-            uint8_t result = RL(val, (cpu.F & FLAG_C), &carry_out);
-            mmu_write(REG_HL, result);
-            cpu.F = 0;
-            if (result == 0) cpu.F |= FLAG_Z;
-            if (carry_out)  cpu.F |= FLAG_C;
-            break;
-        }
+static void op_ret_z(gb_t* gb) {
+    if (flag_z(&gb->cpu)) {
+        gb->cpu.PC = pop16(gb);
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        // RL A
-        case 0x17: {
-            bool carry_out;
-            cpu.A = RL(cpu.A, (cpu.F & FLAG_C), &carry_out);
-            cpu.F = 0;
-            // Z flag is not set for RL A
-            if (carry_out)  cpu.F |= FLAG_C;
-            break;
-        }
+static void op_ret_nc(gb_t* gb) {
+    if (!flag_c(&gb->cpu)) {
+        gb->cpu.PC = pop16(gb);
+        gb->cpu.branch_taken = true;
+    }
+}
 
-        /** 
-         * 7. RRC n
-         * rotate n right 
-         * old bit 0 to carry flag
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 0 data.
-         */
-        case 0x08: cpu.B = RRC(cpu.B); break;    // RRC B
-        case 0x09: cpu.C = RRC(cpu.C); break;    // RRC C 
-        case 0x0A: cpu.D = RRC(cpu.D); break;    // RRC D
-        case 0x0B: cpu.E = RRC(cpu.E); break;    // RRC E
-        case 0x0C: cpu.H = RRC(cpu.H); break;    // RRC H
-        case 0x0D: cpu.L = RRC(cpu.L); break;    // RRC L
-        
-        // RRC (HL)
-        case 0x0E: {
-            uint16_t addr = REG_HL;
-            uint8_t val = mmu_read(addr);
-            mmu_write(addr, RRC(val));
-            return 16;
-        }
-        case 0x0F: cpu.A = RRC(cpu.A); break;   // RRC A
-        
-
-
-        /**
-         * 8. RR n
-         * rotate n right through carry flag
-         * 
-         * use with:
-         *  n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 0 data.
-         */
-        case 0x18: cpu.B = RR(cpu.B); break;    // RR B
-        case 0x19: cpu.C = RR(cpu.C); break;    // RR C
-        case 0x1A: cpu.D = RR(cpu.D); break;    // RR D
-        case 0x1B: cpu.E = RR(cpu.E); break;    // RR E
-        case 0x1C: cpu.H = RR(cpu.H); break;    // RR H
-        case 0x1D: cpu.L = RR(cpu.L); break;    // RR L
-        
-        // RR (HL)
-        case 0x1E: {
-            uint16_t addr = REG_HL;
-            uint8_t val = mmu_read(addr);
-            mmu_write(addr, RR(val));
-            return 16;
-        }
-        case 0x1F: cpu.A = RR(cpu.A); break;    // RR A
-
-
-        /**
-         * 9. SLA n
-         * shift n left  into carry . Least significant Bit of n set to 0
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 7 data.
-         */
-        case 0x20: SLA(&cpu.B); break;  // SLA B
-        case 0x21: SLA(&cpu.C); break;  // SLA C
-        case 0x22: SLA(&cpu.D); break;  // SLA D
-        case 0x23: SLA(&cpu.E); break;  // SLA E
-        case 0x24: SLA(&cpu.H); break;  // SLA H
-        case 0x25: SLA(&cpu.L); break;   // SLA L
-        // SLA (HL)
-        case 0x26: {
-            uint8_t val = mmu_read(REG_HL);
-            SLA(&val);
-            mmu_write(REG_HL, val);
-            break;
-        }
-        case 0x27: SLA(&cpu.A); break;   // SLA A
-
-        
-
-        /**
-         * 10. SRA n
-         * shift n right into carry. most significant bit  doesnt change
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 0 data. 
-         */
-        case 0x28: SRA(&cpu.B); break;  // SRA B
-        case 0x29: SRA(&cpu.C); break;  // SRA C
-        case 0x2A: SRA(&cpu.D); break;  // SRA D
-        case 0x2B: SRA(&cpu.E); break;  // SRA E
-        case 0x2C: SRA(&cpu.H); break;  // SRA H
-        case 0x2D: SRA(&cpu.L); break;  // SRA L
-          // SRA (HL)
-        case 0x2E: {
-            uint8_t val = mmu_read(REG_HL);
-            SRA(&val);
-            mmu_write(REG_HL, val);
-            break;
-        }
-        case 0x2F: SRA(&cpu.A); break;  // SRA A
-
-
-        /**
-         * 11. SRL n
-         * shift n right into carry. MSB (most significant bit) set to 0
-         * 
-         * use with:
-         * n = A,B,C,D,E,H,L,(HL)
-         * 
-         * flags affected:
-            Z - Set if result is zero.
-            N - Reset.
-            H - Reset.
-            C - Contains old bit 0 data.
-         */
-        case 0x38: SRL(&cpu.B); break;  // SRL B
-        case 0x39: SRL(&cpu.C); break;  // SRL C
-        case 0x3A: SRL(&cpu.D); break;  // SRL D
-        case 0x3B: SRL(&cpu.E); break;  // SRL E
-        case 0x3C: SRL(&cpu.H); break;  // SRL H
-        case 0x3D: SRL(&cpu.L); break;  // SRL L
-          // SRL (HL)
-        case 0x3E: {
-            uint8_t val = mmu_read(REG_HL);
-            SRL(&val);
-            mmu_write(REG_HL, val);
-            break;
-        }
-        case 0x3F: SRL(&cpu.A); break;  // SRL A
-
-
-        /* 3.3.7 BIT OPCODES */
-
-        /**
-         * 1. BIT b, r
-         * test bit b in register r
-         * 
-         * use with:
-         *  b = 0 - 7, r = A,B,C,D,E,H,L,(HL)
-         * 
-         * Flags affected:
-            Z - Set if bit b of register r is 0.
-            N - Reset.
-            H - Set.
-            C - Not affected.
-         */
-
-        // table for auto-generating all 64opcodes for BIT
-        // CB opcodes from 0xC0 to 0x7F
-        case 0x40 ... 0x7F: {
-            uint8_t bit = (opcode >> 3) & 0x07;     //extracted bit number
-            uint8_t index = opcode & 0x07;     // extracted register index
-
-            // register (HL) case
-            if (index == 6) {
-                uint8_t val = mmu_read(REG_HL);
-                BIT(val, bit);
-            } else {
-                // BIT b, r (registers B, C, D, E, H, L, A)
-                BIT(*regs[index], bit);
-            }
-            break;
-        }
+static void op_ret_c(gb_t* gb) {
+    if (flag_c(&gb->cpu)) {
+        gb->cpu.PC = pop16(gb);
+        gb->cpu.branch_taken = true;
+    }
+}
+
+/**
+ * 3. RETI
+ * pop two bytes from stack and jump to that address then enable interrupts
+ */
+static void op_reti(gb_t* gb) {
+    gb->cpu.PC = pop16(gb);
+    gb->cpu.ime = true; // enable ime immediately without delay
+}
 
 
-        /**
-         * 2. SET b, r
-         * SETs bit b in register R
-         * 
-         * use with:
-         *  b = 0 - 7, r = A,B,C,D,E,H,L,(HL)
-         * 
-         * flags affected: none
-         */
-
-        // table for auto generating all of the bitcodes for SET
-        // CB opcodes 0xC0 to 0xFF
-        case 0xC0 ... 0xFF: {
-            uint8_t bit = (opcode >> 3) & 0x07; //extract bit index (b)
-            uint8_t index = opcode & 0x07; // extract register index (r)
-
-            // register (HL)case
-            if (index == 6) {
-                uint8_t val = mmu_read(REG_HL);
-                SET(&val, bit); // SET bit "bit" in val
-                mmu_write(REG_HL, val); // write it back
-            } else {
-                // register case
-                SET((uint8_t*)regs[index], bit); // typecast away const
-            }
-            break;
-        }
+// ==========================================================================
+// CB-PREFIXED OPCODE HANDLERS
+// ==========================================================================
 
+/**
+ * 1. SWAP n
+ * swap upper and lower nibles of n
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL)
+ */
+static void cb_swap_a(gb_t* gb) { gb->cpu.A = SWAP(gb, gb->cpu.A); }                          // SWAP A
+static void cb_swap_b(gb_t* gb) { gb->cpu.B = SWAP(gb, gb->cpu.B); }                          // SWAP B
+static void cb_swap_c(gb_t* gb) { gb->cpu.C = SWAP(gb, gb->cpu.C); }                          // SWAP C
+static void cb_swap_d(gb_t* gb) { gb->cpu.D = SWAP(gb, gb->cpu.D); }                          // SWAP D
+static void cb_swap_e(gb_t* gb) { gb->cpu.E = SWAP(gb, gb->cpu.E); }                          // SWAP E
+static void cb_swap_h(gb_t* gb) { gb->cpu.H = SWAP(gb, gb->cpu.H); }                          // SWAP H
+static void cb_swap_l(gb_t* gb) { gb->cpu.L = SWAP(gb, gb->cpu.L); }                          // SWAP L
+static void cb_swap_hl(gb_t* gb) { mmu_write(gb, REG_HL, SWAP(gb, mmu_read(gb, REG_HL))); }   // SWAP (HL)
 
-        /**
-         * 3. RES b, r
-         * reset bit b in register r
-         * 
-         * use with:
-         * b = 0 - 7, r = A,B,C,D,E,H,L,(HL)
-         * 
-         * flags affected: none
-         */
-        // table to auto generate the CB-prefixed opcodes
-        // CB opcodes: 0x80 to 0xBF
-        case 0x80 ... 0xBF: {
-            uint8_t bit = (opcode >> 3) & 0x07;     //extract bit index (b)
-            uint8_t index = opcode & 0x07;          // extract register index (r) 
-        
-            // register (HL) case
-            if (index == 6) {
-                uint8_t val = mmu_read(REG_HL);
-                RES(&val, bit);     // clear bit 'bit' in val
-                mmu_write(REG_HL, val); // write it back
-            } else {
-                // register case
-                RES((uint8_t*)regs[index], bit);    //cast away const
-            }
-            break;
-        }
+/**
+ * RLC n
+ * rotate n left. old bit 7 to carry flag
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL)
+ */
+#define DEFINE_CB_RLC(name, reg)                                                 \
+    static void name(gb_t* gb) {                                                 \
+        bool carry;                                                              \
+        gb->cpu.reg = RLC(gb->cpu.reg, &carry);                                  \
+        flags_set(&gb->cpu, FLAGS_LOGIC, 0, carry ? FLAG_C : 0, 0, gb->cpu.reg); \
+    }
+
+DEFINE_CB_RLC(cb_rlc_b, B)
+DEFINE_CB_RLC(cb_rlc_c, C)
+DEFINE_CB_RLC(cb_rlc_d, D)
+DEFINE_CB_RLC(cb_rlc_e, E)
+DEFINE_CB_RLC(cb_rlc_h, H)
+DEFINE_CB_RLC(cb_rlc_l, L)
+
+// RLC A
+static void cb_rlc_a(gb_t* gb) {
+    bool carry;
+    gb->cpu.A = RLC(gb->cpu.A, &carry);
+
+    // dont set the Z flag for A case
+    flags_store(&gb->cpu, carry ? FLAG_C : 0);
+}
 
+// RLC (HL)
+static void cb_rlc_hl(gb_t* gb) {
+    bool carry;
+    uint8_t val = mmu_read(gb, REG_HL);
+    uint8_t result = RLC(val, &carry);
+    mmu_write(gb, REG_HL, result);
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, carry ? FLAG_C : 0, 0, result);
+}
+
+/**
+ * 6. RL n
+ * rotate n left through carry flag
+ *
+ * use with:
+ *  n = A,B,C,D,E,H,L,(HL)
+ */
+#define DEFINE_CB_RL(name, reg)                                                      \
+    static void name(gb_t* gb) {                                                     \
+        bool carry_out;                                                              \
+        gb->cpu.reg = RL(gb->cpu.reg, flag_c(&gb->cpu), &carry_out);                 \
+        flags_set(&gb->cpu, FLAGS_LOGIC, 0, carry_out ? FLAG_C : 0, 0, gb->cpu.reg); \
+    }
+
+DEFINE_CB_RL(cb_rl_b, B)
+DEFINE_CB_RL(cb_rl_c, C)
+DEFINE_CB_RL(cb_rl_d, D)
+DEFINE_CB_RL(cb_rl_e, E)
+DEFINE_CB_RL(cb_rl_h, H)
+DEFINE_CB_RL(cb_rl_l, L)
+
+// RL (HL)
+static void cb_rl_hl(gb_t* gb) {
+    uint8_t val = mmu_read(gb, REG_HL);
+    bool carry_out;
+    uint8_t result = RL(val, flag_c(&gb->cpu), &carry_out);
+    mmu_write(gb, REG_HL, result);
+    flags_set(&gb->cpu, FLAGS_LOGIC, 0, carry_out ? FLAG_C : 0, 0, result);
+}
+
+// RL A
+static void cb_rl_a(gb_t* gb) {
+    bool carry_out;
+    gb->cpu.A = RL(gb->cpu.A, flag_c(&gb->cpu), &carry_out);
+    // Z flag is not set for RL A
+    flags_store(&gb->cpu, carry_out ? FLAG_C : 0);
+}
+
+/**
+ * 7. RRC n
+ * rotate n right, old bit 0 to carry flag
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL)
+ */
+static void cb_rrc_a(gb_t* gb) { gb->cpu.A = RRC(gb, gb->cpu.A); }                                             // RRC A
+static void cb_rrc_b(gb_t* gb) { gb->cpu.B = RRC(gb, gb->cpu.B); }                                             // RRC B
+static void cb_rrc_c(gb_t* gb) { gb->cpu.C = RRC(gb, gb->cpu.C); }                                             // RRC C
+static void cb_rrc_d(gb_t* gb) { gb->cpu.D = RRC(gb, gb->cpu.D); }                                             // RRC D
+static void cb_rrc_e(gb_t* gb) { gb->cpu.E = RRC(gb, gb->cpu.E); }                                             // RRC E
+static void cb_rrc_h(gb_t* gb) { gb->cpu.H = RRC(gb, gb->cpu.H); }                                             // RRC H
+static void cb_rrc_l(gb_t* gb) { gb->cpu.L = RRC(gb, gb->cpu.L); }                                             // RRC L
+static void cb_rrc_hl(gb_t* gb) { uint16_t addr = REG_HL; mmu_write(gb, addr, RRC(gb, mmu_read(gb, addr))); }  // RRC (HL)
+
+/**
+ * 8. RR n
+ * rotate n right through carry flag
+ *
+ * use with:
+ *  n = A,B,C,D,E,H,L,(HL)
+ */
+static void cb_rr_a(gb_t* gb) { gb->cpu.A = RR(gb, gb->cpu.A); }                                               // RR A
+static void cb_rr_b(gb_t* gb) { gb->cpu.B = RR(gb, gb->cpu.B); }                                               // RR B
+static void cb_rr_c(gb_t* gb) { gb->cpu.C = RR(gb, gb->cpu.C); }                                               // RR C
+static void cb_rr_d(gb_t* gb) { gb->cpu.D = RR(gb, gb->cpu.D); }                                               // RR D
+static void cb_rr_e(gb_t* gb) { gb->cpu.E = RR(gb, gb->cpu.E); }                                               // RR E
+static void cb_rr_h(gb_t* gb) { gb->cpu.H = RR(gb, gb->cpu.H); }                                               // RR H
+static void cb_rr_l(gb_t* gb) { gb->cpu.L = RR(gb, gb->cpu.L); }                                               // RR L
+static void cb_rr_hl(gb_t* gb) { uint16_t addr = REG_HL; mmu_write(gb, addr, RR(gb, mmu_read(gb, addr))); }    // RR (HL)
+
+/**
+ * 9. SLA n
+ * shift n left into carry. Least significant Bit of n set to 0
+ *
+ * 10. SRA n
+ * shift n right into carry. most significant bit doesnt change
+ *
+ * 11. SRL n
+ * shift n right into carry. MSB (most significant bit) set to 0
+ *
+ * use with:
+ * n = A,B,C,D,E,H,L,(HL)
+ */
+#define DEFINE_CB_SHIFT(op, fn)                                                              \
+    static void cb_##op##_a(gb_t* gb) { fn(gb, &gb->cpu.A); }                                \
+    static void cb_##op##_b(gb_t* gb) { fn(gb, &gb->cpu.B); }                                \
+    static void cb_##op##_c(gb_t* gb) { fn(gb, &gb->cpu.C); }                                \
+    static void cb_##op##_d(gb_t* gb) { fn(gb, &gb->cpu.D); }                                \
+    static void cb_##op##_e(gb_t* gb) { fn(gb, &gb->cpu.E); }                                \
+    static void cb_##op##_h(gb_t* gb) { fn(gb, &gb->cpu.H); }                                \
+    static void cb_##op##_l(gb_t* gb) { fn(gb, &gb->cpu.L); }                                \
+    static void cb_##op##_hl(gb_t* gb) {                                                     \
+        uint8_t val = mmu_read(gb, REG_HL);                                                  \
+        fn(gb, &val);                                                                        \
+        mmu_write(gb, REG_HL, val);                                                          \
+    }
+
+DEFINE_CB_SHIFT(sla, SLA)
+DEFINE_CB_SHIFT(sra, SRA)
+DEFINE_CB_SHIFT(srl, SRL)
 
 
-        default: 
-            printf("[CB] Unimplemented opcode: 0x%02X\n", opcode);
-            cpu.halted = true;
-            return false;
+/* 3.3.7 BIT OPCODES */
+
+/**
+ * 1. BIT b, r - test bit b in register r
+ * 2. SET b, r - SETs bit b in register r
+ * 3. RES b, r - reset bit b in register r
+ *
+ * use with:
+ *  b = 0 - 7, r = A,B,C,D,E,H,L,(HL)
+ *
+ * One handler per (bit, register) pair, so the bit index and the register
+ * are compile time constants instead of being decoded from the opcode
+ */
+#define DEFINE_CB_BIT_OPS(n)                                                                \
+    static void cb_bit_##n##_a(gb_t* gb) { BIT(gb, gb->cpu.A, n); }                         \
+    static void cb_bit_##n##_b(gb_t* gb) { BIT(gb, gb->cpu.B, n); }                         \
+    static void cb_bit_##n##_c(gb_t* gb) { BIT(gb, gb->cpu.C, n); }                         \
+    static void cb_bit_##n##_d(gb_t* gb) { BIT(gb, gb->cpu.D, n); }                         \
+    static void cb_bit_##n##_e(gb_t* gb) { BIT(gb, gb->cpu.E, n); }                         \
+    static void cb_bit_##n##_h(gb_t* gb) { BIT(gb, gb->cpu.H, n); }                         \
+    static void cb_bit_##n##_l(gb_t* gb) { BIT(gb, gb->cpu.L, n); }                         \
+    static void cb_bit_##n##_hl(gb_t* gb) { BIT(gb, mmu_read(gb, REG_HL), n); }             \
+    static void cb_res_##n##_a(gb_t* gb) { RES(&gb->cpu.A, n); }                            \
+    static void cb_res_##n##_b(gb_t* gb) { RES(&gb->cpu.B, n); }                            \
+    static void cb_res_##n##_c(gb_t* gb) { RES(&gb->cpu.C, n); }                            \
+    static void cb_res_##n##_d(gb_t* gb) { RES(&gb->cpu.D, n); }                            \
+    static void cb_res_##n##_e(gb_t* gb) { RES(&gb->cpu.E, n); }                            \
+    static void cb_res_##n##_h(gb_t* gb) { RES(&gb->cpu.H, n); }                            \
+    static void cb_res_##n##_l(gb_t* gb) { RES(&gb->cpu.L, n); }                            \
+    static void cb_res_##n##_hl(gb_t* gb) {                                                 \
+        uint8_t val = mmu_read(gb, REG_HL);                                                 \
+        RES(&val, n);                                                                       \
+        mmu_write(gb, REG_HL, val);                                                         \
+    }                                                                                       \
+    static void cb_set_##n##_a(gb_t* gb) { SET(&gb->cpu.A, n); }                            \
+    static void cb_set_##n##_b(gb_t* gb) { SET(&gb->cpu.B, n); }                            \
+    static void cb_set_##n##_c(gb_t* gb) { SET(&gb->cpu.C, n); }                            \
+    static void cb_set_##n##_d(gb_t* gb) { SET(&gb->cpu.D, n); }                            \
+    static void cb_set_##n##_e(gb_t* gb) { SET(&gb->cpu.E, n); }                            \
+    static void cb_set_##n##_h(gb_t* gb) { SET(&gb->cpu.H, n); }                            \
+    static void cb_set_##n##_l(gb_t* gb) { SET(&gb->cpu.L, n); }                            \
+    static void cb_set_##n##_hl(gb_t* gb) {                                                 \
+        uint8_t val = mmu_read(gb, REG_HL);                                                 \
+        SET(&val, n);                                                                       \
+        mmu_write(gb, REG_HL, val);                                                         \
     }
-    return true;
-}
\ No newline at end of file
+
+DEFINE_CB_BIT_OPS(0)
+DEFINE_CB_BIT_OPS(1)
+DEFINE_CB_BIT_OPS(2)
+DEFINE_CB_BIT_OPS(3)
+DEFINE_CB_BIT_OPS(4)
+DEFINE_CB_BIT_OPS(5)
+DEFINE_CB_BIT_OPS(6)
+DEFINE_CB_BIT_OPS(7)
+
+
+// ==========================================================================
+// OPCODE MAPS
+// ==========================================================================
+
+/**
+ * X-macro maps from opcode to handler.
+ *
+ * X(opcode, handler) is expanded once per opcode, in opcode order,
+ * to build the handler tables and the computed-goto label tables.
+ */
+#define BASE_OPCODE_MAP(X)                                                                          \
+    X(0x00, op_nop)         X(0x01, op_ld_bc_d16)   X(0x02, op_ld_bc_a)     X(0x03, op_inc_bc)      \
+    X(0x04, op_inc_b)       X(0x05, op_dec_b)       X(0x06, op_ld_b_d8)     X(0x07, op_rlca)        \
+    X(0x08, op_ld_a16_sp)   X(0x09, op_add_hl_bc)   X(0x0A, op_ld_a_bc)     X(0x0B, op_dec_bc)      \
+    X(0x0C, op_inc_c)       X(0x0D, op_dec_c)       X(0x0E, op_ld_c_d8)     X(0x0F, op_rrca)        \
+    X(0x10, op_stop)        X(0x11, op_ld_de_d16)   X(0x12, op_ld_de_a)     X(0x13, op_inc_de)      \
+    X(0x14, op_inc_d)       X(0x15, op_dec_d)       X(0x16, op_ld_d_d8)     X(0x17, op_rla)         \
+    X(0x18, op_jr_e8)       X(0x19, op_add_hl_de)   X(0x1A, op_ld_a_de)     X(0x1B, op_dec_de)      \
+    X(0x1C, op_inc_e)       X(0x1D, op_dec_e)       X(0x1E, op_ld_e_d8)     X(0x1F, op_rra)         \
+    X(0x20, op_jr_nz_e8)    X(0x21, op_ld_hl_d16)   X(0x22, op_ldi_hl_a)    X(0x23, op_inc_hl)      \
+    X(0x24, op_inc_h)       X(0x25, op_dec_h)       X(0x26, op_ld_h_d8)     X(0x27, op_daa)         \
+    X(0x28, op_jr_z_e8)     X(0x29, op_add_hl_hl)   X(0x2A, op_ldi_a_hl)    X(0x2B, op_dec_hl)      \
+    X(0x2C, op_inc_l)       X(0x2D, op_dec_l)       X(0x2E, op_ld_l_d8)     X(0x2F, op_cpl)         \
+    X(0x30, op_jr_nc_e8)    X(0x31, op_ld_sp_d16)   X(0x32, op_ldd_hl_a)    X(0x33, op_inc_sp)      \
+    X(0x34, op_inc_hlp)     X(0x35, op_dec_hlp)     X(0x36, op_ld_hl_d8)    X(0x37, op_scf)         \
+    X(0x38, op_jr_c_e8)     X(0x39, op_add_hl_sp)   X(0x3A, op_ldd_a_hl)    X(0x3B, op_dec_sp)      \
+    X(0x3C, op_inc_a)       X(0x3D, op_dec_a)       X(0x3E, op_ld_a_d8)     X(0x3F, op_ccf)         \
+    X(0x40, op_nop)         X(0x41, op_ld_b_c)      X(0x42, op_ld_b_d)      X(0x43, op_ld_b_e)      \
+    X(0x44, op_ld_b_h)      X(0x45, op_ld_b_l)      X(0x46, op_ld_b_hl)     X(0x47, op_ld_b_a)      \
+    X(0x48, op_ld_c_b)      X(0x49, op_nop)         X(0x4A, op_ld_c_d)      X(0x4B, op_ld_c_e)      \
+    X(0x4C, op_ld_c_h)      X(0x4D, op_ld_c_l)      X(0x4E, op_ld_c_hl)     X(0x4F, op_ld_c_a)      \
+    X(0x50, op_ld_d_b)      X(0x51, op_ld_d_c)      X(0x52, op_nop)         X(0x53, op_ld_d_e)      \
+    X(0x54, op_ld_d_h)      X(0x55, op_ld_d_l)      X(0x56, op_ld_d_hl)     X(0x57, op_ld_d_a)      \
+    X(0x58, op_ld_e_b)      X(0x59, op_ld_e_c)      X(0x5A, op_ld_e_d)      X(0x5B, op_nop)         \
+    X(0x5C, op_ld_e_h)      X(0x5D, op_ld_e_l)      X(0x5E, op_ld_e_hl)     X(0x5F, op_ld_e_a)      \
+    X(0x60, op_ld_h_b)      X(0x61, op_ld_h_c)      X(0x62, op_ld_h_d)      X(0x63, op_ld_h_e)      \
+    X(0x64, op_nop)         X(0x65, op_ld_h_l)      X(0x66, op_ld_h_hl)     X(0x67, op_ld_h_a)      \
+    X(0x68, op_ld_l_b)      X(0x69, op_ld_l_c)      X(0x6A, op_ld_l_d)      X(0x6B, op_ld_l_e)      \
+    X(0x6C, op_ld_l_h)      X(0x6D, op_nop)         X(0x6E, op_ld_l_hl)     X(0x6F, op_ld_l_a)      \
+    X(0x70, op_ld_hl_b)     X(0x71, op_ld_hl_c)     X(0x72, op_ld_hl_d)     X(0x73, op_ld_hl_e)     \
+    X(0x74, op_ld_hl_h)     X(0x75, op_ld_hl_l)     X(0x76, op_halt)        X(0x77, op_ld_hl_a)     \
+    X(0x78, op_ld_a_b)      X(0x79, op_ld_a_c)      X(0x7A, op_ld_a_d)      X(0x7B, op_ld_a_e)      \
+    X(0x7C, op_ld_a_h)      X(0x7D, op_ld_a_l)      X(0x7E, op_ld_a_hl)     X(0x7F, op_nop)         \
+    X(0x80, op_add_a_b)     X(0x81, op_add_a_c)     X(0x82, op_add_a_d)     X(0x83, op_add_a_e)     \
+    X(0x84, op_add_a_h)     X(0x85, op_add_a_l)     X(0x86, op_add_a_hl)    X(0x87, op_add_a_a)     \
+    X(0x88, op_adc_a_b)     X(0x89, op_adc_a_c)     X(0x8A, op_adc_a_d)     X(0x8B, op_adc_a_e)     \
+    X(0x8C, op_adc_a_h)     X(0x8D, op_adc_a_l)     X(0x8E, op_adc_a_hl)    X(0x8F, op_adc_a_a)     \
+    X(0x90, op_sub_b)       X(0x91, op_sub_c)       X(0x92, op_sub_d)       X(0x93, op_sub_e)       \
+    X(0x94, op_sub_h)       X(0x95, op_sub_l)       X(0x96, op_sub_hl)      X(0x97, op_sub_a)       \
+    X(0x98, op_sbc_a_b)     X(0x99, op_sbc_a_c)     X(0x9A, op_sbc_a_d)     X(0x9B, op_sbc_a_e)     \
+    X(0x9C, op_sbc_a_h)     X(0x9D, op_sbc_a_l)     X(0x9E, op_sbc_a_hl)    X(0x9F, op_sbc_a_a)     \
+    X(0xA0, op_and_b)       X(0xA1, op_and_c)       X(0xA2, op_and_d)       X(0xA3, op_and_e)       \
+    X(0xA4, op_and_h)       X(0xA5, op_and_l)       X(0xA6, op_and_hl)      X(0xA7, op_and_a)       \
+    X(0xA8, op_xor_b)       X(0xA9, op_xor_c)       X(0xAA, op_xor_d)       X(0xAB, op_xor_e)       \
+    X(0xAC, op_xor_h)       X(0xAD, op_xor_l)       X(0xAE, op_xor_hl)      X(0xAF, op_xor_a)       \
+    X(0xB0, op_or_b)        X(0xB1, op_or_c)        X(0xB2, op_or_d)        X(0xB3, op_or_e)        \
+    X(0xB4, op_or_h)        X(0xB5, op_or_l)        X(0xB6, op_or_hl)       X(0xB7, op_or_a)        \
+    X(0xB8, op_cp_b)        X(0xB9, op_cp_c)        X(0xBA, op_cp_d)        X(0xBB, op_cp_e)        \
+    X(0xBC, op_cp_h)        X(0xBD, op_cp_l)        X(0xBE, op_cp_hl)       X(0xBF, op_cp_a)        \
+    X(0xC0, op_ret_nz)      X(0xC1, op_pop_bc)      X(0xC2, op_jp_nz_a16)   X(0xC3, op_jp_a16)      \
+    X(0xC4, op_call_nz_a16) X(0xC5, op_push_bc)     X(0xC6, op_add_a_d8)    X(0xC7, op_rst_00)      \
+    X(0xC8, op_ret_z)       X(0xC9, op_ret)         X(0xCA, op_jp_z_a16)    X(0xCB, op_illegal)     \
+    X(0xCC, op_call_z_a16)  X(0xCD, op_call_a16)    X(0xCE, op_adc_a_d8)    X(0xCF, op_rst_08)      \
+    X(0xD0, op_ret_nc)      X(0xD1, op_pop_de)      X(0xD2, op_jp_nc_a16)   X(0xD3, op_illegal)     \
+    X(0xD4, op_call_nc_a16) X(0xD5, op_push_de)     X(0xD6, op_sub_d8)      X(0xD7, op_rst_10)      \
+    X(0xD8, op_ret_c)       X(0xD9, op_reti)        X(0xDA, op_jp_c_a16)    X(0xDB, op_illegal)     \
+    X(0xDC, op_call_c_a16)  X(0xDD, op_illegal)     X(0xDE, op_sbc_a_d8)    X(0xDF, op_rst_18)      \
+    X(0xE0, op_ldh_a8_a)    X(0xE1, op_pop_hl)      X(0xE2, op_ld_ioc_a)    X(0xE3, op_illegal)     \
+    X(0xE4, op_illegal)     X(0xE5, op_push_hl)     X(0xE6, op_and_d8)      X(0xE7, op_rst_20)      \
+    X(0xE8, op_add_sp_e8)   X(0xE9, op_jp_hl)       X(0xEA, op_ld_a16_a)    X(0xEB, op_illegal)     \
+    X(0xEC, op_illegal)     X(0xED, op_illegal)     X(0xEE, op_xor_d8)      X(0xEF, op_rst_28)      \
+    X(0xF0, op_ldh_a_a8)    X(0xF1, op_pop_af)      X(0xF2, op_ld_a_ioc)    X(0xF3, op_di)          \
+    X(0xF4, op_illegal)     X(0xF5, op_push_af)     X(0xF6, op_or_d8)       X(0xF7, op_rst_30)      \
+    X(0xF8, op_ld_hl_sp_e8) X(0xF9, op_ld_sp_hl)    X(0xFA, op_ld_a_a16)    X(0xFB, op_ei)          \
+    X(0xFC, op_illegal)     X(0xFD, op_illegal)     X(0xFE, op_cp_d8)       X(0xFF, op_rst_38)
+
+#define CB_OPCODE_MAP(X)                                                                            \
+    X(0x00, cb_rlc_b)    X(0x01, cb_rlc_c)    X(0x02, cb_rlc_d)    X(0x03, cb_rlc_e)                \
+    X(0x04, cb_rlc_h)    X(0x05, cb_rlc_l)    X(0x06, cb_rlc_hl)   X(0x07, cb_rlc_a)                \
+    X(0x08, cb_rrc_b)    X(0x09, cb_rrc_c)    X(0x0A, cb_rrc_d)    X(0x0B, cb_rrc_e)                \
+    X(0x0C, cb_rrc_h)    X(0x0D, cb_rrc_l)    X(0x0E, cb_rrc_hl)   X(0x0F, cb_rrc_a)                \
+    X(0x10, cb_rl_b)     X(0x11, cb_rl_c)     X(0x12, cb_rl_d)     X(0x13, cb_rl_e)                 \
+    X(0x14, cb_rl_h)     X(0x15, cb_rl_l)     X(0x16, cb_rl_hl)    X(0x17, cb_rl_a)                 \
+    X(0x18, cb_rr_b)     X(0x19, cb_rr_c)     X(0x1A, cb_rr_d)     X(0x1B, cb_rr_e)                 \
+    X(0x1C, cb_rr_h)     X(0x1D, cb_rr_l)     X(0x1E, cb_rr_hl)    X(0x1F, cb_rr_a)                 \
+    X(0x20, cb_sla_b)    X(0x21, cb_sla_c)    X(0x22, cb_sla_d)    X(0x23, cb_sla_e)                \
+    X(0x24, cb_sla_h)    X(0x25, cb_sla_l)    X(0x26, cb_sla_hl)   X(0x27, cb_sla_a)                \
+    X(0x28, cb_sra_b)    X(0x29, cb_sra_c)    X(0x2A, cb_sra_d)    X(0x2B, cb_sra_e)                \
+    X(0x2C, cb_sra_h)    X(0x2D, cb_sra_l)    X(0x2E, cb_sra_hl)   X(0x2F, cb_sra_a)                \
+    X(0x30, cb_swap_b)   X(0x31, cb_swap_c)   X(0x32, cb_swap_d)   X(0x33, cb_swap_e)               \
+    X(0x34, cb_swap_h)   X(0x35, cb_swap_l)   X(0x36, cb_swap_hl)  X(0x37, cb_swap_a)               \
+    X(0x38, cb_srl_b)    X(0x39, cb_srl_c)    X(0x3A, cb_srl_d)    X(0x3B, cb_srl_e)                \
+    X(0x3C, cb_srl_h)    X(0x3D, cb_srl_l)    X(0x3E, cb_srl_hl)   X(0x3F, cb_srl_a)                \
+    CB_BIT_ROW(X, bit, 0x4) CB_BIT_ROW(X, bit, 0x5) CB_BIT_ROW(X, bit, 0x6) CB_BIT_ROW(X, bit, 0x7) \
+    CB_BIT_ROW(X, res, 0x8) CB_BIT_ROW(X, res, 0x9) CB_BIT_ROW(X, res, 0xA) CB_BIT_ROW(X, res, 0xB) \
+    CB_BIT_ROW(X, set, 0xC) CB_BIT_ROW(X, set, 0xD) CB_BIT_ROW(X, set, 0xE) CB_BIT_ROW(X, set, 0xF)
+
+/**
+ * One row of 16 BIT/RES/SET opcodes (0xN0 - 0xNF) covers two bit indices.
+ * The bit index of the row is derived from the high nibble of the opcode.
+ */
+#define CB_BIT_ROW(X, op, hi)   CB_BIT_ROW_(X, op, hi, CB_ROW_BIT_##hi)
+#define CB_BIT_ROW_(X, op, hi, bits) CB_BIT_ROW__(X, op, hi, bits)
+#define CB_BIT_ROW__(X, op, hi, lo_bit, hi_bit)                                                                                           \
+    X(hi##0, cb_##op##_##lo_bit##_b) X(hi##1, cb_##op##_##lo_bit##_c)  X(hi##2, cb_##op##_##lo_bit##_d) X(hi##3, cb_##op##_##lo_bit##_e)  \
+    X(hi##4, cb_##op##_##lo_bit##_h) X(hi##5, cb_##op##_##lo_bit##_l)  X(hi##6, cb_##op##_##lo_bit##_hl) X(hi##7, cb_##op##_##lo_bit##_a) \
+    X(hi##8, cb_##op##_##hi_bit##_b) X(hi##9, cb_##op##_##hi_bit##_c)  X(hi##A, cb_##op##_##hi_bit##_d) X(hi##B, cb_##op##_##hi_bit##_e)  \
+    X(hi##C, cb_##op##_##hi_bit##_h) X(hi##D, cb_##op##_##hi_bit##_l)  X(hi##E, cb_##op##_##hi_bit##_hl) X(hi##F, cb_##op##_##hi_bit##_a)
+
+// bit indices covered by each BIT/RES/SET row
+#define CB_ROW_BIT_0x4 0, 1
+#define CB_ROW_BIT_0x5 2, 3
+#define CB_ROW_BIT_0x6 4, 5
+#define CB_ROW_BIT_0x7 6, 7
+#define CB_ROW_BIT_0x8 0, 1
+#define CB_ROW_BIT_0x9 2, 3
+#define CB_ROW_BIT_0xA 4, 5
+#define CB_ROW_BIT_0xB 6, 7
+#define CB_ROW_BIT_0xC 0, 1
+#define CB_ROW_BIT_0xD 2, 3
+#define CB_ROW_BIT_0xE 4, 5
+#define CB_ROW_BIT_0xF 6, 7
+
+
+// ==========================================================================
+// DISPATCH
+// ==========================================================================
+
+/// signature shared by every opcode handler
+typedef void (*opcode_handler_t)(gb_t* gb);
+
+#ifdef GBCEE_DISPATCH_GOTO
+
+/**
+ * Computed-goto dispatcher
+ *
+ * Every opcode gets its own label with a direct call to its handler, so the
+ * static handlers are inlined and the dispatch is a single indirect jump
+ */
+#define OPCODE_LABEL_ADDR(op, handler) [op] = &&L_##op,
+#define OPCODE_LABEL_BODY(op, handler) L_##op: handler(gb); return handler != op_illegal;
+
+/**
+ * @brief execute_opcode()-
+ * Decodes and executes given 8-bit opcode
+ *
+ * @param opcode 8-bit operation code to be executed
+ *
+ * @return  returns true on success and false on halt/unknown instruction
+ */
+bool execute_opcode(gb_t* gb, uint8_t opcode) {
+    static void* const labels[256] = { BASE_OPCODE_MAP(OPCODE_LABEL_ADDR) };
+    goto *labels[opcode];
+    BASE_OPCODE_MAP(OPCODE_LABEL_BODY)
+}
+
+/**
+ * @brief Executes CB Opcodes
+ *
+ * Separated from execute_opcode for logic
+ *
+ * @return  bool
+ * returns true if CB opcode is succesfully executed
+ * returns false otherwise
+ */
+bool execute_cb_opcode(gb_t* gb, uint8_t opcode) {
+    static void* const labels[256] = { CB_OPCODE_MAP(OPCODE_LABEL_ADDR) };
+    goto *labels[opcode];
+    CB_OPCODE_MAP(OPCODE_LABEL_BODY)
+}
+
+#else
+
+#define OPCODE_TABLE_ENTRY(op, handler) [op] = handler,
+
+/// 256-entry handler table for base opcodes
+static const opcode_handler_t base_opcode_table[256] = { BASE_OPCODE_MAP(OPCODE_TABLE_ENTRY) };
+
+/// 256-entry handler table for CB-prefixed opcodes
+static const opcode_handler_t cb_opcode_table[256] = { CB_OPCODE_MAP(OPCODE_TABLE_ENTRY) };
+
+/**
+ * @brief execute_opcode()-
+ * Decodes and executes given 8-bit opcode
+ *
+ * @param opcode 8-bit operation code to be executed
+ *
+ * @return  returns true on success and false on halt/unknown instruction
+ */
+bool execute_opcode(gb_t* gb, uint8_t opcode) {
+    opcode_handler_t handler = base_opcode_table[opcode];
+    handler(gb);
+    return handler != op_illegal;
+}
+
+/**
+ * @brief Executes CB Opcodes
+ *
+ * Separated from execute_opcode for logic
+ *
+ * @return  bool
+ * returns true if CB opcode is succesfully executed
+ * returns false otherwise
+ */
+bool execute_cb_opcode(gb_t* gb, uint8_t opcode) {
+    cb_opcode_table[opcode](gb);
+    return true; // every CB opcode is defined
+}
+
+#endif
+
+#define OPCODE_NAME_ENTRY(op, handler) [op] = #handler,
+
+/**
+ * @brief cpu_opcode_name: Name of the handler an opcode dispatches to
+ *
+ * @param cb: true for the CB-prefixed table
+ * @param opcode: 8-bit opcode
+ *
+ * @returns the handler's name, e.g. "op_jr_nz_e8" or "cb_bit_7_h"
+ */
+const char* cpu_opcode_name(bool cb, uint8_t opcode) {
+    static const char* const base_names[256] = { BASE_OPCODE_MAP(OPCODE_NAME_ENTRY) };
+    static const char* const cb_names[256] = { CB_OPCODE_MAP(OPCODE_NAME_ENTRY) };
+    return cb ? cb_names[opcode] : base_names[opcode];
+}
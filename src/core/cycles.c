@@ -1,27 +1,68 @@
 #include "cycles.h"
 
 // Base opcode cycles
+// conditional JR/JP/CALL/RET list their not-taken cost, illegal opcodes are 0
 const uint8_t opcode_cycles[256] = {
-    [0x00] = 4,
-    [0x01] = 12,
-    [0x02] = 8,
-    [0x03] = 8,
-    [0x04] = 4,
-    [0x05] = 4,
-    [0x06] = 8,
-    [0x07] = 4,
-    [0x08] = 20,
-    // ... fill rest
+//  x0  x1  x2  x3  x4  x5  x6  x7  x8  x9  xA  xB  xC  xD  xE  xF
+     4, 12,  8,  8,  4,  4,  8,  4, 20,  8,  8,  8,  4,  4,  8,  4, // 0x
+     4, 12,  8,  8,  4,  4,  8,  4, 12,  8,  8,  8,  4,  4,  8,  4, // 1x
+     8, 12,  8,  8,  4,  4,  8,  4,  8,  8,  8,  8,  4,  4,  8,  4, // 2x
+     8, 12,  8,  8, 12, 12, 12,  4,  8,  8,  8,  8,  4,  4,  8,  4, // 3x
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 4x
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 5x
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 6x
+     8,  8,  8,  8,  8,  8,  4,  8,  4,  4,  4,  4,  4,  4,  8,  4, // 7x
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 8x
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 9x
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // Ax
+     4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // Bx
+     8, 12, 12, 16, 12, 16,  8, 16,  8, 16, 12,  4, 12, 24,  8, 16, // Cx
+     8, 12, 12,  0, 12, 16,  8, 16,  8, 16, 12,  0, 12,  0,  8, 16, // Dx
+    12, 12,  8,  0,  0, 16,  8, 16, 16,  4, 16,  0,  0,  0,  8, 16, // Ex
+    12, 12,  8,  4,  0, 16,  8, 16, 12,  8, 16,  4,  0,  0,  8, 16, // Fx
+};
+
+// Taken cost of the conditional JR/JP/CALL/RET opcodes
+const uint8_t opcode_cycles_taken[256] = {
+    [0x20] = 12,    // JR NZ, e8
+    [0x28] = 12,    // JR Z, e8
+    [0x30] = 12,    // JR NC, e8
+    [0x38] = 12,    // JR C, e8
+
+    [0xC2] = 16,    // JP NZ, a16
+    [0xCA] = 16,    // JP Z, a16
+    [0xD2] = 16,    // JP NC, a16
+    [0xDA] = 16,    // JP C, a16
+
+    [0xC4] = 24,    // CALL NZ, a16
+    [0xCC] = 24,    // CALL Z, a16
+    [0xD4] = 24,    // CALL NC, a16
+    [0xDC] = 24,    // CALL C, a16
+
+    [0xC0] = 20,    // RET NZ
+    [0xC8] = 20,    // RET Z
+    [0xD0] = 20,    // RET NC
+    [0xD8] = 20,    // RET C
 };
 
 // CB-prefixed cycles
+// includes the 0xCB prefix fetch, (HL) operands cost 16 (12 for BIT b, (HL))
 const uint8_t cb_opcode_cycles[256] = {
-    [0x00] = 8,     
-    [0x01] = 8,
-    [0x02] = 8,
-    [0x03] = 8,
-    [0x04] = 8,
-    [0x05] = 8,
-    [0x06] = 16,    // (HL)
-    // ...
-};
\ No newline at end of file
+//  x0  x1  x2  x3  x4  x5  x6  x7  x8  x9  xA  xB  xC  xD  xE  xF
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // 0x RLC / RRC
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // 1x RL / RR
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // 2x SLA / SRA
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // 3x SWAP / SRL
+     8,  8,  8,  8,  8,  8, 12,  8,  8,  8,  8,  8,  8,  8, 12,  8, // 4x BIT
+     8,  8,  8,  8,  8,  8, 12,  8,  8,  8,  8,  8,  8,  8, 12,  8, // 5x BIT
+     8,  8,  8,  8,  8,  8, 12,  8,  8,  8,  8,  8,  8,  8, 12,  8, // 6x BIT
+     8,  8,  8,  8,  8,  8, 12,  8,  8,  8,  8,  8,  8,  8, 12,  8, // 7x BIT
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // 8x RES
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // 9x RES
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // Ax RES
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // Bx RES
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // Cx SET
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // Dx SET
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // Ex SET
+     8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8, // Fx SET
+};
@@ -0,0 +1,15 @@
+#include "emu.h"
+#include "gb.h"
+
+/**
+ * @brief Runs the machine for one frame worth of T-cycles.
+ *
+ * @returns exact T-cycles consumed by this frame
+ */
+int emu_run_frame(gb_t* gb) {
+    int budget = CYCLES_PER_FRAME - gb->frame_overshoot;
+    int elapsed = cpu_run_cycles(gb, budget);
+
+    gb->frame_overshoot = (elapsed > budget) ? elapsed - budget : 0;
+    return elapsed;
+}
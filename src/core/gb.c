@@ -0,0 +1,101 @@
+#include "gb.h"
+
+#include <stdlib.h>
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ULL
+#define FNV_PRIME        0x100000001B3ULL
+
+/**
+ * @brief Allocates a new machine with the MMU initialized and the scheduler, CPU and PPU reset.
+ *
+ * @returns the new instance, NULL if the allocation failed
+ */
+gb_t* gb_create() {
+    gb_t* gb = (gb_t*)calloc(1, sizeof(gb_t));
+    if (!gb) {
+        return NULL;
+    }
+
+    scheduler_reset(gb);
+    mmu_init(gb);
+    cpu_reset(gb);
+    ppu_reset(gb);
+    idle_reset(gb);
+    gb->serial_echo = true;
+    return gb;
+}
+
+/**
+ * @brief Frees a machine created by gb_create, including its loaded ROM.
+ *
+ * @param gb instance to free (NULL is ignored)
+ *
+ * @returns void
+ */
+void gb_destroy(gb_t* gb) {
+    if (!gb) {
+        return;
+    }
+
+    mmu_free(gb);
+    trace_disable(gb);
+    opstats_disable(gb);
+    profiler_disable(gb);
+    free(gb);
+}
+
+
+/**
+ * @brief Folds a block of bytes into a running FNV-1a hash
+ *
+ * @param hash: hash so far
+ * @param data: bytes to add
+ * @param size: number of bytes
+ *
+ * @returns the updated hash
+ */
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hashes the emulated machine state (64-bit FNV-1a).
+ *
+ * @param gb: instance to hash
+ *
+ * @returns the state hash
+ */
+uint64_t gb_state_hash(const gb_t* gb) {
+    const CPU* cpu = &gb->cpu;
+    const mmu_t* mmu = &gb->mmu;
+
+    // registers are hashed field by field so struct padding never leaks in
+    uint8_t regs[] = {
+        cpu->A, cpu_flags(cpu), cpu->B, cpu->C, cpu->D, cpu->E, cpu->H, cpu->L,
+        cpu->PC & 0xFF, cpu->PC >> 8, cpu->SP & 0xFF, cpu->SP >> 8,
+        cpu->halted, cpu->stopped, cpu->ime, cpu->ime_enable, cpu->ime_disable,
+        mmu->interrupt_enable, mmu->interrupt_flag,
+        mmu->internal_timer & 0xFF, mmu->internal_timer >> 8,
+        mmu->tima, mmu->tma, mmu->tac,
+        mmu->ram_enabled, mmu->current_rom_bank & 0xFF, mmu->current_ram_bank & 0xFF, mmu->mbc1_mode & 0xFF,
+        mmu->joypad_buttons,
+        gb->ppu.mode, gb->ppu.dot & 0xFF, gb->ppu.dot >> 8, gb->ppu.ly, gb->ppu.window_line, gb->ppu.stat_line,
+    };
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = fnv1a(hash, regs, sizeof(regs));
+    hash = fnv1a(hash, mmu->vram, sizeof(mmu->vram));
+    if (mmu->eram) {
+        hash = fnv1a(hash, mmu->eram, mmu->eram_size);
+    }
+    hash = fnv1a(hash, mmu->wram, sizeof(mmu->wram));
+    hash = fnv1a(hash, mmu->oam, sizeof(mmu->oam));
+    hash = fnv1a(hash, mmu->io, sizeof(mmu->io));
+    hash = fnv1a(hash, mmu->hram, sizeof(mmu->hram));
+    return hash;
+}
@@ -0,0 +1,194 @@
+#include "idle.h"
+#include "gb.h"
+
+#include <string.h>
+
+/// how an instruction may touch memory
+typedef enum idle_access_t {
+    IDLE_ACCESS_NONE,       // registers only
+    IDLE_ACCESS_READ,       // reads one byte
+    IDLE_ACCESS_BAD,        // writes, uses the stack, or changes IME / the halt state
+} idle_access_t;
+
+/**
+ * @brief Classifies the instruction at pc, before it executes
+ *
+ * @param pc: address of the instruction
+ * @param addr: receives the address read for IDLE_ACCESS_READ
+ *
+ * @returns its memory access
+ */
+static idle_access_t idle_classify(gb_t* gb, uint16_t pc, uint16_t* addr) {
+    uint8_t opcode = mmu_fetch8(gb, pc);
+
+    // LD r,r' and ALU A,r: (HL) in the source slot is a read, in the destination a write
+    if (opcode >= 0x40 && opcode <= 0xBF) {
+        if (opcode >= 0x70 && opcode <= 0x77) {
+            return IDLE_ACCESS_BAD;     // LD (HL),r and HALT
+        }
+        if ((opcode & 0x07) == 0x06) {
+            *addr = REG_HL;
+            return IDLE_ACCESS_READ;
+        }
+        return IDLE_ACCESS_NONE;
+    }
+
+    switch (opcode) {
+        case 0x00:                                                  // NOP
+        case 0x01: case 0x11: case 0x21: case 0x31:                 // LD rr,nn
+        case 0x03: case 0x13: case 0x23: case 0x33:                 // INC rr
+        case 0x0B: case 0x1B: case 0x2B: case 0x3B:                 // DEC rr
+        case 0x09: case 0x19: case 0x29: case 0x39:                 // ADD HL,rr
+        case 0x04: case 0x0C: case 0x14: case 0x1C: case 0x24: case 0x2C: case 0x3C:   // INC r
+        case 0x05: case 0x0D: case 0x15: case 0x1D: case 0x25: case 0x2D: case 0x3D:   // DEC r
+        case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x3E:   // LD r,n
+        case 0x07: case 0x0F: case 0x17: case 0x1F:                 // RLCA, RRCA, RLA, RRA
+        case 0x27: case 0x2F: case 0x37: case 0x3F:                 // DAA, CPL, SCF, CCF
+        case 0xC6: case 0xCE: case 0xD6: case 0xDE:                 // ADD/ADC/SUB/SBC A,n
+        case 0xE6: case 0xEE: case 0xF6: case 0xFE:                 // AND/XOR/OR/CP n
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:      // JR
+        case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA:      // JP
+            return IDLE_ACCESS_NONE;
+
+        case 0x0A: *addr = REG_BC; return IDLE_ACCESS_READ;         // LD A,(BC)
+        case 0x1A: *addr = REG_DE; return IDLE_ACCESS_READ;         // LD A,(DE)
+        case 0x2A: case 0x3A: *addr = REG_HL; return IDLE_ACCESS_READ;  // LD A,(HL+/-)
+        case 0xF0: *addr = 0xFF00 | mmu_fetch8(gb, pc + 1); return IDLE_ACCESS_READ;   // LDH A,(n)
+        case 0xF2: *addr = 0xFF00 | gb->cpu.C; return IDLE_ACCESS_READ;                // LDH A,(C)
+        case 0xFA: *addr = mmu_fetch16(gb, pc + 1); return IDLE_ACCESS_READ;           // LD A,(nn)
+
+        case 0xCB: {
+            uint8_t cb_opcode = mmu_fetch8(gb, pc + 1);
+            if ((cb_opcode & 0x07) != 0x06) {
+                return IDLE_ACCESS_NONE;                            // any CB op on a register
+            }
+            if (cb_opcode >= 0x40 && cb_opcode <= 0x7F) {
+                *addr = REG_HL;
+                return IDLE_ACCESS_READ;                            // BIT b,(HL)
+            }
+            return IDLE_ACCESS_BAD;                                 // read-modify-write on (HL)
+        }
+
+        default:
+            return IDLE_ACCESS_BAD;
+    }
+}
+
+/**
+ * @brief Whether a byte can only change when a scheduled event fires (or the CPU writes it)
+ *
+ * @returns false for DIV and TIMA, which count between timer events
+ */
+static bool idle_stable_address(uint16_t addr) {
+    return addr != 0xFF04 && addr != 0xFF05;
+}
+
+/**
+ * @brief Remembers the loop being recorded as never idle
+ *
+ * @returns false, so vetting can end with it
+ */
+static bool idle_reject(gb_t* gb) {
+    idle_t* idle = &gb->idle;
+    idle->rejected[idle->branch_pc % IDLE_REJECT_SLOTS] = idle_key(idle->branch_pc, gb->mmu.current_rom_bank);
+    return false;
+}
+
+/**
+ * @brief Copies every CPU field an instruction can change
+ *
+ * @returns void
+ */
+static void idle_snapshot(const gb_t* gb, uint8_t regs[13]) {
+    const CPU* cpu = &gb->cpu;
+    regs[0] = cpu->A;  regs[1] = cpu_flags(cpu);  regs[2] = cpu->B;  regs[3] = cpu->C;
+    regs[4] = cpu->D;  regs[5] = cpu->E;  regs[6] = cpu->H;  regs[7] = cpu->L;
+    regs[8] = cpu->SP & 0xFF;  regs[9] = cpu->SP >> 8;
+    regs[10] = cpu->ime;  regs[11] = cpu->ime_enable;  regs[12] = cpu->ime_disable;
+}
+
+/**
+ * @brief Forgets every loop and turns skipping on
+ *
+ * @returns void
+ */
+void idle_reset(gb_t* gb) {
+    memset(&gb->idle, 0, sizeof(gb->idle));
+    gb->idle.enabled = true;
+}
+
+/**
+ * @brief Starts recording the iteration at gb->cpu.PC
+ *
+ * @param branch_pc: address of the branch that jumped back
+ *
+ * @returns false if an interrupt is dispatched before the iteration starts
+ */
+bool idle_begin(gb_t* gb, uint16_t branch_pc) {
+    if (gb->cpu.ime && (gb->mmu.interrupt_flag & gb->mmu.interrupt_enable & 0x1F)) {
+        return false;
+    }
+
+    idle_t* idle = &gb->idle;
+    idle->head = gb->cpu.PC;
+    idle->branch_pc = branch_pc;
+    idle->instructions = 0;
+    idle->next_at_start = gb->sched.next;
+    idle_snapshot(gb, idle->regs);
+    return true;
+}
+
+/**
+ * @brief Vets the next instruction of the iteration being recorded
+ *
+ * @param pc: address of the instruction about to run
+ *
+ * @returns true if it may run as part of the recording
+ */
+bool idle_check_instruction(gb_t* gb, uint16_t pc) {
+    idle_t* idle = &gb->idle;
+    if (pc < idle->head || pc > idle->branch_pc) {
+        return false;   // the loop was left, nothing to blame it for
+    }
+    if (++idle->instructions > IDLE_MAX_INSTRUCTIONS) {
+        return idle_reject(gb);     // long bodies are not polling loops
+    }
+
+    uint16_t addr;
+    switch (idle_classify(gb, pc, &addr)) {
+        case IDLE_ACCESS_NONE:
+            return true;
+        case IDLE_ACCESS_READ:
+            return idle_stable_address(addr) || idle_reject(gb);
+        default:
+            return idle_reject(gb);
+    }
+}
+
+/**
+ * @brief Finishes an iteration that closed at the head
+ *
+ * @param cycles: T-cycles of the iteration
+ * @param remaining: T-cycles left in the run budget
+ *
+ * @returns T-cycles of whole idle iterations to skip
+ */
+int idle_end(gb_t* gb, int cycles, int remaining) {
+    idle_t* idle = &gb->idle;
+
+    // an event fired (the polled value may have changed) or the state moved on: not idle yet
+    uint8_t regs[13];
+    idle_snapshot(gb, regs);
+    if (gb->sched.next != idle->next_at_start || memcmp(regs, idle->regs, sizeof(regs)) != 0 || remaining <= 0) {
+        return 0;
+    }
+
+    // every iteration up to the next event is the same one again
+    uint64_t limit = gb->sched.next - gb->sched.now;
+    if ((uint64_t)remaining < limit) {
+        limit = (uint64_t)remaining;
+    }
+    int skip = (int)(limit / cycles) * cycles;
+    idle->skipped_cycles += skip;
+    return skip;
+}
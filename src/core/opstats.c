@@ -0,0 +1,109 @@
+#include "opstats.h"
+#include "gb.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Starts counting from zero
+ *
+ * @returns true on success
+ */
+bool opstats_enable(gb_t* gb) {
+#if GBCEE_OPSTATS
+    if (!gb->opstats) {
+        gb->opstats = malloc(sizeof(opstats_t));
+        if (!gb->opstats) {
+            return false;
+        }
+    }
+    memset(gb->opstats, 0, sizeof(opstats_t));
+    return true;
+#else
+    (void)gb;
+    return false;
+#endif
+}
+
+/**
+ * @brief Stops counting and frees the counters
+ *
+ * @returns void
+ */
+void opstats_disable(gb_t* gb) {
+    free(gb->opstats);
+    gb->opstats = NULL;
+}
+
+/// one report line: prefix (0 base, 1 CB) and opcode packed as prefix << 8 | opcode
+typedef struct opstats_entry_t {
+    uint16_t key;
+    uint64_t count;
+    uint64_t cycles;
+} opstats_entry_t;
+
+// most cycles first, then most executions, then opcode order
+static int compare_entries(const void* a, const void* b) {
+    const opstats_entry_t* x = a;
+    const opstats_entry_t* y = b;
+    if (x->cycles != y->cycles) {
+        return x->cycles < y->cycles ? 1 : -1;
+    }
+    if (x->count != y->count) {
+        return x->count < y->count ? 1 : -1;
+    }
+    return x->key - y->key;
+}
+
+/**
+ * @brief Writes the report, most T-cycles first
+ *
+ * @param out: output stream
+ * @param limit: maximum number of opcodes listed (0 for all)
+ *
+ * @returns 0 on success, -1 if counting is off
+ */
+int opstats_report(const gb_t* gb, FILE* out, int limit) {
+    const opstats_t* opstats = gb->opstats;
+    if (!opstats) {
+        return -1;
+    }
+
+    opstats_entry_t entries[512];
+    int used = 0;
+    uint64_t total_count = 0, total_cycles = 0;
+    for (int prefix = 0; prefix < 2; prefix++) {
+        for (int opcode = 0; opcode < 256; opcode++) {
+            if (opstats->count[prefix][opcode]) {
+                entries[used].key = (uint16_t)(prefix << 8 | opcode);
+                entries[used].count = opstats->count[prefix][opcode];
+                entries[used].cycles = opstats->cycles[prefix][opcode];
+                total_count += entries[used].count;
+                total_cycles += entries[used].cycles;
+                used++;
+            }
+        }
+    }
+    qsort(entries, used, sizeof(entries[0]), compare_entries);
+
+    fprintf(out, "# %llu instructions, %llu T-cycles, %d distinct opcodes\n",
+        (unsigned long long)total_count, (unsigned long long)total_cycles, used);
+    fprintf(out, "# %4s  %-7s  %-16s %14s %7s %16s %7s %6s\n",
+        "rank", "opcode", "handler", "count", "count%", "cycles", "cycle%", "avg");
+
+    int shown = (limit > 0 && limit < used) ? limit : used;
+    for (int i = 0; i < shown; i++) {
+        const opstats_entry_t* entry = &entries[i];
+        bool cb = entry->key >> 8;
+        uint8_t opcode = entry->key & 0xFF;
+
+        char label[8];
+        snprintf(label, sizeof(label), cb ? "CB %02X" : "%02X", opcode);
+        fprintf(out, "  %4d  %-7s  %-16s %14llu %6.2f%% %16llu %6.2f%% %6.2f\n",
+            i + 1, label, cpu_opcode_name(cb, opcode),
+            (unsigned long long)entry->count, 100.0 * entry->count / total_count,
+            (unsigned long long)entry->cycles, 100.0 * entry->cycles / total_cycles,
+            (double)entry->cycles / entry->count);
+    }
+    return 0;
+}
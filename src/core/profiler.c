@@ -0,0 +1,568 @@
+#include "profiler.h"
+#include "gb.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/// one symbol of a .sym file
+typedef struct profiler_symbol_t {
+    profiler_loc_t loc;
+    char* name;
+} profiler_symbol_t;
+
+struct profiler_symbols_t {
+    profiler_symbol_t* items;   // sorted by loc
+    int count;
+};
+
+/// initial size of the stack hash index (a power of two)
+#define PROFILER_INDEX_MIN 1024
+
+/**
+ * @brief Location of an address as mapped right now
+ *
+ * @param addr: CPU address
+ *
+ * @returns the address, with the ROM bank mapped at 0x4000-0x7FFF for banked code
+ */
+static profiler_loc_t profiler_location(const gb_t* gb, uint16_t addr) {
+    if (addr >= 0x4000 && addr < 0x8000 && gb->mmu.rom_bankN_ptr) {
+        uint32_t bank = (uint32_t)((gb->mmu.rom_bankN_ptr - gb->mmu.rom_data) >> 14);
+        return bank << 16 | addr;
+    }
+    return addr;
+}
+
+/**
+ * @brief Starts sampling from an empty profile
+ *
+ * @param period: T-cycles between samples (0 for the default)
+ *
+ * @returns true on success
+ */
+bool profiler_enable(gb_t* gb, uint32_t period) {
+#if GBCEE_PROFILER
+    profiler_t* profiler = calloc(1, sizeof(profiler_t));
+    if (!profiler) {
+        return false;
+    }
+
+    profiler_disable(gb);
+    profiler->period = period ? period : PROFILER_DEFAULT_PERIOD;
+    profiler->next_sample = gb->sched.now + profiler->period;
+    gb->profiler = profiler;
+    scheduler_schedule(gb, SCHED_PROFILER, profiler->next_sample);
+    return true;
+#else
+    (void)gb;
+    (void)period;
+    return false;
+#endif
+}
+
+/**
+ * @brief Stops sampling and frees the profile
+ *
+ * @returns void
+ */
+void profiler_disable(gb_t* gb) {
+    profiler_t* profiler = gb->profiler;
+    if (!profiler) {
+        return;
+    }
+    free(profiler->stacks);
+    free(profiler->index);
+    free(profiler);
+    gb->profiler = NULL;
+    scheduler_schedule(gb, SCHED_PROFILER, SCHED_NEVER);
+}
+
+/**
+ * @brief Drops the frames whose return address is no longer on the stack
+ *
+ * @returns void
+ */
+static void profiler_unwind(profiler_t* profiler, uint16_t sp) {
+    while (profiler->depth > 0 && profiler->frames[profiler->depth - 1].sp < sp) {
+        profiler->depth--;
+    }
+}
+
+/**
+ * @brief Records a return address pushed by CALL, RST or an interrupt
+ *
+ * @param return_addr: the pushed address
+ *
+ * @returns void
+ */
+void profiler_call(gb_t* gb, uint16_t return_addr) {
+    profiler_t* profiler = gb->profiler;
+    profiler_unwind(profiler, gb->cpu.SP);
+
+    if (profiler->depth == PROFILER_MAX_DEPTH) {
+        profiler->dropped++;
+        return;
+    }
+    profiler_frame_t* frame = &profiler->frames[profiler->depth++];
+    frame->return_loc = profiler_location(gb, return_addr);
+    frame->sp = gb->cpu.SP;
+}
+
+/**
+ * @brief Drops the frame a RET or RETI just returned from
+ *
+ * @returns void
+ */
+void profiler_return(gb_t* gb) {
+    profiler_unwind(gb->profiler, gb->cpu.SP);
+}
+
+static uint32_t profiler_hash(const profiler_loc_t* locs, int count) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < count; i++) {
+        hash = (hash ^ locs[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Rebuilds the hash index at twice its size
+ *
+ * @returns true on success
+ */
+static bool profiler_grow_index(profiler_t* profiler) {
+    uint32_t size = profiler->index_size ? profiler->index_size * 2 : PROFILER_INDEX_MIN;
+    uint32_t* index = calloc(size, sizeof(uint32_t));
+    if (!index) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < profiler->stack_count; i++) {
+        const profiler_stack_t* stack = &profiler->stacks[i];
+        uint32_t slot = profiler_hash(stack->locs, stack->depth + 1) & (size - 1);
+        while (index[slot]) {
+            slot = (slot + 1) & (size - 1);
+        }
+        index[slot] = i + 1;
+    }
+
+    free(profiler->index);
+    profiler->index = index;
+    profiler->index_size = size;
+    return true;
+}
+
+/**
+ * @brief Adds samples to a stack, creating it on first sight
+ *
+ * @param locs: return addresses outermost first, then the leaf
+ * @param depth: frames before the leaf
+ * @param samples: weight of this sample
+ *
+ * @returns void
+ */
+static void profiler_add(profiler_t* profiler, const profiler_loc_t* locs, int depth, uint64_t samples) {
+    if ((profiler->stack_count + 1) * 2 > profiler->index_size && !profiler_grow_index(profiler)) {
+        return;
+    }
+
+    uint32_t mask = profiler->index_size - 1;
+    uint32_t slot = profiler_hash(locs, depth + 1) & mask;
+    while (profiler->index[slot]) {
+        profiler_stack_t* stack = &profiler->stacks[profiler->index[slot] - 1];
+        if (stack->depth == depth && memcmp(stack->locs, locs, (depth + 1) * sizeof(profiler_loc_t)) == 0) {
+            stack->samples += samples;
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (profiler->stack_count == profiler->stack_capacity) {
+        uint32_t capacity = profiler->stack_capacity ? profiler->stack_capacity * 2 : 256;
+        profiler_stack_t* grown = realloc(profiler->stacks, capacity * sizeof(profiler_stack_t));
+        if (!grown) {
+            return;
+        }
+        profiler->stacks = grown;
+        profiler->stack_capacity = capacity;
+    }
+
+    profiler_stack_t* stack = &profiler->stacks[profiler->stack_count++];
+    stack->samples = samples;
+    stack->depth = (uint8_t)depth;
+    memcpy(stack->locs, locs, (depth + 1) * sizeof(profiler_loc_t));
+    profiler->index[slot] = profiler->stack_count;
+}
+
+/**
+ * @brief Scheduler handler: records the current location and call stack
+ *
+ * @returns void
+ */
+void profiler_sample(gb_t* gb) {
+    profiler_t* profiler = gb->profiler;
+    if (!profiler) {
+        return;
+    }
+
+    // one sample per period covered, the event can fire late after a long instruction or HALT span
+    uint64_t samples = 1 + (gb->sched.now - profiler->next_sample) / profiler->period;
+    profiler->next_sample += samples * profiler->period;
+    scheduler_schedule(gb, SCHED_PROFILER, profiler->next_sample);
+
+    profiler_unwind(profiler, gb->cpu.SP);
+
+    profiler_loc_t locs[PROFILER_MAX_DEPTH + 1];
+    for (int i = 0; i < profiler->depth; i++) {
+        locs[i] = profiler->frames[i].return_loc;
+    }
+    locs[profiler->depth] = profiler_location(gb, gb->cpu.PC);
+
+    profiler_add(profiler, locs, profiler->depth, samples);
+    profiler->total_samples += samples;
+}
+
+
+// ==========================================================================
+// Symbols
+// ==========================================================================
+
+// only ROMX addresses carry a bank, RAM banks are not told apart on the DMG
+static profiler_loc_t symbol_location(uint32_t bank, uint32_t addr) {
+    return (addr >= 0x4000 && addr < 0x8000) ? (bank << 16 | addr) : addr;
+}
+
+// memory region of an address, a symbol never covers code in another region
+static int symbol_region(uint16_t addr) {
+    if (addr < 0x4000) return 0;
+    if (addr < 0x8000) return 1;
+    if (addr < 0xC000) return 2;
+    if (addr < 0xFF80) return 3;
+    return 4;
+}
+
+static int compare_symbols(const void* a, const void* b) {
+    const profiler_symbol_t* x = a;
+    const profiler_symbol_t* y = b;
+    return (x->loc > y->loc) - (x->loc < y->loc);
+}
+
+/**
+ * @brief Loads an RGBDS .sym file
+ *
+ * @details Local labels (names containing a '.') are skipped, so every
+ * address resolves to the function it belongs to.
+ *
+ * @param path: .sym file
+ *
+ * @returns the symbols, NULL if the file could not be read
+ */
+profiler_symbols_t* profiler_load_symbols(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return NULL;
+    }
+
+    profiler_symbols_t* symbols = calloc(1, sizeof(profiler_symbols_t));
+    int capacity = 0;
+    char line[512];
+
+    while (symbols && fgets(line, sizeof(line), f)) {
+        unsigned int bank, addr;
+        char name[256];
+        const char* p = line;
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+        if (*p == ';' || sscanf(p, "%x:%x %255s", &bank, &addr, name) != 3 ||
+            addr > 0xFFFF || strchr(name, '.')) {
+            continue; // comment, blank line or local label
+        }
+
+        if (symbols->count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            profiler_symbol_t* grown = realloc(symbols->items, capacity * sizeof(profiler_symbol_t));
+            if (!grown) {
+                profiler_free_symbols(symbols);
+                symbols = NULL;
+                break;
+            }
+            symbols->items = grown;
+        }
+        char* copy = malloc(strlen(name) + 1);
+        if (!copy) {
+            continue;
+        }
+        strcpy(copy, name);
+        symbols->items[symbols->count].loc = symbol_location(bank, addr);
+        symbols->items[symbols->count].name = copy;
+        symbols->count++;
+    }
+    fclose(f);
+
+    if (symbols) {
+        qsort(symbols->items, symbols->count, sizeof(profiler_symbol_t), compare_symbols);
+    }
+    return symbols;
+}
+
+/**
+ * @brief Frees symbols loaded by profiler_load_symbols
+ *
+ * @returns void
+ */
+void profiler_free_symbols(profiler_symbols_t* symbols) {
+    if (!symbols) {
+        return;
+    }
+    for (int i = 0; i < symbols->count; i++) {
+        free(symbols->items[i].name);
+    }
+    free(symbols->items);
+    free(symbols);
+}
+
+/**
+ * @brief Finds the closest symbol at or below a location in the same bank and region
+ *
+ * @returns index of the symbol, -1 if there is none
+ */
+static int symbol_find(const profiler_symbols_t* symbols, profiler_loc_t loc) {
+    if (!symbols) {
+        return -1;
+    }
+
+    int low = 0, high = symbols->count - 1, found = -1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (symbols->items[mid].loc <= loc) {
+            found = mid;
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    if (found >= 0) {
+        profiler_loc_t match = symbols->items[found].loc;
+        if ((match >> 16) == (loc >> 16) && symbol_region(match & 0xFFFF) == symbol_region(loc & 0xFFFF)) {
+            return found;
+        }
+    }
+
+    // ROMs linked with rgblink -t put 0x4000-0x7FFF in bank 0
+    if ((loc >> 16) == 1) {
+        return symbol_find(symbols, loc & 0xFFFF);
+    }
+    return -1;
+}
+
+// name of a location: its symbol, or BB:AAAA
+static const char* location_name(const profiler_symbols_t* symbols, profiler_loc_t loc, char* buffer, size_t size) {
+    int symbol = symbol_find(symbols, loc);
+    if (symbol >= 0) {
+        return symbols->items[symbol].name;
+    }
+    snprintf(buffer, size, "%02X:%04X", (unsigned)(loc >> 16), (unsigned)(loc & 0xFFFF));
+    return buffer;
+}
+
+// the call instruction (or interrupted instruction) lies just before the return address
+static profiler_loc_t call_site(profiler_loc_t return_loc) {
+    return (return_loc & 0xFFFF) ? return_loc - 1 : return_loc;
+}
+
+
+// ==========================================================================
+// Reports
+// ==========================================================================
+
+/// one folded line before identical ones are merged
+typedef struct folded_line_t {
+    char* text;
+    uint64_t samples;
+} folded_line_t;
+
+static int compare_folded(const void* a, const void* b) {
+    return strcmp(((const folded_line_t*)a)->text, ((const folded_line_t*)b)->text);
+}
+
+/**
+ * @brief Writes the profile as folded stacks
+ *
+ * @details Stacks that only differ below symbol granularity resolve to the
+ * same line, those are merged.
+ *
+ * @param out: output stream
+ * @param symbols: symbols to resolve locations with (NULL for BB:AAAA)
+ *
+ * @returns 0 on success, -1 if the profiler is off
+ */
+int profiler_write_folded(const gb_t* gb, FILE* out, const profiler_symbols_t* symbols) {
+    const profiler_t* profiler = gb->profiler;
+    if (!profiler) {
+        return -1;
+    }
+
+    folded_line_t* lines = calloc(profiler->stack_count + 1, sizeof(folded_line_t));
+    if (!lines) {
+        return -1;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < profiler->stack_count; i++) {
+        const profiler_stack_t* stack = &profiler->stacks[i];
+        char text[(PROFILER_MAX_DEPTH + 1) * 64];
+        size_t used = 0;
+
+        for (int frame = 0; frame <= stack->depth; frame++) {
+            char buffer[16];
+            profiler_loc_t loc = frame < stack->depth ? call_site(stack->locs[frame]) : stack->locs[frame];
+            const char* name = location_name(symbols, loc, buffer, sizeof(buffer));
+            int written = snprintf(text + used, sizeof(text) - used, "%s%.60s", frame ? ";" : "", name);
+            if (written > 0) {
+                used += (size_t)written < sizeof(text) - used ? (size_t)written : sizeof(text) - used - 1;
+            }
+        }
+
+        lines[count].text = malloc(used + 1);
+        if (lines[count].text) {
+            memcpy(lines[count].text, text, used + 1);
+            lines[count].samples = stack->samples;
+            count++;
+        }
+    }
+
+    qsort(lines, count, sizeof(folded_line_t), compare_folded);
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t samples = lines[i].samples;
+        while (i + 1 < count && strcmp(lines[i].text, lines[i + 1].text) == 0) {
+            free(lines[i].text);
+            samples += lines[++i].samples;
+        }
+        fprintf(out, "%s %llu\n", lines[i].text, (unsigned long long)samples);
+        free(lines[i].text);
+    }
+
+    free(lines);
+    return 0;
+}
+
+/// one function (or raw location) of the flat profile
+typedef struct flat_entry_t {
+    uint64_t key;       // symbol index, or 1 << 32 | location without a symbol
+    uint64_t self;      // samples with the function as the leaf
+    uint64_t total;     // samples with the function anywhere on the stack
+} flat_entry_t;
+
+static int compare_flat_key(const void* a, const void* b) {
+    const flat_entry_t* x = a;
+    const flat_entry_t* y = b;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+static int compare_flat_self(const void* a, const void* b) {
+    const flat_entry_t* x = a;
+    const flat_entry_t* y = b;
+    if (x->self != y->self) {
+        return x->self < y->self ? 1 : -1;
+    }
+    if (x->total != y->total) {
+        return x->total < y->total ? 1 : -1;
+    }
+    return compare_flat_key(a, b);
+}
+
+static uint64_t flat_key(const profiler_symbols_t* symbols, profiler_loc_t loc) {
+    int symbol = symbol_find(symbols, loc);
+    return symbol >= 0 ? (uint64_t)symbol : (1ull << 32) | loc;
+}
+
+/**
+ * @brief Writes the flat profile, most self samples first
+ *
+ * @param out: output stream
+ * @param symbols: symbols to resolve locations with (NULL for every sampled address)
+ * @param limit: maximum number of functions listed (0 for all)
+ *
+ * @returns 0 on success, -1 if the profiler is off
+ */
+int profiler_write_flat(const gb_t* gb, FILE* out, const profiler_symbols_t* symbols, int limit) {
+    const profiler_t* profiler = gb->profiler;
+    if (!profiler) {
+        return -1;
+    }
+
+    // one entry per function per stack, merged below
+    flat_entry_t* entries = calloc((size_t)profiler->stack_count * (PROFILER_MAX_DEPTH + 1) + 1, sizeof(flat_entry_t));
+    if (!entries) {
+        return -1;
+    }
+
+    size_t count = 0;
+    for (uint32_t i = 0; i < profiler->stack_count; i++) {
+        const profiler_stack_t* stack = &profiler->stacks[i];
+        size_t first = count;
+
+        for (int frame = 0; frame <= stack->depth; frame++) {
+            bool leaf = frame == stack->depth;
+            uint64_t key = flat_key(symbols, leaf ? stack->locs[frame] : call_site(stack->locs[frame]));
+
+            // a recursive function counts once towards its total
+            bool seen = false;
+            for (size_t j = first; j < count; j++) {
+                if (entries[j].key == key) {
+                    seen = true;
+                    if (leaf) {
+                        entries[j].self += stack->samples;
+                    }
+                    break;
+                }
+            }
+            if (!seen) {
+                entries[count].key = key;
+                entries[count].self = leaf ? stack->samples : 0;
+                entries[count].total = stack->samples;
+                count++;
+            }
+        }
+    }
+
+    qsort(entries, count, sizeof(flat_entry_t), compare_flat_key);
+    size_t merged = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (merged && entries[merged - 1].key == entries[i].key) {
+            entries[merged - 1].self += entries[i].self;
+            entries[merged - 1].total += entries[i].total;
+        } else {
+            entries[merged++] = entries[i];
+        }
+    }
+    qsort(entries, merged, sizeof(flat_entry_t), compare_flat_self);
+
+    uint64_t total = profiler->total_samples ? profiler->total_samples : 1;
+    fprintf(out, "# %llu samples, one every %u T-cycles",
+        (unsigned long long)profiler->total_samples, profiler->period);
+    if (profiler->dropped) {
+        fprintf(out, " (%d calls deeper than %d frames not recorded)", profiler->dropped, PROFILER_MAX_DEPTH);
+    }
+    fprintf(out, "\n# %12s %7s %12s %7s  %s\n", "self", "self%", "total", "total%", "function");
+
+    size_t shown = (limit > 0 && (size_t)limit < merged) ? (size_t)limit : merged;
+    for (size_t i = 0; i < shown; i++) {
+        const flat_entry_t* entry = &entries[i];
+        char buffer[16];
+        const char* name;
+        if (entry->key >> 32) {
+            name = location_name(NULL, (profiler_loc_t)entry->key, buffer, sizeof(buffer));
+        } else {
+            name = symbols->items[entry->key].name;
+        }
+        fprintf(out, "  %12llu %6.2f%% %12llu %6.2f%%  %s\n",
+            (unsigned long long)entry->self, 100.0 * entry->self / total,
+            (unsigned long long)entry->total, 100.0 * entry->total / total, name);
+    }
+
+    free(entries);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "scheduler.h"
+#include "gb.h"
+#include "timer.h"
+#include "profiler.h"
+
+/// what runs when an event fires: the owning peripheral's sync
+static void (*const sched_handlers[SCHED_EVENT_COUNT])(gb_t* gb) = {
+    [SCHED_TIMER] = timer_sync,
+    [SCHED_PPU] = ppu_sync,
+    [SCHED_PROFILER] = profiler_sample,
+};
+
+/**
+ * @brief Recomputes the cached earliest due time
+ *
+ * @returns void
+ */
+static void scheduler_update_next(scheduler_t* sched) {
+    uint64_t next = SCHED_NEVER;
+    for (int event = 0; event < SCHED_EVENT_COUNT; event++) {
+        if (sched->due[event] < next) {
+            next = sched->due[event];
+        }
+    }
+    sched->next = next;
+}
+
+/**
+ * @brief Clears the schedule and restarts the clock at 0
+ *
+ * @returns void
+ */
+void scheduler_reset(gb_t* gb) {
+    gb->sched.now = 0;
+    for (int event = 0; event < SCHED_EVENT_COUNT; event++) {
+        gb->sched.due[event] = SCHED_NEVER;
+    }
+    gb->sched.next = SCHED_NEVER;
+}
+
+/**
+ * @brief Sets (or moves) the time an event fires
+ *
+ * @param event: event kind
+ * @param when: absolute time in T-cycles, SCHED_NEVER to cancel
+ *
+ * @returns void
+ */
+void scheduler_schedule(gb_t* gb, sched_event_t event, uint64_t when) {
+    gb->sched.due[event] = when;
+    scheduler_update_next(&gb->sched);
+}
+
+/**
+ * @brief Fires every event that is due now
+ *
+ * @returns void
+ */
+void scheduler_run(gb_t* gb) {
+    scheduler_t* sched = &gb->sched;
+
+    for (int event = 0; event < SCHED_EVENT_COUNT; event++) {
+        if (sched->due[event] <= sched->now) {
+            sched->due[event] = SCHED_NEVER;
+            sched_handlers[event](gb);
+        }
+    }
+    scheduler_update_next(sched);
+}
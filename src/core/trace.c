@@ -0,0 +1,154 @@
+#include "trace.h"
+#include "gb.h"
+#include "debug.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Starts tracing into a fresh ring
+ *
+ * @param capacity: records kept, rounded up to a power of two (0 for the default)
+ *
+ * @returns true on success
+ */
+bool trace_enable(gb_t* gb, uint32_t capacity) {
+#if GBCEE_TRACE
+    if (capacity == 0) {
+        capacity = TRACE_DEFAULT_CAPACITY;
+    }
+    uint32_t size = 1;
+    while (size < capacity && size < (1u << 31)) {
+        size <<= 1;
+    }
+
+    trace_record_t* records = calloc(size, sizeof(trace_record_t));
+    if (!records) {
+        return false;
+    }
+
+    trace_disable(gb);
+    gb->trace.records = records;
+    gb->trace.capacity = size;
+    gb->trace.count = 0;
+    return true;
+#else
+    (void)gb;
+    (void)capacity;
+    return false;
+#endif
+}
+
+/**
+ * @brief Stops tracing and frees the ring
+ *
+ * @returns void
+ */
+void trace_disable(gb_t* gb) {
+    free(gb->trace.records);
+    gb->trace.records = NULL;
+    gb->trace.capacity = 0;
+    gb->trace.count = 0;
+}
+
+/**
+ * @brief Appends one instruction, overwriting the oldest record once the ring is full
+ *
+ * @param pc: address of the instruction
+ * @param opcode: first opcode byte
+ *
+ * @returns void
+ */
+void trace_record(gb_t* gb, uint16_t pc, uint8_t opcode) {
+    const CPU* cpu = &gb->cpu;
+    trace_record_t* record = &gb->trace.records[gb->trace.count & (gb->trace.capacity - 1)];
+    gb->trace.count++;
+
+    record->pc = pc;
+    record->sp = cpu->SP;
+    record->bank = 0;
+    if (pc >= 0x4000 && pc < 0x8000 && gb->mmu.rom_bankN_ptr) {
+        // the bank actually mapped, the MBC register can point past the end of the ROM
+        record->bank = (uint8_t)((gb->mmu.rom_bankN_ptr - gb->mmu.rom_data) >> 14);
+    }
+    record->opcode = opcode;
+    record->operand[0] = mmu_fetch8(gb, pc + 1);
+    record->operand[1] = mmu_fetch8(gb, pc + 2);
+    record->a = cpu->A;  record->f = cpu_flags(cpu);
+    record->b = cpu->B;  record->c = cpu->C;
+    record->d = cpu->D;  record->e = cpu->E;
+    record->h = cpu->H;  record->l = cpu->L;
+}
+
+static void put_u16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static void put_u32(uint8_t* out, uint32_t value) {
+    put_u16(out, value & 0xFFFF);
+    put_u16(out + 2, value >> 16);
+}
+
+/**
+ * @brief Writes the ring to a file, oldest record first
+ *
+ * @param path: output file
+ *
+ * @returns 0 on success, -1 on failure
+ */
+int trace_dump(const gb_t* gb, const char* path) {
+    const trace_t* trace = &gb->trace;
+    if (!trace->records) {
+        return -1;
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+
+    uint32_t kept = trace->count < trace->capacity ? (uint32_t)trace->count : trace->capacity;
+    uint64_t first = trace->count - kept;
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    memcpy(header, TRACE_MAGIC, 8);
+    put_u32(header + 8, TRACE_VERSION);
+    put_u32(header + 12, kept);
+    put_u32(header + 16, (uint32_t)trace->count);
+    put_u32(header + 20, (uint32_t)(trace->count >> 32));
+    bool ok = fwrite(header, sizeof(header), 1, f) == 1;
+
+    // serialized field by field so the file does not depend on the host's struct layout
+    for (uint64_t i = first; ok && i < trace->count; i++) {
+        const trace_record_t* record = &trace->records[i & (trace->capacity - 1)];
+        uint8_t out[TRACE_RECORD_SIZE] = {
+            0, 0, 0, 0, record->bank, record->opcode, record->operand[0], record->operand[1],
+            record->a, record->f, record->b, record->c, record->d, record->e, record->h, record->l,
+        };
+        put_u16(out, record->pc);
+        put_u16(out + 2, record->sp);
+        ok = fwrite(out, sizeof(out), 1, f) == 1;
+    }
+
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+/**
+ * @brief Dumps the ring to trace.dump_path when the CPU faults
+ *
+ * @returns void
+ */
+void trace_fault(const gb_t* gb) {
+    if (!gb->trace.records || !gb->trace.dump_path) {
+        return;
+    }
+    if (trace_dump(gb, gb->trace.dump_path) == 0) {
+        LOG_ERROR("Trace of the last %u instructions written to %s\n",
+            gb->trace.count < gb->trace.capacity ? (unsigned)gb->trace.count : gb->trace.capacity,
+            gb->trace.dump_path);
+    } else {
+        LOG_ERROR("Failed to write the trace to %s\n", gb->trace.dump_path);
+    }
+}
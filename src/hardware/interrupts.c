@@ -1,11 +1,9 @@
 #include "interrupts.h"
 #include "cpu.h"
 #include "mmu.h"
+#include "gb.h"
 #include "alu.h" // for push16()
 
-extern CPU cpu;
-extern mmu_t mmu;
-
 /**
  * @brief Services a single, specific interrupt by jumping the CPU.
  * 
@@ -21,25 +19,25 @@ extern mmu_t mmu;
  * 
  * @note static
  */
-static void service_interrupts(int interrupt_bit) {
+static void service_interrupts(gb_t* gb, int interrupt_bit) {
     // 1. When an interrupt is serviced, global interrupts are disabled immediately.
-    cpu.ime = false;
+    gb->cpu.ime = false;
 
     // 2. The corresponding request bit in the IF register (0xFF0F) is cleared.
     // We use the getter/setter functions to maintain encapsulation.
-    uint8_t if_reg = mmu_get_if_register();
-    mmu_write(0xFF0F, if_reg & ~(1 << interrupt_bit));
+    uint8_t if_reg = mmu_get_if_register(gb);
+    mmu_write(gb, 0xFF0F, if_reg & ~(1 << interrupt_bit));
 
     // 3. The current Program Counter is pushed onto the stack.
-    push16(cpu.PC);
+    push16(gb, gb->cpu.PC);
 
     // 4. The CPU's Program Counter is set to the interrupt's vector address.
     switch (interrupt_bit) {
-        case 0: cpu.PC = 0x0040; break; // V-Blank Interrupt
-        case 1: cpu.PC = 0x0048; break; // LCD STAT Interrupt
-        case 2: cpu.PC = 0x0050; break; // Timer Interrupt
-        case 3: cpu.PC = 0x0058; break; // Serial Interrupt
-        case 4: cpu.PC = 0x0060; break; // Joypad Interrupt
+        case 0: gb->cpu.PC = 0x0040; break; // V-Blank Interrupt
+        case 1: gb->cpu.PC = 0x0048; break; // LCD STAT Interrupt
+        case 2: gb->cpu.PC = 0x0050; break; // Timer Interrupt
+        case 3: gb->cpu.PC = 0x0058; break; // Serial Interrupt
+        case 4: gb->cpu.PC = 0x0060; break; // Joypad Interrupt
     }
 }
 
@@ -53,26 +51,26 @@ static void service_interrupts(int interrupt_bit) {
  * 
  * checks for pending and enabled interrupts
  * 
- * @param none
+ * @param gb: emulator instance
  * 
- * @returns void
+ * @returns T-cycles spent dispatching (20 when an interrupt is serviced, 0 otherwise)
  */ 
-void handle_interrupts() {
+int handle_interrupts(gb_t* gb) {
     // Determine which interrupts are both requested (in IF) and enabled (in IE).
-    uint8_t requested_interrupts = mmu_get_if_register();
-    uint8_t enabled_interrupts = mmu_get_ie_register();
+    uint8_t requested_interrupts = mmu_get_if_register(gb);
+    uint8_t enabled_interrupts = mmu_get_ie_register(gb);
     
     // --- Wake from HALT ---
     // If the CPU is in a HALT state and there are any active interrupts,
     // it should wake up on the next cycle.
-    if (cpu.halted && (requested_interrupts & 0x1F)) {
-        cpu.halted = false;
+    if (gb->cpu.halted && (requested_interrupts & 0x1F)) {
+        gb->cpu.halted = false;
     }
     
     // --- Service Interrupts ---
     // Interrupts can only be serviced if the master interrupt switch (IME) is enabled.
-    if (!cpu.ime) {
-        return;
+    if (!gb->cpu.ime) {
+        return 0;
     }
 
     // Determine which interrupts are active (both requested and enabled)
@@ -83,10 +81,12 @@ void handle_interrupts() {
         // Loop from bit 0 (V-Blank, highest priority) to bit 4 (Joypad, lowest).
         for (int i = 0; i < 5; i++) {
             if (active_interrupts & (1 << i)) {
-                service_interrupts(i);
+                service_interrupts(gb, i);
                 // Only one interrupt is serviced per instruction cycle.
-                break;
+                // The dispatch takes 5 machine cycles (2 wait, 2 push, 1 jump)
+                return 20;
             }
         }
     }
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "joypad.h"
+#include "gb.h"
+
+// The joypad interrupt is on bit 4 of the IF register
+#define JOYPAD_INTERRUPT_BIT 4
+
+/**
+ * @brief Sets which buttons are currently held down.
+ *
+ * @param gb: emulator instance
+ * @param buttons: mask of JOYPAD_* bits, set = pressed
+ *
+ * @returns void
+ */
+void joypad_set_buttons(gb_t* gb, uint8_t buttons) {
+    uint8_t newly_pressed = buttons & ~gb->mmu.joypad_buttons;
+    gb->mmu.joypad_buttons = buttons;
+
+    if (newly_pressed) {
+        gb->mmu.interrupt_flag |= (1 << JOYPAD_INTERRUPT_BIT);
+    }
+}
+
+/**
+ * @brief Reads JOYP (0xFF00) for the nibble(s) the game has selected.
+ *
+ * @param gb: emulator instance
+ *
+ * @returns register value
+ */
+uint8_t joypad_read(gb_t* gb) {
+    uint8_t select = gb->mmu.io[0x00] & 0x30; // bits 4-5, written by the game
+    uint8_t pressed = 0;
+
+    if (!(select & 0x10)) {
+        pressed |= gb->mmu.joypad_buttons & 0x0F;        // D-pad selected
+    }
+    if (!(select & 0x20)) {
+        pressed |= (gb->mmu.joypad_buttons >> 4) & 0x0F; // action buttons selected
+    }
+
+    // bits 6-7 are unused and read as 1, a pressed button reads as 0
+    return 0xC0 | select | (~pressed & 0x0F);
+}
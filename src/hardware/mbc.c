@@ -1,6 +1,7 @@
 #include "mbc.h"
 #include "mmu.h"
 #include "rom.h"
+#include "debug.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -22,6 +23,17 @@ void mbc_init(mmu_t* mmu) {
     mmu->ram_enabled = false;
     mmu->current_ram_bank = 0;
 
+    // banks wrap at the ROM size (always a power of two number of 16KB banks)
+    mmu->rom_bank_mask = mmu->rom_size ? (uint32_t)(mmu->rom_size >> 14) - 1 : 0;
+
+    // cartridge RAM is sized by the header (0x149), most MBC-less games have none
+    free(mmu->eram);
+    mmu->eram_size = (mmu->rom_size >= 0x150) ? rom_header_ram_size(mmu->rom_data[0x149]) : 0;
+    mmu->eram = mmu->eram_size ? calloc(1, mmu->eram_size) : NULL;
+    if (!mmu->eram) {
+        mmu->eram_size = 0; // reads 0xFF like a cartridge without RAM
+    }
+
     
     switch(mmu->mbc_type) {
         case MBC_TYPE_NONE: {
@@ -46,45 +58,88 @@ void mbc_init(mmu_t* mmu) {
         }
     }
     
+    mbc_update_map(mmu);
+
     // DEBUG
-    printf("[DEBUG] MBC initialized: type=%d, rom_bank=%d\n",
-        mmu->mbc_type, mmu->current_rom_bank);
+    LOG_MMU("[DEBUG] MBC initialized: type=%d, rom_bank=%d, rom_banks=%u, eram=%zu\n",
+        mmu->mbc_type, mmu->current_rom_bank, mmu->rom_bank_mask + 1, mmu->eram_size);
 }
 
-uint8_t mbc_read_rom(mmu_t* mmu, uint16_t addr) {
-    uint32_t rom_offset = 0;
 
+/**
+ * @brief ROM offset of the bank currently switched into 0x4000-0x7FFF
+ * 
+ * @param mmu: pointer to the main mmu struct
+ * 
+ * @return byte offset into rom_data
+ */
+static uint32_t mbc_rom_bank_offset(mmu_t* mmu) {
     switch (mmu->mbc_type) {
-        case MBC_TYPE_NONE:
-            rom_offset = addr;
-            break;
-
-        case MBC_TYPE_MBC1:
-            if (addr < 0x4000) {
-                // Bank 00 is usually at 0x0000-0x3FFF.
-                // In advanced mode, this can change, but for now, this is correct.
-                rom_offset = addr;
-            } else {
-                // The switchable bank is at 0x4000-0x7FFF.
-                // --- FIX: Added logic to handle the bank 0 hardware quirk. ---
-                int effective_bank = mmu->current_rom_bank;
-                // Banks 0x00, 0x20, 0x40, 0x60 are read as bank+1 on MBC1.
-                if (effective_bank == 0x00 || effective_bank == 0x20 || effective_bank == 0x40 || effective_bank == 0x60) {
-                    effective_bank++;
-                }
-                rom_offset = (effective_bank * 0x4000) + (addr - 0x4000);
+        case MBC_TYPE_MBC1: {
+            // --- FIX: Added logic to handle the bank 0 hardware quirk. ---
+            int effective_bank = mmu->current_rom_bank;
+            // Banks 0x00, 0x20, 0x40, 0x60 are read as bank+1 on MBC1.
+            if (effective_bank == 0x00 || effective_bank == 0x20 || effective_bank == 0x40 || effective_bank == 0x60) {
+                effective_bank++;
             }
-            break;
+            return (effective_bank & mmu->rom_bank_mask) * 0x4000;
+        }
 
         default:
-            rom_offset = addr;
-            break;
+            // no banking, 0x4000-0x7FFF is simply the second 16KB of the ROM
+            return 0x4000;
     }
+}
 
-    if (rom_offset < mmu->rom_size) {
-        return mmu->rom_data[rom_offset];
+
+/**
+ * @brief Offset mask of the 8KB window at 0xA000-0xBFFF into the current RAM bank
+ * 
+ * @param mmu: pointer to the main mmu struct
+ * 
+ * @return 0x1FFF, or less for 2KB RAM which mirrors across the window
+ */
+static uint32_t mbc_eram_window_mask(mmu_t* mmu) {
+    return (mmu->eram_size < 0x2000 ? (uint32_t)mmu->eram_size : 0x2000) - 1;
+}
+
+
+/**
+ * @brief Recomputes the cached bank pointers and the ROM/external RAM pages of the memory map
+ * 
+ * @param mmu: pointer to the main mmu struct
+ * 
+ * @return void
+ */
+void mbc_update_map(mmu_t* mmu) {
+    // every bank is fully backed (rom_size is a power of two >= 32KB), so no length checks
+    mmu->rom_bank0_ptr = mmu->rom_data;
+    mmu->rom_bankN_ptr = mmu->rom_data ? &mmu->rom_data[mbc_rom_bank_offset(mmu)] : NULL;
+
+    // disabled or missing RAM reads 0xFF and ignores writes,
+    // banks past the end wrap like ROM banks do
+    mmu->eram_ptr = (mmu->ram_enabled && mmu->eram)
+        ? &mmu->eram[(mmu->current_ram_bank * 0x2000) & (mmu->eram_size - 1)]
+        : NULL;
+
+    // ROM pages are read only, writes are MBC register writes and always take the handler
+    for (int page = 0x00; page <= 0x7F; page++) {
+        uint8_t* bank = (page < 0x40) ? mmu->rom_bank0_ptr : mmu->rom_bankN_ptr;
+        mmu->read_map[page] = bank ? &bank[(page & 0x3F) << 8] : NULL;
+    }
+
+    uint32_t window_mask = mbc_eram_window_mask(mmu);
+    for (int page = 0xA0; page <= 0xBF; page++) {
+        mmu->read_map[page] = mmu->eram_ptr ? &mmu->eram_ptr[((page - 0xA0) << 8) & window_mask] : NULL;
+        mmu->write_map[page] = mmu->read_map[page];
     }
-    return 0xFF; // Return 0xFF if out of bounds.
+}
+
+uint8_t mbc_read_rom(mmu_t* mmu, uint16_t addr) {
+    // Bank 00 is usually at 0x0000-0x3FFF, the switchable bank at 0x4000-0x7FFF.
+    // Both pointers are kept current by mbc_update_map.
+    uint8_t* bank = (addr < 0x4000) ? mmu->rom_bank0_ptr : mmu->rom_bankN_ptr;
+    return bank ? bank[addr & 0x3FFF] : 0xFF; // 0xFF with no cartridge inserted
 }
 
 
@@ -116,6 +171,7 @@ void mbc_write_rom(mmu_t* mmu, uint16_t addr, uint8_t value) {
             } else { // Banking Mode Select
                 mmu->mbc1_mode = value & 0x01;
             }
+            mbc_update_map(mmu); // bank or RAM enable may have changed
             break;
 
         // TODO: Implement logic for MBC3, MBC5, etc.
@@ -143,19 +199,11 @@ void mbc_write_rom(mmu_t* mmu, uint16_t addr, uint8_t value) {
  * @returns the byte from the correctly calculated ram area
  */
 uint8_t mbc_read_ram(mmu_t* mmu, uint16_t addr) {
-    if (!mmu->ram_enabled) {
-        return 0xFF; // Open bus behavior
+    if (!mmu->eram_ptr) {
+        return 0xFF; // Open bus behavior, RAM is disabled or absent
     }
 
-    // Calculate offset into ERAM based on the current RAM bank
-    uint32_t ram_offset = (mmu->current_ram_bank * 0x2000) + (addr - 0xA000);
-
-    // Note: A proper implementation would check the ERAM size from the header.
-    // For now, we assume it fits within our MAX_ERAM_SIZE buffer.
-    if (ram_offset < MAX_ERAM_SIZE) {
-        return mmu->eram[ram_offset];
-    }
-    return 0xFF;
+    return mmu->eram_ptr[(addr - 0xA000) & mbc_eram_window_mask(mmu)];
 }
 
 
@@ -169,13 +217,9 @@ uint8_t mbc_read_ram(mmu_t* mmu, uint16_t addr) {
  * @returns void
  */
 void mbc_write_ram(mmu_t* mmu, uint16_t addr, uint8_t value) {
-    if (!mmu->ram_enabled) {
-        return;
+    if (!mmu->eram_ptr) {
+        return; // RAM is disabled or absent
     }
 
-    uint32_t ram_offset = (mmu->current_ram_bank * 0x2000) + (addr - 0xA000);
-
-    if (ram_offset < MAX_ERAM_SIZE) {
-        mmu->eram[ram_offset] = value;
-    }
+    mmu->eram_ptr[(addr - 0xA000) & mbc_eram_window_mask(mmu)] = value;
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "mmu.h"
+#include "gb.h"
 #include "mbc.h"            // NEW: delegate banking to MBC
 #include "rom.h"
+#include "timer.h"
+#include "joypad.h"
+#include "ppu.h"
+#include "debug.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -25,35 +30,51 @@
 /// IO register size (128 bytes)
 #define IO_SIZE 0x80
 
-/// Max External RAM size (32KB)
-#define MAX_ERAM_SIZE (32 * 1024)
-
-
-// ===================================================
-// MMU State Structure
-// ===================================================
-
-
-mmu_t mmu; // static mmu_t mmu change to static after running unit tests
-
 
 // =========================================================
 // Function Implementations
 // ============================================================
 
 
+/**
+ * @brief Maps the pages whose backing memory never moves
+ * 
+ * VRAM, WRAM and its echo are plain memory. Writes to VRAM tile data
+ * (0x8000-0x97FF) still take the handler so the PPU's decoded tile cache
+ * hears about them. ROM and external RAM follow the MBC (mbc_update_map),
+ * and 0xFE/0xFF pages (OAM + unusable, IO, HRAM, IE) stay on the handler chain.
+ * 
+ * @param mmu: pointer to the main mmu struct
+ * 
+ * @returns void
+ */
+static void mmu_map_fixed(mmu_t* mmu) {
+    for (int page = 0x80; page <= 0x9F; page++) {   // VRAM
+        mmu->read_map[page] = &mmu->vram[(page - 0x80) << 8];
+        mmu->write_map[page] = (page >= 0x98) ? mmu->read_map[page] : NULL; // tile maps only
+    }
+    for (int page = 0xC0; page <= 0xDF; page++) {   // WRAM
+        mmu->read_map[page] = mmu->write_map[page] = &mmu->wram[(page - 0xC0) << 8];
+    }
+    for (int page = 0xE0; page <= 0xFD; page++) {   // Echo RAM
+        mmu->read_map[page] = mmu->write_map[page] = &mmu->wram[(page - 0xE0) << 8];
+    }
+}
+
+
 /**
  * @brief Initializes the MMU memory regions
  * 
- * Clears RAM and prepares memory map. No parameters.
+ * Clears RAM and prepares memory map.
  * 
- * @param none
+ * @param gb: emulator instance
  * 
  * @returns void 
  */
-void mmu_init() {
-    memset(&mmu, 0, sizeof(mmu));
-    printf("MMU Initialized!.\n");
+void mmu_init(gb_t* gb) {
+    memset(&gb->mmu, 0, sizeof(gb->mmu));
+    mmu_map_fixed(&gb->mmu);
+    LOG_MMU("MMU Initialized!.\n");
 }
 
 
@@ -63,11 +84,21 @@ void mmu_init() {
  * 
  * @returns void
  */
-void mmu_free() {
-    if (mmu.rom_data) {
-        free(mmu.rom_data);
-            mmu.rom_data = NULL;
-            printf("ROM Memory freed!.\n");
+void mmu_free(gb_t* gb) {
+    if (gb->mmu.rom_data) {
+        if (gb->mmu.rom_image) {
+            rom_release(gb->mmu.rom_image); // shared image, other instances may still use it
+            gb->mmu.rom_image = NULL;
+        } else {
+            free(gb->mmu.rom_data);
+        }
+            free(gb->mmu.eram);
+            gb->mmu.eram = NULL;
+            gb->mmu.eram_size = 0;
+            gb->mmu.rom_data = NULL;
+            gb->mmu.rom_size = 0;
+            mbc_update_map(&gb->mmu); // drop the page table entries into the freed ROM
+            LOG_MMU("ROM Memory freed!.\n");
     }
 }
 
@@ -79,145 +110,206 @@ void mmu_free() {
  * @param filepath The path to the Game Boy ROM file.
  * @return 0 on success, or -1 on failure (e.g., file not found).
  */
-int mmu_load_rom(const char* filepath) {
-    mmu_free(); // Free any previously loaded ROM
+int mmu_load_rom(gb_t* gb, const char* filepath) {
+    mmu_free(gb); // Free any previously loaded ROM
 
     // Delegate the file loading and parsing to the rom.c module
-    int result = load_rom(filepath, &mmu.rom_data, &mmu.rom_size, &mmu.mbc_type);
+    int result = load_rom(filepath, &gb->mmu.rom_image, &gb->mmu.rom_data, &gb->mmu.rom_size, &gb->mmu.mbc_type);
 
     if (result == 0) { // Check for failure (assuming 0 is failure from your rom.c)
-        mmu.rom_data = NULL; // Ensure pointer is null on failure
+        gb->mmu.rom_data = NULL; // Ensure pointer is null on failure
+        gb->mmu.rom_image = NULL;
         return -1;
     }
 
-    printf("ROM loading delegated to rom.c, result integrated into MMU.\n");
-    printf("Detected MBC Type: %d\n", mmu.mbc_type);
+    LOG_MMU("ROM loading delegated to rom.c, result integrated into MMU.\n");
+    LOG_MMU("Detected MBC Type: %d\n", gb->mmu.mbc_type);
 
     // TODO: Initialize the MBC based on the detected type
-    mbc_init(&mmu);
+    mbc_init(&gb->mmu);
     
     return 0; // Success
 }
 
 
 /**
- * @brief Reads a byte from the full memory map.
+ * @brief Reads a byte through the handler chain.
  *
- * Handles memory bank redirection as per address range.
+ * Handles memory bank redirection as per address range. Only reached for
+ * pages the page table does not map directly.
  *
  * @param addr Address to read from.
  * @return Value at that address.
  */
-uint8_t mmu_read(uint16_t addr) {
+static uint8_t mmu_read_slow(gb_t* gb, uint16_t addr) {
     // serial port stubbing
     // temporarily setting value with bit 7 set
     if (addr == 0xFF02) {
         return 0xFF;
     }
     if (addr <= 0x7FFF) {
-        return mbc_read_rom(&mmu, addr);
-        // return mmu.rom_data[addr]; // Placeholder for no MBC
+        return mbc_read_rom(&gb->mmu, addr);
+        // return gb->mmu.rom_data[addr]; // Placeholder for no MBC
     }
     if (addr <= 0x9FFF) { 
-        return mmu.vram[addr - 0x8000]; 
+        return gb->mmu.vram[addr - 0x8000]; 
     }
     if (addr <= 0xBFFF) {
-        return mbc_read_ram(&mmu, addr);
-        // return mmu.eram[addr - 0xA000]; // Placeholder for no MBC
+        return mbc_read_ram(&gb->mmu, addr);
+        // return gb->mmu.eram[addr - 0xA000]; // Placeholder for no MBC
     }
     if (addr <= 0xDFFF) { 
-        return mmu.wram[addr - 0xC000]; 
+        return gb->mmu.wram[addr - 0xC000]; 
     }
     if (addr <= 0xFDFF) { 
-        return mmu.wram[addr - 0xE000]; 
+        return gb->mmu.wram[addr - 0xE000]; 
     } // Echo RAM
     if (addr <= 0xFE9F) { 
-        return mmu.oam[addr - 0xFE00]; 
+        return gb->mmu.oam[addr - 0xFE00]; 
     }
     if (addr <= 0xFEFF) { 
         return 0xFF; 
     }
     // Timer Suite
     if (addr <= 0xFF7F) {
-        if (addr == 0xFF04) return mmu.internal_timer >> 8;     // DIV
-        if (addr == 0xFF05) return mmu.tima;                    // TIMA
-        if (addr == 0xFF06) return mmu.tma;                     // TMA
-        if (addr == 0xFF07) return mmu.tac;                     // TAC
-        if (addr == 0xFF0F) return mmu.interrupt_flag;          // added interrupt flag
+        if (addr == 0xFF00) return joypad_read(gb);             // JOYP
+        if (addr >= 0xFF04 && addr <= 0xFF07) return timer_read(gb, addr); // DIV, TIMA, TMA, TAC
+        if (addr == 0xFF0F) return gb->mmu.interrupt_flag;          // added interrupt flag
+        if (addr >= 0xFF40 && addr <= 0xFF4B && addr != 0xFF46) return ppu_read(gb, addr); // LCD registers
 
         if (addr == 0xFF01) return 0xFF;            // Serial Data (stub)
         if (addr == 0xFF02) return 0xFF;            // Serial Control (stub)
 
-        return mmu.io[addr - 0xFF00];
+        return gb->mmu.io[addr - 0xFF00];
     }
     if (addr <= 0xFFFE) { 
-        return mmu.hram[addr - 0xFF80]; 
+        return gb->mmu.hram[addr - 0xFF80]; 
     }
     
-    return mmu.interrupt_enable; // 0xFFFF
+    return gb->mmu.interrupt_enable; // 0xFFFF
 }
 
 /**
- * @brief Writes a byte to the full memory map.
+ * @brief Copies 160 bytes from (value << 8) into OAM
  *
- * Handles memory protection and mirroring.
+ * The transfer is done at once rather than over 160 machine cycles, games
+ * wait it out from HRAM anyway.
+ *
+ * @param value: source page, written to 0xFF46
+ * 
+ * @returns void
+ */
+static void mmu_oam_dma(gb_t* gb, uint8_t value) {
+    gb->mmu.io[0x46] = value;
+    uint16_t source = value << 8;
+    for (int i = 0; i < OAM_SIZE; i++) {
+        gb->mmu.oam[i] = mmu_read(gb, (uint16_t)(source + i));
+    }
+}
+
+/**
+ * @brief Writes a byte through the handler chain.
+ *
+ * Handles memory protection and mirroring. Only reached for pages the page
+ * table does not map directly.
  *
  * @param addr Address to write to.
  * @param value Byte to write.
  * 
  * @returns void
  */
-void mmu_write(uint16_t addr, uint8_t value) {
+static void mmu_write_slow(gb_t* gb, uint16_t addr, uint8_t value) {
     // serial port output stubbing
     if (addr == 0xFF01) {
-        printf("%c", value);
-        fflush(stdout); // immediately print the character
+        if (gb->serial_echo) {
+            printf("%c", value);
+            fflush(stdout); // immediately print the character
+        }
         return;
     }
 
     if (addr <= 0x7FFF) {
-        mbc_write_rom(&mmu, addr, value);
+        mbc_write_rom(&gb->mmu, addr, value);
         return;
     }
     if (addr <= 0x9FFF) { 
-        mmu.vram[addr - 0x8000] = value; 
+        gb->mmu.vram[addr - 0x8000] = value; 
+        if (addr <= 0x97FF) {
+            ppu_tile_written(gb, addr); // tile data, drop the decoded copy
+        }
         return; 
     }
     if (addr <= 0xBFFF) {
-        mbc_write_ram(&mmu, addr, value);
-        // mmu.eram[addr - 0xA000] = value; // Placeholder for no MBC
+        mbc_write_ram(&gb->mmu, addr, value);
+        // gb->mmu.eram[addr - 0xA000] = value; // Placeholder for no MBC
         return;
     }
     if (addr <= 0xDFFF) { 
-        mmu.wram[addr - 0xC000] = value; return; 
+        gb->mmu.wram[addr - 0xC000] = value; return; 
     }
     if (addr <= 0xFDFF) { 
-        mmu.wram[addr - 0xE000] = value; return; 
+        gb->mmu.wram[addr - 0xE000] = value; return; 
     } // Echo RAM
     if (addr <= 0xFE9F) { 
-        mmu.oam[addr - 0xFE00] = value; return; 
+        gb->mmu.oam[addr - 0xFE00] = value; return; 
     }
     if (addr <= 0xFEFF) { 
         return; 
     } 
     // Timer Suite
     if (addr <= 0xFF7F) {
-        if (addr == 0xFF04) { mmu.internal_timer = 0; return; }         // any write to DIV resets the timer
-        if (addr == 0xFF05) { mmu.tima = value; return; }               // TIMA
-        if (addr == 0xFF06) { mmu.tma = value; return; }               // TMA
-        if (addr == 0xFF07) { mmu.tac = value; return; }               // TAC
+        if (addr >= 0xFF04 && addr <= 0xFF07) { timer_write(gb, addr, value); return; } // DIV, TIMA, TMA, TAC
         
-        if (addr == 0xFF0F) { mmu.interrupt_flag = value; return; }
+        if (addr == 0xFF0F) { gb->mmu.interrupt_flag = value; return; }
+        if (addr == 0xFF46) { mmu_oam_dma(gb, value); return; }                                 // OAM DMA
+        if (addr >= 0xFF40 && addr <= 0xFF4B) { ppu_write(gb, addr, value); return; }          // LCD registers
 
-        mmu.io[addr - 0xFF00] = value;
+        gb->mmu.io[addr - 0xFF00] = value;
         return;
     }
     
     if (addr <= 0xFFFE) { 
-        mmu.hram[addr - 0xFF80] = value; return; 
+        gb->mmu.hram[addr - 0xFF80] = value; return; 
     }
     
-    mmu.interrupt_enable = value; // 0xFFFF
+    gb->mmu.interrupt_enable = value; // 0xFFFF
+}
+
+/**
+ * @brief Reads a byte from the full memory map.
+ *
+ * Directly mapped pages are a single table lookup, everything else
+ * (IO, MBC without a mapping) goes through mmu_read_slow.
+ *
+ * @param addr Address to read from.
+ * @return Value at that address.
+ */
+uint8_t mmu_read(gb_t* gb, uint16_t addr) {
+    const uint8_t* page = gb->mmu.read_map[addr >> MMU_PAGE_SHIFT];
+    if (page) {
+        return page[addr & 0xFF];
+    }
+    return mmu_read_slow(gb, addr);
+}
+
+/**
+ * @brief Writes a byte to the full memory map.
+ *
+ * Directly mapped pages are a single table lookup, everything else
+ * (IO, MBC registers, disabled RAM) goes through mmu_write_slow.
+ *
+ * @param addr Address to write to.
+ * @param value Byte to write.
+ * 
+ * @returns void
+ */
+void mmu_write(gb_t* gb, uint16_t addr, uint8_t value) {
+    uint8_t* page = gb->mmu.write_map[addr >> MMU_PAGE_SHIFT];
+    if (page) {
+        page[addr & 0xFF] = value;
+        return;
+    }
+    mmu_write_slow(gb, addr, value);
 }
 
 /**
@@ -225,8 +317,8 @@ void mmu_write(uint16_t addr, uint8_t value) {
  * 
  * @return the 8-bit value of the IE register
  */
-uint8_t mmu_get_ie_register() {
-    return mmu.interrupt_enable;
+uint8_t mmu_get_ie_register(gb_t* gb) {
+    return gb->mmu.interrupt_enable;
 }
 
 /**
@@ -234,6 +326,6 @@ uint8_t mmu_get_ie_register() {
  * 
  * @return The 8-bit value of the IF register.
  */
-uint8_t mmu_get_if_register() {
-    return mmu.interrupt_flag;
+uint8_t mmu_get_if_register(gb_t* gb) {
+    return gb->mmu.interrupt_flag;
 }
\ No newline at end of file
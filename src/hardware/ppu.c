@@ -1,56 +1,550 @@
 #include "ppu.h"
-#include "mmu.h"
-#include <SDL2/SDL.h>
+#include "ppu_kernels.h"
+#include "gb.h"
+#include "debug.h"
+
 #include <string.h>
 
-// change according to screen sizes
-#define SCREEN_WIDTH 160
-#define SCREEN_HEIGHT 144
+// Scanline timing in T-cycles (dots)
+#define PPU_DOTS_PER_LINE 456
+#define PPU_OAM_SCAN_END 80             // OAM scan: dots 0 - 79
+#define PPU_DRAWING_END (80 + 172)      // drawing: dots 80 - 251, HBlank for the rest
+#define PPU_VBLANK_LINE 144
+#define PPU_LINES_PER_FRAME 154
+
+// LCD registers, as offsets into mmu.io
+#define REG_LCDC 0x40
+#define REG_STAT 0x41
+#define REG_SCY  0x42
+#define REG_SCX  0x43
+#define REG_LYC  0x45
+#define REG_BGP  0x47
+#define REG_OBP0 0x48
+#define REG_OBP1 0x49
+#define REG_WY   0x4A
+#define REG_WX   0x4B
+
+// LCDC bits
+#define LCDC_BG_ENABLE      0x01    // BG and window master enable on the DMG
+#define LCDC_OBJ_ENABLE     0x02
+#define LCDC_OBJ_SIZE       0x04    // 8x16 sprites when set
+#define LCDC_BG_MAP         0x08    // BG tile map at 0x9C00 when set, 0x9800 otherwise
+#define LCDC_TILE_DATA      0x10    // unsigned tile numbers from 0x8000 when set, signed from 0x9000 otherwise
+#define LCDC_WINDOW_ENABLE  0x20
+#define LCDC_WINDOW_MAP     0x40    // window tile map at 0x9C00 when set
+#define LCDC_LCD_ENABLE     0x80
+
+// STAT interrupt sources
+#define STAT_HBLANK_INT     0x08
+#define STAT_VBLANK_INT     0x10
+#define STAT_OAM_INT        0x20
+#define STAT_LYC_INT        0x40
+
+// IF bits
+#define VBLANK_INTERRUPT_BIT 0
+#define STAT_INTERRUPT_BIT 1
+
+/// DMG shades as ARGB8888, lightest first
+static const uint32_t ppu_shades[4] = { 0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555, 0xFF000000 };
+
+
+// =========================================================
+// Scanline renderer
+// =========================================================
+
+/**
+ * @brief Builds the ARGB8888 lookup table of a palette register
+ *
+ * @param palette: BGP, OBP0 or OBP1
+ * @param lut: receives the color of each index
+ *
+ * @returns void
+ */
+static void ppu_palette_lut(uint8_t palette, uint32_t lut[4]) {
+    for (int color = 0; color < 4; color++) {
+        lut[color] = ppu_shades[(palette >> (color * 2)) & 0x03];
+    }
+}
+
+/**
+ * @brief Decodes all 8 rows of a tile into the tile cache
+ *
+ * @param gb: emulator instance
+ * @param tile: tile index (0 - 383)
+ *
+ * @returns void
+ */
+static void ppu_decode_tile(gb_t* gb, int tile) {
+    gb->ppu.kernels->decode_tile(&gb->mmu.vram[tile * 16], &gb->ppu.tile_cache[tile][0][0]);
+    gb->ppu.tile_dirty[tile] = false;
+}
+
+/**
+ * @brief Decoded row of a tile, decoding the tile first if VRAM changed under it
+ *
+ * @param gb: emulator instance
+ * @param tile: tile index (0 - 383)
+ * @param row: row within the tile (0 - 7)
+ *
+ * @returns 8 color indices, leftmost pixel first
+ */
+static const uint8_t* ppu_tile_row(gb_t* gb, int tile, int row) {
+    if (gb->ppu.tile_dirty[tile]) {
+        ppu_decode_tile(gb, tile);
+    }
+    return gb->ppu.tile_cache[tile][row];
+}
+
+/**
+ * @brief Marks the decoded copy of a VRAM tile stale
+ *
+ * @param addr: address written (0x8000 - 0x97FF)
+ *
+ * @returns void
+ */
+void ppu_tile_written(gb_t* gb, uint16_t addr) {
+    gb->ppu.tile_dirty[(addr - 0x8000) >> 4] = true;
+}
+
+/**
+ * @brief Tile index of a BG/window tile, following the LCDC addressing mode
+ *
+ * @param lcdc: value of the LCDC register
+ * @param tile: tile number from the tile map
+ *
+ * @returns tile index (0 - 383)
+ */
+static int ppu_bg_tile_index(uint8_t lcdc, uint8_t tile) {
+    if (lcdc & LCDC_TILE_DATA) {
+        return tile;                    // 0x8000 - 0x8FFF
+    }
+    return 256 + (int8_t)tile;          // 0x8800 - 0x97FF, tile 0 at 0x9000
+}
+
+/**
+ * @brief Draws a run of BG or window tiles into the scanline
+ *
+ * @param gb: emulator instance
+ * @param line: color indices of the scanline
+ * @param x: first screen column to draw
+ * @param map: VRAM offset of the tile map (0x1800 or 0x1C00)
+ * @param src_x: map column shown at screen column x (wraps at 256)
+ * @param src_y: map row shown on this scanline
+ *
+ * @returns void
+ */
+static void ppu_render_tiles(gb_t* gb, uint8_t* line, int x, uint16_t map, uint8_t src_x, uint8_t src_y) {
+    const uint8_t* vram = gb->mmu.vram;
+    uint8_t lcdc = gb->mmu.io[REG_LCDC];
+    uint16_t map_row = map + (src_y >> 3) * 32;
+    int fine_y = src_y & 7;
+
+    while (x < SCREEN_WIDTH) {
+        int tile = ppu_bg_tile_index(lcdc, vram[map_row + (src_x >> 3)]);
+        const uint8_t* pixels = ppu_tile_row(gb, tile, fine_y);
+
+        // the first tile may start part way in when scrolled
+        for (int i = src_x & 7; i < 8 && x < SCREEN_WIDTH; i++) {
+            line[x++] = pixels[i];
+            src_x++;
+        }
+    }
+}
+
+/**
+ * @brief Draws up to 10 sprites of the current scanline over the BG
+ *
+ * @param gb: emulator instance
+ * @param bg_line: BG/window color indices, color 0 lets background priority sprites show through
+ * @param out: framebuffer row, overwritten where sprites are opaque
+ *
+ * @returns void
+ */
+static void ppu_render_sprites(gb_t* gb, const uint8_t* bg_line, uint32_t* out) {
+    const uint8_t* oam = gb->mmu.oam;
+    const uint8_t* io = gb->mmu.io;
+    int height = (io[REG_LCDC] & LCDC_OBJ_SIZE) ? 16 : 8;
+    int ly = gb->ppu.ly;
+
+    uint32_t obp_lut[2][4];
+    ppu_palette_lut(io[REG_OBP0], obp_lut[0]);
+    ppu_palette_lut(io[REG_OBP1], obp_lut[1]);
+
+    // OAM scan: the first 10 sprites covering this line, in OAM order
+    int visible[10];
+    int count = 0;
+    for (int i = 0; i < 40 && count < 10; i++) {
+        int top = oam[i * 4] - 16;
+        if (ly >= top && ly < top + height) {
+            visible[count++] = i;
+        }
+    }
+
+    // the lower X wins, ties go to the earlier OAM entry (stable insertion sort)
+    for (int i = 1; i < count; i++) {
+        int sprite = visible[i];
+        int j = i;
+        while (j > 0 && oam[visible[j - 1] * 4 + 1] > oam[sprite * 4 + 1]) {
+            visible[j] = visible[j - 1];
+            j--;
+        }
+        visible[j] = sprite;
+    }
+
+    // draw the lowest priority first so the winners end up on top
+    for (int n = count - 1; n >= 0; n--) {
+        const uint8_t* obj = &oam[visible[n] * 4];
+        int left = obj[1] - 8;
+        uint8_t tile = obj[2];
+        uint8_t attr = obj[3];
+
+        int row = ly - (obj[0] - 16);
+        if (attr & 0x40) {
+            row = height - 1 - row;     // Y flip
+        }
+        if (height == 16) {
+            tile &= 0xFE;               // 8x16 sprites ignore bit 0, the row runs into the next tile
+        }
+
+        const uint8_t* pixels = ppu_tile_row(gb, tile + (row >> 3), row & 7);
+
+        const uint32_t* lut = obp_lut[(attr & 0x10) ? 1 : 0];
+        for (int i = 0; i < 8; i++) {
+            int x = left + i;
+            if (x < 0 || x >= SCREEN_WIDTH) {
+                continue;
+            }
+
+            uint8_t color = (attr & 0x20) ? pixels[7 - i] : pixels[i];   // X flip
+            if (color == 0) {
+                continue;   // transparent
+            }
+            if ((attr & 0x80) && bg_line[x] != 0) {
+                continue;   // behind BG colors 1-3
+            }
+            out[x] = lut[color];
+        }
+    }
+}
+
+/**
+ * @brief Whether the window covers part of the current scanline
+ *
+ * @param gb: emulator instance
+ *
+ * @returns true once LY reaches WY with the window on and WX on screen
+ */
+static bool ppu_window_on_line(const gb_t* gb) {
+    const uint8_t* io = gb->mmu.io;
+    uint8_t lcdc = io[REG_LCDC];
+    return (lcdc & LCDC_BG_ENABLE) && (lcdc & LCDC_WINDOW_ENABLE) &&
+           gb->ppu.ly >= io[REG_WY] && io[REG_WX] - 7 < SCREEN_WIDTH;
+}
+
+/**
+ * @brief Renders the current scanline (LY) into the framebuffer
+ *
+ * @param gb: emulator instance
+ *
+ * @returns void
+ */
+static void ppu_render_line(gb_t* gb) {
+    const uint8_t* io = gb->mmu.io;
+    uint8_t lcdc = io[REG_LCDC];
+    uint8_t ly = gb->ppu.ly;
+
+    uint8_t bg_line[SCREEN_WIDTH];  // BG/window color indices, kept for sprite priority
+    uint32_t bg_lut[4];
+    uint32_t* out = &gb->ppu.framebuffer[ly * SCREEN_WIDTH];
+
+    if (lcdc & LCDC_BG_ENABLE) {
+        uint16_t bg_map = (lcdc & LCDC_BG_MAP) ? 0x1C00 : 0x1800;
+        ppu_render_tiles(gb, bg_line, 0, bg_map, io[REG_SCX], (uint8_t)(io[REG_SCY] + ly));
 
-// SDL rendering suite
-static SDL_Window* window = NULL;
-static SDL_Renderer* renderer = NULL;
-static SDL_Texture* texture = NULL;
-static uint32_t framebuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+        // the window covers everything right of WX - 7 once LY reaches WY
+        if (ppu_window_on_line(gb)) {
+            int window_x = io[REG_WX] - 7;
+            uint16_t window_map = (lcdc & LCDC_WINDOW_MAP) ? 0x1C00 : 0x1800;
+            int skip = window_x < 0 ? -window_x : 0;
+            ppu_render_tiles(gb, bg_line, window_x + skip, window_map, (uint8_t)skip, gb->ppu.window_line);
+        }
+
+        ppu_palette_lut(io[REG_BGP], bg_lut);
+    } else {
+        // BG disabled: blank (white) line, sprites still draw on top
+        memset(bg_line, 0, sizeof(bg_line));
+        ppu_palette_lut(0x00, bg_lut);
+    }
+
+    gb->ppu.kernels->expand_line(bg_line, bg_lut, out, SCREEN_WIDTH);
+
+    if (lcdc & LCDC_OBJ_ENABLE) {
+        ppu_render_sprites(gb, bg_line, out);
+    }
+}
+
+
+// =========================================================
+// Mode state machine
+// =========================================================
+
+/**
+ * @brief Re-evaluates the STAT interrupt line and requests STAT on its rising edge
+ *
+ * @param gb: emulator instance
+ *
+ * @returns void
+ */
+static void ppu_update_stat(gb_t* gb) {
+    uint8_t stat = gb->mmu.io[REG_STAT];
+    ppu_mode_t mode = gb->ppu.mode;
+    bool lcd_on = (gb->mmu.io[REG_LCDC] & LCDC_LCD_ENABLE) != 0;
+
+    bool line = lcd_on && (
+        ((stat & STAT_HBLANK_INT) && mode == PPU_MODE_HBLANK) ||
+        ((stat & STAT_VBLANK_INT) && mode == PPU_MODE_VBLANK) ||
+        ((stat & STAT_OAM_INT) && mode == PPU_MODE_OAM_SCAN) ||
+        ((stat & STAT_LYC_INT) && gb->ppu.ly == gb->mmu.io[REG_LYC]));
+
+    if (line && !gb->ppu.stat_line) {
+        gb->mmu.interrupt_flag |= (1 << STAT_INTERRUPT_BIT);
+    }
+    gb->ppu.stat_line = line;
+}
+
+/**
+ * @brief Dot at which the current mode ends
+ *
+ * @returns dot within the scanline
+ */
+static int ppu_mode_end(const ppu_t* ppu) {
+    switch (ppu->mode) {
+        case PPU_MODE_OAM_SCAN: return PPU_OAM_SCAN_END;
+        case PPU_MODE_DRAWING:  return PPU_DRAWING_END;
+        default:                return PPU_DOTS_PER_LINE;   // HBlank and VBlank run to the end of the line
+    }
+}
+
+/**
+ * @brief Moves on to the next mode once the current one has run out
+ *
+ * @param gb: emulator instance
+ *
+ * @returns void
+ */
+static void ppu_next_mode(gb_t* gb) {
+    ppu_t* ppu = &gb->ppu;
+
+    switch (ppu->mode) {
+        case PPU_MODE_OAM_SCAN:
+            ppu->mode = PPU_MODE_DRAWING;
+            break;
+
+        case PPU_MODE_DRAWING:
+            // the whole line is composed at once when drawing ends
+            if (ppu->framebuffer && ppu->render_frame) {
+                ppu_render_line(gb);
+            }
+            // the window line counter runs whether or not anything is drawn
+            if (ppu_window_on_line(gb)) {
+                ppu->window_line++;
+            }
+            ppu->mode = PPU_MODE_HBLANK;
+            break;
+
+        default:
+            // end of the scanline
+            ppu->dot = 0;
+            ppu->ly++;
+
+            if (ppu->ly == PPU_VBLANK_LINE) {
+                ppu->mode = PPU_MODE_VBLANK;
+                ppu->frame_ready = ppu->framebuffer && ppu->render_frame;
+                gb->mmu.interrupt_flag |= (1 << VBLANK_INTERRUPT_BIT);
+            } else if (ppu->ly == PPU_LINES_PER_FRAME) {
+                ppu->ly = 0;
+                ppu->window_line = 0;
+                ppu->mode = PPU_MODE_OAM_SCAN;
+
+                // pick whether the new frame is drawn
+                if (ppu->skip_countdown > 0) {
+                    ppu->skip_countdown--;
+                    ppu->render_frame = false;
+                } else {
+                    ppu->skip_countdown = ppu->render_skip;
+                    ppu->render_frame = true;
+                }
+            } else if (ppu->ly < PPU_VBLANK_LINE) {
+                ppu->mode = PPU_MODE_OAM_SCAN;
+            }
+            break;
+    }
+
+    ppu_update_stat(gb);
+}
 
 /**
- * init_ppu - See header.
+ * @brief Advances the PPU by a number of T-cycles
+ *
+ * @param cycles: T-cycles to advance by
+ *
+ * @returns void
  */
-void init_ppu() {
-    SDL_Init(SDL_INIT_VIDEO);
-    window = SDL_CreateWindow(
-        "GameBoy Emulator",
-        SDL_WINDOWPOS_UNDEFINED,
-        SDL_WINDOWPOS_UNDEFINED,
-        SCREEN_WIDTH * 2,
-        SCREEN_HEIGHT * 2,
-        0
-    );
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    texture = SDL_CreateTexture(
-        renderer,
-        SDL_PIXELFORMAT_ARGB8888,
-        SDL_TEXTUREACCESS_STREAMING,
-        SCREEN_WIDTH,
-        SCREEN_HEIGHT
-    );
-    memset(framebuffer, 0xFF, sizeof(framebuffer)); // White screen
+void ppu_step(gb_t* gb, int cycles) {
+    if (!(gb->mmu.io[REG_LCDC] & LCDC_LCD_ENABLE)) {
+        return; // LCD off, LY stays at 0
+    }
+
+    while (cycles > 0) {
+        int remaining = ppu_mode_end(&gb->ppu) - gb->ppu.dot;
+        if (cycles < remaining) {
+            gb->ppu.dot += cycles;
+            return;
+        }
+
+        cycles -= remaining;
+        gb->ppu.dot += remaining;
+        ppu_next_mode(gb);
+    }
 }
 
 /**
- * ppu_step - See header.
+ * @brief Schedules the next mode change
+ *
+ * @returns void
  */
-void ppu_step() {
-    // Placeholder for scanline rendering logic
-    // Eventually simulate LY, LCDC, STAT, etc.
+static void ppu_reschedule(gb_t* gb) {
+    if (!(gb->mmu.io[REG_LCDC] & LCDC_LCD_ENABLE)) {
+        scheduler_schedule(gb, SCHED_PPU, SCHED_NEVER);
+        return;
+    }
+    scheduler_schedule(gb, SCHED_PPU, gb->sched.now + (ppu_mode_end(&gb->ppu) - gb->ppu.dot));
 }
 
 /**
- * ppu_render_frame - See header.
+ * @brief Brings the PPU up to the scheduler clock
+ *
+ * @returns void
  */
-void ppu_render_frame() {
-    SDL_UpdateTexture(texture, NULL, framebuffer, SCREEN_WIDTH * sizeof(uint32_t));
-    SDL_RenderClear(renderer);
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-    SDL_RenderPresent(renderer);
+void ppu_sync(gb_t* gb) {
+    uint64_t now = gb->sched.now;
+    if (now > gb->ppu.synced_at) {
+        ppu_step(gb, (int)(now - gb->ppu.synced_at));
+        gb->ppu.synced_at = now;
+    }
+    ppu_reschedule(gb);
+}
+
+/**
+ * @brief Puts the PPU and the LCD registers in their post boot ROM state
+ *
+ * @returns void
+ */
+void ppu_reset(gb_t* gb) {
+    memset(&gb->ppu, 0, sizeof(gb->ppu));
+    gb->ppu.synced_at = gb->sched.now;
+
+    // nothing decoded yet
+    memset(gb->ppu.tile_dirty, true, sizeof(gb->ppu.tile_dirty));
+    gb->ppu.kernels = ppu_kernels_best();
+    gb->ppu.render_frame = true;
+
+    gb->mmu.io[REG_LCDC] = 0x91;    // LCD and BG on, tiles at 0x8000
+    gb->mmu.io[REG_BGP] = 0xFC;
+    gb->ppu.mode = PPU_MODE_OAM_SCAN;
+    ppu_reschedule(gb);
+}
+
+/**
+ * @brief Points the PPU at a caller-owned framebuffer (NULL renders nothing)
+ *
+ * @param framebuffer: SCREEN_WIDTH * SCREEN_HEIGHT ARGB8888 pixels, or NULL
+ *
+ * @returns void
+ */
+void ppu_set_framebuffer(gb_t* gb, uint32_t* framebuffer) {
+    gb->ppu.framebuffer = framebuffer;
+
+    // white screen until the first line is drawn
+    if (framebuffer) {
+        for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+            framebuffer[i] = ppu_shades[0];
+        }
+    }
+}
+
+/**
+ * @brief Renders only every (frames + 1)th frame, the frame in progress counting as rendered
+ *
+ * @param frames: frames to skip after each rendered one (0 renders every frame)
+ *
+ * @returns void
+ */
+void ppu_set_render_skip(gb_t* gb, int frames) {
+    gb->ppu.render_skip = frames > 0 ? frames : 0;
+    gb->ppu.skip_countdown = gb->ppu.render_skip;
+}
+
+/**
+ * @brief Reads an LCD register (0xFF40 - 0xFF4B)
+ *
+ * @param addr: register address
+ *
+ * @returns the up to date register value
+ */
+uint8_t ppu_read(gb_t* gb, uint16_t addr) {
+    ppu_sync(gb);
+
+    switch (addr) {
+        case 0xFF41: {
+            // bit 7 always reads 1, bits 0-2 are the live coincidence flag and mode
+            uint8_t coincidence = (gb->ppu.ly == gb->mmu.io[REG_LYC]) ? 0x04 : 0x00;
+            return 0x80 | (gb->mmu.io[REG_STAT] & 0x78) | coincidence | gb->ppu.mode;
+        }
+        case 0xFF44: return gb->ppu.ly;     // LY
+        default:     return gb->mmu.io[addr - 0xFF00];
+    }
+}
+
+/**
+ * @brief Writes an LCD register (0xFF40 - 0xFF4B)
+ *
+ * @param addr: register address
+ * @param value: value to be written
+ *
+ * @returns void
+ */
+void ppu_write(gb_t* gb, uint16_t addr, uint8_t value) {
+    // lines up to now are drawn with the old value (raster effects)
+    ppu_sync(gb);
+
+    switch (addr) {
+        case 0xFF40: {
+            bool was_on = (gb->mmu.io[REG_LCDC] & LCDC_LCD_ENABLE) != 0;
+            bool is_on = (value & LCDC_LCD_ENABLE) != 0;
+            gb->mmu.io[REG_LCDC] = value;
+
+            if (was_on != is_on) {
+                // switching the LCD either way restarts it at the top of the frame
+                gb->ppu.ly = 0;
+                gb->ppu.dot = 0;
+                gb->ppu.window_line = 0;
+                gb->ppu.mode = is_on ? PPU_MODE_OAM_SCAN : PPU_MODE_HBLANK;
+                LOG_PPU("LCD %s\n", is_on ? "on" : "off");
+            }
+            break;
+        }
+        case 0xFF41:
+            gb->mmu.io[REG_STAT] = value & 0x78;    // only the interrupt sources are writable
+            break;
+        case 0xFF44:
+            break;                                  // LY is read only
+        default:
+            gb->mmu.io[addr - 0xFF00] = value;
+            break;
+    }
+
+    // STAT sources or LYC may have changed
+    ppu_update_stat(gb);
+    ppu_reschedule(gb);
 }
@@ -0,0 +1,264 @@
+#include "ppu_kernels.h"
+
+#include <stddef.h>
+
+// SIMD variants need x86 and GCC/Clang (target attributes, __builtin_cpu_supports)
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PPU_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define PPU_KERNELS_X86 0
+#endif
+
+
+// =========================================================
+// Scalar (portable reference)
+// =========================================================
+
+/**
+ * @brief Splits every row of a 2bpp tile into 8 color indices
+ *
+ * @returns void
+ */
+static void decode_tile_scalar(const uint8_t* data, uint8_t* out) {
+    for (int row = 0; row < 8; row++) {
+        uint8_t lo = data[row * 2];
+        uint8_t hi = data[row * 2 + 1];
+        for (int i = 0; i < 8; i++) {
+            int bit = 7 - i;
+            out[row * 8 + i] = (((hi >> bit) & 1) << 1) | ((lo >> bit) & 1);
+        }
+    }
+}
+
+/**
+ * @brief Maps color indices to pixels one at a time
+ *
+ * @returns void
+ */
+static void expand_line_scalar(const uint8_t* index, const uint32_t lut[4], uint32_t* out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = lut[index[i] & 0x03];
+    }
+}
+
+static const ppu_kernels_t kernels_scalar = {
+    .name = "scalar",
+    .decode_tile = decode_tile_scalar,
+    .expand_line = expand_line_scalar,
+};
+
+
+#if PPU_KERNELS_X86
+
+// =========================================================
+// SSE2
+// =========================================================
+
+/**
+ * @brief Turns [lo x8 | hi x8] into the 8 color indices of the row (low 8 bytes)
+ *
+ * @returns the row in the low 8 bytes
+ */
+__attribute__((target("sse2")))
+static inline __m128i sse2_decode_row(__m128i planes) {
+    // one bit per byte lane, leftmost pixel (bit 7) first, for both bitplanes
+    const __m128i bit_mask = _mm_setr_epi8(
+        (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+        (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m128i weight = _mm_setr_epi8(1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2);
+
+    __m128i set = _mm_cmpeq_epi8(_mm_and_si128(planes, bit_mask), bit_mask);
+    __m128i bits = _mm_and_si128(set, weight);
+    return _mm_or_si128(bits, _mm_srli_si128(bits, 8));    // low plane + high plane
+}
+
+/**
+ * @brief Decodes a tile two rows per vector
+ *
+ * @returns void
+ */
+__attribute__((target("sse2")))
+static void decode_tile_sse2(const uint8_t* data, uint8_t* out) {
+    __m128i tile = _mm_loadu_si128((const __m128i*)data);  // lo0 hi0 lo1 hi1 ... lo7 hi7
+
+    // spread every byte 8 wide: [lo_r x8 | hi_r x8] per row
+    __m128i pairs[2] = { _mm_unpacklo_epi8(tile, tile), _mm_unpackhi_epi8(tile, tile) };
+    for (int half = 0; half < 2; half++) {
+        __m128i quads_lo = _mm_unpacklo_epi16(pairs[half], pairs[half]);
+        __m128i quads_hi = _mm_unpackhi_epi16(pairs[half], pairs[half]);
+
+        __m128i row0 = sse2_decode_row(_mm_unpacklo_epi32(quads_lo, quads_lo));
+        __m128i row1 = sse2_decode_row(_mm_unpackhi_epi32(quads_lo, quads_lo));
+        __m128i row2 = sse2_decode_row(_mm_unpacklo_epi32(quads_hi, quads_hi));
+        __m128i row3 = sse2_decode_row(_mm_unpackhi_epi32(quads_hi, quads_hi));
+
+        _mm_storeu_si128((__m128i*)(out + half * 32), _mm_unpacklo_epi64(row0, row1));
+        _mm_storeu_si128((__m128i*)(out + half * 32 + 16), _mm_unpacklo_epi64(row2, row3));
+    }
+}
+
+/**
+ * @brief Maps 4 color indices (one per dword lane) through the lookup table
+ *
+ * @returns the 4 pixels
+ */
+__attribute__((target("sse2")))
+static inline __m128i sse2_lookup(__m128i index, const __m128i lut[4]) {
+    __m128i pixels = _mm_and_si128(_mm_cmpeq_epi32(index, _mm_setzero_si128()), lut[0]);
+    pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi32(index, _mm_set1_epi32(1)), lut[1]));
+    pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi32(index, _mm_set1_epi32(2)), lut[2]));
+    pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi32(index, _mm_set1_epi32(3)), lut[3]));
+    return pixels;
+}
+
+/**
+ * @brief Maps color indices to pixels 16 at a time (no variable shuffle in SSE2, so compare and select)
+ *
+ * @returns void
+ */
+__attribute__((target("sse2")))
+static void expand_line_sse2(const uint8_t* index, const uint32_t lut[4], uint32_t* out, int count) {
+    const __m128i colors[4] = {
+        _mm_set1_epi32((int)lut[0]), _mm_set1_epi32((int)lut[1]),
+        _mm_set1_epi32((int)lut[2]), _mm_set1_epi32((int)lut[3]),
+    };
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i index_mask = _mm_set1_epi8(0x03);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_and_si128(_mm_loadu_si128((const __m128i*)(index + i)), index_mask);
+        __m128i words_lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i words_hi = _mm_unpackhi_epi8(bytes, zero);
+
+        _mm_storeu_si128((__m128i*)(out + i),      sse2_lookup(_mm_unpacklo_epi16(words_lo, zero), colors));
+        _mm_storeu_si128((__m128i*)(out + i + 4),  sse2_lookup(_mm_unpackhi_epi16(words_lo, zero), colors));
+        _mm_storeu_si128((__m128i*)(out + i + 8),  sse2_lookup(_mm_unpacklo_epi16(words_hi, zero), colors));
+        _mm_storeu_si128((__m128i*)(out + i + 12), sse2_lookup(_mm_unpackhi_epi16(words_hi, zero), colors));
+    }
+
+    expand_line_scalar(index + i, lut, out + i, count - i);
+}
+
+static const ppu_kernels_t kernels_sse2 = {
+    .name = "sse2",
+    .decode_tile = decode_tile_sse2,
+    .expand_line = expand_line_sse2,
+};
+
+
+// =========================================================
+// AVX2
+// =========================================================
+
+/**
+ * @brief Decodes a tile four rows per vector
+ *
+ * @returns void
+ */
+__attribute__((target("avx2")))
+static void decode_tile_avx2(const uint8_t* data, uint8_t* out) {
+    const __m256i bit_mask = _mm256_setr_epi8(
+        (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+        (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+        (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+        (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m256i weight = _mm256_setr_epi8(
+        1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2,
+        1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2);
+
+    __m256i tile = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)data));
+
+    // row pairs (2k in the low lane, 2k + 1 in the high lane) as [lo x8 | hi x8]
+    __m256i rows[4];
+    for (int k = 0; k < 4; k++) {
+        char lo0 = (char)(4 * k), hi0 = (char)(4 * k + 1);
+        char lo1 = (char)(4 * k + 2), hi1 = (char)(4 * k + 3);
+        __m256i spread = _mm256_setr_epi8(
+            lo0, lo0, lo0, lo0, lo0, lo0, lo0, lo0, hi0, hi0, hi0, hi0, hi0, hi0, hi0, hi0,
+            lo1, lo1, lo1, lo1, lo1, lo1, lo1, lo1, hi1, hi1, hi1, hi1, hi1, hi1, hi1, hi1);
+        __m256i planes = _mm256_shuffle_epi8(tile, spread);
+
+        __m256i set = _mm256_cmpeq_epi8(_mm256_and_si256(planes, bit_mask), bit_mask);
+        __m256i bits = _mm256_and_si256(set, weight);
+        rows[k] = _mm256_or_si256(bits, _mm256_srli_si256(bits, 8));   // row in the low 8 bytes of each lane
+    }
+
+    // [row0 row2 | row1 row3] -> [row0 row1 row2 row3]
+    __m256i first = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(rows[0], rows[1]), _MM_SHUFFLE(3, 1, 2, 0));
+    __m256i second = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(rows[2], rows[3]), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256((__m256i*)out, first);
+    _mm256_storeu_si256((__m256i*)(out + 32), second);
+}
+
+/**
+ * @brief Maps color indices to pixels 8 at a time with a variable permute
+ *
+ * @returns void
+ */
+__attribute__((target("avx2")))
+static void expand_line_avx2(const uint8_t* index, const uint32_t lut[4], uint32_t* out, int count) {
+    // vpermd looks at 3 index bits, repeat the table so 4 - 7 can never pick garbage
+    const __m256i table = _mm256_setr_epi32(
+        (int)lut[0], (int)lut[1], (int)lut[2], (int)lut[3],
+        (int)lut[0], (int)lut[1], (int)lut[2], (int)lut[3]);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(index + i)));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_permutevar8x32_epi32(table, lanes));
+    }
+
+    expand_line_scalar(index + i, lut, out + i, count - i);
+}
+
+static const ppu_kernels_t kernels_avx2 = {
+    .name = "avx2",
+    .decode_tile = decode_tile_avx2,
+    .expand_line = expand_line_avx2,
+};
+
+#endif // PPU_KERNELS_X86
+
+
+// =========================================================
+// Runtime dispatch
+// =========================================================
+
+/**
+ * @brief Kernel table for one instruction set
+ *
+ * @param isa: instruction set
+ *
+ * @returns the table, NULL if it is not compiled in or the CPU lacks the instruction set
+ */
+const ppu_kernels_t* ppu_kernels_for(ppu_kernel_isa_t isa) {
+    switch (isa) {
+        case PPU_KERNELS_SCALAR:
+            return &kernels_scalar;
+#if PPU_KERNELS_X86
+        case PPU_KERNELS_SSE2:
+            return __builtin_cpu_supports("sse2") ? &kernels_sse2 : NULL;
+        case PPU_KERNELS_AVX2:
+            return __builtin_cpu_supports("avx2") ? &kernels_avx2 : NULL;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Fastest kernel table the running CPU supports
+ *
+ * @returns the table (never NULL)
+ */
+const ppu_kernels_t* ppu_kernels_best() {
+    for (int isa = PPU_KERNELS_ISA_COUNT - 1; isa > PPU_KERNELS_SCALAR; isa--) {
+        const ppu_kernels_t* kernels = ppu_kernels_for((ppu_kernel_isa_t)isa);
+        if (kernels) {
+            return kernels;
+        }
+    }
+    return &kernels_scalar;
+}
@@ -1,30 +1,64 @@
 #include "timer.h"
-#include "mmu.h"
-#include "cpu.h"
+#include "gb.h"
 
-// Allow this file to access the global mmu and cpu state
-extern mmu_t mmu;
-extern CPU cpu;
 
 // The timer interrupt is on bit 2 of the IF register
 #define TIMER_INTERRUPT_BIT 2
 
 /**
- * @brief 
- * 
+ * @brief Bit of the internal counter whose falling edge clocks TIMA
+ *
+ * @param tac: value of the TAC register
+ *
+ * @returns bit index (3, 5, 7 or 9)
+ */
+static int timer_edge_bit(uint8_t tac) {
+    switch (tac & 0x03) {
+        case 0: return 9;  // 4096 Hz
+        case 1: return 3;  // 262144 Hz
+        case 2: return 5;  // 65536 Hz
+        default: return 7; // 16384 Hz
+    }
+}
+
+/**
+ * @brief Applies any number of TIMA increments at once
+ *
+ * @param increments: falling edges of the selected counter bit
+ *
+ * @returns void
+ */
+static void timer_add_increments(gb_t* gb, uint32_t increments) {
+    uint32_t to_overflow = 0x100 - gb->mmu.tima;
+    if (increments < to_overflow) {
+        gb->mmu.tima += increments;
+        return;
+    }
+
+    // after the first overflow TIMA restarts from TMA and wraps every 0x100 - TMA increments
+    increments -= to_overflow;
+    gb->mmu.tima = gb->mmu.tma + increments % (0x100 - gb->mmu.tma);
+
+    // one IF bit, however many overflows the span held
+    gb->mmu.interrupt_flag |= (1 << TIMER_INTERRUPT_BIT);
+}
+
+/**
+ * @brief Advances DIV and TIMA by a span of T-cycles in constant time
+ *
  * @param cycles :number of CPU cycles
- * 
+ *
  * @returns void
  */
-void timer_step(int cycles) {
+void timer_step(gb_t* gb, int cycles) {
     // 1. Handle the DIV register
     // The internal 16-bit counter increments every 4 T-cycles.
     // Since our `cycles` are already T-cycles, we just add them.
-    uint16_t old_timer = mmu.internal_timer;
-    mmu.internal_timer += cycles;
+    uint16_t old_timer = gb->mmu.internal_timer;
+    gb->mmu.internal_timer += cycles;
 
     // Checks if the timer is enabled in the TAC register
-    bool timer_enabled = (mmu.tac & 0x04) != 0;
+    bool timer_enabled = (gb->mmu.tac & 0x04) != 0;
     if (!timer_enabled) {
         return;
     }
@@ -32,27 +66,86 @@ void timer_step(int cycles) {
     // 3. Determine which bit of the internal counter to check for TIMA increment
     // This is the tricky part that makes the timer cycle-accurate.
     // TIMA increments on a "falling edge" of a specific bit in the internal counter.
-    int bit_to_check = 0;
-    switch (mmu.tac & 0x03) {
-        case 0: bit_to_check = 9; break;  // 4096 Hz
-        case 1: bit_to_check = 3; break;  // 262144 Hz
-        case 2: bit_to_check = 5; break;  // 65536 Hz
-        case 3: bit_to_check = 7; break;  // 16384 Hz
+    int bit_to_check = timer_edge_bit(gb->mmu.tac);
+
+    // Count the falling edges: the bit falls every time the counter crosses
+    // a multiple of 2^(bit + 1), so larger steps can contain several of them.
+    uint32_t span_end = (uint32_t)old_timer + (uint32_t)cycles;
+    uint32_t edges = (span_end >> (bit_to_check + 1)) - (old_timer >> (bit_to_check + 1));
+
+    // every falling edge increments TIMA, an overflow reloads TMA and requests the interrupt
+    timer_add_increments(gb, edges);
+}
+
+/**
+ * @brief Schedules the next TIMA overflow, the only time the timer changes IF
+ *
+ * @returns void
+ */
+static void timer_reschedule(gb_t* gb) {
+    if ((gb->mmu.tac & 0x04) == 0) {
+        scheduler_schedule(gb, SCHED_TIMER, SCHED_NEVER);  // TIMA is stopped, only DIV runs
+        return;
     }
 
-    // Check for the falling edge: was the bit 1 before, and is it 0 now?
-    bool was_set = (old_timer >> bit_to_check) & 1;
-    bool is_set = (mmu.internal_timer >> bit_to_check) & 1;
-
-    if (was_set && !is_set) {
-        // Falling edge detected! Increment TIMA.
-        mmu.tima++;
-        if (mmu.tima == 0) { // Check for overflow (0xFF -> 0x00)
-            // On overflow, reload TIMA with the value from TMA
-            mmu.tima = mmu.tma;
-            
-            // And request a timer interrupt
-            mmu.interrupt_flag |= (1 << TIMER_INTERRUPT_BIT);
-        }
+    // the edge bit falls every time the counter crosses a multiple of 2^(bit + 1),
+    // TIMA overflows on the (0x100 - TIMA)th edge from here
+    uint32_t period = 1u << (timer_edge_bit(gb->mmu.tac) + 1);
+    uint32_t until_edge = period - (gb->mmu.internal_timer & (period - 1));
+    uint32_t increments = 0x100 - gb->mmu.tima;
+    scheduler_schedule(gb, SCHED_TIMER, gb->sched.now + until_edge + (uint64_t)(increments - 1) * period);
+}
+
+/**
+ * @brief Brings the timer up to the scheduler clock
+ *
+ * @returns void
+ */
+void timer_sync(gb_t* gb) {
+    uint64_t now = gb->sched.now;
+    if (now > gb->mmu.timer_synced_at) {
+        timer_step(gb, (int)(now - gb->mmu.timer_synced_at));
+        gb->mmu.timer_synced_at = now;
     }
-}
\ No newline at end of file
+    timer_reschedule(gb);
+}
+
+/**
+ * @brief Reads a timer register (0xFF04 - 0xFF07)
+ *
+ * @param addr: register address
+ *
+ * @returns the up to date register value
+ */
+uint8_t timer_read(gb_t* gb, uint16_t addr) {
+    timer_sync(gb);
+
+    switch (addr) {
+        case 0xFF04: return gb->mmu.internal_timer >> 8;    // DIV
+        case 0xFF05: return gb->mmu.tima;                   // TIMA
+        case 0xFF06: return gb->mmu.tma;                    // TMA
+        default:     return gb->mmu.tac;                    // TAC
+    }
+}
+
+/**
+ * @brief Writes a timer register (0xFF04 - 0xFF07)
+ *
+ * @param addr: register address
+ * @param value: value to be written
+ *
+ * @returns void
+ */
+void timer_write(gb_t* gb, uint16_t addr, uint8_t value) {
+    timer_sync(gb);
+
+    switch (addr) {
+        case 0xFF04: gb->mmu.internal_timer = 0; break;     // any write to DIV resets the timer
+        case 0xFF05: gb->mmu.tima = value; break;           // TIMA
+        case 0xFF06: gb->mmu.tma = value; break;            // TMA
+        default:     gb->mmu.tac = value; break;            // TAC
+    }
+
+    // DIV and TAC writes move the next edge
+    timer_reschedule(gb);
+}
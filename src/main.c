@@ -1,12 +1,68 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdbool.h> 
-#include "cpu.h"
-#include "mmu.h"
-#include "timer.h"
-#include "interrupts.h"
+#include <signal.h>
+#include "gb.h"
+#include "emu.h"
+#include "video.h"
 
-// TODO ppu.h, and timer.h
+// the PPU renders into this, owned by the frontend
+static uint32_t framebuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
 
+// set by SIGUSR1, asks the main loop for an opcode profile report
+static volatile sig_atomic_t opstats_requested = 0;
+
+#ifdef SIGUSR1
+static void request_opstats(int signal_number) {
+    (void)signal_number;
+    opstats_requested = 1;
+}
+#endif
+
+/**
+ * @brief Writes the opcode profile report
+ *
+ * @param path: output file, "-" for stdout
+ *
+ * @returns void
+ */
+static void write_opstats(const gb_t* gb, const char* path) {
+    FILE* out = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Failed to write the opcode profile to '%s'.\n", path);
+        return;
+    }
+    opstats_report(gb, out, 0);
+    if (out != stdout) {
+        fclose(out);
+    }
+}
+
+
+/**
+ * @brief Prints the command line help
+ *
+ * @param program: argv[0]
+ *
+ * @returns void
+ */
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [--video <backend>] [--frames <count>] [--frame-skip <count>] [--no-idle-skip] [--trace <file>] [--opstats <file>] [--profile <file>] <ROM file>\n", program);
+    fprintf(stderr, "  --video   sdl or headless (default: %s)\n", video_default()->name);
+    fprintf(stderr, "  --frames  stop after this many frames (default: run until closed)\n");
+    fprintf(stderr, "  --frame-skip  frames skipped after every rendered one (default: 0)\n");
+    fprintf(stderr, "  --no-idle-skip  run polling loops instruction by instruction\n");
+    fprintf(stderr, "  --trace   keep the last %u instructions, written to <file> on a CPU fault or exit\n", TRACE_DEFAULT_CAPACITY);
+    fprintf(stderr, "            (needs a build with GBCEE_TRACE, decode with gbcee_trace)\n");
+    fprintf(stderr, "  --opstats per-opcode counts and cycles, written to <file> ('-' for stdout) at exit\n");
+    fprintf(stderr, "            and on SIGUSR1 (needs a build with GBCEE_OPSTATS)\n");
+    fprintf(stderr, "  --profile sample the game's PC and call stack, folded stacks written to <file> at exit\n");
+    fprintf(stderr, "            (needs a build with GBCEE_PROFILER)\n");
+    fprintf(stderr, "  --profile-sym     RGBDS .sym file to name the sampled code with\n");
+    fprintf(stderr, "  --profile-flat    write a flat per-function profile instead of folded stacks\n");
+    fprintf(stderr, "  --profile-period  T-cycles between samples (default: %d)\n", PROFILER_DEFAULT_PERIOD);
+}
 
 /**
  * @brief main:
@@ -21,57 +77,169 @@
  * 0 on success, non-zero on failure.
  */
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <ROM file>\n", argv[0]);
+    const video_backend_t* video = video_default();
+    const char* rom_path = NULL;
+    long max_frames = 0;    // 0 = no limit
+    int frame_skip = 0;
+    bool idle_skip = true;
+    const char* trace_path = NULL;
+    const char* opstats_path = NULL;
+    const char* profile_path = NULL;
+    const char* profile_sym_path = NULL;
+    bool profile_flat = false;
+    uint32_t profile_period = 0;    // 0 = PROFILER_DEFAULT_PERIOD
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--video") == 0 && i + 1 < argc) {
+            video = video_find(argv[++i]);
+            if (!video) {
+                fprintf(stderr, "Error: Video backend '%s' is not available in this build.\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--frame-skip") == 0 && i + 1 < argc) {
+            frame_skip = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-idle-skip") == 0) {
+            idle_skip = false;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--opstats") == 0 && i + 1 < argc) {
+            opstats_path = argv[++i];
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (strcmp(argv[i], "--profile-sym") == 0 && i + 1 < argc) {
+            profile_sym_path = argv[++i];
+        } else if (strcmp(argv[i], "--profile-flat") == 0) {
+            profile_flat = true;
+        } else if (strcmp(argv[i], "--profile-period") == 0 && i + 1 < argc) {
+            profile_period = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (argv[i][0] != '-' && !rom_path) {
+            rom_path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!rom_path) {
+        print_usage(argv[0]);
         return 1;
     }
 
     // should follow emulator lifecycle:
     // initialize hardware -> load the game -> run main loop -> clean up resources 
 
-    // 1. Initialize hardware
-    mmu_init();
-    cpu_reset();
-    // ppu_init();   // placeholder for initializing the Picture Processing Unit 
-    // timer_init(); // placeholder for initializing the timer
+    // 1. Initialize hardware (mmu_init + cpu_reset)
+    gb_t* gb = gb_create();
+    if (!gb) {
+        fprintf(stderr, "Error: Failed to allocate the emulator.\n");
+        return 1;
+    }
+    ppu_set_framebuffer(gb, framebuffer);
+    ppu_set_render_skip(gb, frame_skip);
+    gb->idle.enabled = idle_skip;
+
+    // the core dumps the ring itself on a fault, the rest is written at exit
+    if (trace_path) {
+        if (!trace_enable(gb, TRACE_DEFAULT_CAPACITY)) {
+            fprintf(stderr, "Error: Tracing is not available in this build (configure with -DGBCEE_TRACE=ON).\n");
+            gb_destroy(gb);
+            return 1;
+        }
+        gb->trace.dump_path = trace_path;
+    }
+
+    if (opstats_path) {
+        if (!opstats_enable(gb)) {
+            fprintf(stderr, "Error: Opcode profiling is not available in this build (configure with -DGBCEE_OPSTATS=ON).\n");
+            gb_destroy(gb);
+            return 1;
+        }
+#ifdef SIGUSR1
+        signal(SIGUSR1, request_opstats);
+#endif
+    }
+
+    profiler_symbols_t* profile_symbols = NULL;
+    if (profile_path) {
+        if (!profiler_enable(gb, profile_period)) {
+            fprintf(stderr, "Error: Profiling is not available in this build (configure with -DGBCEE_PROFILER=ON).\n");
+            gb_destroy(gb);
+            return 1;
+        }
+        if (profile_sym_path && !(profile_symbols = profiler_load_symbols(profile_sym_path))) {
+            fprintf(stderr, "Error: Failed to read the symbol file '%s'.\n", profile_sym_path);
+            gb_destroy(gb);
+            return 1;
+        }
+    }
 
     // 2. Load the game rom
     // only call mmu_load_rom and not load_rom
-    if (mmu_load_rom(argv[1]) != 0) {
-        fprintf(stderr, "Error: Failed to load ROM '%s'.\n", argv[1]);
+    if (mmu_load_rom(gb, rom_path) != 0) {
+        fprintf(stderr, "Error: Failed to load ROM '%s'.\n", rom_path);
+        gb_destroy(gb);
+        profiler_free_symbols(profile_symbols);
+        return 1;
+    }
+
+    // 3. Open the video output the PPU frames go to
+    if (!video->init()) {
+        fprintf(stderr, "Error: Failed to open the '%s' video output.\n", video->name);
+        gb_destroy(gb);
+        profiler_free_symbols(profile_symbols);
         return 1;
     }
 
     // Main emulation loop
     printf(" --- Starting Emulation --- \n");
-    while (true) { 
-        /** Execute one instruction per cycle 
-         * cpu step handles the halted state internally
-         * doesnt fetch an opcode for halting
+    long frames = 0;
+    while (!gb->cpu.stopped && video->poll() && (max_frames == 0 || frames < max_frames)) { 
+        /** Run one frame per iteration
+         * cpu_run_cycles (via emu_run_frame) executes the instructions and
+         * syncs the timer, PPU and interrupts in the same batch
+         * gb->cpu.stopped is set when the cpu hits an illegal opcode
         */
-        int cycles_this_step = cpu_step();
-
-        // check if the STOP instruction has been executed
-        // if (cpu.stopped) {
-        //     break;
-        // }
+        emu_run_frame(gb);
+        frames++;
 
-        // check if the cpu has halted and has 0 cycless this step
-        if (cycles_this_step == 0) {
-            break;
+        // show the frame once the PPU has finished it (never set for skipped frames)
+        if (gb->ppu.frame_ready) {
+            video->present(framebuffer);
+            gb->ppu.frame_ready = false;
         }
 
-        // update other hardware components with the elapsed cycles
-        timer_step(cycles_this_step);
-        // PLACEHOLDER: Future hardware steps will go here.
-        // ppu_step(cycles_from_cpu);
-
-        // Check for interrupts after all hardware has been updated
-        handle_interrupts();
+        if (opstats_requested) {
+            opstats_requested = 0;
+            write_opstats(gb, opstats_path);
+        }
     }
     
+    if (trace_path && !gb->cpu.stopped && trace_dump(gb, trace_path) != 0) {
+        fprintf(stderr, "Error: Failed to write the trace to '%s'.\n", trace_path);
+    }
+    if (opstats_path) {
+        write_opstats(gb, opstats_path);
+    }
+    if (profile_path) {
+        FILE* out = fopen(profile_path, "w");
+        if (!out) {
+            fprintf(stderr, "Error: Failed to write the profile to '%s'.\n", profile_path);
+        } else {
+            if (profile_flat) {
+                profiler_write_flat(gb, out, profile_symbols, 0);
+            } else {
+                profiler_write_folded(gb, out, profile_symbols);
+            }
+            fclose(out);
+        }
+        profiler_free_symbols(profile_symbols);
+    }
+
     // 4. cleanup  
     printf(" --- Emulation Halted --- ");
-    mmu_free(); // prevent memory leaks from loaded roms
+    video->shutdown();
+    gb_destroy(gb); // prevent memory leaks from loaded roms
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,117 @@
+#include "movie.h"
+#include "joypad.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/**
+ * @brief Parses a button list such as "A+START" or "-"
+ *
+ * @param text: button list
+ * @param out_buttons: receives the JOYPAD_* mask
+ *
+ * @returns true on success, false on an unknown button name
+ */
+bool movie_parse_buttons(const char* text, uint8_t* out_buttons) {
+    static const struct { const char* name; uint8_t mask; } names[] = {
+        { "A", JOYPAD_A }, { "B", JOYPAD_B }, { "SELECT", JOYPAD_SELECT }, { "START", JOYPAD_START },
+        { "RIGHT", JOYPAD_RIGHT }, { "LEFT", JOYPAD_LEFT }, { "UP", JOYPAD_UP }, { "DOWN", JOYPAD_DOWN },
+    };
+
+    *out_buttons = 0;
+    if (strcmp(text, "-") == 0) {
+        return true;
+    }
+
+    char token[16];
+    const char* p = text;
+    while (*p) {
+        size_t len = 0;
+        while (p[len] && p[len] != '+') {
+            len++;
+        }
+        if (len == 0 || len >= sizeof(token)) {
+            return false;
+        }
+        for (size_t i = 0; i < len; i++) {
+            token[i] = (char)toupper((unsigned char)p[i]);
+        }
+        token[len] = '\0';
+
+        bool found = false;
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (strcmp(token, names[i].name) == 0) {
+                *out_buttons |= names[i].mask;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+
+        p += len;
+        if (*p == '+') {
+            p++;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Loads a movie file
+ *
+ * @param path: movie file
+ * @param out_count: receives the number of events
+ *
+ * @returns malloc'd events sorted by frame, NULL with *out_count == -1 on failure
+ */
+movie_event_t* movie_load(const char* path, int* out_count) {
+    *out_count = -1;
+
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return NULL;
+    }
+
+    movie_event_t* events = NULL;
+    int count = 0, capacity = 0, last_frame = -1;
+    char line[256];
+
+    while (fgets(line, sizeof(line), f)) {
+        int frame;
+        char buttons_text[128];
+        if (line[0] == '#' || sscanf(line, "%d %127s", &frame, buttons_text) != 2) {
+            continue; // comment or blank line
+        }
+
+        uint8_t buttons;
+        if (frame <= last_frame || !movie_parse_buttons(buttons_text, &buttons)) {
+            fprintf(stderr, "%s: bad movie line: %s", path, line);
+            free(events);
+            fclose(f);
+            return NULL;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            movie_event_t* grown = realloc(events, capacity * sizeof(movie_event_t));
+            if (!grown) {
+                free(events);
+                fclose(f);
+                return NULL;
+            }
+            events = grown;
+        }
+        events[count].frame = frame;
+        events[count].buttons = buttons;
+        count++;
+        last_frame = frame;
+    }
+
+    fclose(f);
+    *out_count = count;
+    return events;
+}
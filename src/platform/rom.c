@@ -1,19 +1,196 @@
 #include "rom.h"
 #include "mmu.h"
+#include "debug.h"
 #include <stdio.h>
 #include <string.h> //for memset()
 #include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 // removed extern rom array to prevent external exposure to rom 
 
+/// one ROM file held by the process-wide cache
+struct rom_image_t {
+    char* path;
+    uint8_t* data;
+    size_t size;                // image size, a power of two >= 32KB
+    size_t file_size;           // size of the file on disk
+    uint8_t header_checksum;    // 0x014D
+    uint16_t global_checksum;   // 0x014E - 0x014F
+    mbc_type_t mbc_type;
+    bool mapped;                // mmap'd (true) or a heap copy (false)
+    int refcount;               // instances currently using the image
+    struct rom_image_t* next;
+};
+
+// every image in use, shared by all emulator instances of the process
+static rom_image_t* rom_cache = NULL;
+static pthread_mutex_t rom_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
 /**
- * @brief load_rom - Loads a ROM file into memory starting at 0x0100.
+ * @brief Maps the cartridge type byte (0x0147) to an MBC type
  *
- * @param path Path to the ROM file.
+ * @param mbc_code: cartridge type byte
+ *
+ * @returns the detected MBC type
+ */
+static mbc_type_t rom_parse_mbc(uint8_t mbc_code) {
+    switch(mbc_code) {
+        // allocating cartrigde type bytes from the rom header
+        
+        // No-MBC
+        case 0x00: return MBC_TYPE_NONE;
+
+        // --- MBC 1 ---
+        case 0x01: // MBC1 
+        case 0x02: // MBC1 + RAM
+        case 0x03: // MBC1 + BATTERY
+            return MBC_TYPE_MBC1;
+
+        // --- MBC2 ---
+        case 0x05: // MBC2
+        case 0x06: // MBC2 + BATTERY
+            // return MBC_TYPE_MBC2; // UNCOMMENT after mbc 2 implementation
+            return MBC_TYPE_UNKNOWN;
+
+        // --- MBC 3 --- 
+        case 0x0F: // MBC3 + TIMER + BATTERY
+        case 0x10: // MBC3 + TIMER + RAM + BATTERY
+        case 0x11: // MBC3
+        case 0x12: // MBC3 + RAM 
+        case 0x13: // MBC3 + RAM + BATTERY
+            return MBC_TYPE_MBC3;
+
+        // --- MBC 5 --- 
+        case 0x19: // MBC 5 
+        case 0x1A: // MBC5 + RAM
+        case 0x1B: // MBC5 + RAM + BATTERY
+        case 0x1C: // MBC5 + RUMBLE
+        case 0x1D: // MBC5 + RUMBLE + RAM
+        case 0x1E: // MBC5 + RUMBLE + RAM + BATTERY
+            return MBC_TYPE_MBC5;
+
+        // --- uncommon MBC types ---
+        case 0x08: // ROM + RAM
+        case 0x09: // ROM + RAM + BATTERY
+            return MBC_TYPE_NONE; // behaves like ROM_ONLY but has RAM lol
+
+        default: return MBC_TYPE_UNKNOWN;
+    }
+}
+
+
+/**
+ * @brief rom_header_rom_size - Decodes the ROM size byte (0x0148)
+ *
+ * @param size_code: ROM size byte
+ *
+ * @returns the ROM size in bytes, 0 for an unknown code
+ */
+size_t rom_header_rom_size(uint8_t size_code) {
+    // 32KB << n, 2 banks up to 512 banks (8MB)
+    return (size_code <= 0x08) ? ((size_t)0x8000 << size_code) : 0;
+}
+
+
+/**
+ * @brief rom_header_ram_size - Decodes the external RAM size byte (0x0149)
+ *
+ * @param size_code: RAM size byte
+ *
+ * @returns the external RAM size in bytes, 0 if the cartridge has none
+ */
+size_t rom_header_ram_size(uint8_t size_code) {
+    switch (size_code) {
+        case 0x01: return 0x800;        // 2KB (unofficial, some homebrew)
+        case 0x02: return 0x2000;       // 8KB, 1 bank
+        case 0x03: return 0x8000;       // 32KB, 4 banks
+        case 0x04: return 0x20000;      // 128KB, 16 banks
+        case 0x05: return 0x10000;      // 64KB, 8 banks
+        default:   return 0;            // no RAM
+    }
+}
+
+
+/**
+ * @brief Size of the image a ROM file is loaded into
+ *
+ * @details Rounded up to a power of two so the MBC can wrap bank numbers with
+ * a mask instead of bounds checking every read. Covers whatever the header
+ * declares too, so truncated dumps still have every bank addressable.
+ *
+ * @param file_size: size of the file on disk
+ * @param size_code: ROM size byte (0x0148)
+ *
+ * @returns image size in bytes
+ */
+static size_t rom_image_size(size_t file_size, uint8_t size_code) {
+    size_t declared = rom_header_rom_size(size_code);
+    size_t size = 0x8000;
+    while (size < file_size || size < declared) {
+        size <<= 1;
+    }
+    return size;
+}
+
+
+/**
+ * @brief Maps a ROM file read-only into memory
+ *
+ * @details Uses a private read-only mmap where available, so the image is
+ * backed by the page cache and never copied. Other platforms read the file
+ * into a heap buffer instead.
+ *
+ * @param path: path to the ROM file
+ * @param out_data: receives the image
+ * @param out_size: receives the image size
+ * @param out_mapped: receives whether the image is mmap'd
  *
  * @returns 1 on success, 0 on failure.
  */
-int load_rom(const char* path, uint8_t** out_rom_data, size_t* out_rom_size, mbc_type_t* out_mbc_type) {
+static int rom_map_file(const char* path, uint8_t** out_data, size_t* out_size, bool* out_mapped) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("ROM open failed");
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("ROM stat failed");
+        close(fd);
+        return 0;
+    }
+
+    // checking the minimal size of a valid header
+    size_t size = (size_t)st.st_size;
+    if (size < 0x150) {
+        fprintf(stderr, "ROM File is too small.\n");
+        close(fd);
+        return 0;
+    }
+
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (data == MAP_FAILED) {
+        perror("ROM mmap failed");
+        return 0;
+    }
+
+    *out_data = (uint8_t*)data;
+    *out_size = size;
+    *out_mapped = true;
+    return 1;
+#else
     FILE* f = fopen(path, "rb");
     if (!f) {
         perror("ROM open failed");
@@ -45,62 +222,179 @@ int load_rom(const char* path, uint8_t** out_rom_data, size_t* out_rom_size, mbc
         free(buffer);
         return 0;
     }
+    fclose(f);
 
-    /* Parsing the file */
-    uint8_t mbc_code = buffer[0x147];
-    switch(mbc_code) {
-        // allocating cartrigde type bytes from the rom header
-        
-        // No-MBC
-        case 0x00: *out_mbc_type = MBC_TYPE_NONE; break;
+    *out_data = buffer;
+    *out_size = size;
+    *out_mapped = false;
+    return 1;
+#endif
+}
 
-        // --- MBC 1 ---
-        case 0x01: // MBC1 
-        case 0x02: // MBC1 + RAM
-        case 0x03: // MBC1 + BATTERY
-            *out_mbc_type = MBC_TYPE_MBC1;
-            break;
 
-        // --- MBC2 ---
-        case 0x05: // MBC2
-        case 0x06: // MBC2 + BATTERY
-            // *out_mbc_type = MBC_TYPE_MBC2; // UNCOMMENT after mbc 2 implementation
-            *out_mbc_type = MBC_TYPE_UNKNOWN;
-            break;
+/**
+ * @brief Undoes rom_map_file
+ *
+ * @returns void
+ */
+static void rom_unmap_file(uint8_t* data, size_t size, bool mapped) {
+#ifndef _WIN32
+    if (mapped) {
+        munmap(data, size);
+        return;
+    }
+#endif
+    (void)size;
+    (void)mapped;
+    free(data);
+}
 
-        // --- MBC 3 --- 
-        case 0x0F: // MBC3 + TIMER + BATTERY
-        case 0x10: // MBC3 + TIMER + RAM + BATTERY
-        case 0x11: // MBC3
-        case 0x12: // MBC3 + RAM 
-        case 0x13: // MBC3 + RAM + BATTERY
-            *out_mbc_type = MBC_TYPE_MBC3;
-            break;
 
-        // --- MBC 5 --- 
-        case 0x19: // MBC 5 
-        case 0x1A: // MBC5 + RAM
-        case 0x1B: // MBC5 + RAM + BATTERY
-        case 0x1C: // MBC5 + RUMBLE
-        case 0x1D: // MBC5 + RUMBLE + RAM
-        case 0x1E: // MBC5 + RUMBLE + RAM + BATTERY
-            *out_mbc_type = MBC_TYPE_MBC5;
-            break;
+/**
+ * @brief Replaces a mapped file by a heap copy padded with 0xFF up to image_size
+ *
+ * @param data: mapped file, released on success
+ * @param file_size: size of the mapped file
+ * @param image_size: size of the padded copy
+ * @param mapped: whether data is mmap'd, cleared on success
+ *
+ * @returns the padded copy, NULL on failure (data is left untouched)
+ */
+static uint8_t* rom_pad_image(uint8_t* data, size_t file_size, size_t image_size, bool* mapped) {
+    uint8_t* padded = malloc(image_size);
+    if (!padded) {
+        return NULL;
+    }
 
-        // --- uncommon MBC types ---
-        case 0x08: // ROM + RAM
-        case 0x09: // ROM + RAM + BATTERY
-            *out_mbc_type = MBC_TYPE_NONE; // behaves like ROM_ONLY but has RAM lol
-            break;
+    // missing banks read as open bus
+    memcpy(padded, data, file_size);
+    memset(padded + file_size, 0xFF, image_size - file_size);
+
+    rom_unmap_file(data, file_size, *mapped);
+    *mapped = false;
+    return padded;
+}
+
+
+/**
+ * @brief load_rom - Acquires a ROM image through the process-wide cache.
+ *
+ * @param path Path to the ROM file.
+ *
+ * @returns 1 on success, 0 on failure.
+ */
+int load_rom(const char* path, rom_image_t** out_image, uint8_t** out_rom_data, size_t* out_rom_size, mbc_type_t* out_mbc_type) {
+    uint8_t* data;
+    size_t file_size;
+    bool mapped;
 
-        default: *out_mbc_type = MBC_TYPE_UNKNOWN; break;
+    // mapping is cheap (no copy), and the header checksums are needed for the lookup
+    if (!rom_map_file(path, &data, &file_size, &mapped)) {
+        return 0;
     }
 
-    /* Setting output preferences */
-    *out_rom_data = buffer;
-    *out_rom_size = size;
+    uint8_t header_checksum = data[0x14D];
+    uint16_t global_checksum = (data[0x14E] << 8) | data[0x14F];
+
+    pthread_mutex_lock(&rom_cache_lock);
+
+    rom_image_t* image = rom_cache;
+    while (image && !(image->file_size == file_size &&
+                      image->header_checksum == header_checksum &&
+                      image->global_checksum == global_checksum &&
+                      strcmp(image->path, path) == 0)) {
+        image = image->next;
+    }
 
-    printf("Loaded %zu bytes from %s\n", size, path);
+    if (image) {
+        // same game already loaded: share it and drop the mapping we just made
+        image->refcount++;
+        pthread_mutex_unlock(&rom_cache_lock);
+        rom_unmap_file(data, file_size, mapped);
+    } else {
+        size_t size = rom_image_size(file_size, data[0x148]);
+        uint8_t* image_data = data;
+        if (size != file_size) {
+            // odd sized or truncated dump, the mapping can't be grown in place
+            image_data = rom_pad_image(data, file_size, size, &mapped);
+        }
+
+        image = image_data ? calloc(1, sizeof(rom_image_t)) : NULL;
+        size_t path_size = strlen(path) + 1;
+        char* path_copy = image ? malloc(path_size) : NULL;   // strdup is POSIX, not C11
+        if (path_copy) {
+            memcpy(path_copy, path, path_size);
+        }
+        if (!path_copy) {
+            pthread_mutex_unlock(&rom_cache_lock);
+            fprintf(stderr, "Failed to allocate memory for ROM.\n");
+            free(image);
+            if (image_data) {
+                rom_unmap_file(image_data, size, mapped);
+            } else {
+                rom_unmap_file(data, file_size, mapped);
+            }
+            return 0;
+        }
+
+        /* Parsing the file */
+        image->path = path_copy;
+        image->data = image_data;
+        image->size = size;
+        image->file_size = file_size;
+        image->header_checksum = header_checksum;
+        image->global_checksum = global_checksum;
+        image->mbc_type = rom_parse_mbc(image_data[0x147]);
+        image->mapped = mapped;
+        image->refcount = 1;
+
+        image->next = rom_cache;
+        rom_cache = image;
+        pthread_mutex_unlock(&rom_cache_lock);
+
+        LOG_MMU("Loaded %zu bytes from %s\n", file_size, path);
+        if (size != file_size) {
+            LOG_MMU("ROM padded to %zu bytes\n", size);
+        }
+    }
+
+    /* Setting output preferences */
+    *out_image = image;
+    *out_rom_data = image->data;
+    *out_rom_size = image->size;
+    *out_mbc_type = image->mbc_type;
 
     return 1; //success
 }
+
+
+/**
+ * @brief rom_release - Drops one reference to a cached ROM image.
+ *
+ * @param image image returned by load_rom
+ *
+ * @returns void
+ */
+void rom_release(rom_image_t* image) {
+    if (!image) {
+        return;
+    }
+
+    pthread_mutex_lock(&rom_cache_lock);
+    if (--image->refcount > 0) {
+        pthread_mutex_unlock(&rom_cache_lock);
+        return;
+    }
+
+    // last user is gone, unlink it from the cache
+    rom_image_t** link = &rom_cache;
+    while (*link != image) {
+        link = &(*link)->next;
+    }
+    *link = image->next;
+    pthread_mutex_unlock(&rom_cache_lock);
+
+    rom_unmap_file(image->data, image->size, image->mapped);
+    free(image->path);
+    free(image);
+}
@@ -0,0 +1,71 @@
+#include "video.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// =========================================================
+// Headless backend
+// =========================================================
+
+static bool headless_init() {
+    return true;
+}
+
+static void headless_present(const uint32_t* framebuffer) {
+    (void)framebuffer;
+}
+
+static bool headless_poll() {
+    return true;
+}
+
+static void headless_shutdown() {
+}
+
+const video_backend_t video_headless = {
+    .name = "headless",
+    .init = headless_init,
+    .present = headless_present,
+    .poll = headless_poll,
+    .shutdown = headless_shutdown,
+};
+
+
+// =========================================================
+// Backend selection
+// =========================================================
+
+// every backend compiled into this binary, preferred first
+static const video_backend_t* const video_backends[] = {
+#ifdef GBCEE_HAVE_SDL
+    &video_sdl,
+#endif
+    &video_headless,
+};
+
+#define VIDEO_BACKEND_COUNT (sizeof(video_backends) / sizeof(video_backends[0]))
+
+/**
+ * @brief Looks a compiled-in backend up by name
+ *
+ * @param name: backend name
+ *
+ * @returns the backend, NULL if it is unknown or not compiled in
+ */
+const video_backend_t* video_find(const char* name) {
+    for (size_t i = 0; i < VIDEO_BACKEND_COUNT; i++) {
+        if (strcmp(video_backends[i]->name, name) == 0) {
+            return video_backends[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Preferred compiled-in backend
+ *
+ * @returns the backend (never NULL)
+ */
+const video_backend_t* video_default() {
+    return video_backends[0];
+}
@@ -0,0 +1,91 @@
+#include "video.h"
+#include "ppu.h"
+
+#define SDL_MAIN_HANDLED   // main() stays ours, the frontend is optional
+#include <SDL.h>
+#include <stdio.h>
+
+// SDL rendering suite
+static SDL_Window* window = NULL;
+static SDL_Renderer* renderer = NULL;
+static SDL_Texture* texture = NULL;
+
+/**
+ * @brief Opens the window (2x scale) and its streaming texture
+ *
+ * @returns true on success, false if SDL could not be initialized
+ */
+static bool sdl_init() {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        fprintf(stderr, "SDL Init Error: %s\n", SDL_GetError());
+        return false;
+    }
+
+    window = SDL_CreateWindow(
+        "GameBoy Emulator",
+        SDL_WINDOWPOS_UNDEFINED,
+        SDL_WINDOWPOS_UNDEFINED,
+        SCREEN_WIDTH * 2,
+        SCREEN_HEIGHT * 2,
+        0
+    );
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    texture = SDL_CreateTexture(
+        renderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        SCREEN_WIDTH,
+        SCREEN_HEIGHT
+    );
+    return window && renderer && texture;
+}
+
+/**
+ * @brief Uploads a frame into the texture and shows it
+ *
+ * @returns void
+ */
+static void sdl_present(const uint32_t* framebuffer) {
+    SDL_UpdateTexture(texture, NULL, framebuffer, SCREEN_WIDTH * sizeof(uint32_t));
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+}
+
+/**
+ * @brief Drains pending window events
+ *
+ * @returns false once the window has been closed
+ */
+static bool sdl_poll() {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Destroys the window and shuts SDL down
+ *
+ * @returns void
+ */
+static void sdl_shutdown() {
+    if (texture) SDL_DestroyTexture(texture);
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (window) SDL_DestroyWindow(window);
+    texture = NULL;
+    renderer = NULL;
+    window = NULL;
+    SDL_Quit();
+}
+
+const video_backend_t video_sdl = {
+    .name = "sdl",
+    .init = sdl_init,
+    .present = sdl_present,
+    .poll = sdl_poll,
+    .shutdown = sdl_shutdown,
+};
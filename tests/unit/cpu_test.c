@@ -6,12 +6,14 @@
 
 #include "cpu.h"
 #include "mmu.h"
+#include "gb.h"
 #include "rom.h"
+#include "mbc.h"
 #include "alu.h"
+#include "emu.h"
 
 // --- Test Suite Setup ---
-extern CPU cpu;
-extern mmu_t mmu;
+static gb_t* gb; // fresh emulator instance per test
 
 // =============================================================================
 // A Simple Testing Framework
@@ -36,36 +38,36 @@ static int tests_failed = 0;
 
 // Helper to reset CPU and MMU state before each test
 void setup_test() {
-    mmu_init();
-    cpu_reset();
-    mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
-    mmu.rom_size = 32 * 1024;
-    cpu.PC = 0x0100; // Default start for all tests
+    gb = gb_create();
+    gb->mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
+    gb->mmu.rom_size = 32 * 1024;
+    mbc_init(&gb->mmu); // map the ROM pages like mmu_load_rom would
+    gb->cpu.PC = 0x0100; // Default start for all tests
 }
 
 void teardown_test() {
-    mmu_free();
+    gb_destroy(gb);
 }
 
 // Helper to execute a single opcode placed at 0x0100
 void run_opcode(uint8_t opcode) {
-    mmu.rom_data[0x0100] = opcode;
-    cpu_step();
+    gb->mmu.rom_data[0x0100] = opcode;
+    cpu_step(gb);
 }
 
 // Helper for 2-byte opcodes
 void run_opcode_d8(uint8_t opcode, uint8_t d8) {
-    mmu.rom_data[0x0100] = opcode;
-    mmu.rom_data[0x0101] = d8;
-    cpu_step();
+    gb->mmu.rom_data[0x0100] = opcode;
+    gb->mmu.rom_data[0x0101] = d8;
+    cpu_step(gb);
 }
 
 // Helper for 3-byte opcodes
 void run_opcode_d16(uint8_t opcode, uint16_t d16) {
-    mmu.rom_data[0x0100] = opcode;
-    mmu.rom_data[0x0101] = d16 & 0xFF;
-    mmu.rom_data[0x0102] = (d16 >> 8) & 0xFF;
-    cpu_step();
+    gb->mmu.rom_data[0x0100] = opcode;
+    gb->mmu.rom_data[0x0101] = d16 & 0xFF;
+    gb->mmu.rom_data[0x0102] = (d16 >> 8) & 0xFF;
+    cpu_step(gb);
 }
 
 // =============================================================================
@@ -75,14 +77,14 @@ void run_opcode_d16(uint8_t opcode, uint16_t d16) {
 TEST_CASE(ld_8bit_ops) {
     setup_test();
     run_opcode_d8(0x06, 0xAB); // LD B, 0xAB
-    ASSERT_EQ(cpu.B, 0xAB, "LD B, n");
-    ASSERT_EQ(cpu.PC, 0x0102, "PC advances by 2");
+    ASSERT_EQ(gb->cpu.B, 0xAB, "LD B, n");
+    ASSERT_EQ(gb->cpu.PC, 0x0102, "PC advances by 2");
     
-    cpu.C = 0xBE;
-    cpu.PC = 0x0100;
+    gb->cpu.C = 0xBE;
+    gb->cpu.PC = 0x0100;
     run_opcode(0x41); // LD B, C
-    ASSERT_EQ(cpu.B, 0xBE, "LD B, C");
-    ASSERT_EQ(cpu.PC, 0x0101, "PC advances by 1");
+    ASSERT_EQ(gb->cpu.B, 0xBE, "LD B, C");
+    ASSERT_EQ(gb->cpu.PC, 0x0101, "PC advances by 1");
     teardown_test();
 }
 
@@ -90,76 +92,76 @@ TEST_CASE(ld_16bit_ops) {
     setup_test();
     run_opcode_d16(0x21, 0xDEAD); // LD HL, 0xDEAD
     ASSERT_EQ(REG_HL, 0xDEAD, "LD HL, 0xDEAD");
-    ASSERT_EQ(cpu.PC, 0x0103, "PC advances by 3");
+    ASSERT_EQ(gb->cpu.PC, 0x0103, "PC advances by 3");
     teardown_test();
 }
 
 TEST_CASE(push_pop) {
     setup_test();
     SET_REG_BC(0xABCD);
-    cpu.SP = 0xFFFE;
+    gb->cpu.SP = 0xFFFE;
     run_opcode(0xC5); // PUSH BC
-    ASSERT_EQ(cpu.SP, 0xFFFC, "SP decrements by 2 after PUSH");
-    ASSERT_EQ(mmu_read(0xFFFD), 0xAB, "PUSH writes high byte");
-    ASSERT_EQ(mmu_read(0xFFFC), 0xCD, "PUSH writes low byte");
+    ASSERT_EQ(gb->cpu.SP, 0xFFFC, "SP decrements by 2 after PUSH");
+    ASSERT_EQ(mmu_read(gb, 0xFFFD), 0xAB, "PUSH writes high byte");
+    ASSERT_EQ(mmu_read(gb, 0xFFFC), 0xCD, "PUSH writes low byte");
 
     // --- FIX: Reset PC before the next instruction in the same test ---
-    cpu.PC = 0x0100;
+    gb->cpu.PC = 0x0100;
     SET_REG_DE(0x0000);
     run_opcode(0xD1); // POP DE
     ASSERT_EQ(REG_DE, 0xABCD, "POP DE retrieves correct value");
-    ASSERT_EQ(cpu.SP, 0xFFFE, "SP increments by 2 after POP");
+    ASSERT_EQ(gb->cpu.SP, 0xFFFE, "SP increments by 2 after POP");
     teardown_test();
 }
 
 TEST_CASE(add_sub_flags) {
     setup_test();
-    cpu.A = 0x0F;
-    cpu.B = 0x01;
+    gb->cpu.A = 0x0F;
+    gb->cpu.B = 0x01;
     run_opcode(0x80); // ADD A, B
-    ASSERT_EQ(cpu.A, 0x10, "ADD A, B result");
-    ASSERT_EQ(cpu.F, FLAG_H, "ADD should set Half Carry flag");
+    ASSERT_EQ(gb->cpu.A, 0x10, "ADD A, B result");
+    ASSERT_EQ(gb->cpu.F, FLAG_H, "ADD should set Half Carry flag");
 
-    cpu.A = 0xFF;
-    cpu.B = 0x01;
-    cpu.PC = 0x0100;
+    gb->cpu.A = 0xFF;
+    gb->cpu.B = 0x01;
+    gb->cpu.PC = 0x0100;
     run_opcode(0x80); // ADD A, B
-    ASSERT_EQ(cpu.A, 0x00, "ADD with carry result");
-    ASSERT_EQ(cpu.F, FLAG_Z | FLAG_H | FLAG_C, "ADD should set Z, H, and C flags");
+    ASSERT_EQ(gb->cpu.A, 0x00, "ADD with carry result");
+    ASSERT_EQ(gb->cpu.F, FLAG_Z | FLAG_H | FLAG_C, "ADD should set Z, H, and C flags");
 
-    cpu.A = 0x10;
-    cpu.C = 0x01;
-    cpu.PC = 0x0100;
+    gb->cpu.A = 0x10;
+    gb->cpu.C = 0x01;
+    gb->cpu.PC = 0x0100;
     run_opcode(0x91); // SUB C
-    ASSERT_EQ(cpu.A, 0x0F, "SUB result");
-    ASSERT_EQ(cpu.F, FLAG_N | FLAG_H, "SUB should set N and H flags");
+    ASSERT_EQ(gb->cpu.A, 0x0F, "SUB result");
+    ASSERT_EQ(gb->cpu.F, FLAG_N | FLAG_H, "SUB should set N and H flags");
     teardown_test();
 }
 
 TEST_CASE(and_or_xor_cp_flags) {
     setup_test();
-    cpu.A = 0b11001100;
+    gb->cpu.A = 0b11001100;
     run_opcode_d8(0xE6, 0b10101010); // AND 0b10101010
-    ASSERT_EQ(cpu.A, 0b10001000, "AND result");
-    ASSERT_EQ(cpu.F, FLAG_H, "AND should set H flag");
+    ASSERT_EQ(gb->cpu.A, 0b10001000, "AND result");
+    ASSERT_EQ(gb->cpu.F, FLAG_H, "AND should set H flag");
 
-    cpu.A = 0b11001100;
-    cpu.PC = 0x0100;
+    gb->cpu.A = 0b11001100;
+    gb->cpu.PC = 0x0100;
     run_opcode_d8(0xF6, 0b00110011); // OR 0b00110011
-    ASSERT_EQ(cpu.A, 0b11111111, "OR result");
-    ASSERT_EQ(cpu.F, 0, "OR should clear all flags");
+    ASSERT_EQ(gb->cpu.A, 0b11111111, "OR result");
+    ASSERT_EQ(gb->cpu.F, 0, "OR should clear all flags");
 
-    cpu.A = 0xFF;
-    cpu.PC = 0x0100;
+    gb->cpu.A = 0xFF;
+    gb->cpu.PC = 0x0100;
     run_opcode_d8(0xEE, 0xFF); // XOR 0xFF
-    ASSERT_EQ(cpu.A, 0x00, "XOR result");
-    ASSERT_EQ(cpu.F, FLAG_Z, "XOR should set Z flag");
+    ASSERT_EQ(gb->cpu.A, 0x00, "XOR result");
+    ASSERT_EQ(gb->cpu.F, FLAG_Z, "XOR should set Z flag");
 
-    cpu.A = 0x3C;
-    cpu.PC = 0x0100;
+    gb->cpu.A = 0x3C;
+    gb->cpu.PC = 0x0100;
     run_opcode_d8(0xFE, 0x3C); // CP 0x3C
-    ASSERT_EQ(cpu.A, 0x3C, "CP should not change A");
-    ASSERT_EQ(cpu.F, FLAG_Z | FLAG_N, "CP should set Z and N flags on equal");
+    ASSERT_EQ(gb->cpu.A, 0x3C, "CP should not change A");
+    ASSERT_EQ(gb->cpu.F, FLAG_Z | FLAG_N, "CP should set Z and N flags on equal");
     teardown_test();
 }
 
@@ -170,7 +172,7 @@ TEST_CASE(inc_dec_16bit_edge_cases) {
     ASSERT_EQ(REG_HL, 0x0000, "INC HL should wrap from 0xFFFF to 0x0000");
     
     SET_REG_BC(0x0000);
-    cpu.PC = 0x0100;
+    gb->cpu.PC = 0x0100;
     run_opcode(0x0B); // DEC BC
     ASSERT_EQ(REG_BC, 0xFFFF, "DEC BC should wrap from 0x0000 to 0xFFFF");
     teardown_test();
@@ -179,43 +181,126 @@ TEST_CASE(inc_dec_16bit_edge_cases) {
 TEST_CASE(jumps_and_calls) {
     setup_test();
     run_opcode_d16(0xC3, 0xDEAD); // JP 0xDEAD
-    ASSERT_EQ(cpu.PC, 0xDEAD, "JP should set PC to the new address");
+    ASSERT_EQ(gb->cpu.PC, 0xDEAD, "JP should set PC to the new address");
 
-    cpu.PC = 0x0100;
-    cpu.F = FLAG_C; // Set Carry flag
+    gb->cpu.PC = 0x0100;
+    gb->cpu.F = FLAG_C; // Set Carry flag
     run_opcode_d16(0xD2, 0xBEEF); // JP NC, 0xBEEF (not taken)
-    ASSERT_EQ(cpu.PC, 0x0103, "JP NC should not be taken when C is set");
+    ASSERT_EQ(gb->cpu.PC, 0x0103, "JP NC should not be taken when C is set");
 
-    cpu.PC = 0x0100;
-    cpu.SP = 0xFFFE;
+    gb->cpu.PC = 0x0100;
+    gb->cpu.SP = 0xFFFE;
     run_opcode_d16(0xCD, 0xFACE); // CALL 0xFACE
-    ASSERT_EQ(cpu.PC, 0xFACE, "CALL should jump to new address");
-    ASSERT_EQ(cpu.SP, 0xFFFC, "CALL should push return address, decrementing SP");
-    ASSERT_EQ(mmu_read(0xFFFD), 0x01, "Return address high byte pushed to stack");
-    ASSERT_EQ(mmu_read(0xFFFC), 0x03, "Return address low byte pushed to stack");
+    ASSERT_EQ(gb->cpu.PC, 0xFACE, "CALL should jump to new address");
+    ASSERT_EQ(gb->cpu.SP, 0xFFFC, "CALL should push return address, decrementing SP");
+    ASSERT_EQ(mmu_read(gb, 0xFFFD), 0x01, "Return address high byte pushed to stack");
+    ASSERT_EQ(mmu_read(gb, 0xFFFC), 0x03, "Return address low byte pushed to stack");
     teardown_test();
 }
 
 TEST_CASE(cb_bit_ops) {
     setup_test();
-    cpu.A = 0b10101010;
+    gb->cpu.A = 0b10101010;
     run_opcode_d8(0xCB, 0x7F); // BIT 7, A
-    ASSERT_EQ((cpu.F & FLAG_Z), 0, "BIT 7, A should clear Z flag (bit is set)");
+    ASSERT_EQ((gb->cpu.F & FLAG_Z), 0, "BIT 7, A should clear Z flag (bit is set)");
 
-    cpu.A = 0b01111111;
-    cpu.PC = 0x0100;
+    gb->cpu.A = 0b01111111;
+    gb->cpu.PC = 0x0100;
     run_opcode_d8(0xCB, 0x7F); // BIT 7, A
-    ASSERT_EQ((cpu.F & FLAG_Z), FLAG_Z, "BIT 7, A should set Z flag (bit is clear)");
+    ASSERT_EQ((gb->cpu.F & FLAG_Z), FLAG_Z, "BIT 7, A should set Z flag (bit is clear)");
 
-    cpu.B = 0b00000000;
-    cpu.PC = 0x0100;
+    gb->cpu.B = 0b00000000;
+    gb->cpu.PC = 0x0100;
     run_opcode_d8(0xCB, 0xC0); // SET 0, B
-    ASSERT_EQ(cpu.B, 0b00000001, "SET 0, B");
+    ASSERT_EQ(gb->cpu.B, 0b00000001, "SET 0, B");
 
-    cpu.C = 0b11111111;
-    cpu.PC = 0x0100;
+    gb->cpu.C = 0b11111111;
+    gb->cpu.PC = 0x0100;
     run_opcode_d8(0xCB, 0x99); // RES 3, C
-    ASSERT_EQ(cpu.C, 0b11110111, "RES 3, C");
+    ASSERT_EQ(gb->cpu.C, 0b11110111, "RES 3, C");
+    teardown_test();
+}
+
+TEST_CASE(fetch_paths) {
+    setup_test();
+    // 16-bit operand straddling the 0x01xx / 0x02xx page boundary
+    gb->mmu.rom_data[0x01FE] = 0x01; // LD BC, 0xBEEF
+    gb->mmu.rom_data[0x01FF] = 0xEF;
+    gb->mmu.rom_data[0x0200] = 0xBE;
+    gb->cpu.PC = 0x01FE;
+    cpu_step(gb);
+    ASSERT_EQ(REG_BC, 0xBEEF, "d16 operand read across a page boundary");
+    ASSERT_EQ(gb->cpu.PC, 0x0201, "PC advances by 3 across the boundary");
+
+    // code running from HRAM (the usual home of the OAM DMA routine)
+    mmu_write(gb, 0xFF80, 0x3E); // LD A, 0x5A
+    mmu_write(gb, 0xFF81, 0x5A);
+    gb->cpu.PC = 0xFF80;
+    cpu_step(gb);
+    ASSERT_EQ(gb->cpu.A, 0x5A, "Opcode and operand fetched from HRAM");
+    ASSERT_EQ(gb->cpu.PC, 0xFF82, "PC advances inside HRAM");
+    teardown_test();
+}
+
+TEST_CASE(independent_instances) {
+    setup_test();
+    gb_t* other = gb_create();
+
+    run_opcode_d8(0x3E, 0x42); // LD A, 0x42 on the test instance only
+    mmu_write(gb, 0xC000, 0x99);
+
+    ASSERT_EQ(gb->cpu.A, 0x42, "Test instance executed the opcode");
+    ASSERT_EQ(other->cpu.A, 0x01, "Second instance keeps its reset value");
+    ASSERT_EQ(other->cpu.PC, 0x0100, "Second instance PC is untouched");
+    ASSERT_EQ(mmu_read(other, 0xC000), 0x00, "WRAM is not shared between instances");
+
+    gb_destroy(other);
+    teardown_test();
+}
+
+// Halt loop woken by VBlank (INC B) and the timer (INC C)
+static void load_halt_program(gb_t* target) {
+    static const uint8_t program[] = {
+        0x3E, 0x05,     // LD A, 0x05
+        0xE0, 0xFF,     // LDH (IE), A      VBlank + timer
+        0x3E, 0x05,     // LD A, 0x05
+        0xE0, 0x07,     // LDH (TAC), A     timer on, 16 cycles per increment
+        0xFB,           // EI
+        0x76,           // HALT
+        0x18, 0xFD,     // JR -3 (back to HALT)
+    };
+    memcpy(&target->mmu.rom_data[0x0100], program, sizeof(program));
+    target->mmu.rom_data[0x0040] = 0x04;    // INC B
+    target->mmu.rom_data[0x0041] = 0xD9;    // RETI
+    target->mmu.rom_data[0x0050] = 0x0C;    // INC C
+    target->mmu.rom_data[0x0051] = 0xD9;    // RETI
+    target->mmu.interrupt_flag = 0;
+    target->cpu.B = 0;
+    target->cpu.C = 0;
+}
+
+TEST_CASE(halt_fast_forward) {
+    setup_test();
+    gb_t* reference = gb;
+    setup_test();
+    load_halt_program(reference);
+    load_halt_program(gb);
+
+    // one big batch skips through HALT, 4-cycle batches cannot skip at all
+    int budget = 10 * CYCLES_PER_FRAME;
+    int elapsed = cpu_run_cycles(gb, budget);
+    int reference_elapsed = 0;
+    while (reference_elapsed < budget) {
+        reference_elapsed += cpu_run_cycles(reference, 4);
+    }
+
+    ASSERT_EQ(gb->cpu.B, 10, "Woken by every VBlank");
+    ASSERT_EQ(gb->cpu.C > 0, true, "Woken by timer overflows");
+    ASSERT_EQ(elapsed, reference_elapsed, "Same number of cycles");
+    ASSERT_EQ(gb->cpu.C, reference->cpu.C, "Same number of timer wake-ups");
+    ASSERT_EQ(gb_state_hash(gb) == gb_state_hash(reference), true, "Same machine state as stepping through HALT");
+
+    gb_destroy(reference);
     teardown_test();
 }
 
@@ -235,6 +320,9 @@ int main() {
     RUN_TEST(inc_dec_16bit_edge_cases);
     RUN_TEST(jumps_and_calls);
     RUN_TEST(cb_bit_ops);
+    RUN_TEST(fetch_paths);
+    RUN_TEST(independent_instances);
+    RUN_TEST(halt_fast_forward);
 
     printf("\n----------------------------------------\n");
     if (tests_failed == 0) {
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "gb.h"
+#include "mbc.h"
+#include "emu.h"
+#include "idle.h"
+
+// Machine that skips idle loops and one that never does, recreated by every test case
+static gb_t* gb;
+static gb_t* reference;
+
+// =============================================================================
+// A Simple Testing Framework
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_failed = 0;
+
+#define TEST_CASE(name) static void test_##name()
+#define RUN_TEST(name) do { printf("--- Running test: %s ---\n", #name); test_##name(); } while (0)
+
+#define ASSERT_EQ(a, b, message) \
+    do { \
+        tests_run++; \
+        if ((a) != (b)) { \
+            fprintf(stderr, "    [FAIL] %s:%d: " message " - Expected 0x%X, got 0x%X\n", __FILE__, __LINE__, (int)(b), (int)(a)); \
+            tests_failed++; \
+        } else { \
+            printf("    [PASS] %s\n", message); \
+        } \
+    } while (0)
+
+// =============================================================================
+// Test Helper Functions
+// =============================================================================
+
+static gb_t* create_machine(const uint8_t* program, size_t size, bool idle_skip) {
+    gb_t* machine = gb_create();
+    machine->mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
+    machine->mmu.rom_size = 32 * 1024;
+    mbc_init(&machine->mmu);
+    memcpy(&machine->mmu.rom_data[0x0100], program, size);
+    machine->mmu.rom_data[0x0040] = 0x04;   // VBlank: INC B
+    machine->mmu.rom_data[0x0041] = 0xD9;   //         RETI
+    machine->mmu.interrupt_flag = 0;
+    machine->cpu.B = 0;
+    machine->idle.enabled = idle_skip;
+    return machine;
+}
+
+// Same program on both machines, skipping only on gb
+static void setup_test(const uint8_t* program, size_t size) {
+    gb = create_machine(program, size, true);
+    reference = create_machine(program, size, false);
+}
+
+static void teardown_test() {
+    gb_destroy(gb);
+    gb_destroy(reference);
+}
+
+// Runs both machines frame by frame, returns the first frame they differ on (frames if none)
+static int run_lockstep(int frames) {
+    for (int frame = 0; frame < frames; frame++) {
+        int cycles = emu_run_frame(gb);
+        if (emu_run_frame(reference) != cycles || gb_state_hash(gb) != gb_state_hash(reference)) {
+            return frame;
+        }
+    }
+    return frames;
+}
+
+// =============================================================================
+// Test Cases
+// =============================================================================
+
+TEST_CASE(ly_poll_skipped) {
+    static const uint8_t program[] = {
+        0x21, 0x00, 0xC0,   // 0100 LD HL, 0xC000
+        0xF0, 0x44,         // 0103 LDH A, (LY)
+        0xFE, 0x90,         //      CP 0x90
+        0x20, 0xFA,         //      JR NZ, 0x0103
+        0x34,               //      INC (HL)         once per frame
+        0xF0, 0x44,         // 010A LDH A, (LY)
+        0xFE, 0x90,         //      CP 0x90
+        0x28, 0xFA,         //      JR Z, 0x010A
+        0x18, 0xF1,         //      JR 0x0103
+    };
+    setup_test(program, sizeof(program));
+
+    ASSERT_EQ(run_lockstep(60), 60, "Same state as plain execution after every frame");
+    ASSERT_EQ(gb->idle.skipped_cycles > 30 * CYCLES_PER_FRAME, true, "Most of the LY poll is skipped");
+    ASSERT_EQ(reference->idle.skipped_cycles, 0, "Nothing skipped with idle.enabled off");
+    ASSERT_EQ(mmu_read(gb, 0xC000), 60, "Outer loop ran once per frame");
+
+    teardown_test();
+}
+
+TEST_CASE(stat_poll_with_interrupts) {
+    static const uint8_t program[] = {
+        0x3E, 0x01,         // 0100 LD A, 0x01
+        0xE0, 0xFF,         //      LDH (IE), A      VBlank
+        0xFB,               //      EI
+        0xF0, 0x41,         // 0105 LDH A, (STAT)
+        0xE6, 0x03,         //      AND 0x03
+        0xFE, 0x03,         //      CP 0x03          pixel transfer
+        0x20, 0xF8,         //      JR NZ, 0x0105
+        0x0C,               //      INC C
+        0x18, 0xF5,         //      JR 0x0105
+    };
+    setup_test(program, sizeof(program));
+
+    ASSERT_EQ(run_lockstep(30), 30, "Same state as plain execution after every frame");
+    ASSERT_EQ(gb->idle.skipped_cycles > 0, true, "STAT poll is skipped");
+    ASSERT_EQ(gb->cpu.B, reference->cpu.B, "Same number of VBlank interrupts");
+    ASSERT_EQ(gb->cpu.B >= 29, true, "VBlank still interrupts the loop");
+
+    teardown_test();
+}
+
+TEST_CASE(write_loop_not_skipped) {
+    static const uint8_t program[] = {
+        0x21, 0x00, 0xC0,   // 0100 LD HL, 0xC000
+        0x34,               // 0103 INC (HL)
+        0x18, 0xFD,         //      JR 0x0103
+    };
+    setup_test(program, sizeof(program));
+
+    ASSERT_EQ(run_lockstep(5), 5, "Same state as plain execution after every frame");
+    ASSERT_EQ(gb->idle.skipped_cycles, 0, "A loop that writes is never skipped");
+    ASSERT_EQ(gb->idle.rejected[0x0104 % IDLE_REJECT_SLOTS], idle_key(0x0104, 1), "Loop remembered as never idle");
+
+    teardown_test();
+}
+
+TEST_CASE(div_poll_not_skipped) {
+    static const uint8_t program[] = {
+        0xF0, 0x04,         // 0100 LDH A, (DIV)
+        0xFE, 0x80,         //      CP 0x80
+        0x20, 0xFA,         //      JR NZ, 0x0100
+        0x0C,               //      INC C
+        0x18, 0xF7,         //      JR 0x0100
+    };
+    setup_test(program, sizeof(program));
+
+    ASSERT_EQ(run_lockstep(5), 5, "Same state as plain execution after every frame");
+    ASSERT_EQ(gb->idle.skipped_cycles, 0, "DIV changes between events, never skipped");
+    ASSERT_EQ(gb->cpu.C > 0, true, "DIV poll saw DIV change");
+
+    teardown_test();
+}
+
+// =============================================================================
+// Test Runner
+// =============================================================================
+
+int main() {
+    printf("Starting idle loop test suite...\n\n");
+
+    RUN_TEST(ly_poll_skipped);
+    RUN_TEST(stat_poll_with_interrupts);
+    RUN_TEST(write_loop_not_skipped);
+    RUN_TEST(div_poll_not_skipped);
+
+    printf("\n----------------------------------------\n");
+    if (tests_failed == 0) {
+        printf("All %d tests passed! ✅\n", tests_run);
+    } else {
+        printf("%d of %d tests failed. ❌\n", tests_failed, tests_run);
+    }
+    printf("----------------------------------------\n");
+
+    return tests_failed > 0;
+}
@@ -5,11 +5,12 @@
 #include <stdbool.h>
 
 #include "mmu.h"
+#include "gb.h"
 #include "rom.h"
 
-// This extern declaration allows our test file to access the global 'mmu'
-// instance defined in mmu.c for verification purposes.
-extern mmu_t mmu;
+// Emulator instance under test, recreated by every test case so its
+// internal mmu state can be inspected directly.
+static gb_t* gb;
 
 // =============================================================================
 // A Simple Testing Framework
@@ -52,15 +53,24 @@ void create_dummy_rom(const char* filename, size_t size, mbc_type_t mbc_type) {
 
     // Set the MBC type code in the cartridge header (address 0x0147)
     uint8_t cart_type_code = 0;
+    uint8_t ram_size_code = 0;
     switch(mbc_type) {
         case MBC_TYPE_NONE: cart_type_code = 0x00; break;
-        case MBC_TYPE_MBC1: cart_type_code = 0x01; break;
+        case MBC_TYPE_MBC1: cart_type_code = 0x03; ram_size_code = 0x03; break; // MBC1 + 32KB RAM
         case MBC_TYPE_MBC3: cart_type_code = 0x11; break;
         case MBC_TYPE_MBC5: cart_type_code = 0x19; break;
         default: break;
     }
     buffer[0x0147] = cart_type_code;
 
+    // ROM size (32KB << n) and RAM size codes
+    uint8_t rom_size_code = 0;
+    while (((size_t)0x8000 << rom_size_code) < size) {
+        rom_size_code++;
+    }
+    buffer[0x0148] = rom_size_code;
+    buffer[0x0149] = ram_size_code;
+
     fwrite(buffer, 1, size, f);
     fclose(f);
     free(buffer);
@@ -74,14 +84,14 @@ TEST_CASE(rom_only_read) {
     const char* rom_name = "test_rom_only.gb";
     create_dummy_rom(rom_name, 32 * 1024, MBC_TYPE_NONE);
 
-    mmu_init();
-    assert(mmu_load_rom(rom_name) == 0);
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
 
-    ASSERT_EQ(mmu.mbc_type, MBC_TYPE_NONE, "ROM ONLY type detected");
-    ASSERT_EQ(mmu_read(0x1234), 0x00, "Read from Bank 0");
-    ASSERT_EQ(mmu_read(0x4567), 0x01, "Read from Bank 1");
+    ASSERT_EQ(gb->mmu.mbc_type, MBC_TYPE_NONE, "ROM ONLY type detected");
+    ASSERT_EQ(mmu_read(gb, 0x1234), 0x00, "Read from Bank 0");
+    ASSERT_EQ(mmu_read(gb, 0x4567), 0x01, "Read from Bank 1");
 
-    mmu_free();
+    gb_destroy(gb);
     remove(rom_name);
 }
 
@@ -89,22 +99,22 @@ TEST_CASE(mbc1_ram_enable) {
     const char* rom_name = "test_mbc1.gb";
     create_dummy_rom(rom_name, 128 * 1024, MBC_TYPE_MBC1);
 
-    mmu_init();
-    assert(mmu_load_rom(rom_name) == 0);
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
 
-    ASSERT_EQ(mmu.ram_enabled, false, "RAM is initially disabled");
-    mmu_write(0xA000, 0xAB);
-    ASSERT_EQ(mmu_read(0xA000), 0xFF, "Read from disabled RAM should return 0xFF");
+    ASSERT_EQ(gb->mmu.ram_enabled, false, "RAM is initially disabled");
+    mmu_write(gb, 0xA000, 0xAB);
+    ASSERT_EQ(mmu_read(gb, 0xA000), 0xFF, "Read from disabled RAM should return 0xFF");
 
-    mmu_write(0x0000, 0x0A);
-    ASSERT_EQ(mmu.ram_enabled, true, "RAM is enabled after writing 0x0A");
-    mmu_write(0xA000, 0xCD);
-    ASSERT_EQ(mmu_read(0xA000), 0xCD, "Read/write to enabled RAM");
+    mmu_write(gb, 0x0000, 0x0A);
+    ASSERT_EQ(gb->mmu.ram_enabled, true, "RAM is enabled after writing 0x0A");
+    mmu_write(gb, 0xA000, 0xCD);
+    ASSERT_EQ(mmu_read(gb, 0xA000), 0xCD, "Read/write to enabled RAM");
 
-    mmu_write(0x0000, 0x00);
-    ASSERT_EQ(mmu.ram_enabled, false, "RAM is disabled after writing non-0x0A value");
+    mmu_write(gb, 0x0000, 0x00);
+    ASSERT_EQ(gb->mmu.ram_enabled, false, "RAM is disabled after writing non-0x0A value");
 
-    mmu_free();
+    gb_destroy(gb);
     remove(rom_name);
 }
 
@@ -112,21 +122,21 @@ TEST_CASE(mbc1_rom_bank_switching_basic) {
     const char* rom_name = "test_mbc1_basic.gb";
     create_dummy_rom(rom_name, 128 * 1024, MBC_TYPE_MBC1);
 
-    mmu_init();
-    assert(mmu_load_rom(rom_name) == 0);
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
 
-    ASSERT_EQ(mmu_read(0x1000), 0x00, "Bank 0 is always accessible");
-    ASSERT_EQ(mmu_read(0x4000), 0x01, "Default switchable bank is 1");
+    ASSERT_EQ(mmu_read(gb, 0x1000), 0x00, "Bank 0 is always accessible");
+    ASSERT_EQ(mmu_read(gb, 0x4000), 0x01, "Default switchable bank is 1");
 
-    mmu_write(0x2100, 0x05);
-    ASSERT_EQ(mmu.current_rom_bank, 5, "Switched to ROM bank 5");
-    ASSERT_EQ(mmu_read(0x4000), 0x05, "Read from banked-in ROM bank 5");
+    mmu_write(gb, 0x2100, 0x05);
+    ASSERT_EQ(gb->mmu.current_rom_bank, 5, "Switched to ROM bank 5");
+    ASSERT_EQ(mmu_read(gb, 0x4000), 0x05, "Read from banked-in ROM bank 5");
 
-    mmu_write(0x2100, 0x00);
-    ASSERT_EQ(mmu.current_rom_bank, 1, "Writing 0 to bank select defaults to bank 1");
-    ASSERT_EQ(mmu_read(0x4000), 0x01, "Read from default bank 1");
+    mmu_write(gb, 0x2100, 0x00);
+    ASSERT_EQ(gb->mmu.current_rom_bank, 1, "Writing 0 to bank select defaults to bank 1");
+    ASSERT_EQ(mmu_read(gb, 0x4000), 0x01, "Read from default bank 1");
 
-    mmu_free();
+    gb_destroy(gb);
     remove(rom_name);
 }
 
@@ -135,20 +145,144 @@ TEST_CASE(mbc1_rom_bank_switching_advanced) {
     const char* rom_name = "test_mbc1_large.gb";
     create_dummy_rom(rom_name, 1024 * 1024, MBC_TYPE_MBC1); // 1MB ROM = 64 banks
 
-    mmu_init();
-    assert(mmu_load_rom(rom_name) == 0);
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
 
     // Select bank 0x1F (31)
-    mmu_write(0x2100, 0x1F);
-    ASSERT_EQ(mmu_read(0x4000), 31, "Read from bank 31");
+    mmu_write(gb, 0x2100, 0x1F);
+    ASSERT_EQ(mmu_read(gb, 0x4000), 31, "Read from bank 31");
 
     // Now, set the upper two bits to 1 (binary 01)
     // This should select bank (0b01 << 5) | 0x1F = 0x20 | 0x1F = 0x3F (63)
-    mmu_write(0x4000, 0x01);
-    ASSERT_EQ(mmu.current_rom_bank, 63, "Switched to ROM bank 63 (upper bits)");
-    ASSERT_EQ(mmu_read(0x4000), 63, "Read from bank 63");
+    mmu_write(gb, 0x4000, 0x01);
+    ASSERT_EQ(gb->mmu.current_rom_bank, 63, "Switched to ROM bank 63 (upper bits)");
+    ASSERT_EQ(mmu_read(gb, 0x4000), 63, "Read from bank 63");
+
+    gb_destroy(gb);
+    remove(rom_name);
+}
+
+TEST_CASE(mbc1_cached_bank_pointers) {
+    const char* rom_name = "test_mbc1_cached.gb";
+    create_dummy_rom(rom_name, 1024 * 1024, MBC_TYPE_MBC1); // 64 banks
+
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
+
+    // bank 0x20 hits the MBC1 quirk and reads as bank 0x21
+    mmu_write(gb, 0x2100, 0x00);
+    mmu_write(gb, 0x4000, 0x01);
+    ASSERT_EQ(mmu_read(gb, 0x4000), 0x21, "Bank 0x20 reads as bank 0x21");
+    ASSERT_EQ(gb->mmu.rom_bankN_ptr == gb->mmu.rom_data + 0x21 * 0x4000, true, "Bank N pointer follows the quirk");
+    ASSERT_EQ(mmu_read(gb, 0x7FFF), 0x21, "Last byte of the switchable bank");
+
+    // switch to RAM banking mode, each RAM bank keeps its own data
+    mmu_write(gb, 0x0000, 0x0A);    // enable RAM
+    mmu_write(gb, 0x6000, 0x01);    // RAM mode
+    mmu_write(gb, 0x4000, 0x00);    // RAM bank 0
+    mmu_write(gb, 0xA000, 0x11);
+    mmu_write(gb, 0x4000, 0x02);    // RAM bank 2
+    ASSERT_EQ(mmu_read(gb, 0xA000), 0x00, "RAM bank 2 starts empty");
+    mmu_write(gb, 0xA000, 0x22);
+    mmu_write(gb, 0x4000, 0x00);
+    ASSERT_EQ(mmu_read(gb, 0xA000), 0x11, "RAM bank 0 kept its value");
+    ASSERT_EQ(gb->mmu.eram[2 * 0x2000], 0x22, "RAM bank 2 write landed in its own bank");
+
+    mmu_write(gb, 0x0000, 0x00);    // disable RAM
+    ASSERT_EQ(gb->mmu.eram_ptr == NULL, true, "Disabling RAM drops the ERAM pointer");
+    ASSERT_EQ(mmu_read(gb, 0xA000), 0xFF, "Disabled RAM reads 0xFF");
+
+    gb_destroy(gb);
+    remove(rom_name);
+}
+
+TEST_CASE(mbc1_bank_past_rom_end) {
+    const char* rom_name = "test_mbc1_small.gb";
+    create_dummy_rom(rom_name, 128 * 1024, MBC_TYPE_MBC1); // 8 banks
+
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
+
+    mmu_write(gb, 0x2100, 0x1F); // bank 31 does not exist
+    ASSERT_EQ(gb->mmu.rom_bank_mask, 7, "Bank mask covers 8 banks");
+    ASSERT_EQ(mmu_read(gb, 0x4000), 0x07, "Bank past the end of the ROM wraps to bank 31 & 7");
+
+    gb_destroy(gb);
+    remove(rom_name);
+}
+
+TEST_CASE(header_sized_eram) {
+    const char* rom_name = "test_eram_size.gb";
+
+    // ROM only: no cartridge RAM is allocated at all
+    create_dummy_rom(rom_name, 32 * 1024, MBC_TYPE_NONE);
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
+    ASSERT_EQ(gb->mmu.eram == NULL, true, "ROM only cartridge has no ERAM");
+    ASSERT_EQ(gb->mmu.eram_size, 0, "ROM only ERAM size is 0");
+    mmu_write(gb, 0x0000, 0x0A);
+    mmu_write(gb, 0xA000, 0x12);
+    ASSERT_EQ(mmu_read(gb, 0xA000), 0xFF, "Missing ERAM reads 0xFF");
+    gb_destroy(gb);
+
+    // MBC1 + 32KB RAM
+    create_dummy_rom(rom_name, 64 * 1024, MBC_TYPE_MBC1);
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
+    ASSERT_EQ(gb->mmu.eram_size, 32 * 1024, "ERAM sized from header byte 0x149");
+    gb_destroy(gb);
+
+    remove(rom_name);
+}
+
+TEST_CASE(truncated_rom_padded) {
+    const char* rom_name = "test_truncated.gb";
+    create_dummy_rom(rom_name, 48 * 1024, MBC_TYPE_MBC1); // 3 banks, header says 64KB
+
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
+    ASSERT_EQ(gb->mmu.rom_size, 64 * 1024, "Image rounded up to a power of two");
+    ASSERT_EQ(gb->mmu.rom_bank_mask, 3, "Bank mask covers 4 banks");
+
+    mmu_write(gb, 0x2100, 0x02);
+    ASSERT_EQ(mmu_read(gb, 0x4000), 0x02, "Bank 2 comes from the file");
+    mmu_write(gb, 0x2100, 0x03);
+    ASSERT_EQ(mmu_read(gb, 0x4000), 0xFF, "Missing bank 3 reads 0xFF");
+
+    gb_destroy(gb);
+    remove(rom_name);
+}
+
+TEST_CASE(rom_cache_shared) {
+    const char* rom_name = "test_rom_cache.gb";
+    create_dummy_rom(rom_name, 64 * 1024, MBC_TYPE_MBC1);
+
+    gb_t* a = gb_create();
+    gb_t* b = gb_create();
+    assert(mmu_load_rom(a, rom_name) == 0);
+    assert(mmu_load_rom(b, rom_name) == 0);
+
+    ASSERT_EQ(a->mmu.rom_data == b->mmu.rom_data, true, "Same ROM shares one image");
+    ASSERT_EQ(a->mmu.rom_image == b->mmu.rom_image, true, "Same ROM shares one cache entry");
+
+    // bank switching is per instance even though the data is shared
+    mmu_write(a, 0x2000, 0x02);
+    ASSERT_EQ(mmu_read(a, 0x4000), 0x02, "Instance A sees bank 2");
+    ASSERT_EQ(mmu_read(b, 0x4000), 0x01, "Instance B still sees bank 1");
+
+    // the image outlives the first instance
+    gb_destroy(a);
+    ASSERT_EQ(mmu_read(b, 0x4000), 0x01, "Shared image survives the other instance");
+
+    // a different file under the same path gets its own entry
+    create_dummy_rom(rom_name, 128 * 1024, MBC_TYPE_MBC1);
+    gb_t* c = gb_create();
+    assert(mmu_load_rom(c, rom_name) == 0);
+    ASSERT_EQ(c->mmu.rom_image != b->mmu.rom_image, true, "Changed file gets a fresh image");
+    ASSERT_EQ(c->mmu.rom_size, 128 * 1024, "Fresh image has the new size");
 
-    mmu_free();
+    gb_destroy(b);
+    gb_destroy(c);
     remove(rom_name);
 }
 
@@ -156,20 +290,20 @@ TEST_CASE(mbc1_rom_bank_switching_advanced) {
 TEST_CASE(mbc3_detected) {
     const char* rom_name = "test_mbc3.gb";
     create_dummy_rom(rom_name, 128 * 1024, MBC_TYPE_MBC3);
-    mmu_init();
-    assert(mmu_load_rom(rom_name) == 0);
-    ASSERT_EQ(mmu.mbc_type, MBC_TYPE_MBC3, "MBC3 type detected");
-    mmu_free();
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
+    ASSERT_EQ(gb->mmu.mbc_type, MBC_TYPE_MBC3, "MBC3 type detected");
+    gb_destroy(gb);
     remove(rom_name);
 }
 
 TEST_CASE(mbc5_detected) {
     const char* rom_name = "test_mbc5.gb";
     create_dummy_rom(rom_name, 128 * 1024, MBC_TYPE_MBC5);
-    mmu_init();
-    assert(mmu_load_rom(rom_name) == 0);
-    ASSERT_EQ(mmu.mbc_type, MBC_TYPE_MBC5, "MBC5 type detected");
-    mmu_free();
+    gb = gb_create();
+    assert(mmu_load_rom(gb, rom_name) == 0);
+    ASSERT_EQ(gb->mmu.mbc_type, MBC_TYPE_MBC5, "MBC5 type detected");
+    gb_destroy(gb);
     remove(rom_name);
 }
 
@@ -184,6 +318,11 @@ int main() {
     RUN_TEST(mbc1_ram_enable);
     RUN_TEST(mbc1_rom_bank_switching_basic);
     RUN_TEST(mbc1_rom_bank_switching_advanced);
+    RUN_TEST(mbc1_cached_bank_pointers);
+    RUN_TEST(mbc1_bank_past_rom_end);
+    RUN_TEST(header_sized_eram);
+    RUN_TEST(truncated_rom_padded);
+    RUN_TEST(rom_cache_shared);
     RUN_TEST(mbc3_detected);
     RUN_TEST(mbc5_detected);
 
@@ -5,10 +5,12 @@
 #include <stdbool.h>
 
 #include "mmu.h"
+#include "gb.h"
+#include "joypad.h"
 #include "rom.h"
 
-// We declare the main mmu struct as 'extern' to access its internal state.
-extern mmu_t mmu;
+// Emulator instance under test, its mmu struct is inspected directly.
+static gb_t* gb;
 
 // =============================================================================
 // A Simple Testing Framework
@@ -36,52 +38,68 @@ static int tests_failed = 0;
 // =============================================================================
 
 TEST_CASE(initialization) {
-    mmu_init();
-    ASSERT_EQ(mmu_read(0xC000), 0x00, "WRAM should be 0 after init");
-    ASSERT_EQ(mmu_read(0x8000), 0x00, "VRAM should be 0 after init");
-    ASSERT_EQ(mmu_read(0xFF80), 0x00, "HRAM should be 0 after init");
-    ASSERT_EQ(mmu_read(0xFFFF), 0x00, "IE register should be 0 after init");
-    mmu_free();
+    gb = gb_create();
+    ASSERT_EQ(mmu_read(gb, 0xC000), 0x00, "WRAM should be 0 after init");
+    ASSERT_EQ(mmu_read(gb, 0x8000), 0x00, "VRAM should be 0 after init");
+    ASSERT_EQ(mmu_read(gb, 0xFF80), 0x00, "HRAM should be 0 after init");
+    ASSERT_EQ(mmu_read(gb, 0xFFFF), 0x00, "IE register should be 0 after init");
+    gb_destroy(gb);
 }
 
 TEST_CASE(wram_read_write) {
-    mmu_init();
-    mmu_write(0xC123, 0xAB);
-    mmu_write(0xD456, 0xCD);
-    ASSERT_EQ(mmu_read(0xC123), 0xAB, "WRAM read/write at 0xC123");
-    ASSERT_EQ(mmu_read(0xD456), 0xCD, "WRAM read/write at 0xD456");
-    mmu_free();
+    gb = gb_create();
+    mmu_write(gb, 0xC123, 0xAB);
+    mmu_write(gb, 0xD456, 0xCD);
+    ASSERT_EQ(mmu_read(gb, 0xC123), 0xAB, "WRAM read/write at 0xC123");
+    ASSERT_EQ(mmu_read(gb, 0xD456), 0xCD, "WRAM read/write at 0xD456");
+    gb_destroy(gb);
 }
 
 TEST_CASE(vram_read_write) {
-    mmu_init();
-    mmu_write(0x8000, 0xFE);
-    mmu_write(0x9FFF, 0xDC);
-    ASSERT_EQ(mmu_read(0x8000), 0xFE, "VRAM read/write at 0x8000");
-    ASSERT_EQ(mmu_read(0x9FFF), 0xDC, "VRAM read/write at 0x9FFF");
-    mmu_free();
+    gb = gb_create();
+    mmu_write(gb, 0x8000, 0xFE);
+    mmu_write(gb, 0x9FFF, 0xDC);
+    ASSERT_EQ(mmu_read(gb, 0x8000), 0xFE, "VRAM read/write at 0x8000");
+    ASSERT_EQ(mmu_read(gb, 0x9FFF), 0xDC, "VRAM read/write at 0x9FFF");
+    gb_destroy(gb);
 }
 
 TEST_CASE(echo_ram) {
-    mmu_init();
+    gb = gb_create();
     // Write to WRAM, read from Echo RAM
-    mmu_write(0xC005, 0x42);
-    ASSERT_EQ(mmu_read(0xE005), 0x42, "Write to WRAM should be reflected in Echo RAM");
+    mmu_write(gb, 0xC005, 0x42);
+    ASSERT_EQ(mmu_read(gb, 0xE005), 0x42, "Write to WRAM should be reflected in Echo RAM");
 
     // Write to Echo RAM, read from WRAM
-    mmu_write(0xE006, 0x88);
-    ASSERT_EQ(mmu_read(0xC006), 0x88, "Write to Echo RAM should be reflected in WRAM");
-    mmu_free();
+    mmu_write(gb, 0xE006, 0x88);
+    ASSERT_EQ(mmu_read(gb, 0xC006), 0x88, "Write to Echo RAM should be reflected in WRAM");
+    gb_destroy(gb);
 }
 
 TEST_CASE(unusable_memory) {
-    mmu_init();
+    gb = gb_create();
     // Write to the unusable area
-    mmu_write(0xFEA0, 0x55);
+    mmu_write(gb, 0xFEA0, 0x55);
     
     // Verify that reading from the unusable area returns 0xFF
-    ASSERT_EQ(mmu_read(0xFEA5), 0xFF, "Read from unusable memory should return 0xFF");
-    mmu_free();
+    ASSERT_EQ(mmu_read(gb, 0xFEA5), 0xFF, "Read from unusable memory should return 0xFF");
+    gb_destroy(gb);
+}
+
+TEST_CASE(joypad_register) {
+    gb = gb_create();
+    joypad_set_buttons(gb, JOYPAD_RIGHT | JOYPAD_START);
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x10, 0x10, "Button press requests the joypad interrupt");
+
+    mmu_write(gb, 0xFF00, 0x20); // select the D-pad
+    ASSERT_EQ(mmu_read(gb, 0xFF00), 0xEE, "D-pad nibble reads RIGHT as pressed (active low)");
+
+    mmu_write(gb, 0xFF00, 0x10); // select the action buttons
+    ASSERT_EQ(mmu_read(gb, 0xFF00), 0xD7, "Action nibble reads START as pressed (active low)");
+
+    mmu_write(gb, 0xFF00, 0x30); // select nothing
+    ASSERT_EQ(mmu_read(gb, 0xFF00), 0xFF, "No nibble selected reads all released");
+    gb_destroy(gb);
 }
 
 // =============================================================================
@@ -96,6 +114,7 @@ int main() {
     RUN_TEST(vram_read_write);
     RUN_TEST(echo_ram);
     RUN_TEST(unusable_memory);
+    RUN_TEST(joypad_register);
 
     printf("\n----------------------------------------\n");
     if (tests_failed == 0) {
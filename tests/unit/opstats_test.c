@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "gb.h"
+#include "mbc.h"
+#include "opstats.h"
+
+// Emulator instance under test, recreated by every test case
+static gb_t* gb;
+
+// =============================================================================
+// A Simple Testing Framework
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_failed = 0;
+
+#define TEST_CASE(name) static void test_##name()
+#define RUN_TEST(name) do { printf("--- Running test: %s ---\n", #name); test_##name(); } while (0)
+
+#define ASSERT_EQ(a, b, message) \
+    do { \
+        tests_run++; \
+        if ((a) != (b)) { \
+            fprintf(stderr, "    [FAIL] %s:%d: " message " - Expected 0x%X, got 0x%X\n", __FILE__, __LINE__, (int)(b), (int)(a)); \
+            tests_failed++; \
+        } else { \
+            printf("    [PASS] %s\n", message); \
+        } \
+    } while (0)
+
+// =============================================================================
+// Test Helper Functions
+// =============================================================================
+
+// Fresh machine running the given program from 0x0100, counting enabled
+static void setup_test(const uint8_t* program, size_t size) {
+    gb = gb_create();
+    gb->mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
+    gb->mmu.rom_size = 32 * 1024;
+    mbc_init(&gb->mmu);
+    memcpy(&gb->mmu.rom_data[0x0100], program, size);
+    gb->mmu.interrupt_flag = 0;
+    gb->cpu.PC = 0x0100;
+    opstats_enable(gb);
+}
+
+static void teardown_test() {
+    gb_destroy(gb);
+}
+
+// =============================================================================
+// Test Cases
+// =============================================================================
+
+TEST_CASE(counts_and_cycles) {
+    static const uint8_t program[] = {
+        0x06, 0x03,         // 0100 LD B, 3
+        0x05,               // 0102 DEC B
+        0x20, 0xFD,         //      JR NZ, 0x0102    taken twice, then falls through
+        0x3C,               //      INC A
+    };
+    setup_test(program, sizeof(program));
+    ASSERT_EQ(gb->opstats != NULL, true, "Counters allocated");
+
+    for (int i = 0; i < 8; i++) {
+        cpu_step(gb);
+    }
+    ASSERT_EQ(gb->opstats->count[0][0x06], 1, "LD B, d8 ran once");
+    ASSERT_EQ(gb->opstats->count[0][0x05], 3, "DEC B ran three times");
+    ASSERT_EQ(gb->opstats->count[0][0x20], 3, "JR NZ ran three times");
+    ASSERT_EQ(gb->opstats->cycles[0][0x20], 12 + 12 + 8, "JR NZ cycles: two taken, one not");
+    ASSERT_EQ(gb->opstats->count[0][0x3C], 1, "INC A ran once");
+
+    teardown_test();
+}
+
+TEST_CASE(cb_counted_separately) {
+    static const uint8_t program[] = {
+        0xCB, 0x7C,         // 0100 BIT 7, H
+        0xCB, 0x46,         // 0102 BIT 0, (HL)
+    };
+    setup_test(program, sizeof(program));
+    gb->cpu.H = 0xC0;
+    gb->cpu.L = 0x00;
+
+    cpu_step(gb);
+    cpu_step(gb);
+    ASSERT_EQ(gb->opstats->count[1][0x7C], 1, "BIT 7, H counted in the CB table");
+    ASSERT_EQ(gb->opstats->cycles[1][0x7C], 8, "BIT 7, H takes 8 cycles");
+    ASSERT_EQ(gb->opstats->cycles[1][0x46], 12, "BIT 0, (HL) takes 12 cycles");
+    ASSERT_EQ(gb->opstats->count[0][0xCB], 0, "The prefix itself is not counted");
+    ASSERT_EQ(strcmp(cpu_opcode_name(true, 0x7C), "cb_bit_7_h"), 0, "CB handler name");
+
+    teardown_test();
+}
+
+TEST_CASE(halt_not_counted) {
+    static const uint8_t program[] = {
+        0x76,               // 0100 HALT
+    };
+    setup_test(program, sizeof(program));
+
+    cpu_run_cycles(gb, 10000);
+    ASSERT_EQ(gb->opstats->count[0][0x76], 1, "HALT counted once");
+    ASSERT_EQ(gb->opstats->cycles[0][0x76], 4, "Time spent halted is not an instruction");
+
+    teardown_test();
+}
+
+TEST_CASE(report_sorted_by_cycles) {
+    static const uint8_t program[] = {
+        0x00,               // 0100 NOP              4 cycles
+        0x00,               //      NOP              4 cycles
+        0x00,               //      NOP              4 cycles
+        0xC3, 0x00, 0x01,   //      JP 0x0100        16 cycles, the most in total
+    };
+    setup_test(program, sizeof(program));
+    for (int i = 0; i < 8; i++) {
+        cpu_step(gb);
+    }
+
+    FILE* out = tmpfile();
+    ASSERT_EQ(opstats_report(gb, out, 0), 0, "Report written");
+    rewind(out);
+
+    char line[256];
+    char header[256], first[256] = "", second[256] = "";
+    fgets(header, sizeof(header), out);
+    fgets(line, sizeof(line), out);     // column names
+    fgets(first, sizeof(first), out);
+    fgets(second, sizeof(second), out);
+    fclose(out);
+
+    ASSERT_EQ(strcmp(header, "# 8 instructions, 56 T-cycles, 2 distinct opcodes\n"), 0, "Totals");
+    ASSERT_EQ(strstr(first, "op_jp_a16") != NULL, true, "JP first (32 cycles)");
+    ASSERT_EQ(strstr(second, "op_nop") != NULL, true, "NOP second (24 cycles)");
+
+    opstats_disable(gb);
+    ASSERT_EQ(opstats_report(gb, stdout, 0), -1, "No report once disabled");
+
+    teardown_test();
+}
+
+// =============================================================================
+// Test Runner
+// =============================================================================
+
+int main() {
+    printf("Starting opcode profile test suite...\n\n");
+
+    RUN_TEST(counts_and_cycles);
+    RUN_TEST(cb_counted_separately);
+    RUN_TEST(halt_not_counted);
+    RUN_TEST(report_sorted_by_cycles);
+
+    printf("\n----------------------------------------\n");
+    if (tests_failed == 0) {
+        printf("All %d tests passed! ✅\n", tests_run);
+    } else {
+        printf("%d of %d tests failed. ❌\n", tests_failed, tests_run);
+    }
+    printf("----------------------------------------\n");
+
+    return tests_failed > 0;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ppu_kernels.h"
+
+// =============================================================================
+// A Simple Testing Framework
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_failed = 0;
+
+#define TEST_CASE(name) static void test_##name()
+#define RUN_TEST(name) do { printf("--- Running test: %s ---\n", #name); test_##name(); } while (0)
+
+#define ASSERT_EQ(a, b, message) \
+    do { \
+        tests_run++; \
+        if ((a) != (b)) { \
+            fprintf(stderr, "    [FAIL] %s:%d: " message " - Expected 0x%X, got 0x%X\n", __FILE__, __LINE__, (int)(b), (int)(a)); \
+            tests_failed++; \
+        } else { \
+            printf("    [PASS] %s\n", message); \
+        } \
+    } while (0)
+
+// =============================================================================
+// Test Helper Functions
+// =============================================================================
+
+// small deterministic generator so failures reproduce
+static uint32_t rng_state = 0x12345678;
+static uint32_t next_random() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// =============================================================================
+// Test Cases
+// =============================================================================
+
+TEST_CASE(scalar_reference) {
+    const ppu_kernels_t* scalar = ppu_kernels_for(PPU_KERNELS_SCALAR);
+    ASSERT_EQ(scalar != NULL, true, "Scalar kernels always available");
+    ASSERT_EQ(ppu_kernels_best() != NULL, true, "Best kernels never NULL");
+    printf("    best kernels: %s\n", ppu_kernels_best()->name);
+
+    // row 0: lo = 0b10100000, hi = 0b11000000 -> 3, 1, 2, 0, ...
+    uint8_t tile[16] = { 0xA0, 0xC0 };
+    uint8_t out[64];
+    scalar->decode_tile(tile, out);
+    ASSERT_EQ(out[0], 3, "Both bitplanes set -> color 3");
+    ASSERT_EQ(out[1], 2, "High bitplane only -> color 2");
+    ASSERT_EQ(out[2], 1, "Low bitplane only -> color 1");
+    ASSERT_EQ(out[3], 0, "Neither bitplane -> color 0");
+    ASSERT_EQ(out[8], 0, "Row 1 decoded separately");
+
+    const uint32_t lut[4] = { 0x11111111, 0x22222222, 0x33333333, 0x44444444 };
+    const uint8_t index[4] = { 3, 0, 2, 1 };
+    uint32_t pixels[4];
+    scalar->expand_line(index, lut, pixels, 4);
+    ASSERT_EQ(pixels[0], 0x44444444, "Index 3 maps to lut[3]");
+    ASSERT_EQ(pixels[3], 0x22222222, "Index 1 maps to lut[1]");
+}
+
+TEST_CASE(decode_tile_bit_identical) {
+    const ppu_kernels_t* scalar = ppu_kernels_for(PPU_KERNELS_SCALAR);
+
+    for (int isa = PPU_KERNELS_SCALAR + 1; isa < PPU_KERNELS_ISA_COUNT; isa++) {
+        const ppu_kernels_t* simd = ppu_kernels_for((ppu_kernel_isa_t)isa);
+        if (!simd) {
+            printf("    [SKIP] instruction set %d not available\n", isa);
+            continue;
+        }
+
+        // every (low, high) bitplane pair, 8 rows per tile
+        int mismatches = 0;
+        for (int pair = 0; pair < 0x10000; pair += 8) {
+            uint8_t tile[16];
+            for (int row = 0; row < 8; row++) {
+                tile[row * 2] = (uint8_t)((pair + row) & 0xFF);
+                tile[row * 2 + 1] = (uint8_t)((pair + row) >> 8);
+            }
+
+            uint8_t expected[64], actual[64];
+            scalar->decode_tile(tile, expected);
+            simd->decode_tile(tile, actual);
+            mismatches += memcmp(expected, actual, sizeof(expected)) != 0;
+        }
+
+        printf("    %s:\n", simd->name);
+        ASSERT_EQ(mismatches, 0, "decode_tile matches scalar for every bitplane pair");
+    }
+}
+
+TEST_CASE(expand_line_bit_identical) {
+    const ppu_kernels_t* scalar = ppu_kernels_for(PPU_KERNELS_SCALAR);
+
+    for (int isa = PPU_KERNELS_SCALAR + 1; isa < PPU_KERNELS_ISA_COUNT; isa++) {
+        const ppu_kernels_t* simd = ppu_kernels_for((ppu_kernel_isa_t)isa);
+        if (!simd) {
+            printf("    [SKIP] instruction set %d not available\n", isa);
+            continue;
+        }
+
+        int mismatches = 0;
+        for (int trial = 0; trial < 2000; trial++) {
+            uint32_t lut[4];
+            for (int i = 0; i < 4; i++) {
+                lut[i] = next_random();
+            }
+
+            // every length up to a full line plus an unaligned start
+            int offset = trial % 7;
+            int count = trial % 168;
+            uint8_t index[176];
+            for (int i = 0; i < (int)sizeof(index); i++) {
+                index[i] = (uint8_t)(next_random() & 0x03);
+            }
+
+            uint32_t expected[176], actual[176];
+            memset(expected, 0xEE, sizeof(expected));
+            memset(actual, 0xEE, sizeof(actual));
+            scalar->expand_line(index + offset, lut, expected + offset, count);
+            simd->expand_line(index + offset, lut, actual + offset, count);
+            mismatches += memcmp(expected, actual, sizeof(expected)) != 0;
+        }
+
+        printf("    %s:\n", simd->name);
+        ASSERT_EQ(mismatches, 0, "expand_line matches scalar, no writes past count");
+    }
+}
+
+// =============================================================================
+// Test Runner
+// =============================================================================
+
+int main() {
+    printf("Starting PPU kernel test suite...\n\n");
+
+    RUN_TEST(scalar_reference);
+    RUN_TEST(decode_tile_bit_identical);
+    RUN_TEST(expand_line_bit_identical);
+
+    printf("\n----------------------------------------\n");
+    if (tests_failed == 0) {
+        printf("All %d tests passed! ✅\n", tests_run);
+    } else {
+        printf("%d of %d tests failed. ❌\n", tests_failed, tests_run);
+    }
+    printf("----------------------------------------\n");
+
+    return tests_failed > 0;
+}
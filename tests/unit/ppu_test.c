@@ -0,0 +1,451 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "gb.h"
+#include "mbc.h"
+#include "ppu.h"
+
+// Emulator instance under test, recreated by every test case so the
+// PPU state and framebuffer can be inspected directly.
+static gb_t* gb;
+static uint32_t framebuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+// =============================================================================
+// A Simple Testing Framework
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_failed = 0;
+
+#define TEST_CASE(name) static void test_##name()
+#define RUN_TEST(name) do { printf("--- Running test: %s ---\n", #name); test_##name(); } while (0)
+
+#define ASSERT_EQ(a, b, message) \
+    do { \
+        tests_run++; \
+        if ((a) != (b)) { \
+            fprintf(stderr, "    [FAIL] %s:%d: " message " - Expected 0x%X, got 0x%X\n", __FILE__, __LINE__, (int)(b), (int)(a)); \
+            tests_failed++; \
+        } else { \
+            printf("    [PASS] %s\n", message); \
+        } \
+    } while (0)
+
+// =============================================================================
+// Test Helper Functions
+// =============================================================================
+
+#define WHITE      0xFFFFFFFF
+#define LIGHT_GRAY 0xFFAAAAAA
+#define DARK_GRAY  0xFF555555
+#define BLACK      0xFF000000
+
+#define LINE_DOTS 456
+
+// Fills all 8 rows of a tile at 0x8000 + tile * 16 with the same bitplanes
+static void fill_tile(int tile, uint8_t lo, uint8_t hi) {
+    for (int row = 0; row < 8; row++) {
+        mmu_write(gb, 0x8000 + tile * 16 + row * 2, lo);
+        mmu_write(gb, 0x8000 + tile * 16 + row * 2 + 1, hi);
+    }
+}
+
+// Fresh machine with the identity palettes (color n -> shade n)
+static void setup_test() {
+    gb = gb_create();
+    ppu_set_framebuffer(gb, framebuffer);
+    mmu_write(gb, 0xFF47, 0xE4);    // BGP
+    mmu_write(gb, 0xFF48, 0xE4);    // OBP0
+    mmu_write(gb, 0xFF49, 0xE4);    // OBP1
+}
+
+static void teardown_test() {
+    gb_destroy(gb);
+}
+
+// =============================================================================
+// Test Cases
+// =============================================================================
+
+TEST_CASE(mode_timing) {
+    setup_test();
+
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x03, PPU_MODE_OAM_SCAN, "Line starts in OAM scan");
+    ppu_step(gb, 80);
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x03, PPU_MODE_DRAWING, "Drawing after 80 dots");
+    ppu_step(gb, 172);
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x03, PPU_MODE_HBLANK, "HBlank after 252 dots");
+    ppu_step(gb, 203);
+    ASSERT_EQ(mmu_read(gb, 0xFF44), 0, "Still on line 0 at dot 455");
+    ppu_step(gb, 1);
+    ASSERT_EQ(mmu_read(gb, 0xFF44), 1, "LY advances after 456 dots");
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x03, PPU_MODE_OAM_SCAN, "Next line starts in OAM scan");
+
+    mmu_write(gb, 0xFF44, 0x55);
+    ASSERT_EQ(mmu_read(gb, 0xFF44), 1, "LY is read only");
+
+    teardown_test();
+}
+
+TEST_CASE(vblank_interrupt) {
+    setup_test();
+    gb->mmu.interrupt_flag = 0;
+
+    ppu_step(gb, 144 * LINE_DOTS - 1);
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x01, 0, "No VBlank before line 144");
+
+    ppu_step(gb, 1);
+    ASSERT_EQ(mmu_read(gb, 0xFF44), 144, "LY reaches 144");
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x03, PPU_MODE_VBLANK, "Mode is VBlank");
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x01, 0x01, "VBlank interrupt requested");
+    ASSERT_EQ(gb->ppu.frame_ready, true, "Frame marked ready");
+
+    ppu_step(gb, 10 * LINE_DOTS);
+    ASSERT_EQ(mmu_read(gb, 0xFF44), 0, "LY wraps to 0 after line 153");
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x03, PPU_MODE_OAM_SCAN, "New frame starts in OAM scan");
+
+    teardown_test();
+}
+
+TEST_CASE(stat_interrupts) {
+    setup_test();
+
+    // LY == LYC source
+    mmu_write(gb, 0xFF45, 5);       // LYC
+    mmu_write(gb, 0xFF41, 0x40);    // LYC interrupt
+    gb->mmu.interrupt_flag = 0;
+    ppu_step(gb, 5 * LINE_DOTS - 1);
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x02, 0, "No STAT before LY == LYC");
+    ppu_step(gb, 1);
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x02, 0x02, "STAT requested when LY == LYC");
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x04, 0x04, "Coincidence flag set");
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x80, 0x80, "STAT bit 7 reads 1");
+
+    // HBlank source fires once per line
+    mmu_write(gb, 0xFF41, 0x08);
+    gb->mmu.interrupt_flag = 0;
+    ppu_step(gb, 252);
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x02, 0x02, "STAT requested on HBlank");
+    gb->mmu.interrupt_flag = 0;
+    ppu_step(gb, 100);
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x02, 0, "No second STAT within the same HBlank");
+
+    teardown_test();
+}
+
+TEST_CASE(lcd_off) {
+    setup_test();
+
+    ppu_step(gb, 3 * LINE_DOTS);
+    mmu_write(gb, 0xFF40, 0x11);    // LCD off
+    ASSERT_EQ(mmu_read(gb, 0xFF44), 0, "LY resets when the LCD is switched off");
+    ppu_step(gb, 10 * LINE_DOTS);
+    ASSERT_EQ(mmu_read(gb, 0xFF44), 0, "LY stays at 0 while the LCD is off");
+    ASSERT_EQ(mmu_read(gb, 0xFF41) & 0x03, PPU_MODE_HBLANK, "Mode reads 0 while the LCD is off");
+
+    mmu_write(gb, 0xFF40, 0x91);    // LCD on
+    ppu_step(gb, LINE_DOTS);
+    ASSERT_EQ(mmu_read(gb, 0xFF44), 1, "LCD restarts from line 0");
+
+    teardown_test();
+}
+
+TEST_CASE(background_render) {
+    setup_test();
+
+    fill_tile(1, 0xFF, 0x00);       // solid color 1
+    mmu_write(gb, 0x9800, 0x01);    // top left map entry
+    ppu_step(gb, LINE_DOTS);
+
+    ASSERT_EQ(gb->ppu.framebuffer[0], LIGHT_GRAY, "First tile drawn with color 1");
+    ASSERT_EQ(gb->ppu.framebuffer[7], LIGHT_GRAY, "First tile is 8 pixels wide");
+    ASSERT_EQ(gb->ppu.framebuffer[8], WHITE, "Second tile is tile 0 (color 0)");
+
+    // BGP maps color 1 to black
+    mmu_write(gb, 0xFF47, 0x0C);
+    mmu_write(gb, 0xFF43, 4);       // SCX
+    ppu_step(gb, LINE_DOTS);
+    ASSERT_EQ(gb->ppu.framebuffer[SCREEN_WIDTH + 3], BLACK, "Scrolled tile goes through BGP");
+    ASSERT_EQ(gb->ppu.framebuffer[SCREEN_WIDTH + 4], WHITE, "SCX scrolls the tile 4 pixels left");
+
+    teardown_test();
+}
+
+TEST_CASE(tile_cache_invalidation) {
+    setup_test();
+
+    fill_tile(1, 0xFF, 0x00);       // solid color 1
+    mmu_write(gb, 0x9800, 0x01);
+    ppu_step(gb, LINE_DOTS);
+    ASSERT_EQ(gb->ppu.framebuffer[0], LIGHT_GRAY, "Tile decoded on first use");
+    ASSERT_EQ(gb->ppu.tile_dirty[1], false, "Decoded tile is clean");
+
+    // rewrite one row of the tile, only that tile goes stale
+    mmu_write(gb, 0x8010 + 1 * 2, 0xFF);
+    mmu_write(gb, 0x8010 + 1 * 2 + 1, 0xFF);
+    ASSERT_EQ(gb->ppu.tile_dirty[1], true, "Tile data write marks the tile dirty");
+    ASSERT_EQ(gb->ppu.tile_dirty[0], false, "Other tiles stay clean");
+
+    ppu_step(gb, LINE_DOTS);
+    ASSERT_EQ(gb->ppu.framebuffer[SCREEN_WIDTH], BLACK, "Rewritten row drawn with the new data");
+
+    // tile maps are not cached, they keep their direct page table mapping
+    ASSERT_EQ(gb->mmu.write_map[0x98] != NULL, true, "Tile map pages are written directly");
+    ASSERT_EQ(gb->mmu.write_map[0x97] == NULL, true, "Tile data pages go through the handler");
+
+    teardown_test();
+}
+
+TEST_CASE(signed_tile_data) {
+    setup_test();
+
+    // LCDC bit 4 clear: tile 0 lives at 0x9000
+    for (int row = 0; row < 8; row++) {
+        mmu_write(gb, 0x9000 + row * 2, 0x00);
+        mmu_write(gb, 0x9000 + row * 2 + 1, 0xFF);  // color 2
+    }
+    mmu_write(gb, 0xFF40, 0x81);
+    ppu_step(gb, LINE_DOTS);
+    ASSERT_EQ(gb->ppu.framebuffer[0], DARK_GRAY, "Tile 0 read from 0x9000");
+
+    teardown_test();
+}
+
+TEST_CASE(window_render) {
+    setup_test();
+
+    fill_tile(2, 0xFF, 0xFF);       // solid color 3
+    for (int i = 0; i < 32; i++) {
+        mmu_write(gb, 0x9C00 + i, 0x02);
+    }
+    mmu_write(gb, 0xFF4A, 1);       // WY
+    mmu_write(gb, 0xFF4B, 7 + 80);  // WX
+    mmu_write(gb, 0xFF40, 0x91 | 0x20 | 0x40);  // window on, map at 0x9C00
+
+    ppu_step(gb, LINE_DOTS);
+    ASSERT_EQ(gb->ppu.framebuffer[80], WHITE, "Window starts at WY");
+
+    ppu_step(gb, LINE_DOTS);
+    uint32_t* line = &gb->ppu.framebuffer[SCREEN_WIDTH];
+    ASSERT_EQ(line[79], WHITE, "BG left of the window");
+    ASSERT_EQ(line[80], BLACK, "Window from WX - 7");
+    ASSERT_EQ(line[159], BLACK, "Window to the right edge");
+    ASSERT_EQ(gb->ppu.window_line, 1, "Window line counter advanced");
+
+    teardown_test();
+}
+
+TEST_CASE(no_framebuffer) {
+    setup_test();
+    ppu_set_framebuffer(gb, NULL);
+    gb->mmu.interrupt_flag = 0;
+
+    fill_tile(1, 0xFF, 0x00);
+    mmu_write(gb, 0x9800, 0x01);
+    mmu_write(gb, 0xFF4A, 0);
+    mmu_write(gb, 0xFF4B, 7);
+    mmu_write(gb, 0xFF40, 0x91 | 0x20);   // window on
+
+    ppu_step(gb, 144 * LINE_DOTS);
+    ASSERT_EQ(gb->ppu.ly, 144, "Timing unchanged without a framebuffer");
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x01, 0x01, "VBlank still requested");
+    ASSERT_EQ(gb->ppu.window_line, 144, "Window line counter still advances");
+
+    // attaching a buffer again picks up drawing on the next line
+    ppu_set_framebuffer(gb, framebuffer);
+    ASSERT_EQ(framebuffer[0], WHITE, "Attached buffer starts out white");
+    ppu_step(gb, 10 * LINE_DOTS + LINE_DOTS);
+    ASSERT_EQ(framebuffer[0], LIGHT_GRAY, "Lines drawn once a buffer is attached");
+
+    teardown_test();
+}
+
+TEST_CASE(render_skip) {
+    static uint32_t skipped_buffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+    // reference machine renders every frame, the other one every 4th
+    setup_test();
+    gb_t* reference = gb;
+    setup_test();
+    ppu_set_framebuffer(gb, skipped_buffer);
+    ppu_set_render_skip(gb, 3);
+
+    gb_t* machines[2] = { reference, gb };
+    for (int m = 0; m < 2; m++) {
+        gb = machines[m];
+        fill_tile(1, 0xFF, 0x00);
+        mmu_write(gb, 0x9800, 0x01);
+        mmu_write(gb, 0xFF41, 0x78);    // every STAT source
+        mmu_write(gb, 0xFF45, 20);
+        mmu_write(gb, 0xFF40, 0x91 | 0x20);
+        gb->mmu.interrupt_flag = 0;
+    }
+
+    int rendered = 0;
+    bool identical = true;
+    for (int frame = 0; frame < 8; frame++) {
+        for (int line = 0; line < 154; line++) {
+            ppu_step(reference, LINE_DOTS);
+            ppu_step(gb, LINE_DOTS);
+            identical = identical && gb_state_hash(reference) == gb_state_hash(gb);
+        }
+        if (gb->ppu.frame_ready) {
+            rendered++;
+            gb->ppu.frame_ready = false;
+        }
+        if (frame == 0) {
+            ASSERT_EQ(skipped_buffer[0], LIGHT_GRAY, "First frame rendered");
+            skipped_buffer[0] = 0;
+        }
+        if (frame == 1) {
+            ASSERT_EQ(skipped_buffer[0], 0, "Skipped frame writes no pixels");
+        }
+    }
+
+    ASSERT_EQ(identical, true, "State hash identical on every line while skipping");
+    ASSERT_EQ(rendered, 2, "Only every 4th frame rendered and marked ready");
+    ASSERT_EQ(gb->ppu.window_line, reference->ppu.window_line, "Window line counter kept");
+    ASSERT_EQ(framebuffer[0], LIGHT_GRAY, "Reference machine rendered");
+
+    gb_destroy(reference);
+    teardown_test();
+}
+
+TEST_CASE(sprite_render) {
+    setup_test();
+
+    fill_tile(1, 0x80, 0x80);       // only the leftmost pixel, color 3
+    fill_tile(3, 0xFF, 0x00);       // solid color 1 for the BG
+    mmu_write(gb, 0xFF40, 0x91 | 0x02); // sprites on
+
+    // sprite 0 at screen (10, 0)
+    mmu_write(gb, 0xFE00, 16);
+    mmu_write(gb, 0xFE01, 8 + 10);
+    mmu_write(gb, 0xFE02, 1);
+    mmu_write(gb, 0xFE03, 0x00);
+
+    // sprite 1 at screen (40, 0), X flipped
+    mmu_write(gb, 0xFE04, 16);
+    mmu_write(gb, 0xFE05, 8 + 40);
+    mmu_write(gb, 0xFE06, 1);
+    mmu_write(gb, 0xFE07, 0x20);
+
+    // sprite 2 at screen (80, 0), behind BG over a non zero BG tile
+    mmu_write(gb, 0x9800 + 10, 0x03);
+    mmu_write(gb, 0xFE08, 16);
+    mmu_write(gb, 0xFE09, 8 + 80);
+    mmu_write(gb, 0xFE0A, 1);
+    mmu_write(gb, 0xFE0B, 0x80);
+
+    ppu_step(gb, LINE_DOTS);
+    ASSERT_EQ(gb->ppu.framebuffer[10], BLACK, "Sprite pixel drawn");
+    ASSERT_EQ(gb->ppu.framebuffer[11], WHITE, "Color 0 is transparent");
+    ASSERT_EQ(gb->ppu.framebuffer[40], WHITE, "X flip moves the pixel");
+    ASSERT_EQ(gb->ppu.framebuffer[47], BLACK, "X flipped pixel on the right");
+    ASSERT_EQ(gb->ppu.framebuffer[80], LIGHT_GRAY, "BG priority hides the sprite");
+
+    ppu_step(gb, 8 * LINE_DOTS);
+    ASSERT_EQ(gb->ppu.framebuffer[8 * SCREEN_WIDTH + 10], WHITE, "8x8 sprite ends after 8 lines");
+
+    teardown_test();
+}
+
+TEST_CASE(kernels_render_identical) {
+    // the same busy frame rendered with the scalar and the best kernels
+    uint32_t* frames[2];
+    const ppu_kernels_t* kernels[2] = { ppu_kernels_for(PPU_KERNELS_SCALAR), ppu_kernels_best() };
+
+    for (int run = 0; run < 2; run++) {
+        setup_test();
+        gb->ppu.kernels = kernels[run];
+
+        srand(1234);
+        for (int addr = 0x8000; addr < 0xA000; addr++) {
+            mmu_write(gb, addr, (uint8_t)rand());
+        }
+        for (int addr = 0xFE00; addr < 0xFEA0; addr++) {
+            mmu_write(gb, addr, (uint8_t)rand());
+        }
+        mmu_write(gb, 0xFF40, 0xF7);    // everything on, 8x16 sprites
+        mmu_write(gb, 0xFF47, 0x1B);
+        mmu_write(gb, 0xFF48, 0xD2);
+        mmu_write(gb, 0xFF43, 3);
+        mmu_write(gb, 0xFF4A, 40);
+        mmu_write(gb, 0xFF4B, 50);
+        ppu_step(gb, 144 * LINE_DOTS);
+
+        frames[run] = malloc(sizeof(framebuffer));
+        memcpy(frames[run], framebuffer, sizeof(framebuffer));
+        teardown_test();
+    }
+
+    printf("    comparing scalar against %s\n", kernels[1]->name);
+    ASSERT_EQ(memcmp(frames[0], frames[1], SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t)), 0, "Frames are bit-identical");
+    free(frames[0]);
+    free(frames[1]);
+}
+
+TEST_CASE(oam_dma) {
+    setup_test();
+
+    for (int i = 0; i < 0xA0; i++) {
+        mmu_write(gb, 0xC100 + i, (uint8_t)(i ^ 0x5A));
+    }
+    mmu_write(gb, 0xFF46, 0xC1);
+    ASSERT_EQ(gb->mmu.oam[0x00], 0x5A, "DMA copied the first byte");
+    ASSERT_EQ(gb->mmu.oam[0x9F], 0x9F ^ 0x5A, "DMA copied the last byte");
+
+    teardown_test();
+}
+
+TEST_CASE(cpu_drives_ppu) {
+    setup_test();
+
+    // a ROM full of NOPs
+    gb->mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
+    gb->mmu.rom_size = 32 * 1024;
+    mbc_init(&gb->mmu);
+    gb->mmu.interrupt_flag = 0;
+
+    cpu_run_cycles(gb, 144 * LINE_DOTS);
+    ASSERT_EQ(gb->ppu.ly, 144, "CPU loop advances the PPU");
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x01, 0x01, "VBlank requested from the CPU loop");
+
+    teardown_test();
+}
+
+// =============================================================================
+// Test Runner
+// =============================================================================
+
+int main() {
+    printf("Starting PPU test suite...\n\n");
+
+    RUN_TEST(mode_timing);
+    RUN_TEST(vblank_interrupt);
+    RUN_TEST(stat_interrupts);
+    RUN_TEST(lcd_off);
+    RUN_TEST(background_render);
+    RUN_TEST(tile_cache_invalidation);
+    RUN_TEST(signed_tile_data);
+    RUN_TEST(window_render);
+    RUN_TEST(no_framebuffer);
+    RUN_TEST(render_skip);
+    RUN_TEST(sprite_render);
+    RUN_TEST(kernels_render_identical);
+    RUN_TEST(oam_dma);
+    RUN_TEST(cpu_drives_ppu);
+
+    printf("\n----------------------------------------\n");
+    if (tests_failed == 0) {
+        printf("All %d tests passed! ✅\n", tests_run);
+    } else {
+        printf("%d of %d tests failed. ❌\n", tests_failed, tests_run);
+    }
+    printf("----------------------------------------\n");
+
+    return tests_failed > 0;
+}
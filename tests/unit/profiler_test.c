@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "gb.h"
+#include "mbc.h"
+#include "profiler.h"
+
+// Emulator instance under test, recreated by every test case
+static gb_t* gb;
+
+// =============================================================================
+// A Simple Testing Framework
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_failed = 0;
+
+#define TEST_CASE(name) static void test_##name()
+#define RUN_TEST(name) do { printf("--- Running test: %s ---\n", #name); test_##name(); } while (0)
+
+#define ASSERT_EQ(a, b, message) \
+    do { \
+        tests_run++; \
+        if ((a) != (b)) { \
+            fprintf(stderr, "    [FAIL] %s:%d: " message " - Expected 0x%X, got 0x%X\n", __FILE__, __LINE__, (int)(b), (int)(a)); \
+            tests_failed++; \
+        } else { \
+            printf("    [PASS] %s\n", message); \
+        } \
+    } while (0)
+
+// =============================================================================
+// Test Helper Functions
+// =============================================================================
+
+// Fresh MBC1 machine (4 banks) running the given program from 0x0100, sampling every `period` cycles
+static void setup_test(const uint8_t* program, size_t size, uint32_t period) {
+    gb = gb_create();
+    gb->mmu.rom_data = (uint8_t*)calloc(64 * 1024, 1);
+    gb->mmu.rom_size = 64 * 1024;
+    gb->mmu.mbc_type = MBC_TYPE_MBC1;
+    mbc_init(&gb->mmu);
+    memcpy(&gb->mmu.rom_data[0x0100], program, size);
+    gb->mmu.interrupt_flag = 0;
+    gb->cpu.PC = 0x0100;
+    profiler_enable(gb, period);
+}
+
+static void teardown_test() {
+    gb_destroy(gb);
+}
+
+static void write_text(const char* path, const char* text) {
+    FILE* f = fopen(path, "w");
+    fputs(text, f);
+    fclose(f);
+}
+
+// Reads a written report back into a buffer and closes the stream
+static void read_report(FILE* out, char* buffer, size_t size) {
+    rewind(out);
+    size_t length = fread(buffer, 1, size - 1, out);
+    buffer[length] = '\0';
+    fclose(out);
+}
+
+// =============================================================================
+// Test Cases
+// =============================================================================
+
+TEST_CASE(samples_follow_emulated_time) {
+    static const uint8_t program[] = {
+        0x18, 0xFE,         // 0100 JR 0x0100
+    };
+    setup_test(program, sizeof(program), 100);
+
+    cpu_run_cycles(gb, 10000);
+    ASSERT_EQ(gb->profiler->total_samples, 100, "One sample per 100 cycles");
+    ASSERT_EQ(gb->profiler->stack_count, 1, "A single location");
+    ASSERT_EQ(gb->profiler->stacks[0].locs[0], 0x0100, "Sampled at the loop");
+
+    teardown_test();
+}
+
+TEST_CASE(halt_weighted_by_time) {
+    static const uint8_t program[] = {
+        0x76,               // 0100 HALT             nothing enabled, never wakes
+    };
+    setup_test(program, sizeof(program), 64);
+
+    cpu_run_cycles(gb, 64 * 1000);
+    ASSERT_EQ(gb->profiler->total_samples, 1000, "HALT spans still count every period");
+
+    teardown_test();
+}
+
+TEST_CASE(call_stack_folded) {
+    static const uint8_t program[] = {
+        0xCD, 0x00, 0x02,   // 0100 CALL Work
+        0x18, 0xFB,         // 0103 JR 0x0100
+    };
+    setup_test(program, sizeof(program), 50);
+    gb->mmu.rom_data[0x0200] = 0x18;    // 0200 Work: JR Work
+    gb->mmu.rom_data[0x0201] = 0xFE;
+    write_text("profiler_test.sym",
+        "; File generated by rgblink\n"
+        "00:0100 Main\n"
+        "00:0103 Main.loop\n"
+        "00:0200 Work\n");
+    profiler_symbols_t* symbols = profiler_load_symbols("profiler_test.sym");
+    ASSERT_EQ(symbols != NULL, true, "Symbols loaded");
+
+    cpu_run_cycles(gb, 5000);
+    ASSERT_EQ(gb->profiler->depth, 1, "Inside one call");
+
+    char text[1024];
+    FILE* out = tmpfile();
+    ASSERT_EQ(profiler_write_folded(gb, out, symbols), 0, "Folded stacks written");
+    read_report(out, text, sizeof(text));
+    ASSERT_EQ(strncmp(text, "Main;Work ", 10), 0, "Caller first, then the callee");
+
+    out = tmpfile();
+    profiler_write_folded(gb, out, NULL);
+    read_report(out, text, sizeof(text));
+    ASSERT_EQ(strncmp(text, "00:0102;00:0200 ", 16), 0, "Raw locations without symbols");
+
+    out = tmpfile();
+    ASSERT_EQ(profiler_write_flat(gb, out, symbols, 0), 0, "Flat profile written");
+    read_report(out, text, sizeof(text));
+    const char* work = strstr(text, "Work");
+    const char* main_line = strstr(text, "Main");
+    ASSERT_EQ(work != NULL && main_line != NULL && work < main_line, true, "Work listed first (all self samples)");
+    const char* line = main_line;
+    while (line > text && line[-1] != '\n') {
+        line--;
+    }
+    unsigned long long main_self = 1;
+    sscanf(line, "%llu", &main_self);
+    ASSERT_EQ(main_self, 0, "Main has no self samples");
+
+    profiler_free_symbols(symbols);
+    remove("profiler_test.sym");
+    teardown_test();
+}
+
+TEST_CASE(return_pops_frame) {
+    static const uint8_t program[] = {
+        0xCD, 0x00, 0x02,   // 0100 CALL 0x0200
+        0xC5,               // 0103 PUSH BC          reuses the slot of the return address
+        0x18, 0xFE,         // 0104 JR 0x0104
+    };
+    setup_test(program, sizeof(program), 1000);
+    gb->mmu.rom_data[0x0200] = 0xC9;    // 0200 RET
+
+    for (int i = 0; i < 4; i++) {
+        cpu_step(gb);
+    }
+    ASSERT_EQ(gb->profiler->depth, 0, "RET dropped the frame");
+
+    cpu_run_cycles(gb, 10000);
+    ASSERT_EQ(gb->profiler->stacks[0].depth, 0, "Samples after the return have no caller");
+
+    teardown_test();
+}
+
+TEST_CASE(banked_code_symbolized) {
+    static const uint8_t program[] = {
+        0x3E, 0x02,         // 0100 LD A, 2
+        0xEA, 0x00, 0x20,   //      LD (0x2000), A   bank 2
+        0xC3, 0x00, 0x40,   //      JP 0x4000
+    };
+    setup_test(program, sizeof(program), 100);
+    gb->mmu.rom_data[2 * 0x4000] = 0x18;        // bank 2, 4000: JR 0x4000
+    gb->mmu.rom_data[2 * 0x4000 + 1] = 0xFE;
+    write_text("profiler_test.sym",
+        "01:4000 BankOne\n"
+        "02:4000 BankTwo\n"
+        "03:4000 BankThree\n");
+    profiler_symbols_t* symbols = profiler_load_symbols("profiler_test.sym");
+
+    cpu_run_cycles(gb, 10000);
+
+    char text[1024];
+    FILE* out = tmpfile();
+    profiler_write_folded(gb, out, symbols);
+    read_report(out, text, sizeof(text));
+    ASSERT_EQ(strstr(text, "BankTwo ") != NULL, true, "Code at 0x4000 resolved in bank 2");
+    ASSERT_EQ(strstr(text, "BankOne") == NULL, true, "Never mixed up with bank 1");
+
+    profiler_free_symbols(symbols);
+    remove("profiler_test.sym");
+    teardown_test();
+}
+
+// =============================================================================
+// Test Runner
+// =============================================================================
+
+int main() {
+    printf("Starting profiler test suite...\n\n");
+
+    RUN_TEST(samples_follow_emulated_time);
+    RUN_TEST(halt_weighted_by_time);
+    RUN_TEST(call_stack_folded);
+    RUN_TEST(return_pops_frame);
+    RUN_TEST(banked_code_symbolized);
+
+    printf("\n----------------------------------------\n");
+    if (tests_failed == 0) {
+        printf("All %d tests passed! ✅\n", tests_run);
+    } else {
+        printf("%d of %d tests failed. ❌\n", tests_failed, tests_run);
+    }
+    printf("----------------------------------------\n");
+
+    return tests_failed > 0;
+}
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "gb.h"
+#include "mbc.h"
+#include "timer.h"
+#include "scheduler.h"
+
+// Emulator instance under test, recreated by every test case
+static gb_t* gb;
+
+// =============================================================================
+// A Simple Testing Framework
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_failed = 0;
+
+#define TEST_CASE(name) static void test_##name()
+#define RUN_TEST(name) do { printf("--- Running test: %s ---\n", #name); test_##name(); } while (0)
+
+#define ASSERT_EQ(a, b, message) \
+    do { \
+        tests_run++; \
+        if ((a) != (b)) { \
+            fprintf(stderr, "    [FAIL] %s:%d: " message " - Expected 0x%X, got 0x%X\n", __FILE__, __LINE__, (int)(b), (int)(a)); \
+            tests_failed++; \
+        } else { \
+            printf("    [PASS] %s\n", message); \
+        } \
+    } while (0)
+
+// =============================================================================
+// Test Helper Functions
+// =============================================================================
+
+// Fresh machine running a ROM full of NOPs
+static void setup_test() {
+    gb = gb_create();
+    gb->mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
+    gb->mmu.rom_size = 32 * 1024;
+    mbc_init(&gb->mmu);
+    gb->mmu.interrupt_flag = 0;
+}
+
+static void teardown_test() {
+    gb_destroy(gb);
+}
+
+// =============================================================================
+// Test Cases
+// =============================================================================
+
+TEST_CASE(schedule_and_cancel) {
+    setup_test();
+
+    scheduler_schedule(gb, SCHED_TIMER, 500);
+    scheduler_schedule(gb, SCHED_PPU, 200);
+    ASSERT_EQ(gb->sched.next == 200, true, "Earliest event is cached");
+
+    scheduler_schedule(gb, SCHED_PPU, SCHED_NEVER);
+    ASSERT_EQ(gb->sched.next == 500, true, "Cancelling moves the cache to the next event");
+
+    scheduler_schedule(gb, SCHED_TIMER, SCHED_NEVER);
+    ASSERT_EQ(gb->sched.next == SCHED_NEVER, true, "Nothing scheduled");
+
+    teardown_test();
+}
+
+TEST_CASE(events_reschedule_themselves) {
+    setup_test();
+
+    // LCD on after reset: the PPU always has its next mode change scheduled
+    ASSERT_EQ(gb->sched.due[SCHED_PPU] == 80, true, "OAM scan ends at dot 80");
+
+    gb->sched.now = 80;
+    scheduler_run(gb);
+    ASSERT_EQ(gb->ppu.mode, PPU_MODE_DRAWING, "PPU event fired");
+    ASSERT_EQ(gb->sched.due[SCHED_PPU] == 80 + 172, true, "PPU scheduled its next mode change");
+
+    // timer stopped: no event at all
+    ASSERT_EQ(gb->sched.due[SCHED_TIMER] == SCHED_NEVER, true, "Stopped timer schedules nothing");
+    mmu_write(gb, 0xFF05, 0xFE);    // TIMA two increments from overflowing
+    mmu_write(gb, 0xFF07, 0x05);    // on, 16 cycles per TIMA increment
+    ASSERT_EQ(gb->sched.due[SCHED_TIMER] > gb->sched.now, true, "Enabling the timer schedules it");
+    ASSERT_EQ(gb->sched.due[SCHED_TIMER] - gb->sched.now <= 32, true, "Scheduled at the overflow");
+
+    teardown_test();
+}
+
+TEST_CASE(timer_matches_direct_stepping) {
+    // the scheduled timer ends every instruction boundary in the same state
+    // as a reference timer stepped after each instruction
+    setup_test();
+    gb_t* reference = gb_create();
+
+    mmu_write(gb, 0xFF07, 0x05);
+    mmu_write(gb, 0xFF06, 0xF0);
+    mmu_write(reference, 0xFF07, 0x05);
+    mmu_write(reference, 0xFF06, 0xF0);
+    reference->mmu.interrupt_flag = 0;
+
+    bool identical = true;
+    for (int i = 0; i < 2000; i++) {
+        cpu_run_cycles(gb, 4);      // one NOP, IME is off so nothing is dispatched
+        timer_step(reference, 4);
+        identical = identical && gb->mmu.tima == reference->mmu.tima &&
+                    gb->mmu.internal_timer == reference->mmu.internal_timer &&
+                    (gb->mmu.interrupt_flag & 0x04) == (reference->mmu.interrupt_flag & 0x04);
+    }
+    ASSERT_EQ(identical, true, "TIMA, DIV and the timer interrupt match on every instruction");
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x04, 0x04, "Timer overflowed at least once");
+
+    gb_destroy(reference);
+    teardown_test();
+}
+
+TEST_CASE(batch_leaves_peripherals_synced) {
+    setup_test();
+
+    // the end of a batch leaves every peripheral exact for register pokes from outside
+    cpu_run_cycles(gb, 456);
+    ASSERT_EQ(gb->ppu.ly, 1, "PPU caught up after the batch");
+    ASSERT_EQ(gb->ppu.synced_at == gb->sched.now, true, "PPU synced to the clock");
+    ASSERT_EQ(gb->sched.now == 456, true, "Clock advanced by the batch");
+
+    teardown_test();
+}
+
+// =============================================================================
+// Test Runner
+// =============================================================================
+
+int main() {
+    printf("Starting scheduler test suite...\n\n");
+
+    RUN_TEST(schedule_and_cancel);
+    RUN_TEST(events_reschedule_themselves);
+    RUN_TEST(timer_matches_direct_stepping);
+    RUN_TEST(batch_leaves_peripherals_synced);
+
+    printf("\n----------------------------------------\n");
+    if (tests_failed == 0) {
+        printf("All %d tests passed! ✅\n", tests_run);
+    } else {
+        printf("%d of %d tests failed. ❌\n", tests_failed, tests_run);
+    }
+    printf("----------------------------------------\n");
+
+    return tests_failed > 0;
+}
@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "gb.h"
+#include "mbc.h"
+#include "timer.h"
+#include "scheduler.h"
+
+// Emulator instance under test, recreated by every test case
+static gb_t* gb;
+
+// =============================================================================
+// A Simple Testing Framework
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_failed = 0;
+
+#define TEST_CASE(name) static void test_##name()
+#define RUN_TEST(name) do { printf("--- Running test: %s ---\n", #name); test_##name(); } while (0)
+
+#define ASSERT_EQ(a, b, message) \
+    do { \
+        tests_run++; \
+        if ((a) != (b)) { \
+            fprintf(stderr, "    [FAIL] %s:%d: " message " - Expected 0x%X, got 0x%X\n", __FILE__, __LINE__, (int)(b), (int)(a)); \
+            tests_failed++; \
+        } else { \
+            printf("    [PASS] %s\n", message); \
+        } \
+    } while (0)
+
+// =============================================================================
+// Test Helper Functions
+// =============================================================================
+
+// Fresh machine running a ROM full of NOPs
+static void setup_test() {
+    gb = gb_create();
+    gb->mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
+    gb->mmu.rom_size = 32 * 1024;
+    mbc_init(&gb->mmu);
+    gb->mmu.interrupt_flag = 0;
+}
+
+static void teardown_test() {
+    gb_destroy(gb);
+}
+
+// Reference timer: one T-cycle at a time, one falling edge at a time
+typedef struct {
+    uint16_t counter;
+    uint8_t tima, tma, tac;
+    bool overflowed;
+} ref_timer_t;
+
+static void ref_timer_tick(ref_timer_t* t, int cycles) {
+    static const int edge_bit[4] = { 9, 3, 5, 7 };
+    while (cycles-- > 0) {
+        uint16_t old = t->counter++;
+        int bit = edge_bit[t->tac & 0x03];
+        if ((t->tac & 0x04) && ((old >> bit) & 1) && !((t->counter >> bit) & 1)) {
+            if (++t->tima == 0) {
+                t->tima = t->tma;
+                t->overflowed = true;
+            }
+        }
+    }
+}
+
+// small deterministic generator so failures reproduce
+static uint32_t rng_state = 0x2468ACE1;
+static uint32_t next_random() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// =============================================================================
+// Test Cases
+// =============================================================================
+
+TEST_CASE(large_steps_are_exact) {
+    setup_test();
+
+    int mismatches = 0;
+    for (int trial = 0; trial < 500; trial++) {
+        ref_timer_t ref = {
+            .counter = (uint16_t)next_random(), .tima = (uint8_t)next_random(),
+            .tma = (uint8_t)next_random(), .tac = (uint8_t)(0x04 | (next_random() & 0x03)),
+        };
+        gb->mmu.internal_timer = ref.counter;
+        gb->mmu.tima = ref.tima;
+        gb->mmu.tma = ref.tma;
+        gb->mmu.tac = ref.tac;
+        gb->mmu.interrupt_flag = 0;
+
+        // anything from a single cycle to several full TIMA wraps in one step
+        int cycles = (int)(next_random() % (trial < 250 ? 64 : 1 << 20)) + 1;
+        ref_timer_tick(&ref, cycles);
+        timer_step(gb, cycles);
+
+        mismatches += gb->mmu.internal_timer != ref.counter || gb->mmu.tima != ref.tima ||
+                      ((gb->mmu.interrupt_flag & 0x04) != 0) != ref.overflowed;
+    }
+    ASSERT_EQ(mismatches, 0, "One timer_step matches cycle by cycle stepping");
+
+    teardown_test();
+}
+
+TEST_CASE(tma_ff_reloads_every_increment) {
+    setup_test();
+
+    gb->mmu.tac = 0x05;     // 16 cycles per increment
+    gb->mmu.tma = 0xFF;
+    gb->mmu.tima = 0xFF;
+    gb->mmu.internal_timer = 0;
+    timer_step(gb, 16 * 1000);
+    ASSERT_EQ(gb->mmu.tima, 0xFF, "TMA 0xFF keeps reloading");
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x04, 0x04, "Overflow requested the interrupt");
+
+    teardown_test();
+}
+
+TEST_CASE(overflow_scheduled_once) {
+    setup_test();
+
+    mmu_write(gb, 0xFF04, 0x00);    // DIV reset, counter at 0
+    mmu_write(gb, 0xFF06, 0x00);
+    mmu_write(gb, 0xFF05, 0x00);
+    mmu_write(gb, 0xFF07, 0x05);    // 16 cycles per increment, 256 increments to overflow
+    ASSERT_EQ(gb->sched.due[SCHED_TIMER] == gb->sched.now + 256 * 16, true, "Event at the overflow, not the next increment");
+
+    // the whole span is one batch: no timer sync before the overflow
+    cpu_run_cycles(gb, 256 * 16 - 4);
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x04, 0, "No interrupt one instruction early");
+    cpu_run_cycles(gb, 4);
+    ASSERT_EQ(gb->mmu.interrupt_flag & 0x04, 0x04, "Interrupt on the overflow instruction");
+    ASSERT_EQ(gb->mmu.tima, 0x00, "Reloaded from TMA");
+
+    teardown_test();
+}
+
+TEST_CASE(registers_catch_up_lazily) {
+    setup_test();
+
+    mmu_write(gb, 0xFF04, 0x00);
+    mmu_write(gb, 0xFF05, 0x10);
+    mmu_write(gb, 0xFF07, 0x05);
+    uint64_t synced = gb->mmu.timer_synced_at;
+
+    gb->sched.now += 160;           // time passes without any timer event
+    ASSERT_EQ(gb->mmu.timer_synced_at == synced, true, "Nothing applied until a register is touched");
+    ASSERT_EQ(mmu_read(gb, 0xFF05), 0x1A, "TIMA read catches up 10 increments");
+    ASSERT_EQ(mmu_read(gb, 0xFF04), 0x00, "DIV caught up too");
+
+    gb->sched.now += 96;
+    mmu_write(gb, 0xFF07, 0x04);    // slow down to 1024 cycles per increment
+    ASSERT_EQ(gb->mmu.tima, 0x20, "TAC write applies the old rate first");
+
+    teardown_test();
+}
+
+// =============================================================================
+// Test Runner
+// =============================================================================
+
+int main() {
+    printf("Starting timer test suite...\n\n");
+
+    RUN_TEST(large_steps_are_exact);
+    RUN_TEST(tma_ff_reloads_every_increment);
+    RUN_TEST(overflow_scheduled_once);
+    RUN_TEST(registers_catch_up_lazily);
+
+    printf("\n----------------------------------------\n");
+    if (tests_failed == 0) {
+        printf("All %d tests passed! ✅\n", tests_run);
+    } else {
+        printf("%d of %d tests failed. ❌\n", tests_failed, tests_run);
+    }
+    printf("----------------------------------------\n");
+
+    return tests_failed > 0;
+}
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "gb.h"
+#include "mbc.h"
+#include "trace.h"
+
+// Emulator instance under test, recreated by every test case
+static gb_t* gb;
+
+// =============================================================================
+// A Simple Testing Framework
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_failed = 0;
+
+#define TEST_CASE(name) static void test_##name()
+#define RUN_TEST(name) do { printf("--- Running test: %s ---\n", #name); test_##name(); } while (0)
+
+#define ASSERT_EQ(a, b, message) \
+    do { \
+        tests_run++; \
+        if ((a) != (b)) { \
+            fprintf(stderr, "    [FAIL] %s:%d: " message " - Expected 0x%X, got 0x%X\n", __FILE__, __LINE__, (int)(b), (int)(a)); \
+            tests_failed++; \
+        } else { \
+            printf("    [PASS] %s\n", message); \
+        } \
+    } while (0)
+
+// =============================================================================
+// Test Helper Functions
+// =============================================================================
+
+// Fresh machine running a ROM full of INC A from 0x0100
+static void setup_test() {
+    gb = gb_create();
+    gb->mmu.rom_data = (uint8_t*)calloc(32 * 1024, 1);
+    gb->mmu.rom_size = 32 * 1024;
+    mbc_init(&gb->mmu);
+    memset(&gb->mmu.rom_data[0x0100], 0x3C, 0x100);
+    gb->mmu.interrupt_flag = 0;
+    gb->cpu.PC = 0x0100;
+    gb->cpu.A = 0;
+}
+
+static void teardown_test() {
+    gb_destroy(gb);
+}
+
+// Reads a whole dumped trace file, returns its size (0 if missing)
+static size_t read_file(const char* path, uint8_t* out, size_t capacity) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return 0;
+    }
+    size_t size = fread(out, 1, capacity, f);
+    fclose(f);
+    return size;
+}
+
+// =============================================================================
+// Test Cases
+// =============================================================================
+
+TEST_CASE(ring_keeps_latest) {
+    setup_test();
+    ASSERT_EQ(trace_enable(gb, 5), true, "Tracing enabled");
+    ASSERT_EQ(gb->trace.capacity, 8, "Capacity rounded up to a power of two");
+
+    for (int i = 0; i < 20; i++) {
+        cpu_step(gb);
+    }
+    ASSERT_EQ(gb->trace.count, 20, "Every instruction counted");
+
+    const trace_record_t* newest = &gb->trace.records[19 % 8];
+    ASSERT_EQ(newest->pc, 0x0113, "Newest record is the last instruction");
+    ASSERT_EQ(newest->opcode, 0x3C, "Opcode recorded");
+    ASSERT_EQ(newest->a, 19, "Registers recorded before the instruction ran");
+    ASSERT_EQ(gb->trace.records[12 % 8].pc, 0x010C, "Oldest kept record is instruction 12");
+
+    teardown_test();
+}
+
+TEST_CASE(cb_operand_recorded) {
+    setup_test();
+    gb->mmu.rom_data[0x0100] = 0xCB;
+    gb->mmu.rom_data[0x0101] = 0x7C;    // BIT 7, H
+    trace_enable(gb, 4);
+
+    cpu_step(gb);
+    ASSERT_EQ(gb->trace.records[0].opcode, 0xCB, "CB prefix recorded as the opcode");
+    ASSERT_EQ(gb->trace.records[0].operand[0], 0x7C, "CB opcode recorded as the operand");
+
+    teardown_test();
+}
+
+TEST_CASE(dump_round_trip) {
+    setup_test();
+    ASSERT_EQ(trace_dump(gb, "trace_test.bin"), -1, "Nothing to dump while tracing is off");
+
+    trace_enable(gb, 8);
+    for (int i = 0; i < 20; i++) {
+        cpu_step(gb);
+    }
+    ASSERT_EQ(trace_dump(gb, "trace_test.bin"), 0, "Trace written");
+
+    uint8_t file[TRACE_HEADER_SIZE + 8 * TRACE_RECORD_SIZE + 1];
+    size_t size = read_file("trace_test.bin", file, sizeof(file));
+    ASSERT_EQ(size, TRACE_HEADER_SIZE + 8 * TRACE_RECORD_SIZE, "Header plus one record per kept instruction");
+    ASSERT_EQ(memcmp(file, TRACE_MAGIC, 8), 0, "Magic");
+    ASSERT_EQ(file[12], 8, "Record count");
+    ASSERT_EQ(file[16], 20, "Instructions seen");
+
+    const uint8_t* first = file + TRACE_HEADER_SIZE;
+    const uint8_t* last = first + 7 * TRACE_RECORD_SIZE;
+    ASSERT_EQ(first[0] | (first[1] << 8), 0x010C, "Oldest record first");
+    ASSERT_EQ(last[0] | (last[1] << 8), 0x0113, "Newest record last");
+    ASSERT_EQ(last[8], 19, "A of the newest record");
+
+    remove("trace_test.bin");
+    teardown_test();
+}
+
+TEST_CASE(dump_on_fault) {
+    setup_test();
+    gb->mmu.rom_data[0x0104] = 0xD3;    // illegal opcode
+    trace_enable(gb, 16);
+    gb->trace.dump_path = "trace_fault.bin";
+
+    cpu_run_cycles(gb, 1000);
+    ASSERT_EQ(gb->cpu.stopped, true, "CPU faulted");
+
+    uint8_t file[TRACE_HEADER_SIZE + 16 * TRACE_RECORD_SIZE];
+    size_t size = read_file("trace_fault.bin", file, sizeof(file));
+    ASSERT_EQ(size, TRACE_HEADER_SIZE + 5 * TRACE_RECORD_SIZE, "Trace dumped by the fault");
+
+    const uint8_t* last = file + TRACE_HEADER_SIZE + 4 * TRACE_RECORD_SIZE;
+    ASSERT_EQ(last[0] | (last[1] << 8), 0x0104, "Last record is the faulting instruction");
+    ASSERT_EQ(last[5], 0xD3, "Faulting opcode");
+
+    remove("trace_fault.bin");
+    teardown_test();
+}
+
+TEST_CASE(mapped_bank_recorded) {
+    setup_test();
+    free(gb->mmu.rom_data);
+    gb->mmu.rom_data = (uint8_t*)calloc(64 * 1024, 1);  // 4 banks, bank numbers wrap at 4
+    gb->mmu.rom_size = 64 * 1024;
+    gb->mmu.mbc_type = MBC_TYPE_MBC1;
+    mbc_init(&gb->mmu);
+    static const uint8_t program[] = {
+        0x3E, 0x05,         // 0100 LD A, 5
+        0xEA, 0x00, 0x20,   //      LD (0x2000), A   register 5, maps bank 1
+        0xC3, 0x00, 0x40,   //      JP 0x4000
+    };
+    memcpy(&gb->mmu.rom_data[0x0100], program, sizeof(program));
+    gb->mmu.rom_data[0x4000] = 0x3C;    // bank 1, 4000: INC A
+    trace_enable(gb, 4);
+
+    for (int i = 0; i < 4; i++) {
+        cpu_step(gb);
+    }
+    ASSERT_EQ(gb->mmu.current_rom_bank, 5, "MBC register holds 5");
+    ASSERT_EQ(gb->trace.records[3].pc, 0x4000, "Instruction in the switchable bank");
+    ASSERT_EQ(gb->trace.records[3].bank, 1, "Bank actually mapped recorded, not the register");
+    ASSERT_EQ(gb->trace.records[0].bank, 0, "No bank outside 0x4000-0x7FFF");
+
+    teardown_test();
+}
+
+// =============================================================================
+// Test Runner
+// =============================================================================
+
+int main() {
+    printf("Starting trace test suite...\n\n");
+
+    RUN_TEST(ring_keeps_latest);
+    RUN_TEST(cb_operand_recorded);
+    RUN_TEST(dump_round_trip);
+    RUN_TEST(dump_on_fault);
+    RUN_TEST(mapped_bank_recorded);
+
+    printf("\n----------------------------------------\n");
+    if (tests_failed == 0) {
+        printf("All %d tests passed! ✅\n", tests_run);
+    } else {
+        printf("%d of %d tests failed. ❌\n", tests_failed, tests_run);
+    }
+    printf("----------------------------------------\n");
+
+    return tests_failed > 0;
+}
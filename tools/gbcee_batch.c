@@ -0,0 +1,453 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "gb.h"
+#include "emu.h"
+#include "joypad.h"
+#include "movie.h"
+
+/**
+ * @file gbcee_batch.c
+ * @brief Runs many ROM sessions in one process, one emulator instance per job.
+ *
+ * Usage: gbcee_batch <manifest> [-j threads] [--no-idle-skip] [--verify-idle]
+ *
+ * Manifest: one job per line, `<rom> <frames> [movie]`, blank lines and
+ * lines starting with '#' are skipped. Paths cannot contain spaces. The
+ * movie file format is described in movie.h.
+ *
+ * Jobs are spread over a pool of worker threads. Every worker owns a deque:
+ * it takes its own work from the back and, once that runs dry, steals from
+ * the front of the other workers' deques, so a few long sessions do not
+ * leave the rest of the pool idle. Results are printed in manifest order
+ * once every job has finished.
+ *
+ * --no-idle-skip runs every job with idle loop skipping off. --verify-idle
+ * runs a second machine with skipping off next to every job and compares
+ * the two state hashes after every frame; the first mismatch ends the job
+ * with status "diverged" and the frame it happened on.
+ */
+
+#define MAX_PATH_LEN 1024
+
+/// outcome of a job
+typedef enum job_status_t {
+    JOB_PENDING,
+    JOB_OK,         // ran every requested frame
+    JOB_STOPPED,    // the CPU faulted before the last frame
+    JOB_ERROR,      // ROM or movie could not be loaded
+    JOB_DIVERGED,   // idle skipping changed the machine state (--verify-idle)
+} job_status_t;
+
+/// one manifest line and its results
+typedef struct batch_job_t {
+    char rom_path[MAX_PATH_LEN];
+    char movie_path[MAX_PATH_LEN];  // empty when the job has no movie
+    int frames;
+
+    job_status_t status;
+    int frames_run;     // for a diverged job, the frame that diverged
+    double seconds;
+    uint64_t hash;
+} batch_job_t;
+
+/// per worker deque of job indices
+typedef struct work_deque_t {
+    pthread_mutex_t lock;
+    int* jobs;
+    int head;   // next job to be stolen
+    int tail;   // one past the next job the owner takes
+} work_deque_t;
+
+/// shared state of the pool
+typedef struct batch_t {
+    batch_job_t* jobs;
+    int job_count;
+    work_deque_t* deques;
+    int worker_count;
+
+    bool idle_skip;         // skip idle loops (off with --no-idle-skip)
+    bool verify_idle;       // run every job against a machine that never skips
+} batch_t;
+
+/// argument handed to every worker thread
+typedef struct worker_t {
+    batch_t* batch;
+    int id;
+} worker_t;
+
+
+// ==========================================================================
+// Parsing
+// ==========================================================================
+
+static double now_seconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Loads the job manifest
+ *
+ * @param path: manifest file
+ * @param out_count: receives the number of jobs
+ *
+ * @returns malloc'd jobs, NULL on failure
+ */
+static batch_job_t* load_manifest(const char* path, int* out_count) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror("Manifest open failed");
+        return NULL;
+    }
+
+    batch_job_t* jobs = NULL;
+    int count = 0, capacity = 0;
+    char line[3 * MAX_PATH_LEN];
+
+    while (fgets(line, sizeof(line), f)) {
+        char rom[MAX_PATH_LEN], movie[MAX_PATH_LEN];
+        int frames;
+
+        int fields = sscanf(line, "%1023s %d %1023s", rom, &frames, movie);
+        if (line[0] == '#' || fields < 1) {
+            continue; // comment or blank line
+        }
+        if (fields < 2 || frames < 0) {
+            fprintf(stderr, "%s: bad manifest line: %s", path, line);
+            free(jobs);
+            fclose(f);
+            return NULL;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            batch_job_t* grown = realloc(jobs, capacity * sizeof(batch_job_t));
+            if (!grown) {
+                free(jobs);
+                fclose(f);
+                return NULL;
+            }
+            jobs = grown;
+        }
+
+        batch_job_t* job = &jobs[count++];
+        memset(job, 0, sizeof(*job));
+        strcpy(job->rom_path, rom);
+        if (fields == 3) {
+            strcpy(job->movie_path, movie);
+        }
+        job->frames = frames;
+        job->status = JOB_PENDING;
+    }
+
+    fclose(f);
+    *out_count = count;
+    return jobs;
+}
+
+
+// ==========================================================================
+// Jobs
+// ==========================================================================
+
+/**
+ * @brief Creates a machine with the job's ROM loaded
+ *
+ * @returns the machine, NULL if the ROM could not be loaded
+ */
+static gb_t* create_machine(const batch_job_t* job, bool idle_skip) {
+    gb_t* gb = gb_create();
+    if (!gb || mmu_load_rom(gb, job->rom_path) != 0) {
+        fprintf(stderr, "Error: Failed to load ROM '%s'.\n", job->rom_path);
+        gb_destroy(gb);
+        return NULL;
+    }
+    gb->serial_echo = false; // thousands of sessions must not share one stdout
+    gb->idle.enabled = idle_skip;
+    return gb;
+}
+
+/**
+ * @brief Runs one job on a fresh emulator instance and stores its results
+ *
+ * @param batch: options of the batch
+ * @param job: job to run
+ *
+ * @returns void
+ */
+static void run_job(const batch_t* batch, batch_job_t* job) {
+    movie_event_t* movie = NULL;
+    int movie_length = 0;
+
+    if (job->movie_path[0]) {
+        movie = movie_load(job->movie_path, &movie_length);
+        if (movie_length < 0) {
+            fprintf(stderr, "Error: Failed to load movie '%s'.\n", job->movie_path);
+            job->status = JOB_ERROR;
+            return;
+        }
+    }
+
+    gb_t* gb = create_machine(job, batch->idle_skip);
+    gb_t* reference = NULL;     // never skips, stepped in lockstep with gb
+    if (gb && batch->verify_idle) {
+        reference = create_machine(job, false);
+    }
+    if (!gb || (batch->verify_idle && !reference)) {
+        job->status = JOB_ERROR;
+        gb_destroy(gb);
+        free(movie);
+        return;
+    }
+
+    int next_event = 0;
+    bool diverged = false;
+    double start = now_seconds();
+
+    int frame;
+    for (frame = 0; frame < job->frames && !gb->cpu.stopped; frame++) {
+        // apply every input change that lands on this frame
+        while (next_event < movie_length && movie[next_event].frame <= frame) {
+            joypad_set_buttons(gb, movie[next_event].buttons);
+            if (reference) {
+                joypad_set_buttons(reference, movie[next_event].buttons);
+            }
+            next_event++;
+        }
+
+        int cycles = emu_run_frame(gb);
+        if (reference && (emu_run_frame(reference) != cycles ||
+                          gb_state_hash(reference) != gb_state_hash(gb))) {
+            diverged = true;
+            break;
+        }
+    }
+
+    job->seconds = now_seconds() - start;
+    job->frames_run = frame;
+    job->hash = gb_state_hash(gb);
+    job->status = diverged ? JOB_DIVERGED : gb->cpu.stopped ? JOB_STOPPED : JOB_OK;
+
+    gb_destroy(gb);
+    gb_destroy(reference);
+    free(movie);
+}
+
+
+// ==========================================================================
+// Work stealing pool
+// ==========================================================================
+
+/**
+ * @brief Takes the next job from the back of the worker's own deque
+ *
+ * @returns job index, -1 when the deque is empty
+ */
+static int deque_pop(work_deque_t* deque) {
+    int job = -1;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail > deque->head) {
+        job = deque->jobs[--deque->tail];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return job;
+}
+
+/**
+ * @brief Steals the oldest job from the front of another worker's deque
+ *
+ * @returns job index, -1 when the deque is empty
+ */
+static int deque_steal(work_deque_t* deque) {
+    int job = -1;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail > deque->head) {
+        job = deque->jobs[deque->head++];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return job;
+}
+
+static void* worker_main(void* arg) {
+    worker_t* worker = (worker_t*)arg;
+    batch_t* batch = worker->batch;
+
+    for (;;) {
+        int job = deque_pop(&batch->deques[worker->id]);
+
+        // own deque is dry, walk the others starting with the next worker
+        for (int i = 1; job < 0 && i < batch->worker_count; i++) {
+            job = deque_steal(&batch->deques[(worker->id + i) % batch->worker_count]);
+        }
+
+        // no job is ever added after startup, so nothing left to steal means done
+        if (job < 0) {
+            return NULL;
+        }
+
+        run_job(batch, &batch->jobs[job]);
+    }
+}
+
+static int default_thread_count() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+/**
+ * @brief Runs every job of the batch on worker_count threads
+ *
+ * @returns 0 on success, -1 if the pool could not be set up (the started workers are joined first)
+ */
+static int run_batch(batch_t* batch) {
+    int workers = batch->worker_count;
+
+    batch->deques = calloc(workers, sizeof(work_deque_t));
+    worker_t* args = calloc(workers, sizeof(worker_t));
+    pthread_t* threads = calloc(workers, sizeof(pthread_t));
+    if (!batch->deques || !args || !threads) {
+        free(batch->deques);
+        free(args);
+        free(threads);
+        return -1;
+    }
+
+    // deal the jobs out round robin, each deque sized for its share
+    int per_worker = (batch->job_count + workers - 1) / workers;
+    int status = 0;
+    for (int w = 0; w < workers; w++) {
+        work_deque_t* deque = &batch->deques[w];
+        pthread_mutex_init(&deque->lock, NULL);
+        deque->jobs = malloc((per_worker > 0 ? per_worker : 1) * sizeof(int));
+        if (!deque->jobs) {
+            status = -1;
+            continue;
+        }
+        for (int j = w; j < batch->job_count; j += workers) {
+            deque->jobs[deque->tail++] = j;
+        }
+    }
+
+    // the started workers steal whatever the missing ones would have run,
+    // so if a thread can't be created only the started ones are joined
+    int started = 0;
+    for (int w = 0; w < workers && status == 0; w++) {
+        args[w].batch = batch;
+        args[w].id = w;
+        if (pthread_create(&threads[w], NULL, worker_main, &args[w]) != 0) {
+            status = -1;
+            break;
+        }
+        started++;
+    }
+    for (int w = 0; w < started; w++) {
+        pthread_join(threads[w], NULL);
+    }
+
+    for (int w = 0; w < workers; w++) {
+        pthread_mutex_destroy(&batch->deques[w].lock);
+        free(batch->deques[w].jobs);
+    }
+    free(batch->deques);
+    free(args);
+    free(threads);
+    return status;
+}
+
+
+// ==========================================================================
+// Entry point
+// ==========================================================================
+
+int main(int argc, char* argv[]) {
+    const char* manifest = NULL;
+    int threads = 0;
+    bool idle_skip = true, verify_idle = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-idle-skip") == 0) {
+            idle_skip = false;
+        } else if (strcmp(argv[i], "--verify-idle") == 0) {
+            verify_idle = true;
+        } else if (!manifest) {
+            manifest = argv[i];
+        } else {
+            manifest = NULL;
+            break;
+        }
+    }
+    if (!manifest) {
+        fprintf(stderr, "Usage: %s <manifest> [-j threads] [--no-idle-skip] [--verify-idle]\n", argv[0]);
+        return 1;
+    }
+
+    batch_t batch = { 0 };
+    batch.idle_skip = idle_skip;
+    batch.verify_idle = verify_idle;
+    batch.jobs = load_manifest(manifest, &batch.job_count);
+    if (!batch.jobs) {
+        return 1;
+    }
+    if (batch.job_count == 0) {
+        fprintf(stderr, "Manifest '%s' has no jobs.\n", manifest);
+        free(batch.jobs);
+        return 1;
+    }
+
+    if (threads <= 0) {
+        threads = default_thread_count();
+    }
+    batch.worker_count = threads < batch.job_count ? threads : batch.job_count;
+
+    double start = now_seconds();
+    if (run_batch(&batch) != 0) {
+        fprintf(stderr, "Failed to set up the worker pool.\n");
+        free(batch.jobs);
+        return 1;
+    }
+    double wall = now_seconds() - start;
+
+    static const char* status_names[] = { "pending", "ok", "stopped", "error", "diverged" };
+    long long total_frames = 0;
+    int failed = 0;
+
+    for (int i = 0; i < batch.job_count; i++) {
+        batch_job_t* job = &batch.jobs[i];
+        double fps = job->seconds > 0 ? job->frames_run / job->seconds : 0.0;
+
+        printf("job=%d rom=%s status=%s frames=%d seconds=%.3f fps=%.1f hash=%016llx\n",
+            i, job->rom_path, status_names[job->status], job->frames_run,
+            job->seconds, fps, (unsigned long long)job->hash);
+
+        total_frames += job->frames_run;
+        failed += (job->status != JOB_OK);
+    }
+
+    printf("jobs=%d failed=%d threads=%d frames=%lld seconds=%.3f fps=%.1f\n",
+        batch.job_count, failed, batch.worker_count, total_frames, wall,
+        wall > 0 ? total_frames / wall : 0.0);
+
+    free(batch.jobs);
+    return failed ? 2 : 0;
+}
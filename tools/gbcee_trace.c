@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "trace.h"
+
+/**
+ * @file gbcee_trace.c
+ * @brief Decodes a binary instruction trace (see trace.h) into text.
+ *
+ * Usage: gbcee_trace <trace file> [-n last]
+ *
+ * Prints one line per instruction, oldest first, in the format of the
+ * LOG_CPU_STATE console log (registers before the instruction ran), with
+ * the ROM bank added for code in the banked area. -n limits the output to
+ * the last records, which are the ones leading up to a fault.
+ */
+
+static uint16_t get_u16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* in) {
+    return get_u16(in) | ((uint32_t)get_u16(in + 2) << 16);
+}
+
+/**
+ * @brief Prints one record
+ *
+ * @param in: TRACE_RECORD_SIZE bytes as written by trace_dump
+ *
+ * @returns void
+ */
+static void print_record(const uint8_t* in) {
+    uint16_t pc = get_u16(in);
+    uint16_t sp = get_u16(in + 2);
+    uint8_t bank = in[4], opcode = in[5];
+
+    if (opcode == 0xCB) {
+        printf("[PC=0x%04X] Opcode 0xCB %02X", pc, in[6]);
+    } else {
+        printf("[PC=0x%04X] Opcode 0x%02X   ", pc, opcode);
+    }
+    printf(" | A=%02X F=%02X B=%02X C=%02X D=%02X E=%02X H=%02X L=%02X SP=%04X",
+        in[8], in[9], in[10], in[11], in[12], in[13], in[14], in[15], sp);
+    if (pc >= 0x4000 && pc < 0x8000) {
+        printf(" | bank %u", bank);
+    }
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = NULL;
+    long last = -1;     // -1 = every record
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            last = strtol(argv[++i], NULL, 10);
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "Usage: %s <trace file> [-n last]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror("Trace open failed");
+        return 1;
+    }
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, f) != 1 || memcmp(header, TRACE_MAGIC, 8) != 0) {
+        fprintf(stderr, "%s: not a GBCee trace file\n", path);
+        fclose(f);
+        return 1;
+    }
+    if (get_u32(header + 8) != TRACE_VERSION) {
+        fprintf(stderr, "%s: unsupported trace version %u\n", path, get_u32(header + 8));
+        fclose(f);
+        return 1;
+    }
+
+    uint32_t count = get_u32(header + 12);
+    uint64_t seen = get_u32(header + 16) | ((uint64_t)get_u32(header + 20) << 32);
+    printf("# %u of %llu instructions\n", count, (unsigned long long)seen);
+
+    // skip to the last records if asked to
+    uint32_t skip = (last >= 0 && (uint64_t)last < count) ? count - (uint32_t)last : 0;
+    if (skip && fseek(f, (long)skip * TRACE_RECORD_SIZE, SEEK_CUR) != 0) {
+        fprintf(stderr, "%s: truncated trace\n", path);
+        fclose(f);
+        return 1;
+    }
+
+    uint8_t record[TRACE_RECORD_SIZE];
+    for (uint32_t i = skip; i < count; i++) {
+        if (fread(record, sizeof(record), 1, f) != 1) {
+            fprintf(stderr, "%s: truncated trace (%u of %u records)\n", path, i, count);
+            fclose(f);
+            return 1;
+        }
+        print_record(record);
+    }
+
+    fclose(f);
+    return 0;
+}